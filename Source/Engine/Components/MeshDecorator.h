@@ -90,6 +90,9 @@ namespace Engine
 			}
 		}
 
+		// Field by field, the renderer uses it to tell if a cached instance is still current
+		bool operator==(const MeshDecorator&) const = default;
+
 	private:
 
 		glm::vec4 cachedFill = glm::vec4(1.0f);
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Library/glm/glm.hpp"
+
+namespace Engine
+{
+
+	// Marks an entity as a large occluder for CPU occlusion culling, like a wall, a building or the terrain.
+	// The box is in the entity's local space and gets rasterized into the software depth buffer every frame,
+	// so it has to sit fully inside the visible geometry or things behind the gaps get culled.
+	// The default matches the unit cube primitive.
+	struct Occluder
+	{
+
+		glm::vec3 localMin{ -0.5f };
+		glm::vec3 localMax{ 0.5f };
+
+		Occluder() = default;
+
+		Occluder(const glm::vec3& min, const glm::vec3& max)
+			: localMin(min), localMax(max)
+		{}
+
+	};
+
+}
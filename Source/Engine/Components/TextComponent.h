@@ -3,7 +3,7 @@
 #include <memory>
 #include <string>
 #include <vector>
-#include <Engine/Systems/Renderer/Core/Font/FontData.h>
+#include <Engine/Systems/Renderer/Core/Font/GlyphLayout.h>
 #include "Library/glm/vec2.hpp"
 #include "Library/glm/vec4.hpp"
 
@@ -35,6 +35,7 @@ namespace Engine
 				utfDirty = true;
 				linesDirty = true;
 				lineWidthsDirty = true;
+				glyphQuadsDirty = true;
 			}
 		}
 
@@ -43,8 +44,9 @@ namespace Engine
 			if (font != newFont)
 			{
 				font = std::move(newFont);
-				// Only widths depend on the font metrics
+				// Only widths and the laid out glyphs depend on the font metrics
 				lineWidthsDirty = true;
+				glyphQuadsDirty = true;
 			}
 		}
 
@@ -53,8 +55,8 @@ namespace Engine
 			if (alignment != newAlign)
 			{
 				alignment = newAlign;
-				// Alignment does not change cached geometry data
-				// so no dirty flags needed here
+				// Lines and widths stay the same, only where each line starts moves
+				glyphQuadsDirty = true;
 			}
 		}
 
@@ -81,6 +83,18 @@ namespace Engine
 			return lineWidths;
 		}
 
+		// One EM space quad per laid out codepoint of this text that the font has a glyph for (missing ones and line breaks add none),
+		// with kerning and alignment applied.
+		// The renderers read this every frame, so it is only laid out again after the text, font or alignment changed.
+		const std::vector<GlyphQuad>& GetGlyphQuads()
+		{
+			if (glyphQuadsDirty) { RebuildGlyphQuads(); }
+			return glyphQuads;
+		}
+
+		// True until the next GetGlyphQuads lays the text out again, lets a renderer keep its copy of the quads until then
+		bool IsGlyphLayoutDirty() const { return glyphQuadsDirty; }
+
 	private:
 
 		std::string text;
@@ -90,10 +104,12 @@ namespace Engine
 		std::u32string utf32Text;
 		std::vector<std::u32string> lines;
 		std::vector<float> lineWidths;
+		std::vector<GlyphQuad> glyphQuads;
 
 		bool utfDirty = true;
 		bool linesDirty = true;
 		bool lineWidthsDirty = true;
+		bool glyphQuadsDirty = true;
 
 		// handles 3 byte codes, but not 4 byte codes for all the weird crazy emojis
 		static std::u32string Utf8ToUtf32(const std::string& s)
@@ -148,19 +164,20 @@ namespace Engine
 
 		static float MeasureEm(const std::u32string& line, const FontInfo& fi)
 		{
-			auto getKerning = [&](uint32_t l, uint32_t r)->float
-			{
-				auto it = fi.kerning.find(FontInfo::PackKerningKey(l, r));
-				return (it == fi.kerning.end()) ? 0.0f : it->second;
-			};
-
 			float w = 0.0f;
+			uint32_t glyphIndex = line.empty() ? FontInfo::NoGlyph : fi.FindGlyphIndex(line[0]);
+
 			for (size_t i = 0; i < line.size(); ++i)
 			{
-				auto ig = fi.glyphs.find(line[i]);
-				if (ig == fi.glyphs.end()) { continue; }
-				w += ig->second.advance;
-				if (i + 1 < line.size()) { w += getKerning(line[i], line[i + 1]); }
+				const uint32_t nextGlyphIndex = (i + 1 < line.size()) ? fi.FindGlyphIndex(line[i + 1]) : FontInfo::NoGlyph;
+
+				if (glyphIndex != FontInfo::NoGlyph)
+				{
+					w += fi.GetGlyphAt(glyphIndex).advance;
+					if (nextGlyphIndex != FontInfo::NoGlyph) { w += fi.GetKerningAt(glyphIndex, nextGlyphIndex); }
+				}
+
+				glyphIndex = nextGlyphIndex;
 			}
 
 			return w;
@@ -199,6 +216,38 @@ namespace Engine
 			lineWidthsDirty = false;
 		}
 
+		void RebuildGlyphQuads()
+		{
+			glyphQuads.clear();
+
+			if (font)
+			{
+				// Makes sure lines and widths are current
+				const std::vector<float>& widths = GetLineWidths();
+
+				for (size_t i = 0; i < lines.size(); ++i)
+				{
+					float x0 = 0.0f;
+					switch (alignment)
+					{
+						case TextAllignemt::Left:    x0 = 0.0f;              break;
+						case TextAllignemt::Center:  x0 = -0.5f * widths[i]; break;
+						case TextAllignemt::Right:   x0 = -widths[i];        break;
+						case TextAllignemt::Justified:
+						default:                     x0 = 0.0f;              break;
+					}
+					const float y0 = -static_cast<float>(i) * font->lineHeight;
+
+					TextLayout::BuildLineQuads(lines[i], *font, x0, y0, [&](const GlyphQuad& q)
+					{
+						glyphQuads.push_back(q);
+					});
+				}
+			}
+
+			glyphQuadsDirty = false;
+		}
+
 	};
 
 } // Namespace Engine
@@ -1,61 +1,45 @@
 #include "PCH.h"
 #include "Transform.h"
 #include "Engine/Systems/Scene/Scene.h"
+#include "Engine/Systems/Scene/SubSceneSystems/TransformDirtyTracker.h"
 
 namespace Engine
 {
 
 	void Transform::QueueDirtyEntity()
 	{
-		if (owner == entt::null)
+		if (owner == entt::null || !dirtyTracker)
 		{
 			return;
 		}
 
-		if (lastQueuedDirtyEpoch == DirtyEpoch)
+		if (lastQueuedDirtyEpoch == dirtyTracker->GetEpoch())
 		{
 			return;
 		}
 
-		lastQueuedDirtyEpoch = DirtyEpoch;
-		MarkEntityDirty(owner);
+		lastQueuedDirtyEpoch = dirtyTracker->GetEpoch();
+		dirtyTracker->MarkDirty(owner);
 	}
 
 	void Transform::MarkDirty()
 	{
-		const bool alreadyQueuedThisFrame = (lastQueuedDirtyEpoch == DirtyEpoch);
-
 		dirty = true;
-		worldDirty = true;
-		TransformsDirty = true;
-
-		if (!alreadyQueuedThisFrame)
-		{
-			++worldVersion;
-			++GlobalMutationVersion;
-			if (GlobalMutationVersion == 0)
-			{
-				GlobalMutationVersion = 1;
-			}
-			QueueDirtyEntity();
-			MarkChildrenDirty();
-		}
+		MarkWorldDirtyOnly();
 	}
 
 	void Transform::MarkWorldDirtyOnly()
 	{
-		const bool alreadyQueuedThisFrame = (lastQueuedDirtyEpoch == DirtyEpoch);
+		const bool alreadyQueuedThisFrame = dirtyTracker && (lastQueuedDirtyEpoch == dirtyTracker->GetEpoch());
 
 		worldDirty = true;
-		TransformsDirty = true;
 
 		if (!alreadyQueuedThisFrame)
 		{
 			++worldVersion;
-			++GlobalMutationVersion;
-			if (GlobalMutationVersion == 0)
+			if (dirtyTracker)
 			{
-				GlobalMutationVersion = 1;
+				dirtyTracker->NoteMutation();
 			}
 			QueueDirtyEntity();
 			MarkChildrenDirty();
@@ -64,11 +48,13 @@ namespace Engine
 
 	void Transform::MarkChildrenDirty()
 	{
-		// scuffed hack, but is the most painless for the rest of the engine. This is dangerous because what if this transform is not in the active scene?
-		auto scene = SwimEngine::GetInstance()->GetSceneSystem()->GetActiveScene();
-		if (!scene) return;
+		// Children live in the same registry as us, which only the tracker knows about
+		if (children.empty() || !dirtyTracker)
+		{
+			return;
+		}
 
-		entt::registry& reg = scene->GetRegistry();
+		entt::registry& reg = dirtyTracker->GetRegistry();
 
 		for (entt::entity child : children)
 		{
@@ -144,18 +130,23 @@ namespace Engine
 			return;
 		}
 
+		glm::vec3 worldPos;
+		glm::quat worldRot;
+		BlendPhysicsPose(physicsPrevWorldPos, physicsPrevWorldRot, physicsTargetWorldPos, physicsTargetWorldRot, alpha, worldPos, worldRot);
+
+		SetWorldPosition(registry, worldPos);
+		SetWorldRotation(registry, worldRot);
+	}
+
+	void Transform::BlendPhysicsPose(const glm::vec3& prevPos, const glm::quat& prevRot, const glm::vec3& targetPos, const glm::quat& targetRot, float alpha, glm::vec3& outPos, glm::quat& outRot)
+	{
 		float t = alpha;
 
 		if (t < 0.0f) { t = 0.0f; }
 		if (t > 1.0f) { t = 1.0f; }
 
-		const glm::vec3 worldPos = glm::mix(physicsPrevWorldPos, physicsTargetWorldPos, t);
-
-		glm::quat worldRot = glm::slerp(physicsPrevWorldRot, physicsTargetWorldRot, t);
-		worldRot = SafeNormalizeQuat(worldRot);
-
-		SetWorldPosition(registry, worldPos);
-		SetWorldRotation(registry, worldRot);
+		outPos = glm::mix(prevPos, targetPos, t);
+		outRot = SafeNormalizeQuat(glm::slerp(prevRot, targetRot, t));
 	}
 
 	void Transform::SetScreenSpaceLayerRelativeToParent(bool aboveParent)
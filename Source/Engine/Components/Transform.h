@@ -14,6 +14,7 @@ namespace Engine
 	// Forward declare
 	class Scene;
 	class PhysicsWorld;
+	class TransformDirtyTracker;
 
 	enum class TransformSpace : int
 	{
@@ -29,6 +30,10 @@ namespace Engine
 		friend class Scene;
 		// Physics world will do sync between its actors and their transforms
 		friend class PhysicsWorld;
+		// Propagates world matrices breadth first and fills the caches below
+		friend class TransformHierarchy;
+		// Binds owner + tracker when this is constructed in a tracked registry
+		friend class TransformDirtyTracker;
 
 	private:
 
@@ -45,10 +50,7 @@ namespace Engine
 		mutable glm::mat4 worldMatrix{ 1.0f }; // WORLD matrix
 		uint64_t worldVersion = 1; // increments whenever this transforms world answer changes
 
-		inline static bool TransformsDirty = false; // frame flag for stuff like BVH to rebuild
-		inline static std::vector<entt::entity> DirtyEntities{}; // coarse dirty list used by scene systems for incremental updates
-		inline static uint64_t DirtyEpoch = 1;
-		inline static uint64_t GlobalMutationVersion = 1; // monotonic transform mutation serial for renderer-side cache validation
+		TransformDirtyTracker* dirtyTracker = nullptr; // dirty set of the registry this lives in, null outside tracked registries
 		uint64_t lastQueuedDirtyEpoch = 0;
 		TransformSpace space = TransformSpace::World;
 
@@ -111,30 +113,8 @@ namespace Engine
 		const bool IsWorldDirty()			 const { return worldDirty; }
 		uint64_t GetWorldVersion() const { return worldVersion; }
 
-		static bool AreAnyTransformsDirty() { return TransformsDirty; }
-		static void ClearGlobalDirtyFlag() { TransformsDirty = false; }
-		static void ClearDirtyEntities()
-		{
-			DirtyEntities.clear();
-			++DirtyEpoch;
-			if (DirtyEpoch == 0)
-			{
-				DirtyEpoch = 1;
-			}
-		}
-		static const std::vector<entt::entity>& GetDirtyEntities() { return DirtyEntities; }
-		static uint64_t GetGlobalMutationVersion() { return GlobalMutationVersion; }
-
-		static void MarkEntityDirty(entt::entity entity)
-		{
-			if (entity != entt::null)
-			{
-				DirtyEntities.push_back(entity);
-				TransformsDirty = true;
-			}
-		}
-
 		entt::entity GetOwner() const { return owner; }
+		TransformDirtyTracker* GetDirtyTracker() const { return dirtyTracker; }
 
 		void SetPosition(const glm::vec3& pos)
 		{
@@ -242,6 +222,14 @@ namespace Engine
 
 		bool HasPhysicsTarget() const { return physicsHasTarget; }
 
+		const glm::vec3& GetPhysicsPrevWorldPosition() const { return physicsPrevWorldPos; }
+		const glm::vec3& GetPhysicsTargetWorldPosition() const { return physicsTargetWorldPos; }
+		const glm::quat& GetPhysicsPrevWorldRotation() const { return physicsPrevWorldRot; }
+		const glm::quat& GetPhysicsTargetWorldRotation() const { return physicsTargetWorldRot; }
+
+		// The world pose ApplyPhysicsInterpolation writes for alpha, static so it can be evaluated from a copy of the tick poses off the main thread
+		static void BlendPhysicsPose(const glm::vec3& prevPos, const glm::quat& prevRot, const glm::vec3& targetPos, const glm::quat& targetRot, float alpha, glm::vec3& outPos, glm::quat& outRot);
+
 	};
 
 } // Namespace Engine
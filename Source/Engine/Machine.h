@@ -1,5 +1,9 @@
 #pragma once
 
+#include "Engine/Systems/FrameTaskGraph.h"
+
+#include <optional>
+
 namespace Engine
 {
 
@@ -24,6 +28,15 @@ namespace Engine
 		// The param says what tick of the second it is 
 		virtual void FixedUpdate(unsigned int tickThisSecond) {};
 
+		// what Update reads and writes, SystemManager uses this to decide which systems can update at the same time
+		// defaults to exclusive access on the main thread
+		virtual FrameTaskAccess GetFrameTaskAccess() const { return FrameTaskAccess{}; };
+
+		// called once every frame after Update has finished, for systems whose Update runs on a worker and buffers its results
+		// only runs when GetFrameSyncAccess returns something, which is what FrameSync touches
+		virtual void FrameSync(double dt) {};
+		virtual std::optional<FrameTaskAccess> GetFrameSyncAccess() const { return std::nullopt; };
+
 		// called when destroyed
 		// returns an int for success code
 		virtual int Exit() { return 0;  };
@@ -4,6 +4,7 @@
 #include "Engine/Systems/Renderer/Vulkan/VulkanRenderer.h"
 #include "Engine/Systems/Renderer/OpenGL/OpenGLRenderer.h"
 #include "Engine/Systems/Renderer/OpenGL/ShaderToyRendererGL.h"
+#include "Engine/Utility/Profiler.h"
 
 namespace Engine
 {
@@ -671,6 +672,110 @@ namespace Engine
 		{
 			self->SendEditorMessage(L"[Engine] Restart requested (not implemented)");
 		});
+
+		// profiler on|off|dump [path]: CPU zone capture, dump writes Chrome trace JSON (chrome://tracing or ui.perfetto.dev)
+		commandSystem->RegisterRaw("profiler", [self](const std::vector<std::string>& args)
+		{
+			Profiler& profiler = Profiler::Get();
+			const std::string action = args.empty() ? "toggle" : args[0];
+
+			if (action == "on" || (action == "toggle" && !Profiler::IsRecording()))
+			{
+				profiler.SetRecording(true);
+				self->SendEditorMessage(L"[Engine] Profiler recording");
+			}
+			else if (action == "off" || action == "toggle")
+			{
+				profiler.SetRecording(false);
+				self->SendEditorMessage(L"[Engine] Profiler stopped");
+			}
+			else if (action == "dump")
+			{
+				const std::string path = args.size() > 1 ? args[1] : "swim_trace.json";
+				const bool wasRecording = Profiler::IsRecording();
+
+				// Pause so the ring buffers hold still while they are written out
+				profiler.SetRecording(false);
+				const bool written = profiler.ExportChromeTrace(path);
+				if (wasRecording)
+				{
+					profiler.SetRecording(true);
+				}
+
+				self->SendEditorMessage(written ? "[Engine] Profiler trace written to " + path : "[Engine] Profiler could not write " + path);
+			}
+			else
+			{
+				self->SendEditorMessage(L"[Engine] Usage: profiler on|off|dump [path]");
+			}
+		});
+
+		// occlusion on|off|stats: CPU occlusion culling of the BVH gather against Occluder entities (Vulkan only)
+		commandSystem->RegisterRaw("occlusion", [self](const std::vector<std::string>& args)
+		{
+			if constexpr (CONTEXT != RenderContext::Vulkan)
+			{
+				self->SendEditorMessage(L"[Engine] Occlusion culling is only wired into the Vulkan renderer");
+			}
+			else
+			{
+				if (!self->vulkanRenderer)
+				{
+					return;
+				}
+
+				VulkanIndexDraw& indexDraw = *self->vulkanRenderer->GetIndexDraw();
+				const std::string action = args.empty() ? "stats" : args[0];
+
+				if (action == "on" || action == "off")
+				{
+					indexDraw.SetUseOcclusionCulling(action == "on");
+					self->SendEditorMessage(action == "on" ? L"[Engine] Occlusion culling on" : L"[Engine] Occlusion culling off");
+				}
+				else
+				{
+					const OcclusionBuffer::Stats stats = indexDraw.GetOcclusionStats();
+					self->SendEditorMessage("[Engine] Occlusion " + std::string(indexDraw.GetUseOcclusionCulling() ? "on" : "off")
+						+ " | occluders " + std::to_string(stats.occluders)
+						+ " triangles " + std::to_string(stats.trianglesRasterized)
+						+ " tested " + std::to_string(stats.tested)
+						+ " visible " + std::to_string(stats.visible)
+						+ " occluded " + std::to_string(stats.occluded));
+				}
+			}
+		});
+
+		// uploads: bytes the last frame wrote into the world instance, visible slot and indirect buffers (Vulkan only)
+		commandSystem->RegisterRaw("uploads", [self](const std::vector<std::string>&)
+		{
+			if constexpr (CONTEXT != RenderContext::Vulkan)
+			{
+				self->SendEditorMessage(L"[Engine] Instance upload stats are only tracked by the Vulkan renderer");
+			}
+			else
+			{
+				if (!self->vulkanRenderer)
+				{
+					return;
+				}
+
+				const VulkanIndexDraw& indexDraw = *self->vulkanRenderer->GetIndexDraw();
+				const InstanceSlotUploader::Stats& stats = indexDraw.GetInstanceUploadStats();
+				self->SendEditorMessage("[Engine] Instance uploads | drawn " + std::to_string(indexDraw.GetInstanceCount())
+					+ " slots written " + std::to_string(stats.slotsWritten)
+					+ " copies " + std::to_string(stats.copies)
+					+ " slot bytes " + std::to_string(stats.slotBytes)
+					+ " packet bytes " + std::to_string(stats.packetBytes));
+			}
+		});
+
+		// framegraph: report how the last frame's system updates were scheduled and which ones bounded it
+		commandSystem->RegisterRaw("framegraph", [self](const std::vector<std::string>&)
+		{
+			const std::string report = self->systemManager->GetFrameTaskReport().ToString();
+			std::cout << report;
+			self->SendEditorMessage("[Engine] " + report);
+		});
 	}
 
 	int SwimEngine::Run()
@@ -757,6 +862,8 @@ namespace Engine
 
 	void SwimEngine::Update(double dt)
 	{
+		SWIM_PROFILE_ZONE("Frame");
+
 		static double timeAccumulator = 0.0;
 		static int frameCounter = 0;
 		static double dfps = 0.0;
@@ -0,0 +1,305 @@
+#include "PCH.h"
+#include "BenchmarkRunner.h"
+
+#include <Psapi.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace Engine
+{
+
+	namespace
+	{
+
+		std::vector<std::string> SplitCommaList(const std::string& value)
+		{
+			std::vector<std::string> out;
+			std::stringstream stream(value);
+			std::string token;
+			while (std::getline(stream, token, ','))
+			{
+				if (!token.empty())
+				{
+					out.push_back(token);
+				}
+			}
+			return out;
+		}
+
+		bool MatchesFilter(const std::string& filter, const std::string& name)
+		{
+			if (filter.empty() || filter == "all")
+			{
+				return true;
+			}
+
+			for (const std::string& token : SplitCommaList(filter))
+			{
+				if (token == name)
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+	}
+
+	void BenchmarkContext::SummarizeSamples(std::vector<double>& samples, double& outMedianNs, double& outMinNs)
+	{
+		outMedianNs = 0.0;
+		outMinNs = 0.0;
+
+		if (samples.empty())
+		{
+			return;
+		}
+
+		std::sort(samples.begin(), samples.end());
+		outMinNs = samples.front();
+		outMedianNs = samples[samples.size() / 2];
+	}
+
+	void BenchmarkContext::SampleWorkingSet()
+	{
+		casePeakWorkingSetBytes = std::max(casePeakWorkingSetBytes, BenchmarkRunner::GetWorkingSetBytes());
+	}
+
+	void BenchmarkContext::Report(BenchmarkResult result)
+	{
+		if (result.workItemsPerIteration > 0)
+		{
+			result.nsPerItem = result.medianNs / static_cast<double>(result.workItemsPerIteration);
+		}
+
+		SampleWorkingSet();
+		result.peakWorkingSetBytes = casePeakWorkingSetBytes;
+		casePeakWorkingSetBytes = 0;
+
+		std::cout << "[bench] " << result.benchmark << " | " << result.caseName
+			<< " | n=" << result.entityCount
+			<< " | " << std::fixed << std::setprecision(2) << result.nsPerItem << " ns/item"
+			<< " | median " << std::setprecision(3) << (result.medianNs / 1.0e6) << " ms"
+			<< " | nodes " << result.nodesVisitedPerIteration
+			<< std::defaultfloat << std::endl;
+
+		results.push_back(std::move(result));
+	}
+
+	std::vector<BenchmarkRunner::Entry>& BenchmarkRunner::GetFactory()
+	{
+		static std::vector<Entry> factory;
+		return factory;
+	}
+
+	void BenchmarkRunner::Preregister(const std::string& name, BenchmarkFn fn)
+	{
+		GetFactory().push_back({ name, fn });
+	}
+
+	bool BenchmarkRunner::WantsBenchmarkRun(int argc, char** argv)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string arg = argv[i];
+			if (arg == "--bench" || arg.rfind("--bench=", 0) == 0)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	BenchmarkOptions BenchmarkRunner::ParseOptions(int argc, char** argv)
+	{
+		BenchmarkOptions options;
+
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string arg = argv[i];
+
+			if (arg == "--bench" && i + 1 < argc && argv[i + 1][0] != '-')
+			{
+				options.filter = argv[++i];
+			}
+			else if (arg.rfind("--bench=", 0) == 0)
+			{
+				options.filter = arg.substr(std::string("--bench=").size());
+			}
+			else if (arg == "--bench-entities" && i + 1 < argc)
+			{
+				options.entityCounts.clear();
+				for (const std::string& token : SplitCommaList(argv[++i]))
+				{
+					const size_t count = static_cast<size_t>(std::strtoull(token.c_str(), nullptr, 10));
+					if (count > 0)
+					{
+						options.entityCounts.push_back(count);
+					}
+				}
+			}
+			else if (arg == "--bench-dirty" && i + 1 < argc)
+			{
+				options.dirtyPercents.clear();
+				for (const std::string& token : SplitCommaList(argv[++i]))
+				{
+					const float percent = std::strtof(token.c_str(), nullptr);
+					if (percent > 0.0f)
+					{
+						options.dirtyPercents.push_back(std::min(percent, 100.0f));
+					}
+				}
+			}
+			else if (arg == "--bench-models" && i + 1 < argc)
+			{
+				options.modelPaths = SplitCommaList(argv[++i]);
+			}
+			else if (arg == "--bench-iterations" && i + 1 < argc)
+			{
+				options.iterations = std::max<uint32_t>(1, static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10)));
+			}
+			else if (arg == "--bench-seed" && i + 1 < argc)
+			{
+				options.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+			}
+			else if (arg == "--bench-csv" && i + 1 < argc)
+			{
+				options.csvPath = argv[++i];
+			}
+		}
+
+		return options;
+	}
+
+	int BenchmarkRunner::RunFromArgs(int argc, char** argv)
+	{
+		const BenchmarkOptions options = ParseOptions(argc, argv);
+		BenchmarkContext context(options);
+
+		std::vector<Entry> entries = GetFactory();
+		std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.name < b.name; });
+
+		size_t ran = 0;
+		for (const Entry& entry : entries)
+		{
+			if (entry.fn == nullptr || !MatchesFilter(options.filter, entry.name))
+			{
+				continue;
+			}
+
+			std::cout << "[bench] Running " << entry.name << std::endl;
+			entry.fn(context);
+			++ran;
+		}
+
+		if (ran == 0)
+		{
+			std::cout << "[bench] No benchmark matched \"" << options.filter << "\". Available:";
+			for (const Entry& entry : entries)
+			{
+				std::cout << " " << entry.name;
+			}
+			std::cout << std::endl;
+			return -1;
+		}
+
+		PrintResults(context.GetResults());
+
+		if (!options.csvPath.empty() && !WriteCsv(options.csvPath, context.GetResults()))
+		{
+			std::cerr << "[bench] Failed to write " << options.csvPath << std::endl;
+			return -1;
+		}
+
+		return 0;
+	}
+
+	size_t BenchmarkRunner::GetPeakWorkingSetBytes()
+	{
+		PROCESS_MEMORY_COUNTERS counters{};
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		{
+			return static_cast<size_t>(counters.PeakWorkingSetSize);
+		}
+
+		return 0;
+	}
+
+	size_t BenchmarkRunner::GetWorkingSetBytes()
+	{
+		PROCESS_MEMORY_COUNTERS counters{};
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		{
+			return static_cast<size_t>(counters.WorkingSetSize);
+		}
+
+		return 0;
+	}
+
+	void BenchmarkRunner::PrintResults(const std::vector<BenchmarkResult>& results)
+	{
+		std::cout << std::endl;
+		std::cout << std::left
+			<< std::setw(12) << "benchmark"
+			<< std::setw(28) << "case"
+			<< std::right
+			<< std::setw(10) << "entities"
+			<< std::setw(14) << "ns/item"
+			<< std::setw(14) << "median ms"
+			<< std::setw(14) << "min ms"
+			<< std::setw(14) << "nodes/iter"
+			<< std::setw(14) << "struct MiB"
+			<< std::setw(14) << "peak MiB"
+			<< std::endl;
+
+		constexpr double kMiB = 1024.0 * 1024.0;
+		for (const BenchmarkResult& r : results)
+		{
+			std::cout << std::left
+				<< std::setw(12) << r.benchmark
+				<< std::setw(28) << r.caseName
+				<< std::right << std::fixed
+				<< std::setw(10) << r.entityCount
+				<< std::setw(14) << std::setprecision(2) << r.nsPerItem
+				<< std::setw(14) << std::setprecision(3) << (r.medianNs / 1.0e6)
+				<< std::setw(14) << std::setprecision(3) << (r.minNs / 1.0e6)
+				<< std::setw(14) << r.nodesVisitedPerIteration
+				<< std::setw(14) << std::setprecision(2) << (static_cast<double>(r.structureBytes) / kMiB)
+				<< std::setw(14) << std::setprecision(2) << (static_cast<double>(r.peakWorkingSetBytes) / kMiB)
+				<< std::defaultfloat << std::endl;
+		}
+	}
+
+	bool BenchmarkRunner::WriteCsv(const std::string& path, const std::vector<BenchmarkResult>& results)
+	{
+		std::ofstream file(path, std::ios::out | std::ios::trunc);
+		if (!file.is_open())
+		{
+			return false;
+		}
+
+		file << "benchmark,case,entities,work_items,iterations,median_ns,min_ns,ns_per_item,nodes_visited,structure_bytes,peak_working_set_bytes\n";
+		for (const BenchmarkResult& r : results)
+		{
+			file << r.benchmark << ','
+				<< r.caseName << ','
+				<< r.entityCount << ','
+				<< r.workItemsPerIteration << ','
+				<< r.iterations << ','
+				<< std::fixed << std::setprecision(1) << r.medianNs << ','
+				<< r.minNs << ','
+				<< std::setprecision(3) << r.nsPerItem << ','
+				<< r.nodesVisitedPerIteration << ','
+				<< r.structureBytes << ','
+				<< r.peakWorkingSetBytes << '\n';
+		}
+
+		return true;
+	}
+
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Headless CPU benchmarks for engine subsystems.
+// These run from main() before the engine is constructed, so they never touch the window, the GPU or the Win32 message loop.
+// Usage: "Swim Engine.exe --bench <name|all> [--bench-entities 10000,100000,1000000] [--bench-iterations 16] [--bench-dirty 1,10,50] [--bench-models a.glb,b.glb] [--bench-csv out.csv]"
+
+namespace Engine
+{
+
+	struct BenchmarkOptions
+	{
+		std::string filter = "all";
+		std::vector<size_t> entityCounts{ 10000, 100000, 1000000 };
+		std::vector<float> dirtyPercents{ 1.0f, 10.0f, 50.0f };
+		std::vector<std::string> modelPaths{ "Assets/Models/test_sofa.glb" }; // pass a plain and a Draco export of the same model to compare them
+		uint32_t iterations = 16;
+		uint32_t seed = 1337;
+		std::string csvPath;
+	};
+
+	struct BenchmarkResult
+	{
+		std::string benchmark;
+		std::string caseName;
+		size_t entityCount = 0;
+		size_t workItemsPerIteration = 0; // what ns/item is divided by, usually the entity count, or the ray count for ray casts
+		uint32_t iterations = 0;
+		double medianNs = 0.0;
+		double minNs = 0.0;
+		double nsPerItem = 0.0;
+		uint64_t nodesVisitedPerIteration = 0;
+		size_t structureBytes = 0;
+		size_t peakWorkingSetBytes = 0; // largest working set sampled around this case's measured calls, not the process lifetime peak
+	};
+
+	class BenchmarkContext
+	{
+
+	public:
+
+		explicit BenchmarkContext(const BenchmarkOptions& options)
+			: options{ options }
+		{}
+
+		const BenchmarkOptions& GetOptions() const { return options; }
+
+		// Runs one untimed warmup, then times func for the requested iterations and returns the median and min in nanoseconds.
+		// The working set is sampled after each call, outside the timed region.
+		// prepare runs before each timed call and is not included in the measurement.
+		template<typename Prepare, typename Func>
+		void Measure(uint32_t iterations, Prepare&& prepare, Func&& func, double& outMedianNs, double& outMinNs)
+		{
+			prepare();
+			func();
+			SampleWorkingSet();
+
+			std::vector<double> samples;
+			samples.reserve(iterations);
+
+			for (uint32_t i = 0; i < iterations; ++i)
+			{
+				prepare();
+
+				const auto start = std::chrono::high_resolution_clock::now();
+				func();
+				const auto end = std::chrono::high_resolution_clock::now();
+
+				samples.push_back(static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+				SampleWorkingSet();
+			}
+
+			SummarizeSamples(samples, outMedianNs, outMinNs);
+		}
+
+		void Report(BenchmarkResult result);
+
+		const std::vector<BenchmarkResult>& GetResults() const { return results; }
+
+	private:
+
+		static void SummarizeSamples(std::vector<double>& samples, double& outMedianNs, double& outMinNs);
+
+		// The OS peak never goes back down, so each case keeps its own from samples taken after every call
+		void SampleWorkingSet();
+
+		BenchmarkOptions options;
+		std::vector<BenchmarkResult> results;
+		size_t casePeakWorkingSetBytes = 0; // since the last Report
+
+	};
+
+	using BenchmarkFn = void(*)(BenchmarkContext& context);
+
+	class BenchmarkRunner
+	{
+
+	public:
+
+		static void Preregister(const std::string& name, BenchmarkFn fn);
+
+		// True if the command line asks for a benchmark run instead of booting the engine
+		static bool WantsBenchmarkRun(int argc, char** argv);
+
+		// Parses the --bench arguments, runs every matching benchmark and returns a process exit code
+		static int RunFromArgs(int argc, char** argv);
+
+		static size_t GetPeakWorkingSetBytes();
+		static size_t GetWorkingSetBytes();
+
+	private:
+
+		struct Entry
+		{
+			std::string name;
+			BenchmarkFn fn = nullptr;
+		};
+
+		// Function local so registrars in other translation units never race static initialization order
+		static std::vector<Entry>& GetFactory();
+
+		static BenchmarkOptions ParseOptions(int argc, char** argv);
+		static void PrintResults(const std::vector<BenchmarkResult>& results);
+		static bool WriteCsv(const std::string& path, const std::vector<BenchmarkResult>& results);
+
+	};
+
+}
+
+// A registrar struct that, when constructed, preregisters the benchmark function under the given name.
+namespace
+{
+	struct BenchmarkRegistrar
+	{
+		BenchmarkRegistrar(const std::string& name, Engine::BenchmarkFn fn)
+		{
+			Engine::BenchmarkRunner::Preregister(name, fn);
+		}
+	};
+}
+
+#define REGISTER_BENCHMARK(Name, Function) \
+    namespace { \
+        inline BenchmarkRegistrar benchmark_registrar_instance_##Name(#Name, &Function); \
+    }
@@ -0,0 +1,157 @@
+#include "PCH.h"
+#include "BenchmarkRunner.h"
+#include "Engine/Components/Transform.h"
+#include "Engine/Systems/Renderer/Core/Meshes/DrawPacketBuilder.h"
+
+#include <random>
+
+// Times DrawPacketBuilder sorting a frame's worth of world instances and writing the indexed draw commands into caller memory.
+// Instances are added in random order over a fixed set of meshes and textures, like a BVH gather hands them over.
+
+namespace Engine
+{
+
+	namespace
+	{
+
+		constexpr uint32_t kMeshCount = 256;
+		constexpr uint32_t kTextureCount = 64;
+		constexpr uint32_t kIndicesPerMesh = 36;
+
+		struct DrawPacketInstance
+		{
+			uint32_t meshID = 0;
+			uint32_t texture = 0;
+		};
+
+		std::vector<DrawPacketInstance> MakeInstances(size_t instanceCount, uint32_t seed)
+		{
+			std::mt19937 rng(seed);
+			std::uniform_int_distribution<uint32_t> mesh(0, kMeshCount - 1);
+			std::uniform_int_distribution<uint32_t> texture(0, kTextureCount - 1);
+
+			std::vector<DrawPacketInstance> instances(instanceCount);
+			for (DrawPacketInstance& instance : instances)
+			{
+				instance.meshID = mesh(rng);
+				instance.texture = texture(rng);
+			}
+
+			return instances;
+		}
+
+		DrawPacketMesh MakeMesh(uint32_t meshID)
+		{
+			DrawPacketMesh mesh;
+			mesh.meshID = meshID;
+			mesh.indexCount = kIndicesPerMesh;
+			mesh.firstIndex = meshID * kIndicesPerMesh;
+			mesh.vertexOffset = static_cast<int32_t>(meshID * 24);
+			return mesh;
+		}
+
+		// Every instance lands in exactly one command, commands cover the packet back to back and the sorted keys never go down
+		bool ValidatePacket(const std::vector<DrawIndexedCommand>& commands, const std::vector<uint32_t>& sources, const std::vector<DrawPacketInstance>& instances)
+		{
+			if (sources.size() != instances.size())
+			{
+				return false;
+			}
+
+			uint32_t expectedFirst = 0;
+			for (const DrawIndexedCommand& cmd : commands)
+			{
+				if (cmd.firstInstance != expectedFirst || cmd.instanceCount == 0)
+				{
+					return false;
+				}
+
+				const uint32_t meshID = instances[sources[cmd.firstInstance]].meshID;
+				if (cmd.firstIndex != meshID * kIndicesPerMesh)
+				{
+					return false;
+				}
+
+				for (uint32_t i = cmd.firstInstance; i < cmd.firstInstance + cmd.instanceCount; ++i)
+				{
+					if (instances[sources[i]].meshID != meshID)
+					{
+						return false;
+					}
+
+					if (i > cmd.firstInstance && instances[sources[i]].texture < instances[sources[i - 1]].texture)
+					{
+						return false;
+					}
+				}
+
+				expectedFirst += cmd.instanceCount;
+			}
+
+			return expectedFirst == instances.size();
+		}
+
+		void BenchmarkSort(BenchmarkContext& context, const std::vector<DrawPacketInstance>& instances)
+		{
+			const uint32_t iterations = context.GetOptions().iterations;
+
+			DrawPacketBuilder builder;
+			builder.Reserve(instances.size());
+
+			// Caller owned output, the way the Vulkan renderer hands over its indirect command array
+			std::vector<DrawIndexedCommand> commands;
+			std::vector<uint32_t> sources(instances.size());
+
+			auto buildPacket = [&]()
+			{
+				builder.Sort();
+				commands.resize(builder.GetCommandCount());
+
+				DrawPacketOutput output{};
+				output.commands = commands.data();
+				output.sourceIndices = sources.data();
+				builder.Build(output, false);
+			};
+
+			// Adding is part of the gather, the sort and the command cut are what is timed
+			auto addInstances = [&]()
+			{
+				builder.Clear();
+				for (const DrawPacketInstance& instance : instances)
+				{
+					builder.Add(MakeMesh(instance.meshID), instance.texture, static_cast<uint32_t>(TransformSpace::World));
+				}
+			};
+
+			BenchmarkResult result;
+			result.benchmark = "DrawPacket";
+			result.caseName = "Build";
+			result.entityCount = instances.size();
+			result.workItemsPerIteration = instances.size();
+			result.iterations = iterations;
+
+			context.Measure(iterations, addInstances, buildPacket, result.medianNs, result.minNs);
+
+			if (!ValidatePacket(commands, sources, instances))
+			{
+				std::cerr << "[bench] DrawPacket produced an invalid packet for " << instances.size() << " instances" << std::endl;
+			}
+
+			context.Report(std::move(result));
+		}
+
+		void RunDrawPacketBenchmark(BenchmarkContext& context)
+		{
+			const BenchmarkOptions& options = context.GetOptions();
+
+			for (size_t instanceCount : options.entityCounts)
+			{
+				BenchmarkSort(context, MakeInstances(instanceCount, options.seed));
+			}
+		}
+
+	}
+
+}
+
+REGISTER_BENCHMARK(DrawPacket, Engine::RunDrawPacketBenchmark)
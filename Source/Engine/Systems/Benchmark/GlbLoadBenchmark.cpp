@@ -0,0 +1,86 @@
+#include "PCH.h"
+#include "BenchmarkRunner.h"
+#include "Engine/Systems/Renderer/Core/Material/MaterialPool.h"
+
+#include <filesystem>
+
+// Times the CPU half of a GLB load: parse, image decode, Draco decode and vertex conversion, or the baked model read.
+// Nothing is registered, so no texture or mesh reaches the GPU. Run it on a plain and a Draco export of the same model to compare the two.
+
+namespace Engine
+{
+
+	namespace
+	{
+
+		void BenchmarkGlbLoad(BenchmarkContext& context, const std::string& path, bool baked)
+		{
+			MaterialPool& materialPool = MaterialPool::GetInstance();
+			GlbLoadStats stats;
+
+			const size_t workingSetBefore = BenchmarkRunner::GetWorkingSetBytes();
+			size_t workingSetPeakDelta = 0;
+
+			double medianNs = 0.0;
+			double minNs = 0.0;
+			context.Measure(context.GetOptions().iterations, []() {}, [&]()
+			{
+				GlbLoadHandle load = materialPool.LoadCompositeMaterialFromGLBAsync(path, /*allowBake:*/ baked);
+				MaterialPool::WaitForCompositeMaterialLoad(load);
+				stats = MaterialPool::GetCompositeMaterialLoadStats(load);
+
+				// What the decoded load holds on to until FinishCompositeMaterialLoad would hand it over
+				const size_t workingSet = BenchmarkRunner::GetWorkingSetBytes();
+				workingSetPeakDelta = std::max(workingSetPeakDelta, workingSet > workingSetBefore ? workingSet - workingSetBefore : 0);
+			}, medianNs, minNs);
+
+			if (stats.failed)
+			{
+				std::cerr << "[bench] GlbLoad failed to load " << path << std::endl;
+				return;
+			}
+
+			std::error_code ec;
+			const uint64_t fileBytes = std::filesystem::file_size(path, ec);
+
+			constexpr double kMiB = 1024.0 * 1024.0;
+			std::cout << "[bench] GlbLoad | " << path << (baked ? " (baked)" : "")
+				<< " | " << (static_cast<double>(fileBytes) / kMiB) << " MiB on disk"
+				<< " | " << stats.dracoPrimitiveCount << "/" << stats.primitiveCount << " primitives Draco"
+				<< " | decoded " << (static_cast<double>(stats.geometryBytes + stats.imageBytes) / kMiB) << " MiB"
+				<< " | working set +" << (static_cast<double>(workingSetPeakDelta) / kMiB) << " MiB"
+				<< std::endl;
+
+			BenchmarkResult result;
+			result.benchmark = "GlbLoad";
+			result.caseName = std::filesystem::path(path).filename().string() + (baked ? " baked" : " source");
+			result.entityCount = stats.vertexCount;
+			result.workItemsPerIteration = stats.vertexCount;
+			result.iterations = context.GetOptions().iterations;
+			result.medianNs = medianNs;
+			result.minNs = minNs;
+			result.structureBytes = stats.geometryBytes + stats.imageBytes;
+			context.Report(std::move(result));
+		}
+
+		void RunGlbLoadBenchmark(BenchmarkContext& context)
+		{
+			for (const std::string& path : context.GetOptions().modelPaths)
+			{
+				if (!std::filesystem::exists(path))
+				{
+					std::cerr << "[bench] GlbLoad skipping missing model " << path << std::endl;
+					continue;
+				}
+
+				// The source run writes no bake, the warmup of the baked run makes one if the model has none yet
+				BenchmarkGlbLoad(context, path, false);
+				BenchmarkGlbLoad(context, path, true);
+			}
+		}
+
+	}
+
+}
+
+REGISTER_BENCHMARK(GlbLoad, Engine::RunGlbLoadBenchmark)
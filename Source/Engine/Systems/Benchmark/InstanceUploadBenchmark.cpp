@@ -0,0 +1,244 @@
+#include "PCH.h"
+#include "BenchmarkRunner.h"
+#include "Engine/Components/Transform.h"
+#include "Engine/Systems/Renderer/Core/Meshes/InstanceSlotUploader.h"
+#include "Engine/Systems/Scene/SubSceneSystems/TransformDirtyTracker.h"
+#include "Engine/Systems/Scene/SubSceneSystems/TransformHierarchy.h"
+
+#include <cstring>
+#include <random>
+#include <set>
+
+// Times InstanceSlotUploader flushing dirty slots into per frame copies, without a device the destinations are plain CPU arrays.
+// Before timing it checks the upload sets against a reference copy per frame in flight through moves, resizes and removals,
+// and that a transform written after the scene cleared its dirty set (how physics poses land) is picked up in that same frame.
+
+namespace Engine
+{
+
+	namespace
+	{
+
+		constexpr uint32_t kFramesInFlight = 3;
+		constexpr size_t kSlotFloats = 16; // one mat4 per slot, what the uploader moves for world instances
+
+		// Source slots plus what each frame in flight last received, the way the instance buffers see it
+		struct InstanceUploadFixture
+		{
+			InstanceSlotUploader uploader{ kFramesInFlight, kSlotFloats * sizeof(float) };
+			std::vector<float> source;
+			std::vector<float> frames[kFramesInFlight];
+			std::set<uint32_t> expectedSlots[kFramesInFlight]; // what each frame should write on its next Flush
+
+			void Resize(size_t slotCount)
+			{
+				const size_t oldCount = source.size() / kSlotFloats;
+
+				source.resize(slotCount * kSlotFloats, 0.0f);
+				for (uint32_t frame = 0; frame < kFramesInFlight; ++frame)
+				{
+					frames[frame].resize(slotCount * kSlotFloats, -1.0f);
+					expectedSlots[frame].erase(expectedSlots[frame].lower_bound(static_cast<uint32_t>(slotCount)), expectedSlots[frame].end());
+					for (size_t slot = oldCount; slot < slotCount; ++slot)
+					{
+						expectedSlots[frame].insert(static_cast<uint32_t>(slot));
+					}
+				}
+				uploader.Resize(slotCount);
+			}
+
+			void Write(uint32_t slot, float value)
+			{
+				std::fill_n(source.begin() + slot * kSlotFloats, kSlotFloats, value);
+				for (std::set<uint32_t>& expected : expectedSlots)
+				{
+					expected.insert(slot);
+				}
+				uploader.MarkDirty(slot);
+			}
+
+			// Flushes one frame and reports whether its copy matches the source and exactly the changed slots went out, each once
+			bool FlushAndCompare(uint32_t frameIndex)
+			{
+				const size_t expected = expectedSlots[frameIndex].size();
+				expectedSlots[frameIndex].clear();
+
+				if (uploader.GetPendingCount(frameIndex) != expected)
+				{
+					return false;
+				}
+
+				uploader.Flush(frameIndex, source.data(), frames[frameIndex].data());
+
+				if (uploader.GetStats().slotsWritten != expected)
+				{
+					return false;
+				}
+
+				return std::memcmp(source.data(), frames[frameIndex].data(), source.size() * sizeof(float)) == 0;
+			}
+		};
+
+		bool ValidateSlotUploads(uint32_t seed)
+		{
+			std::mt19937 rng(seed);
+			InstanceUploadFixture fixture;
+			fixture.Resize(256);
+
+			for (uint32_t frame = 0; frame < 512; ++frame)
+			{
+				const size_t slotCount = fixture.uploader.GetSlotCount();
+
+				// Moves
+				const uint32_t moves = rng() % 32;
+				for (uint32_t i = 0; i < moves && slotCount > 0; ++i)
+				{
+					fixture.Write(static_cast<uint32_t>(rng() % slotCount), static_cast<float>(frame * 64 + i));
+				}
+
+				// Removals shrink the slot range, spawns grow it back, sometimes both before one flush
+				const uint32_t op = rng() % 8;
+				if (op == 0 && slotCount > 16)
+				{
+					fixture.Resize(slotCount - 1 - rng() % 16);
+				}
+				else if (op == 1)
+				{
+					fixture.Resize(slotCount + 1 + rng() % 16);
+				}
+				else if (op == 2 && slotCount > 16)
+				{
+					fixture.Resize(slotCount - 8);
+					fixture.Resize(slotCount + 8);
+				}
+
+				if (!fixture.FlushAndCompare(frame % kFramesInFlight))
+				{
+					return false;
+				}
+			}
+
+			// Every frame in flight has to catch up once nothing moves anymore
+			for (uint32_t frame = 0; frame < kFramesInFlight; ++frame)
+			{
+				if (!fixture.FlushAndCompare(frame) || fixture.uploader.GetPendingCount(frame) != 0)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		// Mirrors the frame order: scene update, hierarchy update, tracker Clear, then the physics sync stage writes poses and the renderer collects
+		bool ValidateLatePoseWrite()
+		{
+			entt::registry registry;
+			TransformDirtyTracker tracker{ registry };
+			TransformHierarchy hierarchy{ registry };
+			hierarchy.Init();
+
+			const entt::entity body = registry.create();
+			registry.emplace<Transform>(body, glm::vec3(0.0f), glm::vec3(1.0f));
+
+			std::vector<entt::entity> changed;
+			uint64_t seenEpoch = tracker.GetEpoch();
+
+			for (int frame = 1; frame <= 4; ++frame)
+			{
+				hierarchy.Update();
+				tracker.Clear();
+
+				const glm::vec3 pose(static_cast<float>(frame), 0.0f, 0.0f);
+				Transform& tf = registry.get<Transform>(body);
+				tf.SetWorldPosition(registry, pose);
+
+				if (!tracker.CollectChangedSince(seenEpoch, changed))
+				{
+					return false;
+				}
+				seenEpoch = tracker.GetEpoch();
+
+				if (std::count(changed.begin(), changed.end(), body) != 1)
+				{
+					return false;
+				}
+
+				if (glm::vec3(tf.GetWorldMatrix(registry)[3]) != pose)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		void BenchmarkFlush(BenchmarkContext& context, size_t slotCount, float dirtyPercent)
+		{
+			const uint32_t iterations = context.GetOptions().iterations;
+			const size_t dirtyCount = std::max<size_t>(1, static_cast<size_t>(static_cast<double>(slotCount) * dirtyPercent / 100.0));
+
+			InstanceUploadFixture fixture;
+			fixture.Resize(slotCount);
+			for (uint32_t frame = 0; frame < kFramesInFlight; ++frame)
+			{
+				fixture.uploader.Flush(frame, fixture.source.data(), fixture.frames[frame].data());
+			}
+
+			std::mt19937 rng(context.GetOptions().seed);
+			uint32_t frameIndex = 0;
+			float value = 0.0f;
+
+			auto moveSlots = [&]()
+			{
+				frameIndex = (frameIndex + 1) % kFramesInFlight;
+				value += 1.0f;
+				for (size_t i = 0; i < dirtyCount; ++i)
+				{
+					const uint32_t slot = static_cast<uint32_t>(rng() % slotCount);
+					std::fill_n(fixture.source.begin() + slot * kSlotFloats, kSlotFloats, value);
+					fixture.uploader.MarkDirty(slot);
+				}
+			};
+
+			BenchmarkResult result;
+			result.benchmark = "InstanceUpload";
+			result.caseName = "Flush " + std::to_string(static_cast<int>(dirtyPercent)) + "% dirty";
+			result.entityCount = slotCount;
+			result.workItemsPerIteration = dirtyCount;
+			result.iterations = iterations;
+
+			context.Measure(iterations, moveSlots, [&] { fixture.uploader.Flush(frameIndex, fixture.source.data(), fixture.frames[frameIndex].data()); }, result.medianNs, result.minNs);
+
+			result.structureBytes = fixture.source.size() * sizeof(float);
+			context.Report(std::move(result));
+		}
+
+		void RunInstanceUploadBenchmark(BenchmarkContext& context)
+		{
+			const BenchmarkOptions& options = context.GetOptions();
+
+			if (!ValidateSlotUploads(options.seed))
+			{
+				std::cerr << "[bench] InstanceUpload slot uploads diverged from the reference copies" << std::endl;
+			}
+
+			if (!ValidateLatePoseWrite())
+			{
+				std::cerr << "[bench] InstanceUpload missed a transform written after the dirty set was cleared" << std::endl;
+			}
+
+			for (size_t slotCount : options.entityCounts)
+			{
+				for (float dirtyPercent : options.dirtyPercents)
+				{
+					BenchmarkFlush(context, slotCount, dirtyPercent);
+				}
+			}
+		}
+
+	}
+
+}
+
+REGISTER_BENCHMARK(InstanceUpload, Engine::RunInstanceUploadBenchmark)
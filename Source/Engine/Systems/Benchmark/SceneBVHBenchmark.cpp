@@ -0,0 +1,310 @@
+#include "PCH.h"
+#include "BenchmarkRunner.h"
+#include "Engine/Components/Material.h"
+#include "Engine/Components/Transform.h"
+#include "Engine/Systems/Scene/SubSceneSystems/SceneBVH.h"
+#include "Engine/Systems/Scene/SubSceneSystems/TransformDirtyTracker.h"
+#include "Engine/Systems/Renderer/Core/Camera/Frustum.h"
+#include "Engine/Systems/Renderer/Core/MathTypes/Ray.h"
+#include "Library/glm/gtc/matrix_transform.hpp"
+
+#include <random>
+
+// Times SceneBVH build, refit, frustum queries and ray casts over a synthetic registry of Transform + Material entities.
+// Meshes only carry CPU side AABBs here, nothing is uploaded to the GPU.
+
+namespace Engine
+{
+
+	namespace
+	{
+
+		constexpr float kEntitySpacing = 4.0f; // average distance between entities, world grows with cbrt(count)
+		constexpr size_t kRaysPerIteration = 4096;
+
+		std::shared_ptr<MaterialData> MakeBoundsOnlyMaterial(const glm::vec3& halfExtents)
+		{
+			auto meshBufferData = std::make_shared<MeshBufferData>();
+			meshBufferData->aabbMin = glm::vec4(-halfExtents, 1.0f);
+			meshBufferData->aabbMax = glm::vec4(halfExtents, 1.0f);
+
+			auto mesh = std::make_shared<Mesh>();
+			mesh->meshBufferData = meshBufferData;
+
+			auto material = std::make_shared<MaterialData>();
+			material->mesh = mesh;
+			return material;
+		}
+
+		// Owns a registry and a BVH over it. The tracker and BVH are declared after the registry so they disconnect before the registry dies.
+		struct SceneBVHFixture
+		{
+			entt::registry registry;
+			TransformDirtyTracker dirtyTracker{ registry }; // same per registry dirty set a Scene owns
+			std::unique_ptr<SceneBVH> bvh;
+			std::vector<entt::entity> entities;
+			float worldHalfExtent = 0.0f;
+
+			SceneBVHFixture(size_t entityCount, uint32_t seed)
+			{
+				std::mt19937 rng(seed);
+				worldHalfExtent = 0.5f * kEntitySpacing * std::cbrt(static_cast<float>(entityCount));
+
+				std::uniform_real_distribution<float> position(-worldHalfExtent, worldHalfExtent);
+				std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+				std::uniform_real_distribution<float> angle(0.0f, 6.28318530718f);
+
+				const std::shared_ptr<MaterialData> materials[3] =
+				{
+					MakeBoundsOnlyMaterial(glm::vec3(0.5f)), // cube
+					MakeBoundsOnlyMaterial(glm::vec3(2.0f, 0.1f, 2.0f)), // slab
+					MakeBoundsOnlyMaterial(glm::vec3(0.2f, 3.0f, 0.2f)) // pole
+				};
+
+				bvh = std::make_unique<SceneBVH>(registry);
+				bvh->Init();
+
+				entities.reserve(entityCount);
+				for (size_t i = 0; i < entityCount; ++i)
+				{
+					const entt::entity e = registry.create();
+					const glm::quat rotation = glm::angleAxis(angle(rng), glm::vec3(0.0f, 1.0f, 0.0f));
+					registry.emplace<Transform>(e, glm::vec3(position(rng), position(rng), position(rng)), glm::vec3(scale(rng)), rotation);
+					registry.emplace<Material>(e, materials[i % 3]);
+					entities.push_back(e);
+				}
+
+				dirtyTracker.Clear();
+			}
+
+			~SceneBVHFixture()
+			{
+				bvh.reset();
+			}
+
+			void Rebuild()
+			{
+				bvh->ForceUpdateNextFrame();
+				bvh->Update();
+			}
+		};
+
+		void SetOrbitCamera(const SceneBVHFixture& fixture, uint32_t step)
+		{
+			const float yaw = static_cast<float>(step) * 0.05f;
+			const glm::vec3 eye(0.0f);
+			const glm::vec3 forward(std::cos(yaw), -0.15f, std::sin(yaw));
+			const glm::mat4 view = glm::lookAt(eye, eye + forward, glm::vec3(0.0f, 1.0f, 0.0f));
+			const glm::mat4 proj = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, std::max(fixture.worldHalfExtent, 1.0f));
+			Frustum::SetCameraMatrices(view, proj);
+		}
+
+		uint64_t WideNodesSince(const SceneBVH& bvh, const SceneBVH::TraversalStats& before)
+		{
+			return bvh.GetTraversalStats().wideNodesVisited - before.wideNodesVisited;
+		}
+
+		void BenchmarkBuild(BenchmarkContext& context, SceneBVHFixture& fixture)
+		{
+			const uint32_t iterations = context.GetOptions().iterations;
+
+			BenchmarkResult result;
+			result.benchmark = "SceneBVH";
+			result.caseName = "FullRebuild";
+			result.entityCount = fixture.entities.size();
+			result.workItemsPerIteration = fixture.entities.size();
+			result.iterations = iterations;
+
+			context.Measure(iterations, [] {}, [&] { fixture.Rebuild(); }, result.medianNs, result.minNs);
+
+			result.structureBytes = fixture.bvh->GetMemoryFootprintBytes();
+			context.Report(std::move(result));
+		}
+
+		void BenchmarkRefit(BenchmarkContext& context, SceneBVHFixture& fixture, float dirtyPercent)
+		{
+			const uint32_t iterations = context.GetOptions().iterations;
+			const size_t entityCount = fixture.entities.size();
+			const size_t dirtyCount = std::max<size_t>(1, static_cast<size_t>(static_cast<double>(entityCount) * dirtyPercent / 100.0));
+			const size_t stride = std::max<size_t>(1, entityCount / dirtyCount);
+
+			// Start every refit case from a fresh tree so earlier cases do not skew the fat bounds
+			fixture.Rebuild();
+
+			uint32_t step = 0;
+			auto dirtyTransforms = [&]()
+			{
+				fixture.dirtyTracker.Clear();
+
+				// Small oscillating nudge, stays mostly inside the fat AABBs like typical gameplay motion
+				const float offset = (step++ & 1u) ? 0.05f : -0.05f;
+				const size_t phase = step % stride;
+				for (size_t i = phase, touched = 0; i < entityCount && touched < dirtyCount; i += stride, ++touched)
+				{
+					const entt::entity e = fixture.entities[i];
+					Transform& tf = fixture.registry.get<Transform>(e);
+					tf.SetPosition(tf.GetPosition() + glm::vec3(offset, 0.0f, offset));
+				}
+			};
+
+			BenchmarkResult result;
+			result.benchmark = "SceneBVH";
+			result.caseName = "Update " + std::to_string(static_cast<int>(dirtyPercent)) + "% dirty";
+			result.entityCount = entityCount;
+			result.workItemsPerIteration = dirtyCount;
+			result.iterations = iterations;
+
+			context.Measure(iterations, dirtyTransforms, [&] { fixture.bvh->Update(); }, result.medianNs, result.minNs);
+
+			fixture.dirtyTracker.Clear();
+			result.structureBytes = fixture.bvh->GetMemoryFootprintBytes();
+			context.Report(std::move(result));
+		}
+
+		void BenchmarkFrustum(BenchmarkContext& context, SceneBVHFixture& fixture, bool parallel)
+		{
+			const uint32_t iterations = context.GetOptions().iterations;
+
+			std::vector<entt::entity> visible;
+			visible.reserve(fixture.entities.size());
+
+			uint32_t step = 0;
+			auto moveCamera = [&]() { SetOrbitCamera(fixture, step++); };
+			auto query = [&]()
+			{
+				if (parallel)
+				{
+					fixture.bvh->QueryFrustumParallel(Frustum::Get(), visible);
+				}
+				else
+				{
+					fixture.bvh->QueryFrustum(Frustum::Get(), visible);
+				}
+			};
+
+			BenchmarkResult result;
+			result.benchmark = "SceneBVH";
+			result.caseName = parallel ? "QueryFrustumParallel" : "QueryFrustum";
+			result.entityCount = fixture.entities.size();
+			result.workItemsPerIteration = fixture.entities.size();
+			result.iterations = iterations;
+
+			context.Measure(iterations, moveCamera, query, result.medianNs, result.minNs);
+
+			// One more traversal on a fresh camera just to sample how many nodes a query touches
+			moveCamera();
+			const SceneBVH::TraversalStats before = fixture.bvh->GetTraversalStats();
+			query();
+			result.nodesVisitedPerIteration = WideNodesSince(*fixture.bvh, before);
+			result.structureBytes = fixture.bvh->GetMemoryFootprintBytes();
+			context.Report(std::move(result));
+		}
+
+		std::vector<Ray> MakeRandomRays(const BenchmarkContext& context, const SceneBVHFixture& fixture)
+		{
+			std::mt19937 rng(context.GetOptions().seed ^ 0x9E3779B9u);
+			std::uniform_real_distribution<float> position(-fixture.worldHalfExtent, fixture.worldHalfExtent);
+			std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+
+			std::vector<Ray> rays;
+			rays.reserve(kRaysPerIteration);
+			for (size_t i = 0; i < kRaysPerIteration; ++i)
+			{
+				rays.emplace_back(glm::vec3(position(rng), position(rng), position(rng)), glm::vec3(direction(rng), direction(rng), direction(rng)));
+			}
+
+			return rays;
+		}
+
+		void BenchmarkRayCast(BenchmarkContext& context, SceneBVHFixture& fixture)
+		{
+			const uint32_t iterations = context.GetOptions().iterations;
+			const std::vector<Ray> rays = MakeRandomRays(context, fixture);
+
+			size_t hits = 0;
+			auto castAll = [&]()
+			{
+				for (const Ray& ray : rays)
+				{
+					if (fixture.bvh->RayCastClosestHit(ray) != entt::null)
+					{
+						++hits;
+					}
+				}
+			};
+
+			BenchmarkResult result;
+			result.benchmark = "SceneBVH";
+			result.caseName = "RayCastClosestHit";
+			result.entityCount = fixture.entities.size();
+			result.workItemsPerIteration = rays.size();
+			result.iterations = iterations;
+
+			context.Measure(iterations, [] {}, castAll, result.medianNs, result.minNs);
+
+			const SceneBVH::TraversalStats before = fixture.bvh->GetTraversalStats();
+			castAll();
+			result.nodesVisitedPerIteration = WideNodesSince(*fixture.bvh, before);
+			result.structureBytes = fixture.bvh->GetMemoryFootprintBytes();
+			context.Report(std::move(result));
+
+			// Keeps the optimizer from throwing the casts away
+			if (hits == SIZE_MAX)
+			{
+				std::cout << hits << std::endl;
+			}
+		}
+
+		void BenchmarkRayCastBatch(BenchmarkContext& context, SceneBVHFixture& fixture)
+		{
+			const uint32_t iterations = context.GetOptions().iterations;
+			const std::vector<Ray> rays = MakeRandomRays(context, fixture);
+			std::vector<SceneBVH::RayHit> hits;
+
+			auto castBatch = [&]() { fixture.bvh->RayCastBatch(rays, hits); };
+
+			BenchmarkResult result;
+			result.benchmark = "SceneBVH";
+			result.caseName = "RayCastBatch";
+			result.entityCount = fixture.entities.size();
+			result.workItemsPerIteration = rays.size();
+			result.iterations = iterations;
+
+			context.Measure(iterations, [] {}, castBatch, result.medianNs, result.minNs);
+
+			const SceneBVH::TraversalStats before = fixture.bvh->GetTraversalStats();
+			castBatch();
+			result.nodesVisitedPerIteration = WideNodesSince(*fixture.bvh, before);
+			result.structureBytes = fixture.bvh->GetMemoryFootprintBytes();
+			context.Report(std::move(result));
+		}
+
+		void RunSceneBVHBenchmark(BenchmarkContext& context)
+		{
+			const BenchmarkOptions& options = context.GetOptions();
+
+			for (size_t entityCount : options.entityCounts)
+			{
+				SceneBVHFixture fixture(entityCount, options.seed);
+				fixture.Rebuild();
+
+				BenchmarkBuild(context, fixture);
+
+				for (float dirtyPercent : options.dirtyPercents)
+				{
+					BenchmarkRefit(context, fixture, dirtyPercent);
+				}
+
+				fixture.Rebuild();
+				BenchmarkFrustum(context, fixture, false);
+				BenchmarkFrustum(context, fixture, true);
+				BenchmarkRayCast(context, fixture);
+				BenchmarkRayCastBatch(context, fixture);
+			}
+		}
+
+	}
+
+}
+
+REGISTER_BENCHMARK(SceneBVH, Engine::RunSceneBVHBenchmark)
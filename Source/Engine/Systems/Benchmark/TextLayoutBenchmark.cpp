@@ -0,0 +1,245 @@
+#include "PCH.h"
+#include "BenchmarkRunner.h"
+#include "Engine/Systems/Renderer/Core/Font/GlyphLayout.h"
+
+#include <random>
+
+// Times TextLayout::BuildLineQuads over one long line, which is a glyph lookup and a kerning read per codepoint.
+// The font is made up in memory the way FontPool fills one: printable ASCII and Latin-1 (all in the kerning matrix), a CJK block that
+// spills into the kerning rows and emoji past the BMP that go through the sparse glyph list. The same layout through the loaded hash maps,
+// how it was done before the lookup tables, runs next to it and has to produce the same quads.
+
+namespace Engine
+{
+
+	namespace
+	{
+
+		// Every codepoint range the font has, the text picks from them with the weights below
+		struct CodepointBlock
+		{
+			uint32_t first = 0;
+			uint32_t count = 0;
+			uint32_t textWeight = 0;
+		};
+
+		constexpr CodepointBlock kBlocks[] = {
+			{ 0x20, 95, 80 },     // printable ASCII
+			{ 0xA0, 96, 10 },     // Latin-1 supplement
+			{ 0x4E00, 128, 6 },   // CJK, past the kerning matrix
+			{ 0x1F600, 48, 4 },   // emoji, past the BMP
+		};
+
+		constexpr uint32_t kMissingCodepoint = 0x2603; // not in the font, layout has to skip it
+
+		FontInfo MakeFont(uint32_t seed)
+		{
+			std::mt19937 rng(seed);
+			std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+			FontInfo font;
+			font.fontName = "BenchmarkFont";
+			font.lineHeight = 1.2f;
+
+			std::vector<uint32_t> codepoints;
+			for (const CodepointBlock& block : kBlocks)
+			{
+				for (uint32_t cp = block.first; cp < block.first + block.count; ++cp)
+				{
+					Glyph g;
+					g.codepoint = cp;
+					g.advance = 0.4f + 0.3f * unit(rng);
+					g.plane = { 0.02f, -0.2f * unit(rng), g.advance - 0.02f, 0.7f + 0.1f * unit(rng) };
+					g.uv = { unit(rng), unit(rng), unit(rng), unit(rng) };
+					font.glyphs.emplace(cp, g);
+					codepoints.push_back(cp);
+				}
+			}
+
+			// Kerning between every ASCII pair with some chance, and a few pairs reaching into the other blocks
+			for (uint32_t left = 0x20; left < 0x7F; ++left)
+			{
+				for (uint32_t right = 0x20; right < 0x7F; ++right)
+				{
+					if (rng() % 4 == 0)
+					{
+						font.kerning.emplace(FontInfo::PackKerningKey(left, right), -0.05f * unit(rng));
+					}
+				}
+			}
+
+			for (uint32_t i = 0; i < 4096; ++i)
+			{
+				const uint32_t left = codepoints[rng() % codepoints.size()];
+				const uint32_t right = codepoints[rng() % codepoints.size()];
+				font.kerning.emplace(FontInfo::PackKerningKey(left, right), -0.05f * unit(rng));
+			}
+
+			font.BuildLookupTables();
+			return font;
+		}
+
+		std::u32string MakeLine(size_t length, uint32_t seed)
+		{
+			std::mt19937 rng(seed);
+
+			uint32_t totalWeight = 0;
+			for (const CodepointBlock& block : kBlocks)
+			{
+				totalWeight += block.textWeight;
+			}
+
+			std::u32string line(length, U' ');
+			for (char32_t& ch : line)
+			{
+				if (rng() % 256 == 0)
+				{
+					ch = kMissingCodepoint;
+					continue;
+				}
+
+				uint32_t pick = rng() % totalWeight;
+				for (const CodepointBlock& block : kBlocks)
+				{
+					if (pick < block.textWeight)
+					{
+						ch = static_cast<char32_t>(block.first + rng() % block.count);
+						break;
+					}
+					pick -= block.textWeight;
+				}
+			}
+
+			return line;
+		}
+
+		// BuildLineQuads as it read before the lookup tables, a hashed glyph and kerning lookup per codepoint
+		template<typename Emit>
+		void BuildLineQuadsHashed(const std::u32string& line, const FontInfo& fi, float xStartEm, float yBaseEm, Emit&& emit)
+		{
+			float penX = xStartEm;
+			const float penY = yBaseEm;
+
+			for (size_t i = 0; i < line.size(); ++i)
+			{
+				auto it = fi.glyphs.find(line[i]);
+				if (it == fi.glyphs.end())
+				{
+					continue;
+				}
+
+				const Glyph& g = it->second;
+				emit(GlyphQuad{ { penX + g.plane.left, penY + g.plane.bottom, penX + g.plane.right, penY + g.plane.top }, { g.uv.left, g.uv.bottom, g.uv.right, g.uv.top } });
+
+				penX += g.advance;
+				if (i + 1 < line.size() && fi.glyphs.count(line[i + 1]) != 0)
+				{
+					auto kern = fi.kerning.find(FontInfo::PackKerningKey(line[i], line[i + 1]));
+					if (kern != fi.kerning.end())
+					{
+						penX += kern->second;
+					}
+				}
+			}
+		}
+
+		bool SameQuads(const std::vector<GlyphQuad>& a, const std::vector<GlyphQuad>& b)
+		{
+			if (a.size() != b.size())
+			{
+				return false;
+			}
+
+			for (size_t i = 0; i < a.size(); ++i)
+			{
+				if (a[i].plane != b[i].plane || a[i].uv != b[i].uv)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		void BenchmarkLayout(BenchmarkContext& context, const FontInfo& font, size_t length)
+		{
+			const uint32_t iterations = context.GetOptions().iterations;
+			const std::u32string line = MakeLine(length, context.GetOptions().seed);
+
+			std::vector<GlyphQuad> quads;
+			std::vector<GlyphQuad> hashedQuads;
+			quads.reserve(length);
+			hashedQuads.reserve(length);
+
+			auto clearQuads = [&]()
+			{
+				quads.clear();
+				hashedQuads.clear();
+			};
+
+			const struct
+			{
+				const char* caseName;
+				bool hashed;
+			} cases[] = {
+				{ "Layout lookup tables", false },
+				{ "Layout hash maps", true },
+			};
+
+			for (const auto& layoutCase : cases)
+			{
+				BenchmarkResult result;
+				result.benchmark = "TextLayout";
+				result.caseName = layoutCase.caseName;
+				result.entityCount = length;
+				result.workItemsPerIteration = length;
+				result.iterations = iterations;
+
+				if (layoutCase.hashed)
+				{
+					context.Measure(iterations, clearQuads, [&]
+					{
+						BuildLineQuadsHashed(line, font, 0.0f, 0.0f, [&](const GlyphQuad& q) { hashedQuads.push_back(q); });
+					}, result.medianNs, result.minNs);
+				}
+				else
+				{
+					context.Measure(iterations, clearQuads, [&]
+					{
+						TextLayout::BuildLineQuads(line, font, 0.0f, 0.0f, [&](const GlyphQuad& q) { quads.push_back(q); });
+					}, result.medianNs, result.minNs);
+				}
+
+				result.structureBytes = font.glyphTable.size() * sizeof(Glyph)
+					+ font.denseGlyphIndices.size() * sizeof(uint32_t)
+					+ font.kerningMatrix.size() * sizeof(float)
+					+ font.kerningRightGlyphs.size() * (sizeof(uint32_t) + sizeof(float));
+				context.Report(std::move(result));
+			}
+
+			// Both walk the same line, the tables must not change a single quad
+			clearQuads();
+			TextLayout::BuildLineQuads(line, font, 0.0f, 0.0f, [&](const GlyphQuad& q) { quads.push_back(q); });
+			BuildLineQuadsHashed(line, font, 0.0f, 0.0f, [&](const GlyphQuad& q) { hashedQuads.push_back(q); });
+			if (!SameQuads(quads, hashedQuads))
+			{
+				std::cerr << "[bench] TextLayout lookup tables laid out " << length << " codepoints differently from the hash maps" << std::endl;
+			}
+		}
+
+		void RunTextLayoutBenchmark(BenchmarkContext& context)
+		{
+			const BenchmarkOptions& options = context.GetOptions();
+			const FontInfo font = MakeFont(options.seed);
+
+			for (size_t length : options.entityCounts)
+			{
+				BenchmarkLayout(context, font, length);
+			}
+		}
+
+	}
+
+}
+
+REGISTER_BENCHMARK(TextLayout, Engine::RunTextLayoutBenchmark)
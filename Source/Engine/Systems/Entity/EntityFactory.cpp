@@ -1,11 +1,14 @@
 #include "PCH.h"
 #include "EntityFactory.h"
+#include "Engine/Utility/Profiler.h"
 
 namespace Engine
 {
 
 	void EntityFactory::ProcessQueues()
 	{
+		SWIM_PROFILE_FUNCTION();
+
 		// Pull fresh scene from the engine every time
 		auto scene = SwimEngine::GetInstance()->GetSceneSystem()->GetActiveScene();
 		if (!scene)
@@ -0,0 +1,276 @@
+#include "PCH.h"
+#include "FrameTaskGraph.h"
+#include "Engine/Utility/JobSystem.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+namespace Engine
+{
+
+	void FrameTaskGraph::Clear()
+	{
+		stages.clear();
+	}
+
+	void FrameTaskGraph::AddStage(const std::string& name, Machine* machine)
+	{
+		Stage stage;
+		stage.name = name;
+		stage.machine = machine;
+		stages.push_back(std::move(stage));
+
+		if (machine && machine->GetFrameSyncAccess())
+		{
+			Stage syncStage;
+			syncStage.name = name + "Sync";
+			syncStage.machine = machine;
+			syncStage.sync = true;
+			stages.push_back(std::move(syncStage));
+		}
+	}
+
+	void FrameTaskGraph::Build()
+	{
+		for (Stage& stage : stages)
+		{
+			stage.access = FrameTaskAccess{};
+			if (stage.machine)
+			{
+				stage.access = stage.sync ? stage.machine->GetFrameSyncAccess().value_or(FrameTaskAccess{}) : stage.machine->GetFrameTaskAccess();
+			}
+			stage.dependencies.clear();
+		}
+
+		for (size_t j = 0; j < stages.size(); ++j)
+		{
+			const FrameTaskAccess& later = stages[j].access;
+
+			for (size_t i = 0; i < j; ++i)
+			{
+				const FrameTaskAccess& earlier = stages[i].access;
+
+				const bool writeConflict = HasAnyFrameResources(earlier.writes, later.reads | later.writes);
+				const bool readConflict = HasAnyFrameResources(earlier.reads, later.writes);
+
+				// A sync stage always follows its own Update, even when the two declare nothing in common
+				const bool ownUpdate = stages[j].sync && stages[i].machine == stages[j].machine;
+
+				if (writeConflict || readConflict || ownUpdate)
+				{
+					stages[j].dependencies.push_back(i);
+				}
+			}
+		}
+	}
+
+	void FrameTaskGraph::Run(double dt)
+	{
+		using Clock = std::chrono::steady_clock;
+
+		const size_t stageCount = stages.size();
+		const Clock::time_point frameStart = Clock::now();
+
+		auto elapsedMs = [frameStart]()
+		{
+			return std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count();
+		};
+
+		std::vector<FrameTaskTiming> timings(stageCount);
+		std::vector<JobHandle> handles(stageCount); // stays null for main thread stages, which are done by the time anyone looks
+		std::vector<bool> scheduled(stageCount, false);
+		std::vector<JobHandle> dependencyHandles;
+
+		JobSystem& jobs = JobSystem::Get();
+
+		auto runStage = [this, &timings, &elapsedMs, dt](size_t index, uint32_t workerIndex)
+		{
+			FrameTaskTiming& timing = timings[index];
+			timing.workerIndex = workerIndex;
+			timing.startMs = elapsedMs();
+
+			if (stages[index].machine)
+			{
+				if (stages[index].sync)
+				{
+					stages[index].machine->FrameSync(dt);
+				}
+				else
+				{
+					stages[index].machine->Update(dt);
+				}
+			}
+
+			timing.endMs = elapsedMs();
+		};
+
+		auto gatherDependencies = [this, &handles, &dependencyHandles](size_t index)
+		{
+			dependencyHandles.clear();
+			for (size_t dependency : stages[index].dependencies)
+			{
+				if (handles[dependency])
+				{
+					dependencyHandles.push_back(handles[dependency]);
+				}
+			}
+		};
+
+		// Dependencies always point backwards, so by the time a stage is reached in order everything it waits on has been scheduled
+		auto spawnStage = [&](size_t index)
+		{
+			gatherDependencies(index);
+			handles[index] = jobs.Spawn([&runStage, index](uint32_t workerIndex) { runStage(index, workerIndex); }, dependencyHandles);
+			scheduled[index] = true;
+		};
+
+		for (size_t i = 0; i < stageCount; ++i)
+		{
+			if (scheduled[i])
+			{
+				continue;
+			}
+
+			if (!stages[i].access.mainThread)
+			{
+				spawnStage(i);
+				continue;
+			}
+
+			// Before blocking the main thread, hand out every later worker stage that does not need this one
+			for (size_t j = i + 1; j < stageCount; ++j)
+			{
+				if (scheduled[j] || stages[j].access.mainThread)
+				{
+					continue;
+				}
+
+				bool ready = true;
+				for (size_t dependency : stages[j].dependencies)
+				{
+					if (!scheduled[dependency])
+					{
+						ready = false;
+						break;
+					}
+				}
+
+				if (ready)
+				{
+					spawnStage(j);
+				}
+			}
+
+			gatherDependencies(i);
+			for (const JobHandle& handle : dependencyHandles)
+			{
+				jobs.Wait(handle);
+			}
+
+			runStage(i, JobSystem::GetCurrentWorkerIndex());
+			scheduled[i] = true;
+		}
+
+		for (const JobHandle& handle : handles)
+		{
+			if (handle)
+			{
+				jobs.Wait(handle);
+			}
+		}
+
+		FrameTaskReport report;
+		report.frameIndex = frameIndex++;
+		report.frameMs = elapsedMs();
+
+		for (size_t i = 0; i < stageCount; ++i)
+		{
+			timings[i].name = stages[i].name;
+			report.busyMs += timings[i].endMs - timings[i].startMs;
+		}
+
+		// Walk back from the stage that finished last through whichever predecessor released it last.
+		// Main thread stages also wait on the main thread stage before them, so that counts as a predecessor too.
+		if (stageCount > 0)
+		{
+			std::vector<size_t> previousMainStage(stageCount, SIZE_MAX);
+			size_t lastMain = SIZE_MAX;
+			for (size_t i = 0; i < stageCount; ++i)
+			{
+				if (stages[i].access.mainThread)
+				{
+					previousMainStage[i] = lastMain;
+					lastMain = i;
+				}
+			}
+
+			size_t current = 0;
+			for (size_t i = 1; i < stageCount; ++i)
+			{
+				if (timings[i].endMs > timings[current].endMs)
+				{
+					current = i;
+				}
+			}
+
+			while (current != SIZE_MAX)
+			{
+				report.criticalPath.push_back(current);
+
+				size_t blocker = previousMainStage[current];
+				for (size_t dependency : stages[current].dependencies)
+				{
+					if (blocker == SIZE_MAX || timings[dependency].endMs > timings[blocker].endMs)
+					{
+						blocker = dependency;
+					}
+				}
+
+				current = blocker;
+			}
+
+			std::reverse(report.criticalPath.begin(), report.criticalPath.end());
+
+			for (size_t index : report.criticalPath)
+			{
+				report.criticalPathMs += timings[index].endMs - timings[index].startMs;
+			}
+		}
+
+		report.stages = std::move(timings);
+		lastReport = std::move(report);
+	}
+
+	std::string FrameTaskReport::ToString() const
+	{
+		std::ostringstream ss;
+		ss << std::fixed << std::setprecision(3);
+
+		ss << "Frame " << frameIndex << ": " << frameMs << " ms, critical path " << criticalPathMs << " ms, busy " << busyMs << " ms";
+		if (frameMs > 0.0)
+		{
+			ss << " (" << std::setprecision(2) << (busyMs / frameMs) << "x parallel)" << std::setprecision(3);
+		}
+		ss << "\n";
+
+		ss << "Critical path: ";
+		for (size_t i = 0; i < criticalPath.size(); ++i)
+		{
+			ss << (i ? " -> " : "") << stages[criticalPath[i]].name;
+		}
+		ss << "\n";
+
+		for (const FrameTaskTiming& stage : stages)
+		{
+			ss << "  " << std::left << std::setw(16) << stage.name << std::right
+				<< " worker " << stage.workerIndex
+				<< " | " << stage.startMs << " -> " << stage.endMs
+				<< " (" << (stage.endMs - stage.startMs) << " ms)\n";
+		}
+
+		return ss.str();
+	}
+
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+
+	class Machine;
+
+	// Coarse pieces of engine state a system can touch during its per frame Update
+	enum class FrameResource : uint32_t
+	{
+		None = 0,
+		Input = 1u << 0,
+		Commands = 1u << 1,
+		Entities = 1u << 2, // creating/destroying entities and adding/removing components
+		Transform = 1u << 3,
+		SceneBVH = 1u << 4,
+		Physics = 1u << 5,
+		Camera = 1u << 6,
+		DebugDraw = 1u << 7,
+		TextGlyphs = 1u << 8,
+		InstanceBuffers = 1u << 9,
+		Gpu = 1u << 10,
+		PhysicsInterpolation = 1u << 11, // the tick poses PhysicsSystem blends between and the blended poses waiting to be applied
+		All = 0xFFFFFFFFu
+	};
+
+	inline constexpr FrameResource operator|(FrameResource a, FrameResource b)
+	{
+		return static_cast<FrameResource>(static_cast<uint32_t>(a) | static_cast<uint32_t>(b));
+	}
+
+	inline constexpr FrameResource operator&(FrameResource a, FrameResource b)
+	{
+		return static_cast<FrameResource>(static_cast<uint32_t>(a) & static_cast<uint32_t>(b));
+	}
+
+	inline constexpr bool HasAnyFrameResources(FrameResource a, FrameResource b)
+	{
+		return (a & b) != FrameResource::None;
+	}
+
+	// What a system's Update reads and writes, and whether it has to stay on the main thread (window, Vulkan queue, OpenGL context).
+	// The default is fully exclusive, so a system that does not declare anything keeps running in registration order like before.
+	struct FrameTaskAccess
+	{
+		FrameResource reads = FrameResource::All;
+		FrameResource writes = FrameResource::All;
+		bool mainThread = true;
+	};
+
+	struct FrameTaskTiming
+	{
+		std::string name;
+		double startMs = 0.0; // relative to the start of the frame
+		double endMs = 0.0;
+		uint32_t workerIndex = 0;
+	};
+
+	struct FrameTaskReport
+	{
+		uint64_t frameIndex = 0;
+		double frameMs = 0.0;
+		double criticalPathMs = 0.0;
+		double busyMs = 0.0; // sum of every stage duration, busyMs / frameMs is the achieved parallelism
+		std::vector<FrameTaskTiming> stages;
+		std::vector<size_t> criticalPath; // indices into stages, first stage to last
+
+		std::string ToString() const;
+	};
+
+	// Runs one Update per registered system each frame, ordered only by the read/write conflicts the systems declare.
+	// Two stages conflict when either writes something the other touches, in which case the one registered first runs first.
+	// Stages that can leave the main thread are spawned on the JobSystem as soon as their dependencies are done,
+	// main thread stages run inline in registration order so the thread that owns the window and GPU never changes.
+	// A system that declares GetFrameSyncAccess also gets a second stage right after its Update that calls FrameSync,
+	// which is where a worker stage hands what it buffered back to the main thread.
+	class FrameTaskGraph
+	{
+
+	public:
+
+		void Clear();
+
+		void AddStage(const std::string& name, Machine* machine);
+
+		// Recomputes the dependency edges from each stage's current FrameTaskAccess
+		void Build();
+
+		void Run(double dt);
+
+		const FrameTaskReport& GetLastReport() const { return lastReport; }
+
+		size_t GetStageCount() const { return stages.size(); }
+
+	private:
+
+		struct Stage
+		{
+			std::string name;
+			Machine* machine = nullptr;
+			FrameTaskAccess access;
+			bool sync = false; // calls FrameSync instead of Update
+			std::vector<size_t> dependencies; // always lower indices than the stage itself
+		};
+
+		std::vector<Stage> stages;
+		FrameTaskReport lastReport;
+		uint64_t frameIndex = 0;
+
+	};
+
+}
@@ -23,6 +23,7 @@ namespace Engine
     int Init() override;
     void Update(double /*dt*/) override {}
     void FixedUpdate(unsigned int /*tickThisSecond*/) override {}
+    FrameTaskAccess GetFrameTaskAccess() const override { return { FrameResource::None, FrameResource::None, false }; }
     int Exit() override;
 
     // Parse a message like:  "(spawn 10 20 "Enemy Grunt")"
@@ -20,6 +20,9 @@ namespace Engine
 
 		int Exit() override { return 0; }
 
+		// Input state comes from the window's message pump, so it stays on the main thread
+		FrameTaskAccess GetFrameTaskAccess() const override { return { FrameResource::None, FrameResource::Input, true }; }
+
 		// SwimEngine calls this everytime their is an input message that is most likely an input
 		void InputMessage(UINT uMsg, WPARAM wParam);
 
@@ -0,0 +1,144 @@
+#include "PCH.h"
+#include "MappedFile.h"
+
+#include <utility>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Engine
+{
+
+	MappedFile::MappedFile(MappedFile&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Close();
+
+			data = std::exchange(other.data, nullptr);
+			size = std::exchange(other.size, 0);
+		#ifdef _WIN32
+			fileHandle = std::exchange(other.fileHandle, nullptr);
+			mappingHandle = std::exchange(other.mappingHandle, nullptr);
+		#endif
+		}
+
+		return *this;
+	}
+
+#ifdef _WIN32
+
+	bool MappedFile::Open(const std::string& path)
+	{
+		Close();
+
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER fileSize{};
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mapping)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (!view)
+		{
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+
+		fileHandle = file;
+		mappingHandle = mapping;
+		data = static_cast<const uint8_t*>(view);
+		size = static_cast<size_t>(fileSize.QuadPart);
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (data)
+		{
+			UnmapViewOfFile(data);
+		}
+		if (mappingHandle)
+		{
+			CloseHandle(mappingHandle);
+		}
+		if (fileHandle)
+		{
+			CloseHandle(fileHandle);
+		}
+
+		data = nullptr;
+		size = 0;
+		fileHandle = nullptr;
+		mappingHandle = nullptr;
+	}
+
+#else
+
+	bool MappedFile::Open(const std::string& path)
+	{
+		Close();
+
+		const int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+		{
+			return false;
+		}
+
+		struct stat info{};
+		if (::fstat(fd, &info) != 0 || info.st_size == 0)
+		{
+			::close(fd);
+			return false;
+		}
+
+		void* view = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd); // the mapping keeps the file alive on its own
+		if (view == MAP_FAILED)
+		{
+			return false;
+		}
+
+		data = static_cast<const uint8_t*>(view);
+		size = static_cast<size_t>(info.st_size);
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (data)
+		{
+			::munmap(const_cast<uint8_t*>(data), size);
+		}
+
+		data = nullptr;
+		size = 0;
+	}
+
+#endif
+
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace Engine
+{
+
+	// Read only view of a whole file through the OS page cache, nothing is read until a page is touched.
+	// Move only, the mapping closes with the object so spans from GetBytes must not outlive it.
+	class MappedFile
+	{
+
+	public:
+
+		MappedFile() = default;
+		~MappedFile() { Close(); }
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		// False if the file is missing, empty or can't be mapped
+		bool Open(const std::string& path);
+		void Close();
+
+		bool IsOpen() const { return data != nullptr; }
+		std::span<const uint8_t> GetBytes() const { return { data, size }; }
+		size_t GetSize() const { return size; }
+
+	private:
+
+		const uint8_t* data = nullptr;
+		size_t size = 0;
+
+	#ifdef _WIN32
+		void* fileHandle = nullptr;
+		void* mappingHandle = nullptr;
+	#endif
+
+	};
+
+}
@@ -74,8 +74,42 @@ namespace Engine
 		return 0;
 	}
 
+	// Runs on a worker, so it only touches the tracks FixedUpdate captured and the buffer FrameSync applies
 	void PhysicsSystem::Update(double dt)
 	{
+		pendingPoses.clear();
+
+		if (poseTracks.empty())
+		{
+			return;
+		}
+
+		timeSinceLastTick += dt;
+
+		float alpha = 1.0f;
+
+		if (fixedDeltaSeconds > 0.0f)
+		{
+			alpha = static_cast<float>(timeSinceLastTick / static_cast<double>(fixedDeltaSeconds));
+		}
+
+		if (alpha < 0.0f) { alpha = 0.0f; }
+		if (alpha > 1.0f) { alpha = 1.0f; }
+
+		pendingPoses.resize(poseTracks.size());
+		for (size_t i = 0; i < poseTracks.size(); ++i)
+		{
+			const PhysicsPoseTrack& track = poseTracks[i];
+			PhysicsPose& pose = pendingPoses[i];
+			pose.entity = track.entity;
+			Transform::BlendPhysicsPose(track.prevPosition, track.prevRotation, track.targetPosition, track.targetRotation, alpha, pose.position, pose.rotation);
+		}
+	}
+
+	void PhysicsSystem::FrameSync(double dt)
+	{
+		(void)dt;
+
 		auto engine = SwimEngine::GetInstance();
 		if (!engine)
 		{
@@ -86,6 +120,8 @@ namespace Engine
 		if (!HasAnyEngineStates(engine->GetEngineState(), EngineState::Playing))
 		{
 			timeSinceLastTick = 0.0;
+			poseTracks.clear();
+			pendingPoses.clear();
 			return;
 		}
 
@@ -96,8 +132,12 @@ namespace Engine
 		}
 
 		std::shared_ptr<Scene>& scene = sceneSystem->GetActiveScene();
-		if (!scene)
+
+		// The tracks name entities of the scene that was active at the last tick, drop them if the scene changed since
+		if (!scene || scene != interpolationScene.lock())
 		{
+			poseTracks.clear();
+			pendingPoses.clear();
 			return;
 		}
 
@@ -107,19 +147,7 @@ namespace Engine
 			return;
 		}
 
-		timeSinceLastTick += dt;
-
-		float alpha = 1.0f;
-
-		if (fixedDeltaSeconds > 0.0f)
-		{
-			alpha = static_cast<float>(timeSinceLastTick / static_cast<double>(fixedDeltaSeconds));
-		}
-
-		if (alpha < 0.0f) { alpha = 0.0f; }
-		if (alpha > 1.0f) { alpha = 1.0f; }
-
-		worldPtr->Interpolate(alpha);
+		worldPtr->ApplyPoses(pendingPoses);
 	}
 
 	// Each tick we get the active scene's physics world and tick it
@@ -137,6 +165,7 @@ namespace Engine
 		if (!HasAnyEngineStates(engine->GetEngineState(), EngineState::Playing))
 		{
 			timeSinceLastTick = 0.0;
+			poseTracks.clear();
 			return;
 		}
 
@@ -165,6 +194,10 @@ namespace Engine
 		world.Step(fixedDeltaSeconds);
 		world.FetchResults(true);
 		world.PostSimulateSync();
+
+		// FixedUpdate runs before the frame graph, so this is the last point the registry can be read without racing the scene update
+		world.CapturePoseTracks(poseTracks);
+		interpolationScene = scene;
 	}
 
 	int PhysicsSystem::Exit()
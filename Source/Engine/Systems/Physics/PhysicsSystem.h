@@ -1,10 +1,14 @@
 #pragma once
 
 #include <memory>
+#include <optional>
+#include <vector>
 
 #include "PxPhysicsAPI.h"
 #include "extensions/PxDefaultCpuDispatcher.h"
 
+#include "PhysicsWorld.h"
+
 namespace Engine
 {
 
@@ -21,6 +25,17 @@ namespace Engine
 		void FixedUpdate(unsigned int tickThisSecond) override;
 		int Exit() override;
 
+		// Applies the poses Update blended, on the main thread once the scene update is done with Transforms
+		void FrameSync(double dt) override;
+
+		// Update only blends the tick poses FixedUpdate copied out, so it can run on a worker next to the scene update
+		FrameTaskAccess GetFrameTaskAccess() const override { return { FrameResource::PhysicsInterpolation, FrameResource::PhysicsInterpolation, false }; }
+
+		std::optional<FrameTaskAccess> GetFrameSyncAccess() const override
+		{
+			return FrameTaskAccess{ FrameResource::PhysicsInterpolation | FrameResource::Entities, FrameResource::Transform, true };
+		}
+
 		physx::PxFoundation* GetFoundation() const { return foundation.get(); }
 		physx::PxPhysics* GetPxPhysics() const { return physics.get(); }
 
@@ -60,6 +75,13 @@ namespace Engine
 		// Time since last fixed tick (for render interpolation alpha).
 		double timeSinceLastTick = 0.0;
 
+		// Dynamic body poses of the last two ticks in interpolationScene, refreshed every FixedUpdate
+		std::vector<PhysicsPoseTrack> poseTracks;
+		std::weak_ptr<Scene> interpolationScene;
+
+		// Written by Update on a worker, applied by FrameSync
+		std::vector<PhysicsPose> pendingPoses;
+
 	};
 
 } // namespace Engine
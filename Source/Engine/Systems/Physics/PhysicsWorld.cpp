@@ -1,6 +1,7 @@
 #include "PCH.h"
 #include "PhysicsWorld.h"
 #include "PhysicsSystem.h"
+#include "Engine/Utility/Profiler.h"
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/compatibility.hpp> 
 
@@ -425,6 +426,8 @@ namespace Engine
 
 	void PhysicsWorld::PreSimulateSync(float dt)
 	{
+		SWIM_PROFILE_FUNCTION();
+
 		(void)dt;
 
 		if (!initialized || !scene)
@@ -503,6 +506,8 @@ namespace Engine
 
 	void PhysicsWorld::PostSimulateSync()
 	{
+		SWIM_PROFILE_FUNCTION();
+
 		if (!initialized || !scene)
 		{
 			return;
@@ -578,6 +583,54 @@ namespace Engine
 		});
 	}
 
+	void PhysicsWorld::CapturePoseTracks(std::vector<PhysicsPoseTrack>& outTracks) const
+	{
+		outTracks.clear();
+
+		if (!initialized)
+		{
+			return;
+		}
+
+		registry.view<const Transform, const Rigidbody>().each([&](entt::entity e, const Transform& tf, const Rigidbody& rb)
+		{
+			if (!rb.actor || rb.type != RigidbodyType::Dynamic || !tf.HasPhysicsTarget())
+			{
+				return;
+			}
+
+			PhysicsPoseTrack& track = outTracks.emplace_back();
+			track.entity = e;
+			track.prevPosition = tf.GetPhysicsPrevWorldPosition();
+			track.targetPosition = tf.GetPhysicsTargetWorldPosition();
+			track.prevRotation = tf.GetPhysicsPrevWorldRotation();
+			track.targetRotation = tf.GetPhysicsTargetWorldRotation();
+		});
+	}
+
+	void PhysicsWorld::ApplyPoses(const std::vector<PhysicsPose>& poses)
+	{
+		if (!initialized)
+		{
+			return;
+		}
+
+		for (const PhysicsPose& pose : poses)
+		{
+			// Behaviors may have destroyed the body since the tick that captured it
+			if (!registry.valid(pose.entity) || !registry.all_of<Transform, Rigidbody>(pose.entity))
+			{
+				continue;
+			}
+
+			Transform& tf = registry.get<Transform>(pose.entity);
+			tf.SetWorldPosition(registry, pose.position);
+			tf.SetWorldRotation(registry, pose.rotation);
+
+			registry.patch<Transform>(pose.entity, [](auto&) {});
+		}
+	}
+
 	bool PhysicsWorld::HasActor(entt::entity e) const
 	{
 		if (!registry.valid(e) || !registry.any_of<Rigidbody>(e))
@@ -16,6 +16,23 @@ namespace Engine
 
 	class PhysicsSystem;
 
+	// A dynamic body's poses from the last two ticks, copied out of its Transform so the per frame blend does not need the registry
+	struct PhysicsPoseTrack
+	{
+		entt::entity entity = entt::null;
+		glm::vec3 prevPosition{ 0.0f };
+		glm::vec3 targetPosition{ 0.0f };
+		glm::quat prevRotation{ 1.0f, 0.0f, 0.0f, 0.0f };
+		glm::quat targetRotation{ 1.0f, 0.0f, 0.0f, 0.0f };
+	};
+
+	struct PhysicsPose
+	{
+		entt::entity entity = entt::null;
+		glm::vec3 position{ 0.0f };
+		glm::quat rotation{ 1.0f, 0.0f, 0.0f, 0.0f };
+	};
+
 	class PhysicsWorld
 	{
 
@@ -36,6 +53,11 @@ namespace Engine
 		// alpha is in [0,1] where 0 = previous tick, 1 = current tick.
 		void Interpolate(float alpha);
 
+		// Same bodies Interpolate touches, split so the blend can run on a worker:
+		// CapturePoseTracks after PostSimulateSync, blend the tracks anywhere, then ApplyPoses on the main thread.
+		void CapturePoseTracks(std::vector<PhysicsPoseTrack>& outTracks) const;
+		void ApplyPoses(const std::vector<PhysicsPose>& poses);
+
 		physx::PxScene* GetPxScene() const { return scene.get(); }
 		physx::PxMaterial* GetDefaultMaterial() const { return defaultMaterial.get(); }
 
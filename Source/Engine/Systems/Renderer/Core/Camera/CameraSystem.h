@@ -107,6 +107,7 @@ namespace Engine
 
 		int Init() override;
 		void Update(double dt) override;
+		FrameTaskAccess GetFrameTaskAccess() const override { return { FrameResource::None, FrameResource::None, false }; }
 		void RefreshAspect();
 
 		const glm::mat4& GetViewMatrix() const { return camera.GetViewMatrix(); }
@@ -0,0 +1,425 @@
+#include "PCH.h"
+#include "OcclusionBuffer.h"
+#include "Engine/Utility/ParallelUtils.h"
+#include "Engine/Utility/Profiler.h"
+
+#ifndef SWIM_OCCLUSION_USE_SSE
+#define SWIM_OCCLUSION_USE_SSE 0
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <immintrin.h>
+#undef SWIM_OCCLUSION_USE_SSE
+#define SWIM_OCCLUSION_USE_SSE 1
+#endif
+
+namespace Engine
+{
+
+	namespace
+	{
+		constexpr float kMinClipW = 1e-5f;
+
+		// Counter clockwise seen from outside, corner index bits are x | y << 1 | z << 2 (0 = min, 1 = max)
+		constexpr uint8_t kBoxTriangles[12][3] =
+		{
+			{ 0, 4, 6 }, { 0, 6, 2 }, // -X
+			{ 1, 3, 7 }, { 1, 7, 5 }, // +X
+			{ 0, 1, 5 }, { 0, 5, 4 }, // -Y
+			{ 2, 6, 7 }, { 2, 7, 3 }, // +Y
+			{ 0, 2, 3 }, { 0, 3, 1 }, // -Z
+			{ 4, 5, 7 }, { 4, 7, 6 }  // +Z
+		};
+
+		inline bool InFrontOfNearPlane(const glm::vec4& clip)
+		{
+			return clip.w > kMinClipW && clip.z >= -clip.w;
+		}
+	}
+
+	OcclusionBuffer::OcclusionBuffer(uint32_t width, uint32_t height)
+	{
+		Resize(width, height);
+	}
+
+	void OcclusionBuffer::Resize(uint32_t newWidth, uint32_t newHeight)
+	{
+		tilesX = std::max<uint32_t>(1, (newWidth + TileWidth - 1) / TileWidth);
+		tilesY = std::max<uint32_t>(1, (newHeight + TileHeight - 1) / TileHeight);
+		width = tilesX * TileWidth;
+		height = tilesY * TileHeight;
+		blocksX = width / BlockSize;
+		blocksY = height / BlockSize;
+
+		depth.assign(static_cast<size_t>(width) * height, ClearDepth);
+		blockMaxDepth.assign(static_cast<size_t>(blocksX) * blocksY, ClearDepth);
+		tileBins.resize(static_cast<size_t>(tilesX) * tilesY);
+	}
+
+	void OcclusionBuffer::Begin(const glm::mat4& newViewProj)
+	{
+		viewProj = newViewProj;
+
+		// A counter clockwise front face keeps its winding on screen unless the projection mirrors it (Vulkan flips y).
+		// The sign of the x, y, w rows tells which one this is, orthographic projections leave it at 0.
+		const glm::mat3 xyw(
+			glm::vec3(viewProj[0][0], viewProj[0][1], viewProj[0][3]),
+			glm::vec3(viewProj[1][0], viewProj[1][1], viewProj[1][3]),
+			glm::vec3(viewProj[2][0], viewProj[2][1], viewProj[2][3]));
+		const float det = glm::determinant(xyw);
+		frontFaceSign = (std::abs(det) > 1e-12f) ? (det < 0.0f ? 1.0f : -1.0f) : 0.0f;
+
+		std::fill(depth.begin(), depth.end(), ClearDepth);
+		std::fill(blockMaxDepth.begin(), blockMaxDepth.end(), ClearDepth);
+		triangles.clear();
+		for (std::vector<uint32_t>& bin : tileBins)
+		{
+			bin.clear();
+		}
+
+		occluderCount = 0;
+		testedCount.store(0, std::memory_order_relaxed);
+		occludedCount.store(0, std::memory_order_relaxed);
+	}
+
+	void OcclusionBuffer::AddOccluder(const glm::vec3& localMin, const glm::vec3& localMax, const glm::mat4& model)
+	{
+		const glm::mat4 mvp = viewProj * model;
+
+		glm::vec4 clip[8];
+		for (int corner = 0; corner < 8; ++corner)
+		{
+			const glm::vec3 p(
+				(corner & 1) ? localMax.x : localMin.x,
+				(corner & 2) ? localMax.y : localMin.y,
+				(corner & 4) ? localMax.z : localMin.z);
+			clip[corner] = mvp * glm::vec4(p, 1.0f);
+		}
+
+		for (const uint8_t* tri : kBoxTriangles)
+		{
+			AddTriangle(clip[tri[0]], clip[tri[1]], clip[tri[2]]);
+		}
+
+		++occluderCount;
+	}
+
+	void OcclusionBuffer::AddTriangle(const glm::vec4& clip0, const glm::vec4& clip1, const glm::vec4& clip2)
+	{
+		if (!InFrontOfNearPlane(clip0) || !InFrontOfNearPlane(clip1) || !InFrontOfNearPlane(clip2))
+		{
+			return;
+		}
+
+		const glm::vec4* clip[3] = { &clip0, &clip1, &clip2 };
+
+		ScreenTriangle tri;
+		for (int i = 0; i < 3; ++i)
+		{
+			const float invW = 1.0f / clip[i]->w;
+			tri.x[i] = (clip[i]->x * invW * 0.5f + 0.5f) * static_cast<float>(width);
+			tri.y[i] = (clip[i]->y * invW * 0.5f + 0.5f) * static_cast<float>(height);
+			tri.z[i] = clip[i]->z * invW;
+		}
+
+		const float area = (tri.x[1] - tri.x[0]) * (tri.y[2] - tri.y[0]) - (tri.x[2] - tri.x[0]) * (tri.y[1] - tri.y[0]);
+		if (area == 0.0f || area * frontFaceSign < 0.0f)
+		{
+			return; // degenerate or back facing, the front faces of a closed occluder already cover it
+		}
+
+		// The edge functions assume a positive area
+		if (area < 0.0f)
+		{
+			std::swap(tri.x[1], tri.x[2]);
+			std::swap(tri.y[1], tri.y[2]);
+			std::swap(tri.z[1], tri.z[2]);
+		}
+
+		const float minX = std::min({ tri.x[0], tri.x[1], tri.x[2] });
+		const float maxX = std::max({ tri.x[0], tri.x[1], tri.x[2] });
+		const float minY = std::min({ tri.y[0], tri.y[1], tri.y[2] });
+		const float maxY = std::max({ tri.y[0], tri.y[1], tri.y[2] });
+
+		if (maxX < 0.0f || maxY < 0.0f || minX >= static_cast<float>(width) || minY >= static_cast<float>(height))
+		{
+			return;
+		}
+
+		tri.minX = static_cast<int32_t>(std::max(minX, 0.0f));
+		tri.minY = static_cast<int32_t>(std::max(minY, 0.0f));
+		tri.maxX = static_cast<int32_t>(std::min(maxX, static_cast<float>(width - 1)));
+		tri.maxY = static_cast<int32_t>(std::min(maxY, static_cast<float>(height - 1)));
+
+		const uint32_t triIndex = static_cast<uint32_t>(triangles.size());
+		triangles.push_back(tri);
+
+		const uint32_t tileMinX = static_cast<uint32_t>(tri.minX) / TileWidth;
+		const uint32_t tileMaxX = static_cast<uint32_t>(tri.maxX) / TileWidth;
+		const uint32_t tileMinY = static_cast<uint32_t>(tri.minY) / TileHeight;
+		const uint32_t tileMaxY = static_cast<uint32_t>(tri.maxY) / TileHeight;
+
+		for (uint32_t ty = tileMinY; ty <= tileMaxY; ++ty)
+		{
+			for (uint32_t tx = tileMinX; tx <= tileMaxX; ++tx)
+			{
+				tileBins[ty * tilesX + tx].push_back(triIndex);
+			}
+		}
+	}
+
+	void OcclusionBuffer::Rasterize()
+	{
+		SWIM_PROFILE_FUNCTION();
+
+		if (triangles.empty())
+		{
+			return;
+		}
+
+		// Tiles never share pixels, so each task owns its slice of the depth buffer outright
+		ParallelForRenderTasks(tileBins.size(), [this](size_t tileIndex, uint32_t /*workerIndex*/)
+		{
+			RasterizeTile(static_cast<uint32_t>(tileIndex));
+		});
+	}
+
+	void OcclusionBuffer::RasterizeTile(uint32_t tileIndex)
+	{
+		const std::vector<uint32_t>& bin = tileBins[tileIndex];
+		if (bin.empty())
+		{
+			return;
+		}
+
+		const int32_t tileMinX = static_cast<int32_t>((tileIndex % tilesX) * TileWidth);
+		const int32_t tileMinY = static_cast<int32_t>((tileIndex / tilesX) * TileHeight);
+		const int32_t tileMaxX = tileMinX + static_cast<int32_t>(TileWidth) - 1;
+		const int32_t tileMaxY = tileMinY + static_cast<int32_t>(TileHeight) - 1;
+
+		for (uint32_t triIndex : bin)
+		{
+			RasterizeTriangle(triangles[triIndex], tileMinX, tileMinY, tileMaxX, tileMaxY);
+		}
+
+		UpdateTileBlocks(tileIndex);
+	}
+
+	void OcclusionBuffer::RasterizeTriangle(const ScreenTriangle& tri, int32_t tileMinX, int32_t tileMinY, int32_t tileMaxX, int32_t tileMaxY)
+	{
+		const int32_t minY = std::max(tri.minY, tileMinY);
+		const int32_t maxY = std::min(tri.maxY, tileMaxY);
+		const int32_t minX = std::max(tri.minX, tileMinX) & ~3; // 4 pixel aligned, tiles are multiples of 4 wide
+		const int32_t maxX = std::min(tri.maxX, tileMaxX);
+		if (minX > maxX || minY > maxY)
+		{
+			return;
+		}
+
+		// Edge i is the one opposite vertex i, inside is where all three are >= 0.
+		// Row starts are evaluated in double since vertices far off screen make the terms large enough to cancel badly in float.
+		double edgeA[3];
+		double edgeB[3];
+		double edgeC[3];
+		for (int i = 0; i < 3; ++i)
+		{
+			const int a = (i + 1) % 3;
+			const int b = (i + 2) % 3;
+			edgeA[i] = static_cast<double>(tri.y[a]) - tri.y[b];
+			edgeB[i] = static_cast<double>(tri.x[b]) - tri.x[a];
+			edgeC[i] = static_cast<double>(tri.x[a]) * tri.y[b] - static_cast<double>(tri.x[b]) * tri.y[a];
+		}
+
+		// NDC z is linear in screen space
+		const double area = edgeC[0] + edgeC[1] + edgeC[2];
+		const double z10 = static_cast<double>(tri.z[1]) - tri.z[0];
+		const double z20 = static_cast<double>(tri.z[2]) - tri.z[0];
+		const double dzdx = (z10 * (static_cast<double>(tri.y[2]) - tri.y[0]) - z20 * (static_cast<double>(tri.y[1]) - tri.y[0])) / area;
+		const double dzdy = (z20 * (static_cast<double>(tri.x[1]) - tri.x[0]) - z10 * (static_cast<double>(tri.x[2]) - tri.x[0])) / area;
+
+		for (int32_t y = minY; y <= maxY; ++y)
+		{
+			const double py = y + 0.5;
+			const double px = minX + 0.5;
+
+			float rowEdge[3];
+			for (int i = 0; i < 3; ++i)
+			{
+				rowEdge[i] = static_cast<float>(edgeA[i] * px + edgeB[i] * py + edgeC[i]);
+			}
+			const float rowZ = static_cast<float>(tri.z[0] + dzdx * (px - tri.x[0]) + dzdy * (py - tri.y[0]));
+
+			float* row = depth.data() + static_cast<size_t>(y) * width;
+
+		#if SWIM_OCCLUSION_USE_SSE
+			const __m128 lane = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+			__m128 e0 = _mm_add_ps(_mm_set1_ps(rowEdge[0]), _mm_mul_ps(lane, _mm_set1_ps(static_cast<float>(edgeA[0]))));
+			__m128 e1 = _mm_add_ps(_mm_set1_ps(rowEdge[1]), _mm_mul_ps(lane, _mm_set1_ps(static_cast<float>(edgeA[1]))));
+			__m128 e2 = _mm_add_ps(_mm_set1_ps(rowEdge[2]), _mm_mul_ps(lane, _mm_set1_ps(static_cast<float>(edgeA[2]))));
+			__m128 z = _mm_add_ps(_mm_set1_ps(rowZ), _mm_mul_ps(lane, _mm_set1_ps(static_cast<float>(dzdx))));
+
+			const __m128 e0Step = _mm_set1_ps(static_cast<float>(edgeA[0] * 4.0));
+			const __m128 e1Step = _mm_set1_ps(static_cast<float>(edgeA[1] * 4.0));
+			const __m128 e2Step = _mm_set1_ps(static_cast<float>(edgeA[2] * 4.0));
+			const __m128 zStep = _mm_set1_ps(static_cast<float>(dzdx * 4.0));
+
+			for (int32_t x = minX; x <= maxX; x += 4)
+			{
+				// A pixel is outside if any edge value has its sign bit set
+				const __m128 outside = _mm_or_ps(_mm_or_ps(e0, e1), e2);
+				const int outsideMask = _mm_movemask_ps(outside);
+				if (outsideMask != 0xF)
+				{
+					const __m128 outsideLanes = _mm_castsi128_ps(_mm_srai_epi32(_mm_castps_si128(outside), 31));
+					const __m128 old = _mm_loadu_ps(row + x);
+					const __m128 nearer = _mm_min_ps(old, z);
+					_mm_storeu_ps(row + x, _mm_or_ps(_mm_andnot_ps(outsideLanes, nearer), _mm_and_ps(outsideLanes, old)));
+				}
+
+				e0 = _mm_add_ps(e0, e0Step);
+				e1 = _mm_add_ps(e1, e1Step);
+				e2 = _mm_add_ps(e2, e2Step);
+				z = _mm_add_ps(z, zStep);
+			}
+		#else
+			for (int32_t x = minX; x <= maxX; ++x)
+			{
+				const float dx = static_cast<float>(x - minX);
+				const float e0 = rowEdge[0] + static_cast<float>(edgeA[0]) * dx;
+				const float e1 = rowEdge[1] + static_cast<float>(edgeA[1]) * dx;
+				const float e2 = rowEdge[2] + static_cast<float>(edgeA[2]) * dx;
+				if (e0 >= 0.0f && e1 >= 0.0f && e2 >= 0.0f)
+				{
+					const float z = rowZ + static_cast<float>(dzdx) * dx;
+					row[x] = std::min(row[x], z);
+				}
+			}
+		#endif
+		}
+	}
+
+	void OcclusionBuffer::UpdateTileBlocks(uint32_t tileIndex)
+	{
+		constexpr uint32_t blocksPerTileX = TileWidth / BlockSize;
+		constexpr uint32_t blocksPerTileY = TileHeight / BlockSize;
+
+		const uint32_t firstBlockX = (tileIndex % tilesX) * blocksPerTileX;
+		const uint32_t firstBlockY = (tileIndex / tilesX) * blocksPerTileY;
+
+		for (uint32_t by = firstBlockY; by < firstBlockY + blocksPerTileY; ++by)
+		{
+			for (uint32_t bx = firstBlockX; bx < firstBlockX + blocksPerTileX; ++bx)
+			{
+				float farthest = -ClearDepth;
+				for (uint32_t y = by * BlockSize; y < (by + 1) * BlockSize; ++y)
+				{
+					const float* row = depth.data() + static_cast<size_t>(y) * width + bx * BlockSize;
+					for (uint32_t x = 0; x < BlockSize; ++x)
+					{
+						farthest = std::max(farthest, row[x]);
+					}
+				}
+
+				blockMaxDepth[static_cast<size_t>(by) * blocksX + bx] = farthest;
+			}
+		}
+	}
+
+	bool OcclusionBuffer::IsVisible(const glm::vec3& worldMin, const glm::vec3& worldMax) const
+	{
+		testedCount.fetch_add(1, std::memory_order_relaxed);
+
+		if (triangles.empty())
+		{
+			return true;
+		}
+
+		float minNdcX = ClearDepth;
+		float minNdcY = ClearDepth;
+		float maxNdcX = -ClearDepth;
+		float maxNdcY = -ClearDepth;
+		float nearestZ = ClearDepth;
+
+		for (int corner = 0; corner < 8; ++corner)
+		{
+			const glm::vec4 clip = viewProj * glm::vec4(
+				(corner & 1) ? worldMax.x : worldMin.x,
+				(corner & 2) ? worldMax.y : worldMin.y,
+				(corner & 4) ? worldMax.z : worldMin.z,
+				1.0f);
+
+			// Touching the near plane means the camera is at or inside the box
+			if (!InFrontOfNearPlane(clip))
+			{
+				return true;
+			}
+
+			const float invW = 1.0f / clip.w;
+			minNdcX = std::min(minNdcX, clip.x * invW);
+			maxNdcX = std::max(maxNdcX, clip.x * invW);
+			minNdcY = std::min(minNdcY, clip.y * invW);
+			maxNdcY = std::max(maxNdcY, clip.y * invW);
+			nearestZ = std::min(nearestZ, clip.z * invW);
+		}
+
+		// Every pixel the box rectangle touches, not just the ones whose centers it covers
+		const float fWidth = static_cast<float>(width);
+		const float fHeight = static_cast<float>(height);
+		const float sMinX = std::max((minNdcX * 0.5f + 0.5f) * fWidth, 0.0f);
+		const float sMaxX = std::min((maxNdcX * 0.5f + 0.5f) * fWidth, fWidth - 1.0f);
+		const float sMinY = std::max((minNdcY * 0.5f + 0.5f) * fHeight, 0.0f);
+		const float sMaxY = std::min((maxNdcY * 0.5f + 0.5f) * fHeight, fHeight - 1.0f);
+		if (sMinX > sMaxX || sMinY > sMaxY)
+		{
+			return true; // off screen, that is the frustum's call
+		}
+
+		const uint32_t x0 = static_cast<uint32_t>(sMinX);
+		const uint32_t x1 = static_cast<uint32_t>(sMaxX);
+		const uint32_t y0 = static_cast<uint32_t>(sMinY);
+		const uint32_t y1 = static_cast<uint32_t>(sMaxY);
+
+		for (uint32_t by = y0 / BlockSize; by <= y1 / BlockSize; ++by)
+		{
+			for (uint32_t bx = x0 / BlockSize; bx <= x1 / BlockSize; ++bx)
+			{
+				if (blockMaxDepth[static_cast<size_t>(by) * blocksX + bx] < nearestZ)
+				{
+					continue; // the whole block is in front of the box
+				}
+
+				const uint32_t px0 = std::max(x0, bx * BlockSize);
+				const uint32_t px1 = std::min(x1, bx * BlockSize + BlockSize - 1);
+				const uint32_t py0 = std::max(y0, by * BlockSize);
+				const uint32_t py1 = std::min(y1, by * BlockSize + BlockSize - 1);
+
+				for (uint32_t y = py0; y <= py1; ++y)
+				{
+					const float* row = depth.data() + static_cast<size_t>(y) * width;
+					for (uint32_t x = px0; x <= px1; ++x)
+					{
+						if (row[x] >= nearestZ)
+						{
+							return true;
+						}
+					}
+				}
+			}
+		}
+
+		occludedCount.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	OcclusionBuffer::Stats OcclusionBuffer::GetStats() const
+	{
+		Stats stats;
+		stats.occluders = occluderCount;
+		stats.trianglesRasterized = static_cast<uint32_t>(triangles.size());
+		stats.tested = testedCount.load(std::memory_order_relaxed);
+		stats.occluded = occludedCount.load(std::memory_order_relaxed);
+		stats.visible = stats.tested - stats.occluded;
+		return stats;
+	}
+
+}
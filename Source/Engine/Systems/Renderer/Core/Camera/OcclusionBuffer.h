@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "Library/glm/glm.hpp"
+
+namespace Engine
+{
+
+	// Low resolution software depth buffer for CPU occlusion culling.
+	// Each frame: Begin with the camera view projection, add the occluders, Rasterize, then ask IsVisible for any world AABB.
+	// Occluder triangles are binned into screen tiles and the tiles are rasterized in parallel, 4 pixels at a time with SSE when available.
+	// Every 8x8 pixel block also keeps its farthest depth, so most occludee tests finish without touching single pixels.
+	// Depth is NDC z, larger is farther. Nothing here knows about the registry or the graphics API, so it can be driven directly from tests.
+	class OcclusionBuffer
+	{
+
+	public:
+
+		static constexpr uint32_t TileWidth = 64;
+		static constexpr uint32_t TileHeight = 32;
+		static constexpr uint32_t BlockSize = 8; // hierarchical depth granularity, tiles are multiples of it
+		static constexpr uint32_t DefaultWidth = 256;
+		static constexpr uint32_t DefaultHeight = 128;
+
+		// Counters for the current frame, reset by Begin
+		struct Stats
+		{
+			uint32_t occluders = 0;
+			uint32_t trianglesRasterized = 0;
+			uint32_t tested = 0;
+			uint32_t visible = 0;
+			uint32_t occluded = 0;
+		};
+
+		// Sizes get rounded up to whole tiles
+		explicit OcclusionBuffer(uint32_t width = DefaultWidth, uint32_t height = DefaultHeight);
+
+		void Resize(uint32_t width, uint32_t height);
+
+		// Clears depth and counters, all following calls use this view projection
+		void Begin(const glm::mat4& viewProj);
+
+		// Rasterizes the box (localMin, localMax) placed by model as 12 triangles
+		void AddOccluder(const glm::vec3& localMin, const glm::vec3& localMax, const glm::mat4& model);
+
+		// Clip space triangle, counter clockwise when seen from outside. Triangles crossing the near plane are dropped, which only ever costs occlusion.
+		void AddTriangle(const glm::vec4& clip0, const glm::vec4& clip1, const glm::vec4& clip2);
+
+		void Rasterize();
+
+		bool HasOccluders() const { return !triangles.empty(); }
+
+		// False only if every pixel the box could touch already has an occluder in front of it. Safe to call from several threads.
+		bool IsVisible(const glm::vec3& worldMin, const glm::vec3& worldMax) const;
+
+		uint32_t GetWidth() const { return width; }
+		uint32_t GetHeight() const { return height; }
+
+		// Row 0 is the bottom of the screen (NDC y = -1)
+		float GetDepth(uint32_t x, uint32_t y) const { return depth[static_cast<size_t>(y) * width + x]; }
+
+		Stats GetStats() const;
+
+		static constexpr float ClearDepth = 3.402823466e+38f;
+
+	private:
+
+		struct ScreenTriangle
+		{
+			float x[3];
+			float y[3];
+			float z[3];
+			int32_t minX, minY, maxX, maxY; // inclusive pixel bounds, already clipped to the buffer
+		};
+
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t tilesX = 0;
+		uint32_t tilesY = 0;
+		uint32_t blocksX = 0;
+		uint32_t blocksY = 0;
+
+		glm::mat4 viewProj{ 1.0f };
+		float frontFaceSign = 0.0f; // sign a front facing triangle's screen area has, 0 if it can't be told (orthographic) and both sides get drawn
+
+		std::vector<float> depth;
+		std::vector<float> blockMaxDepth;
+		std::vector<ScreenTriangle> triangles;
+		std::vector<std::vector<uint32_t>> tileBins;
+
+		uint32_t occluderCount = 0;
+		mutable std::atomic<uint32_t> testedCount{ 0 };
+		mutable std::atomic<uint32_t> occludedCount{ 0 };
+
+		void RasterizeTile(uint32_t tileIndex);
+		void RasterizeTriangle(const ScreenTriangle& tri, int32_t tileMinX, int32_t tileMinY, int32_t tileMaxX, int32_t tileMaxY);
+		void UpdateTileBlocks(uint32_t tileIndex);
+
+	};
+
+}
@@ -0,0 +1,122 @@
+#include "PCH.h"
+#include "FontData.h"
+
+namespace Engine
+{
+
+	void FontInfo::BuildLookupTables()
+	{
+		glyphTable.clear();
+		denseGlyphIndices.clear();
+		sparseGlyphIndices.clear();
+		kerningMatrixSize = 0;
+		kerningMatrixSlots.clear();
+		kerningMatrix.clear();
+		kerningRowStarts.clear();
+		kerningRightGlyphs.clear();
+		kerningAdvances.clear();
+
+		glyphTable.reserve(glyphs.size());
+		for (const auto& kv : glyphs)
+		{
+			glyphTable.push_back(kv.second);
+		}
+
+		// Codepoint order, so the indices don't depend on how the map happened to hash
+		std::sort(glyphTable.begin(), glyphTable.end(), [](const Glyph& a, const Glyph& b)
+		{
+			return a.codepoint < b.codepoint;
+		});
+
+		uint32_t denseCount = 0;
+		for (const Glyph& glyph : glyphTable)
+		{
+			if (glyph.codepoint < DenseCodepointLimit)
+			{
+				denseCount = glyph.codepoint + 1;
+			}
+		}
+
+		denseGlyphIndices.assign(denseCount, NoGlyph);
+		for (uint32_t glyphIndex = 0; glyphIndex < static_cast<uint32_t>(glyphTable.size()); ++glyphIndex)
+		{
+			const uint32_t cp = glyphTable[glyphIndex].codepoint;
+			if (cp < DenseCodepointLimit)
+			{
+				denseGlyphIndices[cp] = glyphIndex;
+			}
+			else
+			{
+				sparseGlyphIndices.emplace_back(cp, glyphIndex); // glyphTable is sorted, so this is too
+			}
+		}
+
+		// Kerning goes from codepoint pairs to glyph index pairs
+		struct Pair
+		{
+			uint32_t left;
+			uint32_t right;
+			float advance;
+		};
+
+		std::vector<Pair> pairs;
+		pairs.reserve(kerning.size());
+		for (const auto& kv : kerning)
+		{
+			const uint32_t left = FindGlyphIndex(static_cast<uint32_t>(kv.first >> 32));
+			const uint32_t right = FindGlyphIndex(static_cast<uint32_t>(kv.first & 0xFFFFFFFFu));
+			if (left != NoGlyph && right != NoGlyph && kv.second != 0.0f)
+			{
+				pairs.push_back({ left, right, kv.second });
+			}
+		}
+
+		std::sort(pairs.begin(), pairs.end(), [](const Pair& a, const Pair& b)
+		{
+			return a.left != b.left ? a.left < b.left : a.right < b.right;
+		});
+
+		// Matrix slots go to kerned glyphs in glyph index order, so the lowest codepoints get them first
+		std::vector<uint8_t> kerned(glyphTable.size(), 0);
+		for (const Pair& pair : pairs)
+		{
+			kerned[pair.left] = 1;
+			kerned[pair.right] = 1;
+		}
+
+		kerningMatrixSlots.assign(glyphTable.size(), NoKerningSlot);
+		for (size_t glyphIndex = 0; glyphIndex < glyphTable.size() && kerningMatrixSize < MaxKerningMatrixGlyphs; ++glyphIndex)
+		{
+			if (kerned[glyphIndex])
+			{
+				kerningMatrixSlots[glyphIndex] = static_cast<uint16_t>(kerningMatrixSize++);
+			}
+		}
+
+		kerningMatrix.assign(static_cast<size_t>(kerningMatrixSize) * kerningMatrixSize, 0.0f);
+
+		// Whatever doesn't fit the matrix gets bucketed into one row per left glyph
+		kerningRowStarts.assign(glyphTable.size() + 1, 0);
+
+		for (const Pair& pair : pairs)
+		{
+			const uint16_t leftSlot = kerningMatrixSlots[pair.left];
+			const uint16_t rightSlot = kerningMatrixSlots[pair.right];
+			if (leftSlot != NoKerningSlot && rightSlot != NoKerningSlot)
+			{
+				kerningMatrix[static_cast<size_t>(leftSlot) * kerningMatrixSize + rightSlot] = pair.advance;
+				continue;
+			}
+
+			++kerningRowStarts[pair.left + 1];
+			kerningRightGlyphs.push_back(pair.right);
+			kerningAdvances.push_back(pair.advance);
+		}
+
+		for (size_t i = 1; i < kerningRowStarts.size(); ++i)
+		{
+			kerningRowStarts[i] += kerningRowStarts[i - 1];
+		}
+	}
+
+}
@@ -1,7 +1,11 @@
 #pragma once 
 
+#include <algorithm>
 #include <string>
 #include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 #include "Engine/Systems/Renderer/Core/Textures/Texture2D.h"
 
 namespace Engine
@@ -67,34 +71,103 @@ namespace Engine
 		// Kerning keyed by (left<<32 | right) -> adjustment in same space as 'advance'.
 		std::unordered_map<uint64_t, float> kerning;
 
+		// ---- Lookup tables ----
+		// The maps above are what got loaded, text layout goes through these flat copies instead, built once by BuildLookupTables.
+		static constexpr uint32_t NoGlyph = UINT32_MAX;
+		static constexpr uint32_t DenseCodepointLimit = 0x10000; // the BMP, past it codepoints go through the sparse list
+
+		std::vector<Glyph> glyphTable;                                 // every glyph once, in codepoint order
+		std::vector<uint32_t> denseGlyphIndices;                       // glyph index by codepoint, up to the highest BMP codepoint the font has
+		std::vector<std::pair<uint32_t, uint32_t>> sparseGlyphIndices; // (codepoint, glyph index) past the BMP, sorted
+
+		// Kerning between the first MaxKerningMatrixGlyphs glyphs that have any is one row major matrix read, which covers Latin fonts whole
+		static constexpr uint32_t MaxKerningMatrixGlyphs = 256;
+		static constexpr uint16_t NoKerningSlot = UINT16_MAX;
+		uint32_t kerningMatrixSize = 0;
+		std::vector<uint16_t> kerningMatrixSlots; // per glyph index
+		std::vector<float> kerningMatrix;
+
+		// Pairs with a side outside the matrix, row i covers [kerningRowStarts[i], kerningRowStarts[i + 1]) with the right glyphs sorted
+		std::vector<uint32_t> kerningRowStarts;
+		std::vector<uint32_t> kerningRightGlyphs;
+		std::vector<float> kerningAdvances;
+
 		static uint64_t PackKerningKey(uint32_t left, uint32_t right)
 		{
 			return (uint64_t(left) << 32) | uint64_t(right);
 		}
 
+		// Fills the lookup tables from glyphs and kerning, has to run again if either of them changes.
+		// Kerning pairs with a side the font has no glyph for are left out, layout never asks for those.
+		void BuildLookupTables();
+
+		uint32_t FindGlyphIndex(uint32_t cp) const
+		{
+			if (cp < denseGlyphIndices.size())
+			{
+				return denseGlyphIndices[cp];
+			}
+
+			if (cp < DenseCodepointLimit || sparseGlyphIndices.empty())
+			{
+				return NoGlyph;
+			}
+
+			auto it = std::lower_bound(sparseGlyphIndices.begin(), sparseGlyphIndices.end(), cp,
+				[](const std::pair<uint32_t, uint32_t>& entry, uint32_t value) { return entry.first < value; });
+
+			return (it != sparseGlyphIndices.end() && it->first == cp) ? it->second : NoGlyph;
+		}
+
+		const Glyph& GetGlyphAt(uint32_t glyphIndex) const
+		{
+			return glyphTable[glyphIndex];
+		}
+
+		float GetKerningAt(uint32_t leftGlyph, uint32_t rightGlyph) const
+		{
+			const uint16_t leftSlot = kerningMatrixSlots[leftGlyph];
+			const uint16_t rightSlot = kerningMatrixSlots[rightGlyph];
+			if (leftSlot != NoKerningSlot && rightSlot != NoKerningSlot)
+			{
+				return kerningMatrix[static_cast<size_t>(leftSlot) * kerningMatrixSize + rightSlot];
+			}
+
+			const uint32_t* rowBegin = kerningRightGlyphs.data() + kerningRowStarts[leftGlyph];
+			const uint32_t* rowEnd = kerningRightGlyphs.data() + kerningRowStarts[leftGlyph + 1];
+			if (rowBegin == rowEnd)
+			{
+				return 0.0f;
+			}
+
+			const uint32_t* it = std::lower_bound(rowBegin, rowEnd, rightGlyph);
+			return (it != rowEnd && *it == rightGlyph) ? kerningAdvances[it - kerningRightGlyphs.data()] : 0.0f;
+		}
+
 		const Glyph* GetGlyph(uint32_t cp) const
 		{
-			auto it = glyphs.find(cp);
-			if (it == glyphs.end())
+			const uint32_t glyphIndex = FindGlyphIndex(cp);
+			if (glyphIndex == NoGlyph)
 			{
 				return nullptr;
 			}
 			else
 			{
-				return &it->second;
+				return &glyphTable[glyphIndex];
 			}
 		}
 
 		float GetKerning(uint32_t left, uint32_t right) const
 		{
-			auto it = kerning.find(PackKerningKey(left, right));
-			if (it == kerning.end())
+			const uint32_t leftGlyph = FindGlyphIndex(left);
+			const uint32_t rightGlyph = FindGlyphIndex(right);
+			if (leftGlyph == NoGlyph || rightGlyph == NoGlyph)
 			{
 				return 0.0f;
 			}
 			else
 			{
-				return it->second;
+				return GetKerningAt(leftGlyph, rightGlyph);
 			}
 		}
 
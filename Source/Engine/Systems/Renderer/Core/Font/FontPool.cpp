@@ -397,6 +397,9 @@ namespace Engine
 				}
 			}
 		}
+
+		// --- Lookup tables for text layout
+		out.BuildLookupTables();
 	}
 
 }
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <string>
+#include "FontData.h"
+
+namespace Engine
+{
+
+	struct GlyphQuad
+	{
+		glm::vec4 plane; // l,b,r,t in EM space
+		glm::vec4 uv;    // u0,v0,u1,v1
+	};
+
+	namespace TextLayout
+	{
+
+		template<typename Emit>
+		inline void BuildLineQuads
+		(
+			const std::u32string& line,
+			const FontInfo& fi,
+			float xStartEm,
+			float yBaseEm,
+			Emit&& emit
+		)
+		{
+			float penX = xStartEm;
+			float penY = yBaseEm;
+
+			// Every codepoint gets looked up once, the index carries over as the left side of the next kerning pair
+			uint32_t glyphIndex = line.empty() ? FontInfo::NoGlyph : fi.FindGlyphIndex(line[0]);
+
+			for (size_t i = 0; i < line.size(); ++i)
+			{
+				const uint32_t nextGlyphIndex = (i + 1 < line.size()) ? fi.FindGlyphIndex(line[i + 1]) : FontInfo::NoGlyph;
+
+				if (glyphIndex != FontInfo::NoGlyph)
+				{
+					const Glyph& g = fi.GetGlyphAt(glyphIndex);
+
+					const float l = penX + g.plane.left;
+					const float b = penY + g.plane.bottom;
+					const float r = penX + g.plane.right;
+					const float t = penY + g.plane.top;
+
+					emit(GlyphQuad{ {l,b,r,t}, {g.uv.left, g.uv.bottom, g.uv.right, g.uv.top} });
+
+					penX += g.advance;
+					if (nextGlyphIndex != FontInfo::NoGlyph) penX += fi.GetKerningAt(glyphIndex, nextGlyphIndex);
+				}
+
+				glyphIndex = nextGlyphIndex;
+			}
+		}
+
+	} // namespace TextLayout
+
+} // namespace Engine
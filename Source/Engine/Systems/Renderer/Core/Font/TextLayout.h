@@ -7,74 +7,20 @@
 namespace Engine
 {
 
-	struct GlyphQuad
-	{
-		glm::vec4 plane; // l,b,r,t in EM space
-		glm::vec4 uv;    // u0,v0,u1,v1
-	};
-
 	namespace TextLayout
 	{
 
-		template<typename Emit>
-		inline void BuildLineQuads
-		(
-			const std::u32string& line,
-			const FontInfo& fi,
-			float xStartEm,
-			float yBaseEm,
-			Emit&& emit
-		)
-		{
-			float penX = xStartEm;
-			float penY = yBaseEm;
-
-			for (size_t i = 0; i < line.size(); ++i)
-			{
-				auto itG = fi.glyphs.find(line[i]);
-				if (itG == fi.glyphs.end()) continue;
-				const Glyph& g = itG->second;
-
-				const float l = penX + g.plane.left;
-				const float b = penY + g.plane.bottom;
-				const float r = penX + g.plane.right;
-				const float t = penY + g.plane.top;
-
-				emit(GlyphQuad{ {l,b,r,t}, {g.uv.left, g.uv.bottom, g.uv.right, g.uv.top} });
-
-				penX += g.advance;
-				if (i + 1 < line.size()) penX += fi.GetKerning(line[i], line[i + 1]);
-			}
-		}
-
+		// Walks the quads the component keeps laid out, they only get rebuilt after its text, font or alignment changed
 		template<typename Emit>
 		inline void ForEachGlyphQuad
 		(
 			TextComponent& tc,
-			const FontInfo& fi,
 			Emit&& emit
 		)
 		{
-			const std::vector<std::u32string>& lines = tc.GetLines();
-			const std::vector<float>& widths = tc.GetLineWidths();
-
-			for (size_t i = 0; i < lines.size(); ++i)
+			for (const GlyphQuad& q : tc.GetGlyphQuads())
 			{
-				float x0 = 0.0f;
-				switch (tc.GetAlignment())
-				{
-					case TextAllignemt::Left:    x0 = 0.0f;              break;
-					case TextAllignemt::Center:  x0 = -0.5f * widths[i]; break;
-					case TextAllignemt::Right:   x0 = -widths[i];        break;
-					case TextAllignemt::Justified:
-					default:                     x0 = 0.0f;              break;
-				}
-				const float y0 = -static_cast<float>(i) * fi.lineHeight;
-
-				BuildLineQuads(lines[i], fi, x0, y0, [&](const GlyphQuad& q)
-				{
-					emit(static_cast<uint32_t>(i), q);
-				});
+				emit(q);
 			}
 		}
 
@@ -157,14 +103,13 @@ namespace Engine
 	inline void EmitMsdf
 	(
 		TextComponent& tc,
-		const FontInfo& fi,
 		const MsdfTextGpuInstanceData& state,
 		Sink&& sink
 	)
 	{
-		TextLayout::ForEachGlyphQuad(tc, fi, [&](uint32_t lineIdx, const GlyphQuad& q)
+		TextLayout::ForEachGlyphQuad(tc, [&](const GlyphQuad& q)
 		{
-			sink(lineIdx, q, state);
+			sink(q, state);
 		});
 	}
 
@@ -0,0 +1,332 @@
+#include "PCH.h"
+#include "BakedModel.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+#include "Library/zstd/zstd.h"
+
+namespace Engine
+{
+
+	namespace
+	{
+
+		constexpr uint64_t SectionAlignment = 16;
+
+		uint64_t AlignUp(uint64_t value)
+		{
+			return (value + SectionAlignment - 1) & ~(SectionAlignment - 1);
+		}
+
+		// Size and write time of the source, a bake only counts for the exact file it was made from
+		bool GetSourceStamp(const std::string& sourcePath, uint64_t& size, int64_t& writeTime)
+		{
+			std::error_code ec;
+			size = static_cast<uint64_t>(std::filesystem::file_size(sourcePath, ec));
+			if (ec)
+			{
+				return false;
+			}
+
+			const std::filesystem::file_time_type time = std::filesystem::last_write_time(sourcePath, ec);
+			if (ec)
+			{
+				return false;
+			}
+
+			writeTime = static_cast<int64_t>(time.time_since_epoch().count());
+			return true;
+		}
+
+		// Appends the blob at the next aligned offset, compressed if that actually saves something
+		BakedBlob AppendBlob(std::vector<uint8_t>& out, const void* data, size_t size)
+		{
+			out.resize(AlignUp(out.size()));
+
+			BakedBlob blob;
+			blob.offset = out.size();
+			blob.rawSize = size;
+			blob.storedSize = size;
+
+			if (size == 0)
+			{
+				return blob;
+			}
+
+			if constexpr (BakedModelConfig::CompressionLevel > 0)
+			{
+				const size_t bound = ZSTD_compressBound(size);
+				out.resize(blob.offset + bound);
+
+				const size_t written = ZSTD_compress(out.data() + blob.offset, bound, data, size, BakedModelConfig::CompressionLevel);
+				if (!ZSTD_isError(written) && written < size)
+				{
+					out.resize(blob.offset + written);
+					blob.storedSize = written;
+					return blob;
+				}
+			}
+
+			// Incompressible, stored raw so the reader can point straight at it
+			out.resize(blob.offset + size);
+			std::memcpy(out.data() + blob.offset, data, size);
+			return blob;
+		}
+
+		bool BlobInFile(const BakedBlob& blob, size_t fileSize)
+		{
+			return blob.offset <= fileSize && blob.storedSize <= fileSize - blob.offset;
+		}
+
+		// Raw blobs are returned in place, compressed ones are inflated into storage
+		template<typename T>
+		bool ResolveBlob(std::span<const uint8_t> bytes, const BakedBlob& blob, std::vector<T>& storage, std::span<const T>& result)
+		{
+			if (!BlobInFile(blob, bytes.size()) || blob.rawSize % sizeof(T) != 0)
+			{
+				return false;
+			}
+
+			const size_t count = static_cast<size_t>(blob.rawSize / sizeof(T));
+
+			if (!blob.IsCompressed())
+			{
+				if (blob.offset % alignof(T) != 0)
+				{
+					return false;
+				}
+
+				result = std::span<const T>(reinterpret_cast<const T*>(bytes.data() + blob.offset), count);
+				return true;
+			}
+
+			storage.resize(count);
+			const size_t inflated = ZSTD_decompress(storage.data(), blob.rawSize, bytes.data() + blob.offset, blob.storedSize);
+			if (ZSTD_isError(inflated) || inflated != blob.rawSize)
+			{
+				return false;
+			}
+
+			result = storage;
+			return true;
+		}
+
+	}
+
+	std::string GetBakedModelPath(const std::string& sourcePath)
+	{
+		return sourcePath + BakedModelConfig::Extension;
+	}
+
+	bool WriteBakedModel
+	(
+		const std::string& sourcePath,
+		std::span<const BakedModelPrimitiveInput> primitives,
+		std::span<const BakedModelImageInput> images,
+		std::string* error
+	)
+	{
+		BakedModelHeader header;
+		if (!GetSourceStamp(sourcePath, header.sourceSize, header.sourceWriteTime))
+		{
+			if (error)
+			{
+				*error = "Can't stat bake source " + sourcePath;
+			}
+			return false;
+		}
+
+		// Table entries first, the blobs get appended after and their offsets patched in
+		std::vector<BakedPrimitive> bakedPrimitives(primitives.size());
+		std::vector<BakedImage> bakedImages(images.size());
+		std::string names;
+
+		std::vector<Vertex> allVertices;
+		std::vector<uint32_t> allIndices;
+
+		for (size_t i = 0; i < primitives.size(); ++i)
+		{
+			const BakedModelPrimitiveInput& in = primitives[i];
+			BakedPrimitive& out = bakedPrimitives[i];
+
+			out.nameOffset = static_cast<uint32_t>(names.size());
+			out.nameLength = static_cast<uint32_t>(in.name.size());
+			names.append(in.name);
+
+			out.nodeIndex = in.nodeIndex;
+			out.imageIndex = in.imageIndex;
+			out.firstVertex = static_cast<uint32_t>(allVertices.size());
+			out.vertexCount = static_cast<uint32_t>(in.vertices.size());
+			out.firstIndex = static_cast<uint32_t>(allIndices.size());
+			out.indexCount = static_cast<uint32_t>(in.indices.size());
+
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				out.aabbMin[axis] = in.aabbMin[axis];
+				out.aabbMax[axis] = in.aabbMax[axis];
+			}
+
+			allVertices.insert(allVertices.end(), in.vertices.begin(), in.vertices.end());
+			allIndices.insert(allIndices.end(), in.indices.begin(), in.indices.end());
+		}
+
+		header.primitiveCount = static_cast<uint32_t>(bakedPrimitives.size());
+		header.imageCount = static_cast<uint32_t>(bakedImages.size());
+		header.primitivesOffset = AlignUp(sizeof(BakedModelHeader));
+		header.imagesOffset = AlignUp(header.primitivesOffset + bakedPrimitives.size() * sizeof(BakedPrimitive));
+		header.namesOffset = AlignUp(header.imagesOffset + bakedImages.size() * sizeof(BakedImage));
+		header.namesSize = names.size();
+
+		std::vector<uint8_t> out(header.namesOffset + names.size());
+		std::memcpy(out.data() + header.namesOffset, names.data(), names.size());
+
+		header.vertices = AppendBlob(out, allVertices.data(), allVertices.size() * sizeof(Vertex));
+		header.indices = AppendBlob(out, allIndices.data(), allIndices.size() * sizeof(uint32_t));
+
+		for (size_t i = 0; i < images.size(); ++i)
+		{
+			bakedImages[i].width = images[i].width;
+			bakedImages[i].height = images[i].height;
+			bakedImages[i].pixels = AppendBlob(out, images[i].rgba.data(), images[i].rgba.size());
+		}
+
+		std::memcpy(out.data(), &header, sizeof(header));
+		if (!bakedPrimitives.empty())
+		{
+			std::memcpy(out.data() + header.primitivesOffset, bakedPrimitives.data(), bakedPrimitives.size() * sizeof(BakedPrimitive));
+		}
+		if (!bakedImages.empty())
+		{
+			std::memcpy(out.data() + header.imagesOffset, bakedImages.data(), bakedImages.size() * sizeof(BakedImage));
+		}
+
+		const std::string bakedPath = GetBakedModelPath(sourcePath);
+		const std::string tempPath = bakedPath + ".tmp";
+		{
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+			file.write(reinterpret_cast<const char*>(out.data()), static_cast<std::streamsize>(out.size()));
+			if (!file)
+			{
+				if (error)
+				{
+					*error = "Failed to write bake " + tempPath;
+				}
+				return false;
+			}
+		}
+
+		std::error_code ec;
+		std::filesystem::rename(tempPath, bakedPath, ec);
+		if (ec)
+		{
+			std::filesystem::remove(tempPath, ec);
+			if (error)
+			{
+				*error = "Failed to move bake into place " + bakedPath;
+			}
+			return false;
+		}
+
+		return true;
+	}
+
+	bool BakedModelReader::Open(const std::string& sourcePath)
+	{
+		uint64_t sourceSize = 0;
+		int64_t sourceWriteTime = 0;
+		if (!GetSourceStamp(sourcePath, sourceSize, sourceWriteTime))
+		{
+			return false;
+		}
+
+		if (!file.Open(GetBakedModelPath(sourcePath)))
+		{
+			return false;
+		}
+
+		const std::span<const uint8_t> bytes = file.GetBytes();
+		if (bytes.size() < sizeof(BakedModelHeader))
+		{
+			return false;
+		}
+
+		const BakedModelHeader& header = *reinterpret_cast<const BakedModelHeader*>(bytes.data());
+		if (header.magic != BakedModelHeader::Magic
+			|| header.version != BakedModelHeader::CurrentVersion
+			|| header.vertexStride != sizeof(Vertex)
+			|| header.sourceSize != sourceSize
+			|| header.sourceWriteTime != sourceWriteTime)
+		{
+			return false;
+		}
+
+		const BakedBlob primitiveTable{ header.primitivesOffset, header.primitiveCount * sizeof(BakedPrimitive), header.primitiveCount * sizeof(BakedPrimitive) };
+		const BakedBlob imageTable{ header.imagesOffset, header.imageCount * sizeof(BakedImage), header.imageCount * sizeof(BakedImage) };
+		const BakedBlob nameTable{ header.namesOffset, header.namesSize, header.namesSize };
+		if (!BlobInFile(primitiveTable, bytes.size()) || !BlobInFile(imageTable, bytes.size()) || !BlobInFile(nameTable, bytes.size()))
+		{
+			return false;
+		}
+
+		primitives = std::span<const BakedPrimitive>(reinterpret_cast<const BakedPrimitive*>(bytes.data() + header.primitivesOffset), header.primitiveCount);
+		images = std::span<const BakedImage>(reinterpret_cast<const BakedImage*>(bytes.data() + header.imagesOffset), header.imageCount);
+		names = std::string_view(reinterpret_cast<const char*>(bytes.data() + header.namesOffset), header.namesSize);
+
+		if (!ResolveBlob(bytes, header.vertices, inflatedVertices, vertices) || !ResolveBlob(bytes, header.indices, inflatedIndices, indices))
+		{
+			return false;
+		}
+
+		// Everything the getters index with has to stay inside what was just resolved
+		for (const BakedPrimitive& primitive : primitives)
+		{
+			if (static_cast<uint64_t>(primitive.nameOffset) + primitive.nameLength > names.size()
+				|| static_cast<uint64_t>(primitive.firstVertex) + primitive.vertexCount > vertices.size()
+				|| static_cast<uint64_t>(primitive.firstIndex) + primitive.indexCount > indices.size()
+				|| primitive.imageIndex >= static_cast<int32_t>(images.size()))
+			{
+				return false;
+			}
+		}
+
+		for (const BakedImage& image : images)
+		{
+			if (!BlobInFile(image.pixels, bytes.size()) || image.pixels.rawSize != static_cast<uint64_t>(image.width) * image.height * 4)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	std::string_view BakedModelReader::GetName(const BakedPrimitive& primitive) const
+	{
+		return names.substr(primitive.nameOffset, primitive.nameLength);
+	}
+
+	bool BakedModelReader::ReadImage(const BakedImage& image, std::vector<uint8_t>& rgba) const
+	{
+		const std::span<const uint8_t> bytes = file.GetBytes();
+		const uint8_t* stored = bytes.data() + image.pixels.offset;
+
+		rgba.resize(static_cast<size_t>(image.pixels.rawSize));
+		if (rgba.empty())
+		{
+			return true;
+		}
+
+		if (!image.pixels.IsCompressed())
+		{
+			std::memcpy(rgba.data(), stored, rgba.size());
+			return true;
+		}
+
+		const size_t inflated = ZSTD_decompress(rgba.data(), rgba.size(), stored, static_cast<size_t>(image.pixels.storedSize));
+		return !ZSTD_isError(inflated) && inflated == rgba.size();
+	}
+
+}
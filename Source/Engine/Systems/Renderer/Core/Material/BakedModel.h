@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Library/glm/glm.hpp"
+#include "Engine/Systems/IO/MappedFile.h"
+#include "Engine/Systems/Renderer/Core/Meshes/Vertex.h"
+
+namespace Engine
+{
+
+	struct BakedModelConfig
+	{
+		static constexpr bool Enabled = true; // if false GLBs always go through tinygltf and no bakes are written
+		static constexpr int CompressionLevel = 3; // zstd level, 0 stores every blob raw
+		static constexpr const char* Extension = ".swbm"; // written next to the source file
+	};
+
+	// A byte range of the file, zstd compressed when storedSize differs from rawSize
+	struct BakedBlob
+	{
+		uint64_t offset = 0;
+		uint64_t storedSize = 0;
+		uint64_t rawSize = 0;
+
+		bool IsCompressed() const { return storedSize != rawSize; }
+	};
+
+	// File layout: header | primitives | images | names | blobs, each section 16 byte aligned, little endian.
+	// The vertex and index blobs hold every primitive back to back, already in engine Vertex layout.
+	struct BakedModelHeader
+	{
+		static constexpr uint32_t Magic = 0x4D425753; // "SWBM"
+		static constexpr uint32_t CurrentVersion = 2; // 2: meshes are stored welded and reordered by MeshOptimizer
+
+		uint32_t magic = Magic;
+		uint32_t version = CurrentVersion;
+		uint32_t vertexStride = sizeof(Vertex);
+		uint32_t reserved = 0;
+
+		// The source the bake was made from, a mismatch means the bake is stale
+		uint64_t sourceSize = 0;
+		int64_t sourceWriteTime = 0;
+
+		uint32_t primitiveCount = 0;
+		uint32_t imageCount = 0;
+		uint64_t primitivesOffset = 0;
+		uint64_t imagesOffset = 0;
+		uint64_t namesOffset = 0;
+		uint64_t namesSize = 0;
+
+		BakedBlob vertices;
+		BakedBlob indices;
+	};
+
+	struct BakedPrimitive
+	{
+		uint32_t nameOffset = 0; // into the names section
+		uint32_t nameLength = 0;
+		int32_t nodeIndex = 0;
+		int32_t imageIndex = -1;
+
+		uint32_t firstVertex = 0;
+		uint32_t vertexCount = 0;
+		uint32_t firstIndex = 0;
+		uint32_t indexCount = 0;
+
+		float aabbMin[3]{};
+		float aabbMax[3]{};
+	};
+
+	// Base level RGBA8, the same pixels the tinygltf decode hands to the TexturePool
+	struct BakedImage
+	{
+		uint32_t width = 0;
+		uint32_t height = 0;
+		BakedBlob pixels;
+	};
+
+	static_assert(sizeof(BakedBlob) == 24 && sizeof(BakedModelHeader) == 120 && sizeof(BakedPrimitive) == 56 && sizeof(BakedImage) == 32, "baked model layout changed, bump CurrentVersion");
+
+	// What a bake is written from, the spans only have to live through WriteBakedModel
+	struct BakedModelPrimitiveInput
+	{
+		std::string_view name;
+		int32_t nodeIndex = 0;
+		int32_t imageIndex = -1;
+		std::span<const Vertex> vertices;
+		std::span<const uint32_t> indices;
+		glm::vec3 aabbMin{ 0.0f };
+		glm::vec3 aabbMax{ 0.0f };
+	};
+
+	struct BakedModelImageInput
+	{
+		uint32_t width = 0;
+		uint32_t height = 0;
+		std::span<const uint8_t> rgba; // empty for images nothing referenced
+	};
+
+	// The bake of sourcePath lives at sourcePath + BakedModelConfig::Extension
+	std::string GetBakedModelPath(const std::string& sourcePath);
+
+	// Writes to a temporary file and renames it over the old bake, so a reader never sees half a file
+	bool WriteBakedModel
+	(
+		const std::string& sourcePath,
+		std::span<const BakedModelPrimitiveInput> primitives,
+		std::span<const BakedModelImageInput> images,
+		std::string* error
+	);
+
+	// Maps a bake and hands out its contents in place. Raw blobs are spans into the mapping, compressed ones are inflated once on Open.
+	class BakedModelReader
+	{
+
+	public:
+
+		// False if there is no bake, it is stale, from another version or malformed, the caller then loads the source instead
+		bool Open(const std::string& sourcePath);
+
+		std::span<const BakedPrimitive> GetPrimitives() const { return primitives; }
+		std::span<const BakedImage> GetImages() const { return images; }
+
+		std::string_view GetName(const BakedPrimitive& primitive) const;
+		std::span<const Vertex> GetVertices(const BakedPrimitive& primitive) const { return vertices.subspan(primitive.firstVertex, primitive.vertexCount); }
+		std::span<const uint32_t> GetIndices(const BakedPrimitive& primitive) const { return indices.subspan(primitive.firstIndex, primitive.indexCount); }
+
+		// Copies or inflates the pixels into rgba, safe to call for different images from several threads at once
+		bool ReadImage(const BakedImage& image, std::vector<uint8_t>& rgba) const;
+
+	private:
+
+		MappedFile file;
+
+		std::span<const BakedPrimitive> primitives;
+		std::span<const BakedImage> images;
+		std::string_view names;
+
+		std::span<const Vertex> vertices;
+		std::span<const uint32_t> indices;
+
+		// Only used when the blob was compressed
+		std::vector<Vertex> inflatedVertices;
+		std::vector<uint32_t> inflatedIndices;
+
+	};
+
+}
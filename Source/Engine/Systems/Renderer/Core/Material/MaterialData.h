@@ -2,6 +2,7 @@
 
 #include "Engine/Systems/Renderer/Core/Meshes/Mesh.h"
 #include "Engine/Systems/Renderer/Core/Textures/Texture2D.h"
+#include "MaterialHandle.h"
 
 namespace Engine
 {
@@ -14,6 +15,8 @@ namespace Engine
 		// std::shared_ptr<Texture2D> normalMap; // for light
 		// std::shared_ptr<Texture2D> roughnessMap; // height map technically
 
+		MaterialHandle handle; // assigned by the MaterialPool on registration, materials made outside the pool don't get one and aren't drawn by the batched world pass
+
 		MaterialData() = default;
 
 		MaterialData(const std::shared_ptr<Mesh>& meshPtr, std::shared_ptr<Texture2D>& albedoMap)
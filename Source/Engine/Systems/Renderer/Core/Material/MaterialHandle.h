@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Engine
+{
+
+	// Stable reference to a material registered in the MaterialPool, a slot index into the pool's dense arrays plus the generation it was registered under.
+	// Trivially copyable, the render gather passes these around instead of shared_ptrs.
+	struct MaterialHandle
+	{
+
+		static constexpr uint32_t InvalidIndex = UINT32_MAX;
+
+		uint32_t index = InvalidIndex;
+		uint32_t generation = 0;
+
+		bool IsValid() const { return index != InvalidIndex; }
+
+		bool operator==(const MaterialHandle& other) const { return index == other.index && generation == other.generation; }
+		bool operator!=(const MaterialHandle& other) const { return !(*this == other); }
+
+	};
+
+}
@@ -1,9 +1,13 @@
 #include "PCH.h"
 #include "MaterialPool.h"
 #include "Engine/Systems/Renderer/Core/Material/MaterialData.h"
+#include "Engine/Systems/Renderer/Core/Material/BakedModel.h"
 #include "Library/stb/stb_image.h"
 #include "Engine/Systems/Renderer/Core/Meshes/MeshPool.h"
+#include "Engine/Systems/Renderer/Core/Meshes/MeshOptimizer.h"
 #include "Engine/Systems/Renderer/Core/Textures/TexturePool.h"
+#include "Engine/Utility/JobSystem.h"
+#include "Engine/Utility/Profiler.h"
 #include <filesystem>
 
 #define BASISU_FORCE_DEVEL_MESSAGES 0
@@ -17,6 +21,18 @@
 
 #include "Library/webp/include/webp/decode.h"
 
+#include "Library/draco/compression/decode.h"
+
+#ifndef SWIM_GLB_USE_SSE
+#define SWIM_GLB_USE_SSE 0
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <immintrin.h>
+#undef SWIM_GLB_USE_SSE
+#define SWIM_GLB_USE_SSE 1
+#endif
+
 namespace Engine
 {
 
@@ -105,6 +121,7 @@ namespace Engine
 		}
 
 		auto data = std::make_shared<MaterialData>(mesh, albedoMap);
+		data->handle = AssignMaterialSlot(*data);
 		materials.emplace(name, data);
 
 		// Signal the editor to add this string to its list of material assets to keep track of
@@ -117,6 +134,25 @@ namespace Engine
 		return data;
 	}
 
+	MaterialHandle MaterialPool::AssignMaterialSlot(const MaterialData& data)
+	{
+		const uint32_t slot = nextMaterialSlot++;
+		if (slot >= materialSlotInfos.size())
+		{
+			materialSlotInfos.resize(slot + 1);
+			materialSlotGenerations.resize(slot + 1, 0);
+		}
+
+		MaterialRenderInfo& info = materialSlotInfos[slot];
+		info.mesh = data.mesh ? data.mesh->handle : MeshHandle{};
+		info.albedoMap = data.albedoMap.get();
+
+		MaterialHandle handle;
+		handle.index = slot;
+		handle.generation = materialSlotGenerations[slot];
+		return handle;
+	}
+
 	std::vector<std::shared_ptr<MaterialData>> MaterialPool::GetCompositeMaterialData(const std::string& name)
 	{
 		std::lock_guard<std::mutex> lock(poolMutex);
@@ -148,15 +184,61 @@ namespace Engine
 		return false;
 	}
 
+	// Everything a GLB load produces off the main thread, FinishCompositeMaterialLoad turns it into pool entries
+	struct GlbLoad
+	{
+		// One primitive with its vertices already in engine layout
+		struct Primitive
+		{
+			int nodeIndex = 0;
+			bool draco = false;
+			int meshIndex = 0;
+			size_t primitiveIndex = 0;
+			std::string meshName;
+			glm::mat4 worldTransform{ 1.0f };
+
+			int imageSource = -1;
+			glm::vec2 uvOffset{ 0.0f };
+			glm::vec2 uvScale{ 1.0f };
+			float uvRotation = 0.0f;
+
+			std::vector<Vertex> vertices;
+			std::vector<uint32_t> indices;
+			glm::vec3 aabbMin{ 0.0f };
+			glm::vec3 aabbMax{ 0.0f };
+		};
+
+		// Image bytes as they sit in the file, the tinygltf callback only copies them so decoding can run on every worker afterwards
+		struct EncodedImage
+		{
+			std::string mimeType;
+			std::vector<unsigned char> bytes;
+		};
+
+		std::string path;
+		bool allowBake = true;
+		bool optimizeMeshes = true; // MeshPool's optimize on register setting when the load started, the workers do it instead
+		bool fromBake = false;
+		tinygltf::Model model;
+		std::vector<EncodedImage> encodedImages;
+		std::vector<Primitive> primitives;
+
+		std::string error; // set by the job when the load failed
+		JobHandle job;
+
+		bool committed = false;
+		std::vector<std::shared_ptr<MaterialData>> materials;
+	};
+
 	static bool LoadKTX2Image(tinygltf::Image* image, const unsigned char* bytes, int size, std::string* err, int image_idx)
 	{
-		// Initialize the transcoder once globally
-		static bool transcoderInitialized = false;
-		if (!transcoderInitialized)
+		// Initialize the transcoder once globally, images decode on several workers at once
+		static const bool transcoderInitialized = []()
 		{
 			basist::basisu_transcoder_init();
-			transcoderInitialized = true;
-		}
+			return true;
+		}();
+		(void)transcoderInitialized;
 
 		basist::ktx2_transcoder ktx2;
 
@@ -224,12 +306,90 @@ namespace Engine
 		return true;
 	}
 
-	void MaterialPool::LoadNodeRecursive(
+	// Decodes one image the way the tinygltf callback used to, into RGBA8
+	static bool DecodeGltfImage(tinygltf::Image* image, const unsigned char* bytes, int size, std::string* err, int image_idx)
+	{
+		if (image->mimeType == "image/ktx2" || (size >= 12 && std::memcmp(bytes, "\xABKTX 20\xBB\r\n\x1A\n", 12) == 0))
+		{
+			if (!LoadKTX2Image(image, bytes, size, err, image_idx))
+			{
+				if (err != nullptr)
+				{
+					*err += "[GLTF Loader] Failed to load KTX2 image at index " + std::to_string(image_idx) + "\n";
+				}
+				return false;
+			}
+		}
+		else if (image->mimeType == "image/webp" || (size >= 12 && std::memcmp(bytes, "RIFF", 4) == 0 && std::memcmp(bytes + 8, "WEBP", 4) == 0))
+		{
+			int width = 0;
+			int height = 0;
+
+			if (!WebPGetInfo(bytes, size, &width, &height))
+			{
+				if (err != nullptr)
+				{
+					*err += "[GLTF Loader] WebPGetInfo failed (corrupt?) at index " + std::to_string(image_idx) + '\n';
+				}
+				return false;
+			}
+
+			// Allocate once, decode directly into final buffer
+			std::vector<uint8_t> rgba(width * height * 4);
+
+			if (!WebPDecodeRGBAInto(bytes, size, rgba.data(), static_cast<int>(rgba.size()), width * 4))
+			{
+				if (err != nullptr)
+				{
+					*err += "[GLTF Loader] WebPDecodeRGBAInto failed at index " + std::to_string(image_idx) + '\n';
+				}
+				return false;
+			}
+
+			// Fill tinygltf::Image with raw pixels
+			image->width = width;
+			image->height = height;
+			image->component = 4;   // RGBA
+			image->bits = 8;   // 8-bit per channel
+			image->pixel_type = TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
+			image->image = std::move(rgba);
+		}
+		else
+		{
+			int width = 0;
+			int height = 0;
+			int channels = 0;
+			stbi_uc* decoded = stbi_load_from_memory(bytes, size, &width, &height, &channels, STBI_rgb_alpha);
+			if (!decoded)
+			{
+				if (err != nullptr)
+				{
+					*err += "[GLTF Loader] stb_image failed: " + std::string(stbi_failure_reason()) + "\n";
+				}
+				return false;
+			}
+
+			image->width = width;
+			image->height = height;
+			image->component = 4;
+			image->bits = 8;
+			image->pixel_type = TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
+			image->image.resize(width * height * 4);
+			std::memcpy(image->image.data(), decoded, image->image.size());
+			stbi_image_free(decoded);
+		}
+
+		return true;
+	}
+
+	// Walks the node tree in file order and records every primitive with its world transform and texture, the conversion happens later on the workers
+	static void CollectNodePrimitives
+	(
 		const tinygltf::Model& model,
 		int nodeIndex,
 		const glm::mat4& parentTransform,
-		const std::string& path,
-		std::vector<std::shared_ptr<MaterialData>>& loadedMaterials)
+		std::vector<GlbLoad::Primitive>& primitives
+	)
 	{
 		const tinygltf::Node& node = model.nodes[nodeIndex];
 		std::string nodeName = node.name.empty() ? "Node_" + std::to_string(nodeIndex) : node.name;
@@ -275,72 +435,28 @@ namespace Engine
 		if (node.mesh >= 0)
 		{
 			const tinygltf::Mesh& gltfMesh = model.meshes[node.mesh];
-			std::string meshName = gltfMesh.name.empty() ? "mesh_" + std::to_string(node.mesh) : gltfMesh.name;
 
 			for (size_t primIdx = 0; primIdx < gltfMesh.primitives.size(); ++primIdx)
 			{
 				const tinygltf::Primitive& primitive = gltfMesh.primitives[primIdx];
 
+				// Draco primitives keep their accessors for the counts only, the data is in the extension's buffer view
 				const tinygltf::Accessor& posAccessor = model.accessors[primitive.attributes.at("POSITION")];
-				if (posAccessor.count == 0 || posAccessor.bufferView < 0)
+				const bool isDraco = primitive.extensions.contains("KHR_draco_mesh_compression");
+				if (posAccessor.count == 0 || (posAccessor.bufferView < 0 && !isDraco))
 				{
 					continue;
 				}
 
-				const tinygltf::BufferView& posView = model.bufferViews[posAccessor.bufferView];
-				const tinygltf::Buffer& posBuffer = model.buffers[posView.buffer];
-				const unsigned char* posBase = posBuffer.data.data() + posView.byteOffset + posAccessor.byteOffset;
-				const size_t posStride = posView.byteStride > 0 ? posView.byteStride : sizeof(float) * 3;
-
-				// UV and Color handling
-				bool hasUV = primitive.attributes.contains("TEXCOORD_0");
-				bool hasColor = primitive.attributes.contains("COLOR_0");
-
-				const unsigned char* uvRawBase = nullptr;
-				size_t uvStride = 0;
-				const tinygltf::Accessor* uvAccessor = nullptr;
-
-				if (hasUV)
-				{
-					uvAccessor = &model.accessors[primitive.attributes.at("TEXCOORD_0")];
-					if (uvAccessor->count > 0 && uvAccessor->bufferView >= 0)
-					{
-						const auto& uvView = model.bufferViews[uvAccessor->bufferView];
-						const auto& uvBuffer = model.buffers[uvView.buffer];
-						uvRawBase = uvBuffer.data.data() + uvView.byteOffset + uvAccessor->byteOffset;
-						uvStride = uvView.byteStride > 0 ? uvView.byteStride : sizeof(float) * 2;
-					}
-					else
-					{
-						hasUV = false;
-					}
-				}
-
-				const unsigned char* colorRawBase = nullptr;
-				size_t colorStride = 0;
-				const tinygltf::Accessor* colorAccessor = nullptr;
+				GlbLoad::Primitive& prim = primitives.emplace_back();
+				prim.nodeIndex = nodeIndex;
+				prim.draco = isDraco;
+				prim.meshIndex = node.mesh;
+				prim.primitiveIndex = primIdx;
+				prim.worldTransform = worldTransform;
 
-				if (hasColor)
-				{
-					colorAccessor = &model.accessors[primitive.attributes.at("COLOR_0")];
-					if (colorAccessor->count > 0 && colorAccessor->bufferView >= 0)
-					{
-						const auto& colorView = model.bufferViews[colorAccessor->bufferView];
-						const auto& colorBuffer = model.buffers[colorView.buffer];
-						colorRawBase = colorBuffer.data.data() + colorView.byteOffset + colorAccessor->byteOffset;
-						colorStride = colorView.byteStride > 0 ? colorView.byteStride : sizeof(float) * 3;
-					}
-					else
-					{
-						hasColor = false;
-					}
-				}
-
-				// Texture and UV transform setup
-				std::shared_ptr<Texture2D> texture = nullptr;
-				glm::vec2 uvOffset(0.0f);
-				glm::vec2 uvScale(1.0f);
-				float uvRotation = 0.0f;
+				// Ensure mesh and material names are unique per node+prim combo
+				prim.meshName = nodeName + "_mesh" + std::to_string(node.mesh) + "_prim" + std::to_string(primIdx);
 
 				if (primitive.material >= 0 && primitive.material < model.materials.size())
 				{
@@ -380,278 +496,830 @@ namespace Engine
 							if (transform.Has("offset"))
 							{
 								const auto& o = transform.Get("offset").Get<tinygltf::Value::Array>();
-								uvOffset = glm::vec2(static_cast<float>(o[0].Get<double>()), static_cast<float>(o[1].Get<double>()));
+								prim.uvOffset = glm::vec2(static_cast<float>(o[0].Get<double>()), static_cast<float>(o[1].Get<double>()));
 							}
 							if (transform.Has("scale"))
 							{
 								const auto& s = transform.Get("scale").Get<tinygltf::Value::Array>();
-								uvScale = glm::vec2(static_cast<float>(s[0].Get<double>()), static_cast<float>(s[1].Get<double>()));
+								prim.uvScale = glm::vec2(static_cast<float>(s[0].Get<double>()), static_cast<float>(s[1].Get<double>()));
 							}
 							if (transform.Has("rotation"))
 							{
-								uvRotation = static_cast<float>(transform.Get("rotation").Get<double>());
+								prim.uvRotation = static_cast<float>(transform.Get("rotation").Get<double>());
 							}
 						}
 
 						if (imageSource >= 0 && imageSource < model.images.size())
 						{
-							const tinygltf::Image& img = model.images[imageSource];
-							TexturePool& texturePool = TexturePool::GetInstance();
-							texture = texturePool.GetOrCreateTextureFromTinyGltfImage(img, path + "_" + std::to_string(nodeIndex));
+							prim.imageSource = imageSource;
 						}
 					}
 				}
+			}
+		}
 
-				// Build vertex buffer
-				std::vector<Vertex> vertices;
-				vertices.reserve(posAccessor.count);
+		// Recurse into children
+		for (int childIndex : node.children)
+		{
+			CollectNodePrimitives(model, childIndex, worldTransform, primitives);
+		}
+	}
 
-				for (size_t i = 0; i < posAccessor.count; ++i)
-				{
-					Vertex v;
-					const float* posPtr = reinterpret_cast<const float*>(posBase + i * posStride);
-					glm::vec4 rawPos = glm::vec4(posPtr[0], posPtr[1], posPtr[2], 1.0f);
-					v.position = glm::vec3(worldTransform * rawPos);
+	// One vertex attribute with everything per accessor resolved up front, the conversion loops only step through it
+	struct AttributeStream
+	{
+		const unsigned char* base = nullptr;
+		size_t stride = 0;
+		int componentType = 0;
+		int components = 0;
+	};
 
-					if (hasUV)
-					{
-						const float* uvPtr = reinterpret_cast<const float*>(uvRawBase + i * uvStride);
-						glm::vec2 uv = glm::vec2(uvPtr[0], uvPtr[1]);
+	static bool ResolveAttributeStream(const tinygltf::Model& model, const tinygltf::Primitive& primitive, const char* name, AttributeStream& stream)
+	{
+		auto it = primitive.attributes.find(name);
+		if (it == primitive.attributes.end())
+		{
+			return false;
+		}
 
-						uv -= 0.5f;
-						float cosR = std::cos(uvRotation);
-						float sinR = std::sin(uvRotation);
-						uv = glm::mat2(cosR, -sinR, sinR, cosR) * uv;
-						uv += 0.5f;
-						uv = uv * uvScale + uvOffset;
+		const tinygltf::Accessor& accessor = model.accessors[it->second];
+		if (accessor.count == 0 || accessor.bufferView < 0)
+		{
+			return false;
+		}
 
-						v.uv = uv;
-					}
-					else
-					{
-						v.uv = glm::vec2(0.0f);
-					}
+		const tinygltf::BufferView& view = model.bufferViews[accessor.bufferView];
+		const tinygltf::Buffer& buffer = model.buffers[view.buffer];
+		const int byteStride = accessor.ByteStride(view);
+		if (byteStride <= 0)
+		{
+			return false;
+		}
 
-					if (hasColor)
-					{
-						const float* colorPtr = reinterpret_cast<const float*>(colorRawBase + i * colorStride);
-						v.color = glm::vec3(colorPtr[0], colorPtr[1], colorPtr[2]);
-					}
-					else
-					{
-						v.color = glm::vec3(1.0f);
-					}
+		stream.base = buffer.data.data() + view.byteOffset + accessor.byteOffset;
+		stream.stride = static_cast<size_t>(byteStride);
+		stream.componentType = accessor.componentType;
+		stream.components = tinygltf::GetNumComponentsInType(accessor.type);
+		return true;
+	}
 
-					vertices.push_back(v);
-				}
+	// glTF only allows float or normalized unsigned integers for UVs and colors
+	static inline float ToUnitFloat(float value) { return value; }
+	static inline float ToUnitFloat(uint8_t value) { return static_cast<float>(value) * (1.0f / 255.0f); }
+	static inline float ToUnitFloat(uint16_t value) { return static_cast<float>(value) * (1.0f / 65535.0f); }
 
-				// Index buffer
-				std::vector<uint32_t> indices;
-				if (primitive.indices >= 0)
-				{
-					const auto& idxAccessor = model.accessors[primitive.indices];
-					const auto& idxView = model.bufferViews[idxAccessor.bufferView];
-					const auto& idxBuffer = model.buffers[idxView.buffer];
-					const unsigned char* idxBase = idxBuffer.data.data() + idxView.byteOffset + idxAccessor.byteOffset;
+	template<typename T>
+	static inline T LoadComponent(const unsigned char* element, int index)
+	{
+		T value;
+		std::memcpy(&value, element + index * sizeof(T), sizeof(T));
+		return value;
+	}
 
-					indices.reserve(idxAccessor.count);
-					for (size_t i = 0; i < idxAccessor.count; ++i)
-					{
-						uint32_t index = 0;
-						switch (idxAccessor.componentType)
-						{
-							case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:  index = reinterpret_cast<const uint8_t*>(idxBase)[i]; break;
-							case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: index = reinterpret_cast<const uint16_t*>(idxBase)[i]; break;
-							case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:   index = reinterpret_cast<const uint32_t*>(idxBase)[i]; break;
-							default:
-							std::cerr << "[ERROR] Unsupported index type: " << idxAccessor.componentType << std::endl;
-							throw std::runtime_error("Unsupported index type");
-						}
-						indices.push_back(index);
-					}
-				}
-				else
-				{
-					indices.reserve(vertices.size());
-					for (uint32_t i = 0; i < vertices.size(); ++i)
-					{
-						indices.push_back(i);
-					}
-				}
+	// Positions go through the node's world transform as an affine 3x4, the w row of a node transform is always 0 0 0 1
+	static void WritePositions(const AttributeStream& stream, const glm::mat4& transform, Vertex* out, size_t count)
+	{
+		if (stream.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT)
+		{
+			throw std::runtime_error("Unsupported position component type: " + std::to_string(stream.componentType));
+		}
 
-				// Ensure mesh and material names are unique per node+prim combo
-				std::string finalMeshName = nodeName + "_mesh" + std::to_string(node.mesh) + "_prim" + std::to_string(primIdx);
-				std::shared_ptr<Mesh> mesh = MeshPool::GetInstance().RegisterMesh(finalMeshName, vertices, indices);
+	#if SWIM_GLB_USE_SSE
+		const __m128 c0 = _mm_loadu_ps(&transform[0][0]);
+		const __m128 c1 = _mm_loadu_ps(&transform[1][0]);
+		const __m128 c2 = _mm_loadu_ps(&transform[2][0]);
+		const __m128 c3 = _mm_loadu_ps(&transform[3][0]);
 
-				std::string matName = finalMeshName + "_material";
-				std::shared_ptr<MaterialData> matData = RegisterMaterialData(matName, mesh, texture);
-				loadedMaterials.push_back(matData);
+		for (size_t i = 0; i < count; ++i)
+		{
+			const float* p = reinterpret_cast<const float*>(stream.base + i * stream.stride);
+			__m128 r = _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(p[0])), c3);
+			r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(p[1])));
+			r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(p[2])));
+
+			// The fourth lane lands on color.r, which WriteColors always writes after this
+			static_assert(offsetof(Vertex, color) == offsetof(Vertex, position) + sizeof(glm::vec3), "position store spills into color");
+			_mm_storeu_ps(&out[i].position.x, r);
+		}
+	#else
+		const glm::vec3 c0(transform[0]);
+		const glm::vec3 c1(transform[1]);
+		const glm::vec3 c2(transform[2]);
+		const glm::vec3 c3(transform[3]);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			const float* p = reinterpret_cast<const float*>(stream.base + i * stream.stride);
+			out[i].position = c0 * p[0] + c1 * p[1] + c2 * p[2] + c3;
+		}
+	#endif
+	}
+
+	// KHR_texture_transform folded into one 2x3 affine: scale * (rotate(uv - 0.5) + 0.5) + offset
+	struct UvTransform
+	{
+		float a00, a01, b0;
+		float a10, a11, b1;
+
+		UvTransform(glm::vec2 offset, glm::vec2 scale, float rotation)
+		{
+			const float c = std::cos(rotation);
+			const float s = std::sin(rotation);
+
+			a00 = scale.x * c;
+			a01 = scale.x * s;
+			b0 = scale.x * (0.5f - 0.5f * c - 0.5f * s) + offset.x;
+
+			a10 = -scale.y * s;
+			a11 = scale.y * c;
+			b1 = scale.y * (0.5f + 0.5f * s - 0.5f * c) + offset.y;
+		}
+	};
+
+	template<typename T>
+	static void WriteUVsTyped(const AttributeStream& stream, const UvTransform& t, Vertex* out, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			const unsigned char* element = stream.base + i * stream.stride;
+			const float u = ToUnitFloat(LoadComponent<T>(element, 0));
+			const float v = ToUnitFloat(LoadComponent<T>(element, 1));
+			out[i].uv = glm::vec2(t.a00 * u + t.a01 * v + t.b0, t.a10 * u + t.a11 * v + t.b1);
+		}
+	}
+
+	static void WriteUVs(const AttributeStream* stream, const UvTransform& t, Vertex* out, size_t count)
+	{
+		switch (stream ? stream->componentType : -1)
+		{
+			case TINYGLTF_COMPONENT_TYPE_FLOAT:          WriteUVsTyped<float>(*stream, t, out, count); return;
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:  WriteUVsTyped<uint8_t>(*stream, t, out, count); return;
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: WriteUVsTyped<uint16_t>(*stream, t, out, count); return;
+			default: break;
+		}
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			out[i].uv = glm::vec2(0.0f);
+		}
+	}
+
+	template<typename T>
+	static void WriteColorsTyped(const AttributeStream& stream, Vertex* out, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			const unsigned char* element = stream.base + i * stream.stride;
+			out[i].color = glm::vec3(
+				ToUnitFloat(LoadComponent<T>(element, 0)),
+				ToUnitFloat(LoadComponent<T>(element, 1)),
+				ToUnitFloat(LoadComponent<T>(element, 2)));
+		}
+	}
+
+	// VEC4 colors drop their alpha, the vertex only has rgb
+	static void WriteColors(const AttributeStream* stream, Vertex* out, size_t count)
+	{
+		switch (stream && stream->components >= 3 ? stream->componentType : -1)
+		{
+			case TINYGLTF_COMPONENT_TYPE_FLOAT:          WriteColorsTyped<float>(*stream, out, count); return;
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:  WriteColorsTyped<uint8_t>(*stream, out, count); return;
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: WriteColorsTyped<uint16_t>(*stream, out, count); return;
+			default: break;
+		}
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			out[i].color = glm::vec3(1.0f);
+		}
+	}
+
+	template<typename T>
+	static void WriteIndicesTyped(const unsigned char* base, uint32_t* out, size_t count)
+	{
+		if constexpr (sizeof(T) == sizeof(uint32_t))
+		{
+			std::memcpy(out, base, count * sizeof(uint32_t));
+		}
+		else
+		{
+			const T* src = reinterpret_cast<const T*>(base);
+			for (size_t i = 0; i < count; ++i)
+			{
+				out[i] = src[i];
 			}
 		}
+	}
 
-		// Recurse into children
-		for (int childIndex : node.children)
+	// Writes every vertex of the primitive from already resolved streams and works out its bounds, shared by plain and Draco primitives
+	static void WritePrimitiveVertices(const AttributeStream& positions, const AttributeStream* uvs, const AttributeStream* colors, size_t vertexCount, GlbLoad::Primitive& prim)
+	{
+		std::vector<Vertex>& vertices = prim.vertices;
+		vertices.resize(vertexCount);
+		Vertex* out = vertices.data();
+
+		// Colors after positions, see WritePositions
+		WritePositions(positions, prim.worldTransform, out, vertexCount);
+		WriteColors(colors, out, vertexCount);
+		WriteUVs(uvs, UvTransform(prim.uvOffset, prim.uvScale, prim.uvRotation), out, vertexCount);
+
+		// Bounds while the positions are still in cache, the main thread and the bake both take them from here
+		prim.aabbMin = prim.aabbMax = out[0].position;
+		for (size_t i = 1; i < vertexCount; ++i)
 		{
-			LoadNodeRecursive(model, childIndex, worldTransform, path, loadedMaterials);
+			prim.aabbMin = glm::min(prim.aabbMin, out[i].position);
+			prim.aabbMax = glm::max(prim.aabbMax, out[i].position);
 		}
 	}
 
-	std::vector<std::shared_ptr<MaterialData>> MaterialPool::LoadAndRegisterCompositeMaterialFromGLB(const std::string& path)
+	// Draco attribute values are shared between points through a mapping, points that map 1:1 can be read in place
+	static bool ResolveDracoStream(const draco::Mesh& mesh, const draco::PointAttribute* attribute, std::vector<uint8_t>& gathered, AttributeStream& stream)
+	{
+		if (attribute == nullptr)
+		{
+			return false;
+		}
+
+		switch (attribute->data_type())
+		{
+			case draco::DT_FLOAT32: stream.componentType = TINYGLTF_COMPONENT_TYPE_FLOAT; break;
+			case draco::DT_UINT8:   stream.componentType = TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE; break;
+			case draco::DT_UINT16:  stream.componentType = TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT; break;
+			default: return false;
+		}
+
+		stream.components = attribute->num_components();
+		stream.stride = static_cast<size_t>(attribute->byte_stride());
+
+		if (attribute->is_mapping_identity())
+		{
+			stream.base = attribute->GetAddress(draco::AttributeValueIndex(0));
+			return true;
+		}
+
+		const uint32_t pointCount = mesh.num_points();
+		gathered.resize(static_cast<size_t>(pointCount) * stream.stride);
+		for (uint32_t point = 0; point < pointCount; ++point)
+		{
+			std::memcpy(gathered.data() + point * stream.stride, attribute->GetAddressOfMappedIndex(draco::PointIndex(point)), stream.stride);
+		}
+
+		stream.base = gathered.data();
+		return true;
+	}
+
+	// KHR_draco_mesh_compression: decodes the compressed buffer view and runs the result through the same writers as a plain primitive
+	static void ConvertDracoPrimitive(const tinygltf::Model& model, const tinygltf::Value& extension, GlbLoad::Primitive& prim)
 	{
-		struct ImageCollector
+		const int bufferViewIndex = extension.Get("bufferView").GetNumberAsInt();
+		if (bufferViewIndex < 0 || bufferViewIndex >= static_cast<int>(model.bufferViews.size()))
+		{
+			throw std::runtime_error("Draco primitive " + prim.meshName + " has no buffer view");
+		}
+
+		const tinygltf::BufferView& view = model.bufferViews[bufferViewIndex];
+		const tinygltf::Buffer& buffer = model.buffers[view.buffer];
+
+		draco::DecoderBuffer decoderBuffer;
+		decoderBuffer.Init(reinterpret_cast<const char*>(buffer.data.data() + view.byteOffset), view.byteLength);
+
+		draco::Decoder decoder;
+		draco::StatusOr<std::unique_ptr<draco::Mesh>> decoded = decoder.DecodeMeshFromBuffer(&decoderBuffer);
+		if (!decoded.ok() || !decoded.value())
+		{
+			throw std::runtime_error("Draco decode failed for " + prim.meshName + ": " + decoded.status().error_msg_string());
+		}
+
+		const std::unique_ptr<draco::Mesh> mesh = std::move(decoded).value();
+
+		// The extension maps glTF semantics to the unique IDs of the decoded attributes
+		const tinygltf::Value& attributes = extension.Get("attributes");
+		const auto findAttribute = [&](const char* semantic) -> const draco::PointAttribute*
 		{
-			std::unordered_map<int, tinygltf::Image> images;
+			if (!attributes.Has(semantic))
+			{
+				return nullptr;
+			}
+
+			return mesh->GetAttributeByUniqueId(static_cast<uint32_t>(attributes.Get(semantic).GetNumberAsInt()));
 		};
 
-		std::vector<std::shared_ptr<MaterialData>> loadedMaterials;
-		tinygltf::Model model;
+		std::vector<uint8_t> gatheredPositions, gatheredUVs, gatheredColors;
+		AttributeStream positions, uvs, colors;
+
+		if (!ResolveDracoStream(*mesh, findAttribute("POSITION"), gatheredPositions, positions) || positions.components < 3 || mesh->num_points() == 0)
+		{
+			throw std::runtime_error("Draco primitive " + prim.meshName + " has no usable positions");
+		}
+
+		const bool hasUV = ResolveDracoStream(*mesh, findAttribute("TEXCOORD_0"), gatheredUVs, uvs) && uvs.components >= 2;
+		const bool hasColor = ResolveDracoStream(*mesh, findAttribute("COLOR_0"), gatheredColors, colors);
+
+		WritePrimitiveVertices(positions, hasUV ? &uvs : nullptr, hasColor ? &colors : nullptr, mesh->num_points(), prim);
+
+		const uint32_t faceCount = mesh->num_faces();
+		prim.indices.resize(static_cast<size_t>(faceCount) * 3);
+		uint32_t* outIndices = prim.indices.data();
+		for (uint32_t face = 0; face < faceCount; ++face)
+		{
+			const draco::Mesh::Face& corners = mesh->face(draco::FaceIndex(face));
+			outIndices[face * 3 + 0] = corners[0].value();
+			outIndices[face * 3 + 1] = corners[1].value();
+			outIndices[face * 3 + 2] = corners[2].value();
+		}
+	}
+
+	// Fills the primitive's vertices and indices from its accessors, only reads the model so every primitive can convert on its own worker.
+	// Every attribute is one pass straight into the final arrays, which MeshPool::RegisterMesh uploads as they are.
+	static void ConvertGlbPrimitive(const tinygltf::Model& model, const tinygltf::Primitive& primitive, GlbLoad::Primitive& prim)
+	{
+		auto draco = primitive.extensions.find("KHR_draco_mesh_compression");
+		if (draco != primitive.extensions.end())
+		{
+			ConvertDracoPrimitive(model, draco->second, prim);
+			return;
+		}
+
+		AttributeStream positions;
+		if (!ResolveAttributeStream(model, primitive, "POSITION", positions))
+		{
+			return; // the collector already skipped these
+		}
+
+		const size_t vertexCount = model.accessors[primitive.attributes.at("POSITION")].count;
+
+		AttributeStream uvs;
+		AttributeStream colors;
+		const bool hasUV = ResolveAttributeStream(model, primitive, "TEXCOORD_0", uvs);
+		const bool hasColor = ResolveAttributeStream(model, primitive, "COLOR_0", colors);
+
+		WritePrimitiveVertices(positions, hasUV ? &uvs : nullptr, hasColor ? &colors : nullptr, vertexCount, prim);
+
+		// Index buffer
+		std::vector<uint32_t>& indices = prim.indices;
+		if (primitive.indices >= 0)
+		{
+			const auto& idxAccessor = model.accessors[primitive.indices];
+			const auto& idxView = model.bufferViews[idxAccessor.bufferView];
+			const auto& idxBuffer = model.buffers[idxView.buffer];
+			const unsigned char* idxBase = idxBuffer.data.data() + idxView.byteOffset + idxAccessor.byteOffset;
+
+			indices.resize(idxAccessor.count);
+			switch (idxAccessor.componentType)
+			{
+				case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:  WriteIndicesTyped<uint8_t>(idxBase, indices.data(), indices.size()); break;
+				case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: WriteIndicesTyped<uint16_t>(idxBase, indices.data(), indices.size()); break;
+				case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:   WriteIndicesTyped<uint32_t>(idxBase, indices.data(), indices.size()); break;
+				default:
+				throw std::runtime_error("Unsupported index type: " + std::to_string(idxAccessor.componentType));
+			}
+		}
+		else
+		{
+			indices.resize(vertexCount);
+			for (uint32_t i = 0; i < vertexCount; ++i)
+			{
+				indices[i] = i;
+			}
+		}
+	}
+
+	// Parses the file, then decodes the images and converts the primitives across the job system
+	static void ParseGlb(GlbLoad& load)
+	{
 		tinygltf::TinyGLTF loader;
 		std::string err, warn;
-		ImageCollector imageCollector;
 
-		std::cout << "[DEBUG] Loading GLB file: " << path << std::endl;
+		std::cout << "[DEBUG] Loading GLB file: " << load.path << std::endl;
 
-		// Image loader with KTX2 support
-		tinygltf::LoadImageDataFunction CustomImageLoader = [](
+		// Only copies the encoded bytes out, decoding them here would serialize every image of the file
+		tinygltf::LoadImageDataFunction DeferredImageLoader = [](
 			tinygltf::Image* image,
 			const int image_idx,
-			std::string* err,
-			std::string* warn,
-			int req_width,
-			int req_height,
+			std::string* /*err*/,
+			std::string* /*warn*/,
+			int /*req_width*/,
+			int /*req_height*/,
 			const unsigned char* bytes,
 			int size,
 			void* user_data) -> bool
 		{
-			ImageCollector* collector = reinterpret_cast<ImageCollector*>(user_data);
+			std::vector<GlbLoad::EncodedImage>& encodedImages = *reinterpret_cast<std::vector<GlbLoad::EncodedImage>*>(user_data);
+			if (image_idx >= static_cast<int>(encodedImages.size()))
+			{
+				encodedImages.resize(image_idx + 1);
+			}
 
-			if (image->mimeType == "image/ktx2" || (size >= 12 && std::memcmp(bytes, "\xABKTX 20\xBB\r\n\x1A\n", 12) == 0))
+			GlbLoad::EncodedImage& encoded = encodedImages[image_idx];
+			encoded.mimeType = image->mimeType;
+			encoded.bytes.assign(bytes, bytes + size);
+			return true;
+		};
+
+		loader.SetImageLoader(DeferredImageLoader, &load.encodedImages);
+
+		// Load GLB binary
+		tinygltf::Model& model = load.model;
+		if (!loader.LoadBinaryFromFile(&model, &err, &warn, load.path))
+		{
+			load.error = "Failed to load GLB file: " + load.path + "\n" + err;
+			return;
+		}
+		if (!warn.empty())
+		{
+			std::cerr << "GLTF Warning: " << warn << std::endl;
+		}
+
+		if (model.scenes.empty())
+		{
+			load.error = "GLTF file contains no scenes: " + load.path;
+			return;
+		}
+
+		if (load.encodedImages.size() > model.images.size())
+		{
+			model.images.resize(load.encodedImages.size());
+		}
+
+		JobSystem& jobs = JobSystem::Get();
+
+		// Every image decodes straight into its own slot of the model
+		std::vector<std::string> imageErrors(load.encodedImages.size());
+		std::vector<uint8_t> imageFailed(load.encodedImages.size(), 0);
+
+		jobs.ParallelForBackgroundTasks(load.encodedImages.size(), [&](size_t imageIndex, uint32_t /*workerIndex*/)
+		{
+			GlbLoad::EncodedImage& encoded = load.encodedImages[imageIndex];
+			if (encoded.bytes.empty())
+			{
+				return;
+			}
+
+			try
 			{
-				if (!LoadKTX2Image(image, bytes, size, err, image_idx))
+				tinygltf::Image& image = model.images[imageIndex];
+				image.mimeType = encoded.mimeType;
+
+				if (!DecodeGltfImage(&image, encoded.bytes.data(), static_cast<int>(encoded.bytes.size()), &imageErrors[imageIndex], static_cast<int>(imageIndex)))
 				{
-					if (err != nullptr)
-					{
-						*err += "[GLTF Loader] Failed to load KTX2 image at index " + std::to_string(image_idx) + "\n";
-					}
-					return false;
+					imageFailed[imageIndex] = 1;
 				}
 			}
-			else if (image->mimeType == "image/webp" || (size >= 12 && std::memcmp(bytes, "RIFF", 4) == 0 && std::memcmp(bytes + 8, "WEBP", 4) == 0))
+			catch (const std::exception& e)
+			{
+				imageErrors[imageIndex] = e.what();
+				imageFailed[imageIndex] = 1;
+			}
+
+			encoded.bytes = {}; // done with it, don't hold the file twice
+		});
+
+		for (size_t i = 0; i < imageFailed.size(); ++i)
+		{
+			if (imageFailed[i])
 			{
-				int width = 0;
-				int height = 0;
+				load.error = "Failed to load GLB file: " + load.path + "\n" + imageErrors[i];
+				return;
+			}
+		}
 
-				if (!WebPGetInfo(bytes, size, &width, &height))
+		// Print model stats
+		std::cout << "[DEBUG] Model loaded successfully:" << std::endl;
+		std::cout << "  - Nodes: " << model.nodes.size() << std::endl;
+		std::cout << "  - Meshes: " << model.meshes.size() << std::endl;
+		std::cout << "  - Materials: " << model.materials.size() << std::endl;
+		std::cout << "  - Textures: " << model.textures.size() << std::endl;
+		std::cout << "  - Images: " << model.images.size() << std::endl;
+		std::cout << "  - Scenes: " << model.scenes.size() << std::endl;
+
+		int sceneIndex = model.defaultScene >= 0 ? model.defaultScene : 0;
+		const tinygltf::Scene& scene = model.scenes[sceneIndex];
+
+		// Traverse the scene nodes to find everything in the glb file
+		for (size_t i = 0; i < scene.nodes.size(); ++i)
+		{
+			CollectNodePrimitives(model, scene.nodes[i], glm::mat4(1.0f), load.primitives);
+		}
+
+		std::vector<std::string> primitiveErrors(load.primitives.size());
+		std::vector<MeshOptimizeStats> optimizeStats(load.primitives.size());
+
+		jobs.ParallelForBackgroundTasks(load.primitives.size(), [&](size_t primitiveIndex, uint32_t /*workerIndex*/)
+		{
+			try
+			{
+				GlbLoad::Primitive& prim = load.primitives[primitiveIndex];
+				ConvertGlbPrimitive(model, model.meshes[prim.meshIndex].primitives[prim.primitiveIndex], prim);
+
+				// Reordering doesn't move the bounds, so the AABB from the conversion still holds
+				if (load.optimizeMeshes)
 				{
-					if (err != nullptr)
-					{
-						*err += "[GLTF Loader] WebPGetInfo failed (corrupt?) at index " + std::to_string(image_idx) + '\n';
-					}
-					return false;
+					optimizeStats[primitiveIndex] = OptimizeMesh(prim.vertices, prim.indices);
 				}
+			}
+			catch (const std::exception& e)
+			{
+				primitiveErrors[primitiveIndex] = e.what();
+			}
+		});
 
-				// Allocate once, decode directly into final buffer
-				std::vector<uint8_t> rgba(width * height * 4);
+		for (const std::string& primitiveError : primitiveErrors)
+		{
+			if (!primitiveError.empty())
+			{
+				load.error = "Failed to load GLB file: " + load.path + "\n" + primitiveError;
+				return;
+			}
+		}
 
-				if (!WebPDecodeRGBAInto(bytes, size, rgba.data(), static_cast<int>(rgba.size()), width * 4))
+		if (load.optimizeMeshes)
+		{
+			// Weighted by triangle count so the totals read as if the model were one mesh
+			size_t verticesBefore = 0, verticesAfter = 0, triangles = 0;
+			double missesBefore = 0.0, missesAfter = 0.0;
+			for (size_t i = 0; i < optimizeStats.size(); ++i)
+			{
+				if (optimizeStats[i].acmrBefore == 0.0f)
 				{
-					if (err != nullptr)
-					{
-						*err += "[GLTF Loader] WebPDecodeRGBAInto failed at index " + std::to_string(image_idx) + '\n';
-					}
-					return false;
+					continue; // left alone by the optimizer
 				}
 
-				// Fill tinygltf::Image with raw pixels
-				image->width = width;
-				image->height = height;
-				image->component = 4;   // RGBA
-				image->bits = 8;   // 8-bit per channel
-				image->pixel_type = TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
-				image->image = std::move(rgba);
-			}
-			else
-			{
-				int width = 0;
-				int height = 0;
-				int channels = 0;
-				stbi_uc* decoded = stbi_load_from_memory(bytes, size, &width, &height, &channels, STBI_rgb_alpha);
-				if (!decoded)
+				const size_t primitiveTriangles = load.primitives[i].indices.size() / 3;
+				verticesBefore += optimizeStats[i].verticesBefore;
+				verticesAfter += optimizeStats[i].verticesAfter;
+				missesBefore += optimizeStats[i].acmrBefore * primitiveTriangles;
+				missesAfter += optimizeStats[i].acmrAfter * primitiveTriangles;
+				triangles += primitiveTriangles;
+			}
+
+			if (triangles > 0)
+			{
+				std::cout << "[DEBUG] Meshes optimized: vertices " << verticesBefore << " -> " << verticesAfter
+					<< ", ACMR " << missesBefore / triangles << " -> " << missesAfter / triangles << std::endl;
+			}
+		}
+	}
+
+	// Fills the load from a current bake, false sends the caller back to the source file
+	static bool LoadBakedGlb(GlbLoad& load)
+	{
+		BakedModelReader reader;
+		if (!reader.Open(load.path))
+		{
+			return false;
+		}
+
+		std::cout << "[DEBUG] Loading baked model: " << GetBakedModelPath(load.path) << std::endl;
+
+		// Images are the bulk of the file, so they inflate in parallel straight into the model
+		const std::span<const BakedImage> bakedImages = reader.GetImages();
+		load.model.images.resize(bakedImages.size());
+		std::vector<uint8_t> imageFailed(bakedImages.size(), 0);
+
+		JobSystem::Get().ParallelForBackgroundTasks(bakedImages.size(), [&](size_t imageIndex, uint32_t /*workerIndex*/)
+		{
+			const BakedImage& baked = bakedImages[imageIndex];
+			tinygltf::Image& image = load.model.images[imageIndex];
+			image.width = static_cast<int>(baked.width);
+			image.height = static_cast<int>(baked.height);
+			image.component = 4;
+			image.bits = 8;
+			image.pixel_type = TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
+
+			try
+			{
+				if (!reader.ReadImage(baked, image.image))
 				{
-					if (err != nullptr)
-					{
-						*err += "[GLTF Loader] stb_image failed: " + std::string(stbi_failure_reason()) + "\n";
-					}
-					return false;
+					imageFailed[imageIndex] = 1;
 				}
+			}
+			catch (const std::exception&)
+			{
+				imageFailed[imageIndex] = 1; // falls back to parsing the source file
+			}
+		});
 
-				image->width = width;
-				image->height = height;
-				image->component = 4;
-				image->bits = 8;
-				image->pixel_type = TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
-				image->image.resize(width * height * 4);
-				std::memcpy(image->image.data(), decoded, image->image.size());
-				stbi_image_free(decoded);
+		for (uint8_t failed : imageFailed)
+		{
+			if (failed)
+			{
+				load.model.images.clear();
+				return false;
 			}
+		}
 
-			collector->images[image_idx] = *image;
-			return true;
-		};
+		// Already in engine layout, each primitive is two memcpys out of the mapping
+		load.primitives.reserve(reader.GetPrimitives().size());
+		for (const BakedPrimitive& baked : reader.GetPrimitives())
+		{
+			GlbLoad::Primitive& prim = load.primitives.emplace_back();
+			prim.nodeIndex = baked.nodeIndex;
+			prim.meshName = std::string(reader.GetName(baked));
+			prim.imageSource = baked.imageIndex;
+
+			const std::span<const Vertex> vertices = reader.GetVertices(baked);
+			const std::span<const uint32_t> indices = reader.GetIndices(baked);
+			prim.vertices.assign(vertices.begin(), vertices.end());
+			prim.indices.assign(indices.begin(), indices.end());
+
+			prim.aabbMin = glm::vec3(baked.aabbMin[0], baked.aabbMin[1], baked.aabbMin[2]);
+			prim.aabbMax = glm::vec3(baked.aabbMax[0], baked.aabbMax[1], baked.aabbMax[2]);
+		}
 
-		loader.SetImageLoader(CustomImageLoader, &imageCollector);
+		std::cout << "[DEBUG] Baked model loaded: " << load.primitives.size() << " primitives, " << load.model.images.size() << " images" << std::endl;
 
-		// Load GLB binary
-		if (!loader.LoadBinaryFromFile(&model, &err, &warn, path))
+		return true;
+	}
+
+	// Writes what ParseGlb produced, a failed bake only costs the next startup the slow path
+	static void BakeGlb(const GlbLoad& load)
+	{
+		std::vector<BakedModelPrimitiveInput> primitives(load.primitives.size());
+		for (size_t i = 0; i < load.primitives.size(); ++i)
 		{
-			std::cerr << "GLTF Error: " << err << std::endl;
-			throw std::runtime_error("Failed to load GLB file: " + path);
+			const GlbLoad::Primitive& prim = load.primitives[i];
+			BakedModelPrimitiveInput& in = primitives[i];
+			in.name = prim.meshName;
+			in.nodeIndex = prim.nodeIndex;
+			in.imageIndex = prim.imageSource;
+			in.vertices = prim.vertices;
+			in.indices = prim.indices;
+			in.aabbMin = prim.aabbMin;
+			in.aabbMax = prim.aabbMax;
 		}
-		if (!warn.empty())
+
+		// Every decoder above hands back RGBA8, anything else was never decoded and is left empty
+		std::vector<BakedModelImageInput> images(load.model.images.size());
+		for (size_t i = 0; i < load.model.images.size(); ++i)
 		{
-			std::cerr << "GLTF Warning: " << warn << std::endl;
+			const tinygltf::Image& image = load.model.images[i];
+			if (image.width > 0 && image.height > 0 && image.image.size() == static_cast<size_t>(image.width) * image.height * 4)
+			{
+				images[i].width = static_cast<uint32_t>(image.width);
+				images[i].height = static_cast<uint32_t>(image.height);
+				images[i].rgba = image.image;
+			}
 		}
 
-		// Inject custom-loaded images into the GLTF model
-		for (std::pair<const int, tinygltf::Image>& entry : imageCollector.images)
+		std::string error;
+		if (WriteBakedModel(load.path, primitives, images, &error))
 		{
-			int index = entry.first;
-			const tinygltf::Image& img = entry.second;
-			if (index >= model.images.size())
+			std::cout << "[DEBUG] Baked model written: " << GetBakedModelPath(load.path) << std::endl;
+		}
+		else
+		{
+			std::cerr << "[WARN] " << error << std::endl;
+		}
+	}
+
+	// Runs on a worker: takes the bake when it is current, otherwise parses the GLB and bakes it for the next run
+	static void RunGlbLoad(GlbLoad& load)
+	{
+		if constexpr (BakedModelConfig::Enabled)
+		{
+			if (load.allowBake && LoadBakedGlb(load))
 			{
-				model.images.resize(index + 1);
+				load.fromBake = true;
+				return;
 			}
-			model.images[index] = img;
 		}
 
-		// Print model stats
-		std::cout << "[DEBUG] Model loaded successfully:" << std::endl;
-		std::cout << "  - Nodes: " << model.nodes.size() << std::endl;
-		std::cout << "  - Meshes: " << model.meshes.size() << std::endl;
-		std::cout << "  - Materials: " << model.materials.size() << std::endl;
-		std::cout << "  - Textures: " << model.textures.size() << std::endl;
-		std::cout << "  - Images: " << model.images.size() << std::endl;
-		std::cout << "  - Scenes: " << model.scenes.size() << std::endl;
+		ParseGlb(load);
 
-		// Recursive scene walker
-		if (model.scenes.empty())
+		if constexpr (BakedModelConfig::Enabled)
 		{
-			throw std::runtime_error("GLTF file contains no scenes.");
+			if (load.allowBake && load.error.empty())
+			{
+				BakeGlb(load);
+			}
 		}
+	}
 
-		int sceneIndex = model.defaultScene >= 0 ? model.defaultScene : 0;
-		const tinygltf::Scene& scene = model.scenes[sceneIndex];
+	GlbLoadHandle MaterialPool::LoadCompositeMaterialFromGLBAsync(const std::string& path, bool allowBake)
+	{
+		GlbLoadHandle load = std::make_shared<GlbLoad>();
+		load->path = path;
+
+		// Bakes store their meshes optimized, so a load that has to keep the source vertex order skips them
+		load->optimizeMeshes = MeshPool::GetInstance().GetOptimizeOnRegister();
+		load->allowBake = allowBake && load->optimizeMeshes;
+
+		// The job only touches the load, nothing in the pools changes until FinishCompositeMaterialLoad.
+		// It holds its own reference so dropping the handle early doesn't pull the load out from under it.
+		// On the background lane, a frame waiting on its render jobs would otherwise pick the whole parse up from the main thread's deque.
+		// The decode and convert loops inside fan out on that lane too (ParallelForBackgroundTasks), so no piece of the load lands on the main thread.
+		load->job = JobSystem::Get().SpawnBackground([load](uint32_t /*workerIndex*/)
+		{
+			try
+			{
+				RunGlbLoad(*load);
+			}
+			catch (const std::exception& e)
+			{
+				load->error = e.what();
+			}
+		});
 
-		// Traverse the scene nodes to load everything in the glb file
-		for (size_t i = 0; i < scene.nodes.size(); ++i)
+		return load;
+	}
+
+	bool MaterialPool::IsCompositeMaterialLoadReady(const GlbLoadHandle& load)
+	{
+		return load && (!load->job || load->job->IsDone());
+	}
+
+	void MaterialPool::WaitForCompositeMaterialLoad(const GlbLoadHandle& load)
+	{
+		if (load)
+		{
+			JobSystem::Get().Wait(load->job);
+		}
+	}
+
+	GlbLoadStats MaterialPool::GetCompositeMaterialLoadStats(const GlbLoadHandle& load)
+	{
+		GlbLoadStats stats;
+		if (!IsCompositeMaterialLoadReady(load))
+		{
+			return stats;
+		}
+
+		stats.failed = !load->error.empty();
+		stats.fromBake = load->fromBake;
+		stats.primitiveCount = load->primitives.size();
+
+		for (const GlbLoad::Primitive& prim : load->primitives)
+		{
+			stats.dracoPrimitiveCount += prim.draco ? 1 : 0;
+			stats.vertexCount += prim.vertices.size();
+			stats.indexCount += prim.indices.size();
+		}
+		stats.geometryBytes = stats.vertexCount * sizeof(Vertex) + stats.indexCount * sizeof(uint32_t);
+
+		for (const tinygltf::Image& image : load->model.images)
+		{
+			stats.imageBytes += image.image.size();
+		}
+
+		return stats;
+	}
+
+	std::vector<std::shared_ptr<MaterialData>> MaterialPool::FinishCompositeMaterialLoad(const GlbLoadHandle& load)
+	{
+		SWIM_PROFILE_FUNCTION();
+
+		if (load->committed)
 		{
-			const int rootNodeIndex = scene.nodes[i];
-			LoadNodeRecursive(model, rootNodeIndex, glm::mat4(1.0f), path, loadedMaterials);
+			return load->materials;
+		}
+
+		WaitForCompositeMaterialLoad(load);
+		load->job.reset();
+
+		if (!load->error.empty())
+		{
+			std::cerr << "GLTF Error: " << load->error << std::endl;
+			throw std::runtime_error(load->error);
+		}
+
+		const std::string& path = load->path;
+		TexturePool& texturePool = TexturePool::GetInstance();
+		MeshPool& meshPool = MeshPool::GetInstance();
+
+		// Textures and meshes talk to the GPU and the pools, so this part stays on the main thread and only registers what the workers built
+		std::vector<std::shared_ptr<MaterialData>>& loadedMaterials = load->materials;
+		loadedMaterials.clear(); // a call that threw half way may be retried
+		loadedMaterials.reserve(load->primitives.size());
+
+		for (GlbLoad::Primitive& prim : load->primitives)
+		{
+			std::shared_ptr<Texture2D> texture = nullptr;
+			if (prim.imageSource >= 0)
+			{
+				const tinygltf::Image& img = load->model.images[prim.imageSource];
+				texture = texturePool.GetOrCreateTextureFromTinyGltfImage(img, path + "_" + std::to_string(prim.nodeIndex));
+			}
+
+			std::shared_ptr<Mesh> mesh = meshPool.RegisterMesh(prim.meshName, prim.vertices, prim.indices, prim.aabbMin, prim.aabbMax, /*optimized:*/ true);
+
+			std::string matName = prim.meshName + "_material";
+			std::shared_ptr<MaterialData> matData = RegisterMaterialData(matName, mesh, texture);
+			loadedMaterials.push_back(matData);
 		}
 
+		// The pools made their own copies, the decoded images and vertex arrays can go
+		load->model = tinygltf::Model{};
+		load->encodedImages.clear();
+		load->primitives.clear();
+
 		std::cout << "[DEBUG] Total materials loaded: " << loadedMaterials.size() << std::endl;
 
-		compositeMaterials.emplace(path, loadedMaterials);
+		{
+			std::lock_guard<std::mutex> lock(poolMutex);
+			compositeMaterials.emplace(path, loadedMaterials);
+		}
+
+		load->committed = true;
 
 		// Signal the editor to add this string to its list of material assets to keep track of
 		if constexpr (SwimEngine::DefaultEngineState == EngineState::Editing)
@@ -663,12 +1331,25 @@ namespace Engine
 		return loadedMaterials;
 	}
 
+	std::vector<std::shared_ptr<MaterialData>> MaterialPool::LoadAndRegisterCompositeMaterialFromGLB(const std::string& path)
+	{
+		return FinishCompositeMaterialLoad(LoadCompositeMaterialFromGLBAsync(path));
+	}
+
 	void MaterialPool::Flush()
 	{
 		std::lock_guard<std::mutex> lock(poolMutex);
 		materials.clear();
 		compositeMaterials.clear();
 
+		// Slots get handed out again from 0, old handles stop resolving once their generation moves on
+		for (uint32_t i = 0; i < nextMaterialSlot; ++i)
+		{
+			materialSlotInfos[i] = MaterialRenderInfo{};
+			++materialSlotGenerations[i];
+		}
+		nextMaterialSlot = 0;
+
 		if constexpr (SwimEngine::DefaultEngineState == EngineState::Editing)
 		{
 			// Signal the meaterials are cleared
@@ -9,6 +9,30 @@
 namespace Engine
 {
 
+  // A GLB load running on the job system, only FinishCompositeMaterialLoad reads what it made
+  struct GlbLoad;
+  using GlbLoadHandle = std::shared_ptr<GlbLoad>;
+
+  // What a finished GLB load decoded, before any of it was registered
+  struct GlbLoadStats
+  {
+    size_t primitiveCount = 0;
+    size_t dracoPrimitiveCount = 0;
+    size_t vertexCount = 0;
+    size_t indexCount = 0;
+    size_t geometryBytes = 0; // vertices and indices in engine layout
+    size_t imageBytes = 0;    // decoded RGBA8
+    bool fromBake = false;
+    bool failed = false;
+  };
+
+  // What the render gather needs from a material, kept in plain arrays by the pool. The texture pointer doesn't own, the pool's MaterialData does.
+  struct MaterialRenderInfo
+  {
+    MeshHandle mesh;
+    const Texture2D* albedoMap = nullptr;
+  };
+
   class MaterialPool
   {
 
@@ -32,9 +56,34 @@ namespace Engine
 
     // Load a GLB file from disk, this will be used for making a composite material (vector of materials)
     std::vector<std::shared_ptr<MaterialData>> LoadAndRegisterCompositeMaterialFromGLB(const std::string& path);
+
+    // Parses the GLB, decodes its images and converts its primitives on the job system's background lane, nothing is registered yet.
+    // Poll IsCompositeMaterialLoadReady and hand the load to FinishCompositeMaterialLoad on the main thread, that one creates the textures and meshes and throws if the load failed.
+    // allowBake false always parses the GLB and writes no bake, for measuring the source path.
+    GlbLoadHandle LoadCompositeMaterialFromGLBAsync(const std::string& path, bool allowBake = true);
+    static bool IsCompositeMaterialLoadReady(const GlbLoadHandle& load);
+    static void WaitForCompositeMaterialLoad(const GlbLoadHandle& load);
+
+    // Only meaningful once the load is ready and before FinishCompositeMaterialLoad frees what it decoded
+    static GlbLoadStats GetCompositeMaterialLoadStats(const GlbLoadHandle& load);
+
+    std::vector<std::shared_ptr<MaterialData>> FinishCompositeMaterialLoad(const GlbLoadHandle& load);
+
     std::vector<std::shared_ptr<MaterialData>> GetCompositeMaterialData(const std::string& name);
     std::vector<std::shared_ptr<MaterialData>> LazyLoadAndGetCompositeMaterial(const std::string& path);
     bool CompositeMaterialExists(const std::string& name);
+
+    // Resolves a handle without locking or touching any refcount, null if the material was flushed.
+    // Materials are registered from the main thread, so this is safe from the main thread and the render jobs it waits on.
+    const MaterialRenderInfo* TryGetRenderInfo(MaterialHandle handle) const
+    {
+      if (handle.index >= nextMaterialSlot || materialSlotGenerations[handle.index] != handle.generation)
+      {
+        return nullptr;
+      }
+
+      return &materialSlotInfos[handle.index];
+    }
     
 
     // Frees all 
@@ -44,19 +93,17 @@ namespace Engine
 
     MaterialPool() = default;
 
-    void LoadNodeRecursive
-    (
-      const tinygltf::Model& model,
-      int nodeIndex,
-      const glm::mat4& parentTransform,
-      const std::string& path,
-      std::vector<std::shared_ptr<MaterialData>>& loadedMaterials
-    );
+    MaterialHandle AssignMaterialSlot(const MaterialData& data);
 
     mutable std::mutex poolMutex;
     std::unordered_map<std::string, std::shared_ptr<MaterialData>> materials;
     std::unordered_map<std::string, std::vector<std::shared_ptr<MaterialData>>> compositeMaterials;
 
+    // Dense per registered material, slots are handed out in order and only reused after a Flush bumps their generation
+    std::vector<MaterialRenderInfo> materialSlotInfos;
+    std::vector<uint32_t> materialSlotGenerations;
+    uint32_t nextMaterialSlot = 0;
+
   };
 
 }
@@ -0,0 +1,150 @@
+#include "PCH.h"
+#include "DrawPacketBuilder.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Engine
+{
+
+	void DrawPacketBuilder::Clear()
+	{
+		sortKeys.clear();
+		instanceModels.clear();
+		instanceTextureIndices.clear();
+		instanceSpaces.clear();
+
+		sortedKeys.clear();
+		sortedSources.clear();
+		commandCount = 0;
+	}
+
+	void DrawPacketBuilder::Reserve(size_t instanceCount)
+	{
+		sortKeys.reserve(instanceCount);
+		instanceModels.reserve(instanceCount);
+		instanceTextureIndices.reserve(instanceCount);
+		instanceSpaces.reserve(instanceCount);
+	}
+
+	uint32_t DrawPacketBuilder::Add(const DrawPacketMesh& mesh, const glm::mat4& model, uint32_t textureIndex, uint32_t space)
+	{
+		const uint32_t source = Add(mesh, textureIndex, space);
+		if (source == InvalidSource)
+		{
+			return InvalidSource;
+		}
+
+		instanceModels.push_back(model);
+		instanceTextureIndices.push_back(textureIndex);
+		instanceSpaces.push_back(space);
+
+		return source;
+	}
+
+	uint32_t DrawPacketBuilder::Add(const DrawPacketMesh& mesh, uint32_t material, uint32_t space, uint32_t pipeline, uint32_t renderOnTop)
+	{
+		if (mesh.meshID > DrawSortKey::MaxMeshID)
+		{
+			return InvalidSource;
+		}
+
+		if (mesh.meshID >= meshes.size())
+		{
+			meshes.resize(std::max<size_t>(static_cast<size_t>(mesh.meshID) + 1, meshes.size() * 2));
+		}
+
+		// Meshes don't move inside the mega buffers, so whichever instance wrote this last wrote the same thing
+		meshes[mesh.meshID] = mesh;
+
+		const uint32_t source = static_cast<uint32_t>(sortKeys.size());
+		sortKeys.push_back(DrawSortKey::Make(space, pipeline, renderOnTop, mesh.meshID, material));
+
+		return source;
+	}
+
+	void DrawPacketBuilder::Sort()
+	{
+		const size_t instanceCount = sortKeys.size();
+
+		sortedKeys.assign(sortKeys.begin(), sortKeys.end());
+		sortedSources.resize(instanceCount);
+		for (uint32_t source = 0; source < static_cast<uint32_t>(instanceCount); ++source)
+		{
+			sortedSources[source] = source;
+		}
+
+		RadixSortPairs(sortedKeys, sortedSources, radixScratch);
+
+		// Counted up front so the caller can size its command array before Build writes into it
+		commandCount = 0;
+		for (size_t i = 0; i < instanceCount; ++i)
+		{
+			if (i == 0 || DrawSortKey::GetCommandBits(sortedKeys[i]) != DrawSortKey::GetCommandBits(sortedKeys[i - 1]))
+			{
+				++commandCount;
+			}
+		}
+	}
+
+	void DrawPacketBuilder::Build(const DrawPacketOutput& output, bool fillInstances) const
+	{
+		const size_t instanceCount = sortedKeys.size();
+
+		if (output.sourceIndices && instanceCount > 0)
+		{
+			std::memcpy(output.sourceIndices, sortedSources.data(), instanceCount * sizeof(uint32_t));
+		}
+
+		// One pass over the sorted keys, a new command starts wherever the part above the material changes
+		if (output.commands)
+		{
+			DrawIndexedCommand* cmd = nullptr;
+			for (size_t i = 0; i < instanceCount; ++i)
+			{
+				if (i == 0 || DrawSortKey::GetCommandBits(sortedKeys[i]) != DrawSortKey::GetCommandBits(sortedKeys[i - 1]))
+				{
+					const DrawPacketMesh& mesh = meshes[DrawSortKey::GetMeshID(sortedKeys[i])];
+
+					cmd = (cmd == nullptr) ? output.commands : cmd + 1;
+					cmd->indexCount = mesh.indexCount;
+					cmd->instanceCount = 0;
+					cmd->firstIndex = mesh.firstIndex;
+					cmd->vertexOffset = mesh.vertexOffset;
+					cmd->firstInstance = static_cast<uint32_t>(i);
+				}
+
+				++cmd->instanceCount;
+			}
+		}
+
+		if (fillInstances)
+		{
+			WriteInstances(output, 0, instanceCount);
+		}
+	}
+
+	void DrawPacketBuilder::WriteInstances(const DrawPacketOutput& output, size_t begin, size_t end) const
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			const uint32_t source = sortedSources[i];
+
+			if (output.models)
+			{
+				output.models[i] = instanceModels[source];
+			}
+
+			if (output.textureIndices)
+			{
+				output.textureIndices[i] = instanceTextureIndices[source];
+			}
+
+			if (output.spaces)
+			{
+				output.spaces[i] = instanceSpaces[source];
+			}
+		}
+	}
+
+}
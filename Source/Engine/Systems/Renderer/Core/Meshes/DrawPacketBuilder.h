@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Library/glm/glm.hpp"
+#include "Engine/Utility/RadixSort.h"
+
+namespace Engine
+{
+
+	// Same layout as VkDrawIndexedIndirectCommand and GL's DrawElementsIndirectCommand, so either backend can copy it straight into an indirect buffer
+	struct DrawIndexedCommand
+	{
+		uint32_t indexCount = 0;
+		uint32_t instanceCount = 0;
+		uint32_t firstIndex = 0;
+		int32_t vertexOffset = 0;
+		uint32_t firstInstance = 0;
+	};
+
+	// Where a mesh sits in the mega buffers, counted in indices and vertices rather than bytes
+	struct DrawPacketMesh
+	{
+		uint32_t meshID = 0;
+		uint32_t indexCount = 0;
+		uint32_t firstIndex = 0;
+		int32_t vertexOffset = 0;
+	};
+
+	// Everything that decides the draw order packed into one integer, most significant first:
+	// space (2 bits) | pipeline (4) | renderOnTop (2) | mesh ID (24) | material (32).
+	// The upper half picks the command an instance lands in, the material only orders instances inside a command so equal textures end up next to each other.
+	struct DrawSortKey
+	{
+		static constexpr uint32_t MaxMeshID = (1u << 24) - 1;
+
+		static uint64_t Make(uint32_t space, uint32_t pipeline, uint32_t renderOnTop, uint32_t meshID, uint32_t material)
+		{
+			return (static_cast<uint64_t>(space & 0x3u) << 62)
+				| (static_cast<uint64_t>(pipeline & 0xFu) << 58)
+				| (static_cast<uint64_t>(renderOnTop > 3u ? 3u : renderOnTop) << 56)
+				| (static_cast<uint64_t>(meshID & MaxMeshID) << 32)
+				| static_cast<uint64_t>(material);
+		}
+
+		static uint32_t GetMeshID(uint64_t key) { return static_cast<uint32_t>(key >> 32) & MaxMeshID; }
+		static uint32_t GetCommandBits(uint64_t key) { return static_cast<uint32_t>(key >> 32); }
+	};
+
+	// Caller owned memory the packet gets written into, see DrawPacketBuilder::Build for the sizes.
+	// Any of the arrays can be left null when the caller has no use for it.
+	struct DrawPacketOutput
+	{
+		DrawIndexedCommand* commands = nullptr;
+		uint32_t* sourceIndices = nullptr; // the Add call each instance came from
+		glm::mat4* models = nullptr;
+		uint32_t* textureIndices = nullptr;
+		uint32_t* spaces = nullptr;
+	};
+
+	// Turns a flat list of mesh instances into indexed draw commands plus the instance order those commands index into.
+	// Every instance gets a DrawSortKey, the keys get radix sorted and one pass over them cuts the commands wherever the upper half of the key changes.
+	// Instances with equal keys keep the order they were added in, so the same input always gives the same packet.
+	// It knows nothing about the graphics API or the registry, both renderers feed it and it runs fine in a headless test.
+	class DrawPacketBuilder
+	{
+
+	public:
+
+		static constexpr uint32_t NoTexture = UINT32_MAX;
+		static constexpr uint32_t InvalidSource = UINT32_MAX;
+
+		// Drops the instances, keeps the memory
+		void Clear();
+
+		void Reserve(size_t instanceCount);
+
+		// Returns the source index of the new instance, or InvalidSource if the mesh was never given an ID by the MeshPool.
+		// Sorted by space, then mesh, then texture.
+		uint32_t Add(const DrawPacketMesh& mesh, const glm::mat4& model, uint32_t textureIndex, uint32_t space);
+
+		// Groups the instance without storing any instance data, for callers that keep it elsewhere and only need the order.
+		// Don't mix it with the other Add in one packet, WriteInstances expects every instance to have data.
+		uint32_t Add(const DrawPacketMesh& mesh, uint32_t material, uint32_t space = 0, uint32_t pipeline = 0, uint32_t renderOnTop = 0);
+
+		size_t GetInstanceCount() const { return sortKeys.size(); }
+		bool IsEmpty() const { return sortKeys.empty(); }
+
+		// Sorts the instances and counts the commands they cut into, everything below is only valid after it and until the next Add or Clear
+		void Sort();
+
+		size_t GetCommandCount() const { return commandCount; }
+
+		// Writes GetCommandCount commands and GetInstanceCount source indices.
+		// The instance arrays are only filled here when fillInstances is set, callers that split the work across threads use WriteInstances instead.
+		void Build(const DrawPacketOutput& output, bool fillInstances = true) const;
+
+		// Fills the instance arrays of output for packet instances [begin, end), safe to split across threads
+		void WriteInstances(const DrawPacketOutput& output, size_t begin, size_t end) const;
+
+		// Per source index, in Add order
+		const std::vector<glm::mat4>& GetModels() const { return instanceModels; }
+		const std::vector<uint32_t>& GetTextureIndices() const { return instanceTextureIndices; }
+		const std::vector<uint32_t>& GetSpaces() const { return instanceSpaces; }
+
+	private:
+
+		// Added instances, SoA in Add order
+		std::vector<uint64_t> sortKeys;
+		std::vector<glm::mat4> instanceModels;
+		std::vector<uint32_t> instanceTextureIndices;
+		std::vector<uint32_t> instanceSpaces;
+
+		// Indexed by mesh ID, the MeshPool hands those out from a counter so this stays small
+		std::vector<DrawPacketMesh> meshes;
+
+		// Sort output, the keys get sorted into sortedKeys so sortKeys stays in Add order
+		std::vector<uint64_t> sortedKeys;
+		std::vector<uint32_t> sortedSources;
+		size_t commandCount = 0;
+		RadixSortScratch radixScratch;
+
+	};
+
+}
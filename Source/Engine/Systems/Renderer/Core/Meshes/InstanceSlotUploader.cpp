@@ -0,0 +1,131 @@
+#include "PCH.h"
+#include "InstanceSlotUploader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace Engine
+{
+
+	InstanceSlotUploader::InstanceSlotUploader(uint32_t framesInFlight, size_t slotStride)
+		: framesInFlight(framesInFlight), slotStride(slotStride)
+	{
+		if (framesInFlight == 0 || framesInFlight > MaxFramesInFlight)
+		{
+			throw std::runtime_error("InstanceSlotUploader supports 1 to 8 frames in flight");
+		}
+
+		allFramesMask = static_cast<uint8_t>((1u << framesInFlight) - 1u);
+		pendingSlots.resize(framesInFlight);
+	}
+
+	void InstanceSlotUploader::Resize(size_t slotCount)
+	{
+		const size_t oldCount = pendingMasks.size();
+		if (slotCount == oldCount)
+		{
+			return;
+		}
+
+		if (slotCount < oldCount)
+		{
+			// Drop the pending entries past the end too, otherwise growing back before a Flush would queue those slots a second time
+			for (std::vector<uint32_t>& pending : pendingSlots)
+			{
+				pending.erase(std::remove_if(pending.begin(), pending.end(), [slotCount](uint32_t slot) { return slot >= slotCount; }), pending.end());
+			}
+
+			pendingMasks.resize(slotCount);
+			return;
+		}
+
+		pendingMasks.resize(slotCount, 0);
+		for (size_t slot = oldCount; slot < slotCount; ++slot)
+		{
+			MarkDirty(static_cast<uint32_t>(slot));
+		}
+	}
+
+	void InstanceSlotUploader::MarkDirty(uint32_t slot)
+	{
+		uint8_t& mask = pendingMasks[slot];
+		const uint8_t missing = static_cast<uint8_t>(allFramesMask & ~mask);
+		if (missing == 0)
+		{
+			return;
+		}
+
+		mask |= missing;
+		for (uint32_t frame = 0; frame < framesInFlight; ++frame)
+		{
+			if (missing & (1u << frame))
+			{
+				pendingSlots[frame].push_back(slot);
+			}
+		}
+	}
+
+	void InstanceSlotUploader::MarkAllDirty()
+	{
+		const uint32_t slotCount = static_cast<uint32_t>(pendingMasks.size());
+		for (uint32_t frame = 0; frame < framesInFlight; ++frame)
+		{
+			std::vector<uint32_t>& pending = pendingSlots[frame];
+			pending.resize(slotCount);
+			for (uint32_t slot = 0; slot < slotCount; ++slot)
+			{
+				pending[slot] = slot;
+			}
+		}
+
+		std::fill(pendingMasks.begin(), pendingMasks.end(), allFramesMask);
+	}
+
+	void InstanceSlotUploader::Flush(uint32_t frameIndex, const void* source, void* destination)
+	{
+		stats = Stats{};
+
+		std::vector<uint32_t>& pending = pendingSlots[frameIndex];
+		if (pending.empty())
+		{
+			return;
+		}
+
+		// Sorted slots collapse into runs, one copy per run instead of one per slot
+		std::sort(pending.begin(), pending.end());
+
+		const uint8_t frameBit = static_cast<uint8_t>(1u << frameIndex);
+		const uint8_t* src = static_cast<const uint8_t*>(source);
+		uint8_t* dst = static_cast<uint8_t*>(destination);
+
+		size_t i = 0;
+		while (i < pending.size())
+		{
+			const uint32_t runBegin = pending[i];
+			uint32_t runEnd = runBegin + 1;
+			pendingMasks[runBegin] &= ~frameBit;
+			++i;
+
+			while (i < pending.size() && pending[i] == runEnd)
+			{
+				pendingMasks[runEnd] &= ~frameBit;
+				++runEnd;
+				++i;
+			}
+
+			const size_t bytes = static_cast<size_t>(runEnd - runBegin) * slotStride;
+			if (dst)
+			{
+				std::memcpy(dst + runBegin * slotStride, src + runBegin * slotStride, bytes);
+			}
+
+			stats.slotsWritten += runEnd - runBegin;
+			stats.copies += 1;
+			stats.slotBytes += bytes;
+		}
+
+		pending.clear();
+	}
+
+}
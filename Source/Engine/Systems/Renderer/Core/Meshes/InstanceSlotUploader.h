@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Engine
+{
+
+	// Keeps instance data that lives at a fixed slot per renderable in sync across the frames in flight, writing only the slots that changed.
+	// Every frame in flight has its own copy of the slots on the GPU, so a slot marked dirty stays pending for each frame until that frame flushes it.
+	// Flushing into a null destination only counts the traffic, which lets the upload cost be measured without a device.
+	class InstanceSlotUploader
+	{
+
+	public:
+
+		static constexpr uint32_t MaxFramesInFlight = 8;
+
+		// Traffic of the last Flush plus whatever was reported through AddPacketBytes after it
+		struct Stats
+		{
+			uint32_t slotsWritten = 0;
+			uint32_t copies = 0;      // neighbouring slots get merged into one copy
+			uint64_t slotBytes = 0;
+			uint64_t packetBytes = 0; // draw commands and visible slot lists
+
+			uint64_t GetTotalBytes() const { return slotBytes + packetBytes; }
+		};
+
+		InstanceSlotUploader(uint32_t framesInFlight, size_t slotStride);
+
+		// New slots start out pending for every frame
+		void Resize(size_t slotCount);
+
+		void MarkDirty(uint32_t slot);
+
+		// For when the GPU copies were lost, every frame rewrites every slot
+		void MarkAllDirty();
+
+		// Copies the slots frameIndex has not seen yet from source to destination, both laid out slotStride apart, and resets the stats.
+		// Destination may be null to only count.
+		void Flush(uint32_t frameIndex, const void* source, void* destination);
+
+		void AddPacketBytes(uint64_t bytes) { stats.packetBytes += bytes; }
+
+		size_t GetSlotCount() const { return pendingMasks.size(); }
+		size_t GetPendingCount(uint32_t frameIndex) const { return pendingSlots[frameIndex].size(); }
+		const Stats& GetStats() const { return stats; }
+
+	private:
+
+		uint32_t framesInFlight = 0;
+		size_t slotStride = 0;
+		uint8_t allFramesMask = 0;
+
+		std::vector<uint8_t> pendingMasks;               // per slot, a bit for every frame that still has to write it
+		std::vector<std::vector<uint32_t>> pendingSlots; // per frame, holds each slot at most once
+
+		Stats stats;
+
+	};
+
+}
@@ -2,6 +2,7 @@
 
 #include "Vertex.h"
 #include "MeshBufferData.h"
+#include "MeshHandle.h"
 
 namespace Engine
 {
@@ -13,6 +14,8 @@ namespace Engine
 
     std::shared_ptr<MeshBufferData> meshBufferData;
 
+    MeshHandle handle; // assigned by the MeshPool on registration
+
     Mesh() = default;
 
     Mesh(std::vector<Vertex> v, std::vector<uint32_t> i)
@@ -38,4 +38,18 @@ namespace Engine
 		aabbMax.w = 1.0f;
 	}
 
+	void MeshBufferData::GenerateBuffers(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+	{
+		indexCount = static_cast<uint32_t>(indices.size());
+
+		SwimEngine::GetInstance()->GetRenderer().UploadMeshToMegaBuffer(
+			vertices,
+			indices,
+			*this
+		);
+
+		aabbMin = glm::vec4(boundsMin, 1.0f);
+		aabbMax = glm::vec4(boundsMax, 1.0f);
+	}
+
 }
@@ -33,6 +33,9 @@ namespace Engine
 
 		void GenerateBuffersAndAABB(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
 
+		// For callers that already know the bounds, such as baked models, skips the pass over the vertices
+		void GenerateBuffers(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+
 	};
 
 }
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Engine
+{
+
+	// Stable reference to a mesh registered in the MeshPool: the slot index is the mesh ID and the generation goes up whenever the pool is flushed,
+	// so a handle kept across a flush just stops resolving instead of pointing at whatever got registered into the slot next.
+	// Trivially copyable, the render gather passes these around instead of shared_ptrs.
+	struct MeshHandle
+	{
+
+		static constexpr uint32_t InvalidIndex = UINT32_MAX;
+
+		uint32_t index = InvalidIndex;
+		uint32_t generation = 0;
+
+		bool IsValid() const { return index != InvalidIndex; }
+
+		bool operator==(const MeshHandle& other) const { return index == other.index && generation == other.generation; }
+		bool operator!=(const MeshHandle& other) const { return !(*this == other); }
+
+	};
+
+}
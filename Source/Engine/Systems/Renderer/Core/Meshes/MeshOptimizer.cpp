@@ -0,0 +1,353 @@
+#include "PCH.h"
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Engine
+{
+
+	namespace
+	{
+
+		// Forsyth's tuning, see "Linear-Speed Vertex Cache Optimisation"
+		constexpr float CacheDecayPower = 1.5f;
+		constexpr float LastTriangleScore = 0.75f;
+		constexpr float ValenceBoostScale = 2.0f;
+		constexpr float ValenceBoostPower = 0.5f;
+		constexpr uint32_t MaxCacheSize = 64;
+		constexpr uint32_t ValenceScoreTableSize = 64;
+		constexpr uint32_t NoTriangle = UINT32_MAX;
+
+		uint32_t HashVertex(const Vertex& vertex)
+		{
+			uint32_t words[sizeof(Vertex) / sizeof(uint32_t)];
+			std::memcpy(words, &vertex, sizeof(Vertex));
+
+			uint32_t hash = 2166136261u;
+			for (uint32_t word : words)
+			{
+				hash = (hash ^ word) * 16777619u;
+				hash ^= hash >> 15;
+			}
+			return hash;
+		}
+
+	}
+
+	float ComputeMeshACMR(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize)
+	{
+		const size_t triangleCount = indices.size() / 3;
+		if (triangleCount == 0)
+		{
+			return 0.0f;
+		}
+
+		// FIFO: a vertex is still cached while fewer than cacheSize misses happened since it went in
+		std::vector<uint32_t> insertedAt(vertexCount, 0);
+		std::vector<uint8_t> seen(vertexCount, 0);
+		uint32_t misses = 0;
+
+		for (uint32_t index : indices)
+		{
+			if (!seen[index] || misses - insertedAt[index] >= cacheSize)
+			{
+				seen[index] = 1;
+				insertedAt[index] = misses;
+				++misses;
+			}
+		}
+
+		return static_cast<float>(misses) / static_cast<float>(triangleCount);
+	}
+
+	void WeldMeshVertices(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+	{
+		const size_t vertexCount = vertices.size();
+		if (vertexCount < 2)
+		{
+			return;
+		}
+
+		// Open addressing at most half full, slots hold indices into the welded vertex array
+		size_t tableSize = 1;
+		while (tableSize < vertexCount * 2)
+		{
+			tableSize <<= 1;
+		}
+
+		std::vector<uint32_t> table(tableSize, UINT32_MAX);
+		std::vector<uint32_t> remap(vertexCount);
+		uint32_t weldedCount = 0;
+
+		for (size_t i = 0; i < vertexCount; ++i)
+		{
+			const Vertex& vertex = vertices[i];
+			size_t slot = HashVertex(vertex) & (tableSize - 1);
+
+			while (true)
+			{
+				const uint32_t existing = table[slot];
+				if (existing == UINT32_MAX)
+				{
+					// Survivors move to the front in first occurrence order, the write never passes the read
+					vertices[weldedCount] = vertex;
+					table[slot] = weldedCount;
+					remap[i] = weldedCount++;
+					break;
+				}
+
+				if (std::memcmp(&vertices[existing], &vertex, sizeof(Vertex)) == 0)
+				{
+					remap[i] = existing;
+					break;
+				}
+
+				slot = (slot + 1) & (tableSize - 1);
+			}
+		}
+
+		if (weldedCount == vertexCount)
+		{
+			return;
+		}
+
+		vertices.resize(weldedCount);
+		for (uint32_t& index : indices)
+		{
+			index = remap[index];
+		}
+	}
+
+	void OptimizeMeshVertexCache(std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize)
+	{
+		const size_t triangleCount = indices.size() / 3;
+		if (triangleCount < 2 || vertexCount == 0)
+		{
+			return;
+		}
+
+		cacheSize = std::clamp<uint32_t>(cacheSize, 4, MaxCacheSize);
+
+		float cacheScores[MaxCacheSize];
+		for (uint32_t position = 0; position < cacheSize; ++position)
+		{
+			cacheScores[position] = position < 3
+				? LastTriangleScore
+				: std::pow(1.0f - static_cast<float>(position - 3) / static_cast<float>(cacheSize - 3), CacheDecayPower);
+		}
+
+		float valenceScores[ValenceScoreTableSize];
+		valenceScores[0] = 0.0f;
+		for (uint32_t valence = 1; valence < ValenceScoreTableSize; ++valence)
+		{
+			valenceScores[valence] = ValenceBoostScale * std::pow(static_cast<float>(valence), -ValenceBoostPower);
+		}
+
+		// Live triangles per vertex as CSR, an emitted triangle gets swapped past the end of its vertices' live ranges
+		std::vector<uint32_t> liveCount(vertexCount, 0);
+		for (uint32_t index : indices)
+		{
+			++liveCount[index];
+		}
+
+		std::vector<uint32_t> adjacencyStart(vertexCount + 1, 0);
+		for (size_t v = 0; v < vertexCount; ++v)
+		{
+			adjacencyStart[v + 1] = adjacencyStart[v] + liveCount[v];
+		}
+
+		std::vector<uint32_t> adjacency(indices.size());
+		{
+			std::vector<uint32_t> cursor(adjacencyStart.begin(), adjacencyStart.end() - 1);
+			for (uint32_t triangle = 0; triangle < triangleCount; ++triangle)
+			{
+				for (int corner = 0; corner < 3; ++corner)
+				{
+					adjacency[cursor[indices[triangle * 3 + corner]]++] = triangle;
+				}
+			}
+		}
+
+		std::vector<int32_t> cachePosition(vertexCount, -1);
+		std::vector<float> vertexScores(vertexCount);
+		const auto scoreVertex = [&](uint32_t v) -> float
+		{
+			const uint32_t live = liveCount[v];
+			if (live == 0)
+			{
+				return -1.0f;
+			}
+
+			const int32_t position = cachePosition[v];
+			return (position >= 0 ? cacheScores[position] : 0.0f) + valenceScores[std::min(live, ValenceScoreTableSize - 1)];
+		};
+
+		for (uint32_t v = 0; v < vertexCount; ++v)
+		{
+			vertexScores[v] = scoreVertex(v);
+		}
+
+		std::vector<float> triangleScores(triangleCount);
+		std::vector<uint8_t> emitted(triangleCount, 0);
+		uint32_t bestTriangle = 0;
+		for (uint32_t triangle = 0; triangle < triangleCount; ++triangle)
+		{
+			const uint32_t* tri = &indices[triangle * 3];
+			triangleScores[triangle] = vertexScores[tri[0]] + vertexScores[tri[1]] + vertexScores[tri[2]];
+			if (triangleScores[triangle] > triangleScores[bestTriangle])
+			{
+				bestTriangle = triangle;
+			}
+		}
+
+		std::vector<uint32_t> output;
+		output.reserve(indices.size());
+
+		uint32_t cache[MaxCacheSize + 3];
+		uint32_t nextCache[MaxCacheSize + 3];
+		uint32_t cacheCount = 0;
+		uint32_t fallbackCursor = 0;
+
+		for (size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount)
+		{
+			// Nothing in the cache touches a live triangle, restart from the next one in input order
+			if (bestTriangle == NoTriangle)
+			{
+				while (emitted[fallbackCursor])
+				{
+					++fallbackCursor;
+				}
+				bestTriangle = fallbackCursor;
+			}
+
+			const uint32_t triangle = bestTriangle;
+			const uint32_t tri[3] = { indices[triangle * 3 + 0], indices[triangle * 3 + 1], indices[triangle * 3 + 2] };
+			emitted[triangle] = 1;
+			output.insert(output.end(), tri, tri + 3);
+
+			for (uint32_t v : tri)
+			{
+				uint32_t* live = &adjacency[adjacencyStart[v]];
+				uint32_t& count = liveCount[v];
+				for (uint32_t i = 0; i < count; ++i)
+				{
+					if (live[i] == triangle)
+					{
+						std::swap(live[i], live[count - 1]);
+						--count;
+						break;
+					}
+				}
+			}
+
+			// The emitted triangle goes to the front, the old cache follows without it, the overflow falls out
+			uint32_t nextCount = 0;
+			for (uint32_t v : tri)
+			{
+				nextCache[nextCount++] = v;
+			}
+			for (uint32_t i = 0; i < cacheCount; ++i)
+			{
+				const uint32_t v = cache[i];
+				if (v != tri[0] && v != tri[1] && v != tri[2] && nextCount < cacheSize + 3)
+				{
+					nextCache[nextCount++] = v;
+				}
+			}
+
+			for (uint32_t i = 0; i < cacheCount; ++i)
+			{
+				cachePosition[cache[i]] = -1;
+			}
+			for (uint32_t i = 0; i < nextCount; ++i)
+			{
+				cachePosition[nextCache[i]] = i < cacheSize ? static_cast<int32_t>(i) : -1;
+				vertexScores[nextCache[i]] = scoreVertex(nextCache[i]);
+			}
+			for (uint32_t i = 0; i < cacheCount; ++i)
+			{
+				if (cachePosition[cache[i]] < 0)
+				{
+					vertexScores[cache[i]] = scoreVertex(cache[i]);
+				}
+			}
+
+			std::memcpy(cache, nextCache, nextCount * sizeof(uint32_t));
+			cacheCount = nextCount;
+
+			// Only triangles around cached vertices changed score, the best one is among them or the cache has run dry
+			bestTriangle = NoTriangle;
+			float bestScore = -1.0f;
+			for (uint32_t i = 0; i < cacheCount; ++i)
+			{
+				const uint32_t v = cache[i];
+				const uint32_t* live = &adjacency[adjacencyStart[v]];
+				for (uint32_t j = 0; j < liveCount[v]; ++j)
+				{
+					const uint32_t candidate = live[j];
+					const uint32_t* candidateTri = &indices[candidate * 3];
+					const float score = vertexScores[candidateTri[0]] + vertexScores[candidateTri[1]] + vertexScores[candidateTri[2]];
+					triangleScores[candidate] = score;
+					if (score > bestScore)
+					{
+						bestScore = score;
+						bestTriangle = candidate;
+					}
+				}
+			}
+		}
+
+		std::memcpy(indices.data(), output.data(), output.size() * sizeof(uint32_t));
+	}
+
+	void OptimizeMeshVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+	{
+		std::vector<uint32_t> remap(vertices.size(), UINT32_MAX);
+		std::vector<Vertex> reordered;
+		reordered.reserve(vertices.size());
+
+		for (uint32_t& index : indices)
+		{
+			uint32_t& mapped = remap[index];
+			if (mapped == UINT32_MAX)
+			{
+				mapped = static_cast<uint32_t>(reordered.size());
+				reordered.push_back(vertices[index]);
+			}
+			index = mapped;
+		}
+
+		vertices.swap(reordered);
+	}
+
+	MeshOptimizeStats OptimizeMesh(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+	{
+		MeshOptimizeStats stats;
+		stats.verticesBefore = vertices.size();
+		stats.verticesAfter = vertices.size();
+
+		if (indices.size() % 3 != 0 || indices.empty())
+		{
+			return stats;
+		}
+
+		// The passes index straight into per vertex tables, a broken index buffer is left for the caller to notice
+		if (*std::max_element(indices.begin(), indices.end()) >= vertices.size())
+		{
+			return stats;
+		}
+
+		stats.acmrBefore = ComputeMeshACMR(indices, vertices.size());
+
+		WeldMeshVertices(vertices, indices);
+		OptimizeMeshVertexCache(indices, vertices.size());
+		OptimizeMeshVertexFetch(vertices, indices);
+
+		stats.verticesAfter = vertices.size();
+		stats.acmrAfter = ComputeMeshACMR(indices, vertices.size());
+		return stats;
+	}
+
+}
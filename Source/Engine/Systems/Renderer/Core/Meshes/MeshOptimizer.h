@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Vertex.h"
+
+// Offline style optimization of indexed triangle lists, MeshPool runs it on every mesh it registers (the GLB loader already on its workers).
+// Welding shrinks the vertex buffer, the cache reorder cuts how often the GPU transforms a vertex again, and the fetch reorder lays vertices out in the order the reordered indices first touch them.
+
+namespace Engine
+{
+
+	struct MeshOptimizeConfig
+	{
+		static constexpr bool EnabledByDefault = true; // starting value of MeshPool::SetOptimizeOnRegister, off registers meshes in the order they come in
+		static constexpr uint32_t CacheSize = 32; // post transform cache the reorder and the ACMR model, roughly what current GPUs keep per batch
+	};
+
+	struct MeshOptimizeStats
+	{
+		size_t verticesBefore = 0;
+		size_t verticesAfter = 0;
+		float acmrBefore = 0.0f; // average cache misses per triangle, 3 is no reuse at all and about 0.5 is the floor for a regular grid
+		float acmrAfter = 0.0f;
+	};
+
+	// Vertex transforms a FIFO cache of cacheSize would miss per triangle
+	float ComputeMeshACMR(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize = MeshOptimizeConfig::CacheSize);
+
+	// Merges vertices with identical bytes and points the indices at the survivors, vertices keep their first occurrence order
+	void WeldMeshVertices(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+	// Reorders the triangles for the post transform cache with Forsyth's linear speed vertex cache optimization, the vertices don't move
+	void OptimizeMeshVertexCache(std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize = MeshOptimizeConfig::CacheSize);
+
+	// Renumbers the vertices in the order the indices first use them and drops the ones no triangle uses
+	void OptimizeMeshVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+	// All three in order. Meshes whose index count isn't a multiple of 3 or that index past their vertices are left alone.
+	MeshOptimizeStats OptimizeMesh(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+}
@@ -11,12 +11,42 @@ namespace Engine
 		return instance;
 	}
 
+	// Points vertices and indices at optimized copies when registration should optimize, the caller's arrays are const and may be shared
+	static void OptimizeForRegister
+	(
+		const std::vector<Vertex>*& vertices, const std::vector<uint32_t>*& indices, std::vector<Vertex>& vertexCopy, std::vector<uint32_t>& indexCopy
+	)
+	{
+		vertexCopy = *vertices;
+		indexCopy = *indices;
+		OptimizeMesh(vertexCopy, indexCopy);
+
+		vertices = &vertexCopy;
+		indices = &indexCopy;
+	}
+
 	std::shared_ptr<Mesh> MeshPool::RegisterMesh(const std::string& name, const VertexesIndexesPair& data)
 	{
 		return RegisterMesh(name, data.vertices, data.indices);
 	}
 
 	std::shared_ptr<Mesh> MeshPool::RegisterMesh(const std::string& name, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
+	{
+		return RegisterMeshWithBounds(name, vertices, indices, nullptr, nullptr, false);
+	}
+
+	std::shared_ptr<Mesh> MeshPool::RegisterMesh
+	(
+		const std::string& name, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const glm::vec3& aabbMin, const glm::vec3& aabbMax, bool optimized
+	)
+	{
+		return RegisterMeshWithBounds(name, vertices, indices, &aabbMin, &aabbMax, optimized);
+	}
+
+	std::shared_ptr<Mesh> MeshPool::RegisterMeshWithBounds
+	(
+		const std::string& name, const std::vector<Vertex>& sourceVertices, const std::vector<uint32_t>& sourceIndices, const glm::vec3* aabbMin, const glm::vec3* aabbMax, bool optimized
+	)
 	{
 		std::lock_guard<std::mutex> lock(poolMutex);
 
@@ -27,6 +57,18 @@ namespace Engine
 			return it->second; // Return existing mesh
 		}
 
+		// Welding only drops vertices, so bounds handed in still hold afterwards
+		const std::vector<Vertex>* vertexSource = &sourceVertices;
+		const std::vector<uint32_t>* indexSource = &sourceIndices;
+		std::vector<Vertex> vertexCopy;
+		std::vector<uint32_t> indexCopy;
+		if (!optimized && GetOptimizeOnRegister())
+		{
+			OptimizeForRegister(vertexSource, indexSource, vertexCopy, indexCopy);
+		}
+		const std::vector<Vertex>& vertices = *vertexSource;
+		const std::vector<uint32_t>& indices = *indexSource;
+
 		// Create the mesh and its buffer data
 		auto mesh = std::make_shared<Mesh>(vertices, indices);
 		mesh->meshBufferData = std::make_shared<MeshBufferData>();
@@ -40,7 +82,15 @@ namespace Engine
 		idToMesh[meshID] = mesh;
 
 		// Generate mesh buffers and its AABB and then place in the map
-		mesh->meshBufferData->GenerateBuffersAndAABB(vertices, indices);
+		if (aabbMin && aabbMax)
+		{
+			mesh->meshBufferData->GenerateBuffers(vertices, indices, *aabbMin, *aabbMax);
+		}
+		else
+		{
+			mesh->meshBufferData->GenerateBuffersAndAABB(vertices, indices);
+		}
+		mesh->handle = AssignMeshSlot(meshID, mesh);
 		meshes.emplace(name, mesh);
 
 		return mesh;
@@ -48,11 +98,23 @@ namespace Engine
 
 	std::shared_ptr<Mesh> MeshPool::GetOrCreateAndRegisterMesh
 	(
-		const std::string& desiredName, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices
+		const std::string& desiredName, const std::vector<Vertex>& sourceVertices, const std::vector<uint32_t>& sourceIndices
 	)
 	{
 		std::lock_guard<std::mutex> lock(poolMutex);
 
+		// Registered meshes hold their optimized arrays, so the comparison below has to see this one optimized too (the optimizer is deterministic)
+		const std::vector<Vertex>* vertexSource = &sourceVertices;
+		const std::vector<uint32_t>* indexSource = &sourceIndices;
+		std::vector<Vertex> vertexCopy;
+		std::vector<uint32_t> indexCopy;
+		if (GetOptimizeOnRegister())
+		{
+			OptimizeForRegister(vertexSource, indexSource, vertexCopy, indexCopy);
+		}
+		const std::vector<Vertex>& vertices = *vertexSource;
+		const std::vector<uint32_t>& indices = *indexSource;
+
 		// First: check if a mesh with identical vertex/index data already exists
 		for (const auto& [existingName, existingMesh] : meshes)
 		{
@@ -94,6 +156,7 @@ namespace Engine
 
 		// Upload to GPU, compute AABB
 		mesh->meshBufferData->GenerateBuffersAndAABB(vertices, indices);
+		mesh->handle = AssignMeshSlot(meshID, mesh);
 
 		// Name deduplication like TexturePool: append _1, _2, etc.
 		std::string finalName = desiredName;
@@ -120,6 +183,22 @@ namespace Engine
 		return mesh;
 	}
 
+	MeshHandle MeshPool::AssignMeshSlot(uint32_t meshID, const std::shared_ptr<Mesh>& mesh)
+	{
+		if (meshID >= meshSlotBufferData.size())
+		{
+			meshSlotBufferData.resize(meshID + 1, nullptr);
+			meshSlotGenerations.resize(meshID + 1, 0);
+		}
+
+		meshSlotBufferData[meshID] = mesh->meshBufferData.get();
+
+		MeshHandle handle;
+		handle.index = meshID;
+		handle.generation = meshSlotGenerations[meshID];
+		return handle;
+	}
+
 	std::shared_ptr<Mesh> MeshPool::GetMesh(const std::string& name) const
 	{
 		std::lock_guard<std::mutex> lock(poolMutex);
@@ -175,6 +254,13 @@ namespace Engine
 			}
 		}
 
+		// IDs start over from 0, so every slot moves to a new generation and old handles stop resolving
+		for (size_t i = 0; i < meshSlotBufferData.size(); ++i)
+		{
+			meshSlotBufferData[i] = nullptr;
+			++meshSlotGenerations[i];
+		}
+
 		// Clear all meshes from the pool too
 		meshes.clear();
 		meshToID.clear();
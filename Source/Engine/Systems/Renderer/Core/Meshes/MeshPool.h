@@ -1,7 +1,9 @@
 #pragma once
 
+#include <atomic>
 #include <mutex>
 #include "Mesh.h"
+#include "MeshOptimizer.h"
 #include "Vertex.h"
 #include "PrimitiveMeshes.h"
 
@@ -26,6 +28,10 @@ namespace Engine
     std::shared_ptr<Mesh> RegisterMesh(const std::string& name, const VertexesIndexesPair& data);
     std::shared_ptr<Mesh> RegisterMesh(const std::string& name, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
 
+    // Same as above with the AABB already worked out, for loaders that get it for free.
+    // optimized registers the arrays as they are, for loaders that already ran OptimizeMesh on their workers.
+    std::shared_ptr<Mesh> RegisterMesh(const std::string& name, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const glm::vec3& aabbMin, const glm::vec3& aabbMax, bool optimized = false);
+
     // If you care about registering meshes super quick, don't use this. This is for safety.
     std::shared_ptr<Mesh> GetOrCreateAndRegisterMesh(const std::string& desiredName, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
 
@@ -35,6 +41,23 @@ namespace Engine
     uint32_t GetMeshID(const std::shared_ptr<Mesh>& mesh) const;
     std::shared_ptr<Mesh> GetMeshByID(uint32_t id) const;
 
+    // Resolves a handle without locking or touching any refcount, null if the mesh is gone.
+    // Meshes are registered from the main thread, so this is safe from the main thread and the render jobs it waits on.
+    const MeshBufferData* TryGetMeshBufferData(MeshHandle handle) const
+    {
+      if (handle.index >= meshSlotBufferData.size() || meshSlotGenerations[handle.index] != handle.generation)
+      {
+        return nullptr;
+      }
+
+      return meshSlotBufferData[handle.index];
+    }
+
+    // Registration welds and reorders each mesh for the vertex cache before uploading it (see MeshOptimizer.h), the caller's arrays stay untouched.
+    // Turning it off keeps the vertex order of everything registered afterwards as it was handed in.
+    void SetOptimizeOnRegister(bool value) { optimizeOnRegister.store(value, std::memory_order_relaxed); }
+    bool GetOptimizeOnRegister() const { return optimizeOnRegister.load(std::memory_order_relaxed); }
+
     // Removes a mesh by name. Returns true if successful.
     bool RemoveMesh(const std::string& name);
 
@@ -46,6 +69,13 @@ namespace Engine
     // Private constructor for Singleton pattern
     MeshPool() = default;
 
+    MeshHandle AssignMeshSlot(uint32_t meshID, const std::shared_ptr<Mesh>& mesh);
+
+    // Bounds are worked out from the vertices when null
+    std::shared_ptr<Mesh> RegisterMeshWithBounds(const std::string& name, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const glm::vec3* aabbMin, const glm::vec3* aabbMax, bool optimized);
+
+    std::atomic<bool> optimizeOnRegister{ MeshOptimizeConfig::EnabledByDefault };
+
     mutable std::mutex poolMutex; // Protects the mesh map
     std::unordered_map<std::string, std::shared_ptr<Mesh>> meshes;
 
@@ -54,6 +84,10 @@ namespace Engine
     std::unordered_map<uint32_t, std::shared_ptr<Mesh>> idToMesh;
     uint32_t nextMeshID = 0; 
 
+    // Dense per mesh ID, plain data only so handle lookups never touch the shared_ptrs above (those keep ownership)
+    std::vector<const MeshBufferData*> meshSlotBufferData;
+    std::vector<uint32_t> meshSlotGenerations;
+
   };
 
 }
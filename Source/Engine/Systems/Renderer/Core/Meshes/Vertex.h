@@ -54,14 +54,14 @@ namespace Engine
     {
       std::vector<VkVertexInputAttributeDescription> instanceAttribs;
 
-      // mat4 model -> 4 vec4s -> locations 3,4,5,6
-      for (uint32_t i = 0; i < 4; ++i)
+      // affine model rows -> 3 vec4s -> locations 3,4,5
+      for (uint32_t i = 0; i < 3; ++i)
       {
         VkVertexInputAttributeDescription attrib{};
         attrib.binding = 1;
         attrib.location = 3 + i;
         attrib.format = VK_FORMAT_R32G32B32A32_SFLOAT;
-        attrib.offset = static_cast<uint32_t>(offsetof(GpuInstanceData, model) + sizeof(glm::vec4) * i);
+        attrib.offset = static_cast<uint32_t>(offsetof(GpuInstanceData, modelRows) + sizeof(glm::vec4) * i);
         instanceAttribs.push_back(attrib);
       }
 
@@ -73,13 +73,13 @@ namespace Engine
       texIndex.offset = static_cast<uint32_t>(offsetof(GpuInstanceData, textureIndex));
       instanceAttribs.push_back(texIndex);
 
-      // hasTexture (float) -> location 8
-      VkVertexInputAttributeDescription hasTex{};
-      hasTex.binding = 1;
-      hasTex.location = 8;
-      hasTex.format = VK_FORMAT_R32_SFLOAT;
-      hasTex.offset = static_cast<uint32_t>(offsetof(GpuInstanceData, hasTexture));
-      instanceAttribs.push_back(hasTex);
+      // flags (uint) -> location 8
+      VkVertexInputAttributeDescription flags{};
+      flags.binding = 1;
+      flags.location = 8;
+      flags.format = VK_FORMAT_R32_UINT;
+      flags.offset = static_cast<uint32_t>(offsetof(GpuInstanceData, flags));
+      instanceAttribs.push_back(flags);
 
       return instanceAttribs;
     }
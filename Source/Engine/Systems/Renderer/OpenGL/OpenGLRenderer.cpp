@@ -587,6 +587,8 @@ namespace Engine
 		glUseProgram(shaderProgram); // main shader 
 		glEnable(GL_CULL_FACE);
 
+		worldPacketBuilder.Clear();
+
 		scene->GetSceneBVH()->QueryFrustumCallback(frustum, [&](entt::entity entity)
 		{
 			// Skip what should not be rendered
@@ -607,73 +609,105 @@ namespace Engine
 				return;
 			}
 
-			DrawEntity(entity, registry, viewMatrix, projectionMatrix);
+			AddWorldEntity(entity, registry);
 		});
-	}
 
-	void OpenGLRenderer::DrawEntity(entt::entity entity, entt::registry& registry, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix)
-	{
-		const Transform& transform = registry.get<Transform>(entity);
-		const glm::mat4& model = transform.GetWorldMatrix(registry);
-		const glm::mat4 mvp = projectionMatrix * viewMatrix * model;
+		if (worldPacketBuilder.IsEmpty())
+		{
+			return;
+		}
 
-		// === CompositeMaterial handling ===
-		if (registry.any_of<CompositeMaterial>(entity))
+		worldPacketBuilder.Sort();
+
+		const size_t instanceCount = worldPacketBuilder.GetInstanceCount();
+		worldDrawCommands.resize(worldPacketBuilder.GetCommandCount());
+		worldModelScratch.resize(instanceCount);
+		worldTextureScratch.resize(instanceCount);
+
+		DrawPacketOutput output{};
+		output.commands = worldDrawCommands.data();
+		output.models = worldModelScratch.data();
+		output.textureIndices = worldTextureScratch.data();
+		worldPacketBuilder.Build(output);
+
+		glBindVertexArray(globalVAO);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, megaEBO);
+		glActiveTexture(GL_TEXTURE0);
+		glUniform1i(loc_albedoTex, 0);
+
+		const glm::mat4 viewProj = projectionMatrix * viewMatrix;
+
+		// Instances come grouped by mesh and sorted by texture inside it, so the geometry per command stays the same and textures switch as little as possible
+		GLuint boundTexture = 0;
+		float boundHasTexture = -1.0f;
+
+		for (const DrawIndexedCommand& cmd : worldDrawCommands)
 		{
-			const auto& composite = registry.get<CompositeMaterial>(entity);
-			for (const auto& mat : composite.subMaterials)
+			const uint32_t end = cmd.firstInstance + cmd.instanceCount;
+			for (uint32_t i = cmd.firstInstance; i < end; ++i)
 			{
-				const MeshBufferData& meshData = *mat->mesh->meshBufferData;
-
+				const glm::mat4 mvp = viewProj * worldModelScratch[i];
 				glUniformMatrix4fv(loc_mvp, 1, GL_FALSE, &mvp[0][0]);
 
-				bool usesTexture = (mat->albedoMap != nullptr);
-				glUniform1f(loc_hasTexture, usesTexture ? 1.0f : 0.0f);
-
-				GLuint texID = usesTexture ? mat->albedoMap->GetTextureID() : missingTexture->GetTextureID();
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, texID);
-				glUniform1i(loc_albedoTex, 0);
+				const bool usesTexture = worldTextureScratch[i] != DrawPacketBuilder::NoTexture;
+				const float hasTexture = usesTexture ? 1.0f : 0.0f;
+				if (hasTexture != boundHasTexture)
+				{
+					glUniform1f(loc_hasTexture, hasTexture);
+					boundHasTexture = hasTexture;
+				}
 
-				glBindVertexArray(globalVAO);
-				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, megaEBO);
+				const GLuint texID = usesTexture ? static_cast<GLuint>(worldTextureScratch[i]) : missingTexture->GetTextureID();
+				if (texID != boundTexture)
+				{
+					glBindTexture(GL_TEXTURE_2D, texID);
+					boundTexture = texID;
+				}
 
 				glDrawElementsBaseVertex(
 					GL_TRIANGLES,
-					meshData.indexCount,
+					cmd.indexCount,
 					GL_UNSIGNED_INT,
-					reinterpret_cast<void*>(meshData.indexOffsetInMegaBuffer),
-					static_cast<GLint>(meshData.vertexOffsetInMegaBuffer / sizeof(Vertex))
+					reinterpret_cast<void*>(static_cast<size_t>(cmd.firstIndex) * sizeof(uint32_t)),
+					cmd.vertexOffset
 				);
 			}
-
-			return;
 		}
+	}
 
-		// === Regular Material handling ===
-		const auto& mat = registry.get<Material>(entity).data;
-		const MeshBufferData& meshData = *mat->mesh->meshBufferData;
+	void OpenGLRenderer::AddWorldEntity(entt::entity entity, entt::registry& registry)
+	{
+		const Transform& transform = registry.get<Transform>(entity);
+		const glm::mat4& model = transform.GetWorldMatrix(registry);
 
-		glUniformMatrix4fv(loc_mvp, 1, GL_FALSE, &mvp[0][0]);
+		const auto addMaterial = [&](const std::shared_ptr<MaterialData>& mat)
+		{
+			const MeshBufferData& meshData = *mat->mesh->meshBufferData;
 
-		bool usesTexture = (mat->albedoMap != nullptr);
-		glUniform1f(loc_hasTexture, usesTexture ? 1.0f : 0.0f);
+			DrawPacketMesh mesh{};
+			mesh.meshID = meshData.GetMeshID();
+			mesh.indexCount = meshData.indexCount;
+			mesh.firstIndex = static_cast<uint32_t>(meshData.indexOffsetInMegaBuffer / sizeof(uint32_t));
+			mesh.vertexOffset = static_cast<int32_t>(meshData.vertexOffsetInMegaBuffer / sizeof(Vertex));
 
-		GLuint texID = usesTexture ? mat->albedoMap->GetTextureID() : missingTexture->GetTextureID();
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, texID);
-		glUniform1i(loc_albedoTex, 0);
+			const uint32_t texture = mat->albedoMap ? static_cast<uint32_t>(mat->albedoMap->GetTextureID()) : DrawPacketBuilder::NoTexture;
+			worldPacketBuilder.Add(mesh, model, texture, static_cast<uint32_t>(TransformSpace::World));
+		};
 
-		glBindVertexArray(globalVAO);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, megaEBO);
+		// === CompositeMaterial handling ===
+		if (registry.any_of<CompositeMaterial>(entity))
+		{
+			const auto& composite = registry.get<CompositeMaterial>(entity);
+			for (const auto& mat : composite.subMaterials)
+			{
+				addMaterial(mat);
+			}
 
-		glDrawElementsBaseVertex(
-			GL_TRIANGLES,
-			meshData.indexCount,
-			GL_UNSIGNED_INT,
-			reinterpret_cast<void*>(meshData.indexOffsetInMegaBuffer),
-			static_cast<GLint>(meshData.vertexOffsetInMegaBuffer / sizeof(Vertex))
-		);
+			return;
+		}
+
+		// === Regular Material handling ===
+		addMaterial(registry.get<Material>(entity).data);
 	}
 
 	// Draws all screen space objects (typically UI) and also regular transforms that happen to be in screen space.
@@ -693,46 +727,46 @@ namespace Engine
 
 		auto& scene = SwimEngine::GetInstance()->GetSceneSystem()->GetActiveScene();
 
-		registry.view<Transform, Material>().each([&](entt::entity entity, Transform& tf, Material& matComp)
+		worldDecoratedScratch.clear();
+		screenSpaceScratch.clear();
+
+		registry.view<Transform, Material>().each([&](entt::entity entity, Transform& tf, Material& /*matComp*/)
 		{
-			// Skip what should not be rendered
-			if (!scene->ShouldRenderBasedOnState(entity))
+			const TransformSpace space = tf.GetTransformSpace();
+			if (space == TransformSpace::World && !registry.any_of<MeshDecorator>(entity))
 			{
 				return;
 			}
 
-			if (tf.GetTransformSpace() != TransformSpace::World)
+			// Skip what should not be rendered
+			if (!scene->ShouldRenderBasedOnState(entity))
 			{
 				return;
 			}
 
-			if (!registry.any_of<MeshDecorator>(entity))
+			if (space == TransformSpace::World)
 			{
-				return;
+				worldDecoratedScratch.push_back(entity);
+			}
+			else if (space == TransformSpace::Screen)
+			{
+				screenSpaceScratch.push_back(entity);
 			}
-
-			DrawUIEntity(entity, tf, matComp, registry, frustum, viewMatrix, projectionMatrix, cull);
 		});
 
+		for (entt::entity entity : worldDecoratedScratch)
+		{
+			DrawUIEntity(entity, registry.get<Transform>(entity), registry.get<Material>(entity), registry, frustum, viewMatrix, projectionMatrix, cull);
+		}
+
 		// Render screen-space UI last (no depth test)
 		// glDisable(GL_DEPTH_TEST);
 		// glDepthMask(GL_FALSE);
 
-		registry.view<Transform, Material>().each([&](entt::entity entity, Transform& tf, Material& matComp)
+		for (entt::entity entity : screenSpaceScratch)
 		{
-			// Skip what should not be rendered
-			if (!scene->ShouldRenderBasedOnState(entity))
-			{
-				return;
-			}
-
-			if (tf.GetTransformSpace() != TransformSpace::Screen)
-			{
-				return;
-			}
-
-			DrawUIEntity(entity, tf, matComp, registry, frustum, viewMatrix, projectionMatrix, cull);
-		});
+			DrawUIEntity(entity, registry.get<Transform>(entity), registry.get<Material>(entity), registry, frustum, viewMatrix, projectionMatrix, cull);
+		}
 
 		// Restore states
 		glEnable(GL_DEPTH_TEST);
@@ -940,7 +974,7 @@ namespace Engine
 			V.reserve(tc.GetUtf32().size() * 4);
 			I.reserve(tc.GetUtf32().size() * 6);
 
-			EmitMsdf(tc, fi, s, [&](uint32_t, const GlyphQuad& q, const MsdfTextGpuInstanceData&)
+			EmitMsdf(tc, s, [&](const GlyphQuad& q, const MsdfTextGpuInstanceData&)
 			{
 				uint32_t base = (uint32_t)V.size();
 				V.push_back({ {q.plane.x,q.plane.y},{q.uv.x,q.uv.y} });
@@ -1020,7 +1054,7 @@ namespace Engine
 			V.reserve(tc.GetUtf32().size() * 4);
 			I.reserve(tc.GetUtf32().size() * 6);
 
-			EmitMsdf(tc, fi, s, [&](uint32_t, const GlyphQuad& q, const MsdfTextGpuInstanceData&)
+			EmitMsdf(tc, s, [&](const GlyphQuad& q, const MsdfTextGpuInstanceData&)
 			{
 				uint32_t base = (uint32_t)V.size();
 				V.push_back({ {q.plane.x,q.plane.y},{q.uv.x,q.uv.y} });
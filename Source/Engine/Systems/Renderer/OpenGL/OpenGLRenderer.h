@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Engine/Systems/Renderer/Renderer.h"
+#include "Engine/Systems/Renderer/Core/Meshes/DrawPacketBuilder.h"
 
 namespace Engine
 {
@@ -59,7 +60,7 @@ namespace Engine
 		void RenderTextMSDFWorld(entt::registry& registry, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix);
 		void RenderTextMSDFScreen(entt::registry& registry, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix);
 
-		void DrawEntity(entt::entity entity, entt::registry& registry, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix);
+		void AddWorldEntity(entt::entity entity, entt::registry& registry);
 
 		void DrawUIEntity(
 			entt::entity entity,
@@ -134,6 +135,16 @@ namespace Engine
 		GLint loc_txt_strokeWidth = -1;
 		GLint loc_txt_distanceRange = -1;
 
+		// World meshes get grouped by mesh each frame, the texture arrays hold GL texture names
+		DrawPacketBuilder worldPacketBuilder;
+		std::vector<DrawIndexedCommand> worldDrawCommands;
+		std::vector<glm::mat4> worldModelScratch;
+		std::vector<uint32_t> worldTextureScratch;
+
+		// Filled by one pass over the registry so world decorators can still be drawn before screen space
+		std::vector<entt::entity> worldDecoratedScratch;
+		std::vector<entt::entity> screenSpaceScratch;
+
 		GLuint megaVBO = 0;          // Mega vertex buffer object
 		GLuint megaEBO = 0;          // Mega element (index) buffer object
 		GLuint globalVAO = 0;        // VAO used to bind VBO + instance attributes
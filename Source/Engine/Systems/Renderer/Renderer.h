@@ -22,6 +22,17 @@ namespace Engine
 
 		virtual void UploadMeshToMegaBuffer(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, MeshBufferData& meshData) = 0;
 
+		// Rendering reads the finished scene and owns the graphics API, which is tied to the main thread
+		FrameTaskAccess GetFrameTaskAccess() const override
+		{
+			return
+			{
+				FrameResource::Entities | FrameResource::Transform | FrameResource::SceneBVH | FrameResource::Camera | FrameResource::DebugDraw | FrameResource::TextGlyphs,
+				FrameResource::InstanceBuffers | FrameResource::Gpu,
+				true
+			};
+		}
+
 		// For consistent UI scaling across the whole engine:
 
 		constexpr static float VirtualCanvasWidth = 1920.0f;
@@ -5,24 +5,51 @@
 namespace Engine
 {
 
+  enum GpuInstanceFlags : uint32_t
+  {
+    GpuInstanceFlagScreenSpace = 1u << 0,
+    GpuInstanceFlagHasTexture = 1u << 1,
+  };
+
+  // 64 bytes per instance. Bounds, mega buffer offsets and index count are per mesh, so they live once in the MeshPool
+  // behind meshInfoIndex instead of being repeated in every instance. Must match GpuInstanceData in the instanced and decorated vertex shaders.
   struct alignas(16) GpuInstanceData
   {
-    glm::mat4 model;          // 64 bytes
+    glm::vec4 modelRows[3];   // 48 bytes, rows of the affine model matrix with the translation in w
+    uint32_t textureIndex;    // 4 bytes
+    uint32_t meshInfoIndex;   // 4 bytes (mesh ID)
+    uint32_t materialIndex;   // 4 bytes (decorator buffer index for decorated draws)
+    uint32_t flags;           // 4 bytes, GpuInstanceFlags
 
-    glm::vec4 aabbMin;        // 16 bytes
-    glm::vec4 aabbMax;        // 16 bytes
+    void SetModel(const glm::mat4& model)
+    {
+      // glm is column major, model[column][row]
+      modelRows[0] = glm::vec4(model[0][0], model[1][0], model[2][0], model[3][0]);
+      modelRows[1] = glm::vec4(model[0][1], model[1][1], model[2][1], model[3][1]);
+      modelRows[2] = glm::vec4(model[0][2], model[1][2], model[2][2], model[3][2]);
+    }
 
-    uint32_t textureIndex;    // 4 bytes
-    float hasTexture;         // 4 bytes (maybe should be a uint for consistency)
-    uint32_t meshInfoIndex;   // 4 bytes  
-    uint32_t materialIndex;   // 4 bytes  
+    glm::mat4 GetModel() const
+    {
+      return glm::mat4(
+        modelRows[0].x, modelRows[1].x, modelRows[2].x, 0.0f,
+        modelRows[0].y, modelRows[1].y, modelRows[2].y, 0.0f,
+        modelRows[0].z, modelRows[1].z, modelRows[2].z, 0.0f,
+        modelRows[0].w, modelRows[1].w, modelRows[2].w, 1.0f
+      );
+    }
+
+    // space is a TransformSpace, only Screen (1) sets the screen space bit
+    void SetFlags(uint32_t space, bool hasTexture)
+    {
+      flags = (space == 1u ? GpuInstanceFlagScreenSpace : 0u) | (hasTexture ? GpuInstanceFlagHasTexture : 0u);
+    }
 
-    uint32_t indexCount;      // 4 bytes
-    uint32_t space;           // 4 bytes (0 = world, 1 = screen)
-    VkDeviceSize vertexOffsetInMegaBuffer; // 8 bytes
-    VkDeviceSize indexOffsetInMegaBuffer;  // 8 bytes
+    uint32_t GetSpace() const { return (flags & GpuInstanceFlagScreenSpace) ? 1u : 0u; }
   };
 
+  static_assert(sizeof(GpuInstanceData) == 64, "GpuInstanceData must stay 64 bytes to match the shaders");
+
 	struct alignas(16) MeshDecoratorGpuInstanceData
 	{
 		glm::vec4 fillColor;
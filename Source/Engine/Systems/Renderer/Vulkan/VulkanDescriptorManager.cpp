@@ -54,11 +54,19 @@ namespace Engine
 		msdfBufferBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
 		msdfBufferBinding.pImmutableSamplers = nullptr;
 
-		std::array<VkDescriptorSetLayoutBinding, 4> bindings = {
+		VkDescriptorSetLayoutBinding visibleSlotBufferBinding{};
+		visibleSlotBufferBinding.binding = 4;
+		visibleSlotBufferBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		visibleSlotBufferBinding.descriptorCount = 1;
+		visibleSlotBufferBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+		visibleSlotBufferBinding.pImmutableSamplers = nullptr;
+
+		std::array<VkDescriptorSetLayoutBinding, 5> bindings = {
 			uboBinding,
 			instanceBufferBinding,
 			uiParamBufferBinding,
-			msdfBufferBinding
+			msdfBufferBinding,
+			visibleSlotBufferBinding
 		};
 
 		VkDescriptorSetLayoutCreateInfo layoutInfo{};
@@ -81,7 +89,7 @@ namespace Engine
 		poolSizes[0].descriptorCount = maxSets;
 
 		poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-		poolSizes[1].descriptorCount = maxSets * 3; // 3 for each of our buffers
+		poolSizes[1].descriptorCount = maxSets * 4; // 4 for each of our buffers
 
 		poolSizes[2].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 		poolSizes[2].descriptorCount = maxSets; // Only used in set 1 (bindless), but fine to include here
@@ -244,6 +252,30 @@ namespace Engine
 		}
 	}
 
+	void VulkanDescriptorManager::CreateVisibleSlotBufferDescriptorSets(const std::vector<std::unique_ptr<VulkanBuffer>>& perFrameVisibleSlotBuffers)
+	{
+		const uint32_t frameCount = static_cast<uint32_t>(perFrameVisibleSlotBuffers.size());
+
+		for (uint32_t i = 0; i < frameCount; ++i)
+		{
+			VkDescriptorBufferInfo bufferInfo{};
+			bufferInfo.buffer = perFrameVisibleSlotBuffers[i]->GetBuffer();
+			bufferInfo.offset = 0;
+			bufferInfo.range = VK_WHOLE_SIZE;
+
+			VkWriteDescriptorSet write{};
+			write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			write.dstSet = perFrameDescriptorSets[i];
+			write.dstBinding = 4;                     // Binding 4 = visible slot SSBO
+			write.dstArrayElement = 0;
+			write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			write.descriptorCount = 1;
+			write.pBufferInfo = &bufferInfo;
+
+			vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+		}
+	}
+
 	void VulkanDescriptorManager::UpdatePerFrameInstanceBuffer(uint32_t frameIndex, const void* data, size_t size)
 	{
 		if (frameIndex >= perFrameInstanceBuffers.size())
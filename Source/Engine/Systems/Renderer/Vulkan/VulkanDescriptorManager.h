@@ -52,6 +52,9 @@ namespace Engine
 		// Adds SSBO (instance buffer) binding to per-frame descriptor sets
 		void CreateInstanceBufferDescriptorSets(const std::vector<std::unique_ptr<VulkanBuffer>>& perFrameInstanceBuffers);
 
+		// Adds the visible slot SSBO binding the world vertex shader reads its instance index from
+		void CreateVisibleSlotBufferDescriptorSets(const std::vector<std::unique_ptr<VulkanBuffer>>& perFrameVisibleSlotBuffers);
+
 		// Bindless setup
 		void CreateBindlessLayout();
 		void CreateBindlessPool();
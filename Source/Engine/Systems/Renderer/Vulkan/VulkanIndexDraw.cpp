@@ -4,17 +4,27 @@
 #include "Engine/Components/CompositeMaterial.h"
 #include "Engine/Components/Transform.h"
 #include "Engine/Components/MeshDecorator.h"
+#include "Engine/Components/Occluder.h"
 #include "Engine/Components/TextComponent.h"
 #include "Engine/Components/Internal/FrustumCullCache.h"
 #include "Engine/Systems/Renderer/Core/Meshes/MeshPool.h"
+#include "Engine/Systems/Renderer/Core/Material/MaterialPool.h"
 #include "Engine/Systems/Renderer/Core/Camera/Frustum.h"
 #include "Engine/Systems/Renderer/Core/Font/TextLayout.h"
 #include "Engine/Utility/ParallelUtils.h"
+#include "Engine/Utility/Profiler.h"
 #include "VulkanRenderer.h"
 
 namespace Engine
 {
 
+	// The packet builder writes its commands straight into the Vulkan indirect command arrays
+	static_assert(sizeof(DrawIndexedCommand) == sizeof(VkDrawIndexedIndirectCommand), "DrawIndexedCommand must match VkDrawIndexedIndirectCommand");
+	static_assert(offsetof(DrawIndexedCommand, instanceCount) == offsetof(VkDrawIndexedIndirectCommand, instanceCount), "DrawIndexedCommand must match VkDrawIndexedIndirectCommand");
+	static_assert(offsetof(DrawIndexedCommand, firstIndex) == offsetof(VkDrawIndexedIndirectCommand, firstIndex), "DrawIndexedCommand must match VkDrawIndexedIndirectCommand");
+	static_assert(offsetof(DrawIndexedCommand, vertexOffset) == offsetof(VkDrawIndexedIndirectCommand, vertexOffset), "DrawIndexedCommand must match VkDrawIndexedIndirectCommand");
+	static_assert(offsetof(DrawIndexedCommand, firstInstance) == offsetof(VkDrawIndexedIndirectCommand, firstInstance), "DrawIndexedCommand must match VkDrawIndexedIndirectCommand");
+
 	// NOTE: all these draw methods check if the draw instances fit in the ssbo, if not it tries to resize them.
 	// The current execution flow will crash the program on trying to resize since we are reallocating device bound ssbos.
 	// We would need a decently complex system to check if we should reallocate sizes before recording draw commands.
@@ -30,11 +40,9 @@ namespace Engine
 		const int MAX_EXPECTED_INSTANCES,
 		const int MAX_FRAMES_IN_FLIGHT
 	)
-		: device(device), physicalDevice(physicalDevice)
+		: device(device), physicalDevice(physicalDevice), slotUploader(MAX_FRAMES_IN_FLIGHT, sizeof(GpuInstanceData)), msdfUploader(MAX_FRAMES_IN_FLIGHT, sizeof(MsdfTextGpuInstanceData))
 	{
 		uploadedWorldPacketVersions.resize(MAX_FRAMES_IN_FLIGHT, 0);
-		uploadedFullScenePacketVersions.resize(MAX_FRAMES_IN_FLIGHT, 0);
-		uploadedFullSceneCommandVersions.resize(MAX_FRAMES_IN_FLIGHT, 0);
 		instanceBuffer = std::make_unique<Engine::VulkanInstanceBuffer>(
 			device,
 			physicalDevice,
@@ -44,6 +52,18 @@ namespace Engine
 		);
 
 		cpuInstanceData.reserve(MAX_EXPECTED_INSTANCES);
+
+		visibleSlotBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+		for (auto& buffer : visibleSlotBuffers)
+		{
+			buffer = std::make_unique<VulkanBuffer>(
+				device,
+				physicalDevice,
+				sizeof(uint32_t) * MAX_EXPECTED_INSTANCES,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+			);
+		}
 	}
 
 	static void EnsureInstanceCapacity(VulkanInstanceBuffer& ib, size_t requiredInstances)
@@ -87,6 +107,32 @@ namespace Engine
 		}
 	}
 
+	// Same as EnsureIndirectCapacity for a visible slot list, the per frame descriptor sets still point at the old buffer afterwards (see the note at the top)
+	void VulkanIndexDraw::EnsureVisibleSlotCapacity
+	(
+		std::unique_ptr<VulkanBuffer>& buf,
+		size_t slotCount
+	)
+	{
+		const VkDeviceSize need = static_cast<VkDeviceSize>(slotCount * sizeof(uint32_t));
+		if (buf->GetSize() < need)
+		{
+			std::cout << "EnsureVisibleSlotCapacity | Need to grow buffer" << std::endl;
+			const VkDeviceSize newSize = std::max<VkDeviceSize>(need, buf->GetSize() * 2);
+
+			auto newBuf = std::make_unique<VulkanBuffer>(
+				device,
+				physicalDevice,
+				newSize,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+			);
+
+			buf->Free();
+			buf = std::move(newBuf);
+		}
+	}
+
 	uint64_t VulkanIndexDraw::MakeWorldRenderableKey(entt::entity entity, uint32_t subMaterialIndex)
 	{
 		const uint32_t entityID = static_cast<uint32_t>(entt::to_integral(entity));
@@ -117,7 +163,8 @@ namespace Engine
 	{
 		slot.entity = entity;
 		slot.subMaterialIndex = subMaterialIndex;
-		slot.material = mat;
+		slot.material = mat ? mat->handle : MaterialHandle{};
+		slot.textureIndex = (mat && mat->albedoMap) ? mat->albedoMap->GetBindlessIndex() : UINT32_MAX;
 		slot.transformSpace = TransformSpace::World;
 		slot.canUseEntityCullCache = canUseEntityCullCache;
 		slot.active = true;
@@ -153,7 +200,7 @@ namespace Engine
 		auto touchSlot =
 			[&](entt::entity entity, uint32_t subMaterialIndex, const std::shared_ptr<MaterialData>& mat, bool canUseEntityCullCache)
 		{
-			if (!mat || !mat->mesh || !mat->mesh->meshBufferData)
+			if (!mat || !mat->handle.IsValid() || !mat->mesh || !mat->mesh->meshBufferData)
 			{
 				return;
 			}
@@ -401,17 +448,149 @@ namespace Engine
 		currentIndexBufferOffset += indexSize;
 	}
 
-	bool VulkanIndexDraw::CanReuseCachedWorldPacket(const Scene& scene, const Frustum* frustum) const
+	void VulkanIndexDraw::AddSlotInstanceSource(entt::registry& registry, uint32_t slotIndex)
+	{
+		const WorldRenderableSlot& slot = worldRenderableSlots[slotIndex];
+		if (!slot.active || !registry.valid(slot.entity))
+		{
+			return;
+		}
+
+		const Transform* tf = registry.try_get<Transform>(slot.entity);
+		if (tf == nullptr)
+		{
+			return;
+		}
+
+		// GetWorldMatrix fills the caches up the parent chain, so it has to happen here and not on a worker
+		SlotInstanceSource& source = slotSourceScratch.emplace_back();
+		source.slotIndex = slotIndex;
+		source.transformSpace = tf->GetTransformSpace();
+		source.worldMatrix = &tf->GetWorldMatrix(registry);
+	}
+
+	bool VulkanIndexDraw::WriteWorldSlotInstance(const SlotInstanceSource& source)
+	{
+		const WorldRenderableSlot& slot = worldRenderableSlots[source.slotIndex];
+
+		GpuInstanceData instance{};
+		instance.SetModel(*source.worldMatrix);
+		instance.textureIndex = slot.textureIndex;
+		instance.meshInfoIndex = slot.meshID;
+		instance.materialIndex = 0u;
+		instance.SetFlags(static_cast<uint32_t>(source.transformSpace), slot.textureIndex != UINT32_MAX);
+
+		// Only a slot that really changed costs upload bandwidth
+		GpuInstanceData& stored = cpuInstanceData[source.slotIndex];
+		if (std::memcmp(&stored, &instance, sizeof(GpuInstanceData)) == 0)
+		{
+			return false;
+		}
+
+		stored = instance;
+		return true;
+	}
+
+	void VulkanIndexDraw::WriteSlotInstanceSources()
 	{
-		(void)scene;
-		(void)frustum;
-		return false;
+		if (slotSourceScratch.empty())
+		{
+			return;
+		}
+
+		const size_t workerSlots = GetRenderParallelWorkerSlots();
+		EnsureDirtyThreadScratch(workerSlots, 0);
+
+		// Sources hold each slot once, so chunks never write the same instance
+		ParallelForRender(slotSourceScratch.size(), RenderCpuJobConfig::DefaultMinItemsPerChunk, [&](size_t begin, size_t end, uint32_t workerIndex)
+		{
+			std::vector<uint32_t>& localDirty = dirtyThreadScratch[workerIndex].dirtyIndices;
+			for (size_t i = begin; i < end; ++i)
+			{
+				if (WriteWorldSlotInstance(slotSourceScratch[i]))
+				{
+					localDirty.push_back(slotSourceScratch[i].slotIndex);
+				}
+			}
+		});
+
+		for (size_t worker = 0; worker < workerSlots; ++worker)
+		{
+			for (uint32_t slotIndex : dirtyThreadScratch[worker].dirtyIndices)
+			{
+				slotUploader.MarkDirty(slotIndex);
+			}
+		}
 	}
 
 
-	void VulkanIndexDraw::UploadCachedWorldPacketToFrame(uint32_t frameIndex)
+	void VulkanIndexDraw::RefreshAllWorldSlotInstances(Scene& scene)
 	{
-		(void)frameIndex;
+		SWIM_PROFILE_FUNCTION();
+
+		entt::registry& registry = scene.GetRegistry();
+
+		slotSourceScratch.clear();
+		for (size_t i = 0; i < worldRenderableSlots.size(); ++i)
+		{
+			AddSlotInstanceSource(registry, static_cast<uint32_t>(i));
+		}
+
+		WriteSlotInstanceSources();
+	}
+
+
+	void VulkanIndexDraw::UpdateWorldSlotInstances(Scene& scene)
+	{
+		// Drops the decorator instances the last frame appended behind the slots
+		cpuInstanceData.resize(worldRenderableSlots.size());
+		slotUploader.Resize(worldRenderableSlots.size());
+
+		const TransformDirtyTracker& tracker = scene.GetTransformDirtyTracker();
+		const uint64_t epoch = tracker.GetEpoch();
+
+		// The last cleared set covers the scene update, the live set whatever moved after the scene cleared it this frame (physics poses)
+		const bool haveChanges = slotInstancesScene == &scene
+			&& slotInstancesRenderablesRevision == worldRenderableSlotsRevision
+			&& tracker.CollectChangedSince(slotInstancesTrackerEpoch, changedEntityScratch);
+
+		slotInstancesTrackerEpoch = epoch;
+
+		if (!haveChanges)
+		{
+			// Slots were reassigned or a whole frame of changes went by unseen, compare every slot instead
+			RefreshAllWorldSlotInstances(scene);
+
+			slotInstancesScene = &scene;
+			slotInstancesRenderablesRevision = worldRenderableSlotsRevision;
+			return;
+		}
+
+		if (changedEntityScratch.empty())
+		{
+			return;
+		}
+
+		SWIM_PROFILE_FUNCTION();
+
+		entt::registry& registry = scene.GetRegistry();
+
+		slotSourceScratch.clear();
+		for (entt::entity entity : changedEntityScratch)
+		{
+			auto it = worldEntityToSlotIndices.find(entity);
+			if (it == worldEntityToSlotIndices.end())
+			{
+				continue;
+			}
+
+			for (uint32_t slotIndex : it->second)
+			{
+				AddSlotInstanceSource(registry, slotIndex);
+			}
+		}
+
+		WriteSlotInstanceSources();
 	}
 
 
@@ -437,16 +616,31 @@ namespace Engine
 	}
 
 
+	bool VulkanIndexDraw::IsFullScenePacketCurrent(const Scene& scene) const
+	{
+		return fullScenePacketValid
+			&& fullScenePacketScene == &scene
+			&& fullScenePacketRenderablesRevision == scene.GetRenderablesRevision()
+			&& fullScenePacketEngineState == SwimEngine::GetInstance()->GetEngineState();
+	}
+
 
 	bool VulkanIndexDraw::TryBuildGatheredInstance(entt::registry& registry, const VulkanIndexDraw::GatherCandidate& candidate, const Frustum* frustum, VulkanIndexDraw::GatheredInstance& outInstance) const
 	{
-		const std::shared_ptr<MaterialData>& mat = candidate.material;
-		if (!mat || !mat->mesh || !mat->mesh->meshBufferData)
+		// Handles only, copying the shared_ptrs here would bounce their refcounts between every worker running the gather
+		const MaterialRenderInfo* mat = MaterialPool::GetInstance().TryGetRenderInfo(candidate.material);
+		if (!mat)
+		{
+			return false;
+		}
+
+		const MeshBufferData* meshData = MeshPool::GetInstance().TryGetMeshBufferData(mat->mesh);
+		if (!meshData)
 		{
 			return false;
 		}
 
-		const MeshBufferData& mesh = *mat->mesh->meshBufferData;
+		const MeshBufferData& mesh = *meshData;
 		const glm::vec3 localMin = glm::vec3(mesh.aabbMin);
 		const glm::vec3 localMax = glm::vec3(mesh.aabbMax);
 
@@ -466,60 +660,21 @@ namespace Engine
 			}
 		}
 
-		outInstance.meshID = mesh.GetMeshID();
-		outInstance.indexCount = mesh.indexCount;
-		outInstance.vertexOffsetInMegaBuffer = mesh.vertexOffsetInMegaBuffer;
-		outInstance.indexOffsetInMegaBuffer = mesh.indexOffsetInMegaBuffer;
-		outInstance.instance.space = static_cast<uint32_t>(candidate.transformSpace);
-		outInstance.instance.model = candidate.worldMatrix;
-		outInstance.instance.textureIndex = mat->albedoMap ? mat->albedoMap->GetBindlessIndex() : UINT32_MAX;
-		outInstance.instance.hasTexture = mat->albedoMap ? 1.0f : 0.0f;
-		outInstance.instance.materialIndex = 0u;
+		outInstance.mesh.meshID = mesh.GetMeshID();
+		outInstance.mesh.indexCount = mesh.indexCount;
+		outInstance.mesh.firstIndex = static_cast<uint32_t>(mesh.indexOffsetInMegaBuffer / sizeof(uint32_t));
+		outInstance.mesh.vertexOffset = static_cast<int32_t>(mesh.vertexOffsetInMegaBuffer / sizeof(Vertex));
+		outInstance.slotIndex = candidate.slotIndex;
 		return true;
 	}
 
 	void VulkanIndexDraw::AppendGatheredInstance(const VulkanIndexDraw::GatheredInstance& gathered)
 	{
-		auto [it, inserted] = meshBuckets.try_emplace(gathered.meshID);
-		MeshBucket& bucket = it->second;
-		if (inserted)
-		{
-			bucket.indexCount = gathered.indexCount;
-			bucket.indexOffsetInMegaBuffer = gathered.indexOffsetInMegaBuffer;
-			bucket.vertexOffsetInMegaBuffer = gathered.vertexOffsetInMegaBuffer;
-		}
-
-		if (bucket.instances.empty())
-		{
-			activeMeshBucketKeys.push_back(gathered.meshID);
-		}
-
-		bucket.instances.push_back(gathered.instance);
-	}
-
-	void VulkanIndexDraw::AppendGatheredInstances(const std::vector<VulkanIndexDraw::GatheredInstance>& gatheredInstances)
-	{
-		for (const GatheredInstance& gathered : gatheredInstances)
-		{
-			AppendGatheredInstance(gathered);
-		}
-	}
-
-	void VulkanIndexDraw::EnsureGatherThreadScratch(size_t workerSlots, size_t reservePerSlot)
-	{
-		if (gatherThreadScratch.size() < workerSlots)
-		{
-			gatherThreadScratch.resize(workerSlots);
-		}
-
-		for (size_t slot = 0; slot < workerSlots; ++slot)
+		// Keyed by texture inside each mesh, so neighbouring instances in the visible list share a texture
+		const uint32_t material = worldRenderableSlots[gathered.slotIndex].textureIndex;
+		if (worldPacketBuilder.Add(gathered.mesh, material, static_cast<uint32_t>(TransformSpace::World)) != DrawPacketBuilder::InvalidSource)
 		{
-			auto& gathered = gatherThreadScratch[slot].gathered;
-			gathered.clear();
-			if (gathered.capacity() < reservePerSlot)
-			{
-				gathered.reserve(reservePerSlot);
-			}
+			packetSlotScratch.push_back(gathered.slotIndex);
 		}
 	}
 
@@ -566,40 +721,39 @@ namespace Engine
 			return;
 		}
 
-		const size_t workerSlots = GetRenderParallelWorkerSlots();
-		const size_t reservePerSlot = std::max<size_t>((candidates.size() + workerSlots - 1) / workerSlots, 32);
-		EnsureGatherThreadScratch(workerSlots, reservePerSlot);
+		// Built per candidate and appended in candidate order, so an unchanged scene gives the same packet no matter how the chunks were scheduled
+		gatheredScratch.resize(candidates.size());
+		gatheredBuiltScratch.resize(candidates.size());
 
-		ParallelForRender(candidates.size(), RenderCpuJobConfig::DefaultMinItemsPerChunk, [&](size_t begin, size_t end, uint32_t workerIndex)
+		ParallelForRender(candidates.size(), RenderCpuJobConfig::DefaultMinItemsPerChunk, [&](size_t begin, size_t end, uint32_t /*workerIndex*/)
 		{
-			auto& localGathered = gatherThreadScratch[workerIndex].gathered;
 			for (size_t i = begin; i < end; ++i)
 			{
-				GatheredInstance gathered{};
-				if (TryBuildGatheredInstance(registry, candidates[i], nullptr, gathered))
-				{
-					localGathered.push_back(std::move(gathered));
-				}
+				gatheredBuiltScratch[i] = TryBuildGatheredInstance(registry, candidates[i], nullptr, gatheredScratch[i]) ? 1 : 0;
 			}
 		});
 
-		for (size_t slot = 0; slot < workerSlots; ++slot)
+		for (size_t i = 0; i < candidates.size(); ++i)
 		{
-			AppendGatheredInstances(gatherThreadScratch[slot].gathered);
+			if (gatheredBuiltScratch[i])
+			{
+				AppendGatheredInstance(gatheredScratch[i]);
+			}
 		}
 	}
 
-	void VulkanIndexDraw::BuildFullScenePacket(Scene& scene)
+	void VulkanIndexDraw::GatherCandidatesFullScene(Scene& scene)
 	{
-		entt::registry& registry = scene.GetRegistry();
+		SWIM_PROFILE_FUNCTION();
 
-		SyncWorldRenderableSlots(scene);
+		entt::registry& registry = scene.GetRegistry();
 
 		gatherCandidatesScratch.clear();
 		gatherCandidatesScratch.reserve(worldRenderableSlots.size());
 
-		for (const WorldRenderableSlot& slot : worldRenderableSlots)
+		for (uint32_t slotIndex = 0; slotIndex < static_cast<uint32_t>(worldRenderableSlots.size()); ++slotIndex)
 		{
+			const WorldRenderableSlot& slot = worldRenderableSlots[slotIndex];
 			if (!slot.active)
 			{
 				continue;
@@ -615,58 +769,26 @@ namespace Engine
 				continue;
 			}
 
-			const Transform& tf = registry.get<Transform>(slot.entity);
-
+			// Nothing gets frustum tested, so the matrix is left out
 			GatherCandidate candidate{};
 			candidate.entity = slot.entity;
 			candidate.material = slot.material;
-			candidate.worldMatrix = tf.GetWorldMatrix(registry);
-			candidate.worldVersion = tf.GetWorldVersion();
-			candidate.transformSpace = tf.GetTransformSpace();
+			candidate.slotIndex = slotIndex;
+			candidate.transformSpace = TransformSpace::World;
 			candidate.canUseEntityCullCache = false;
-			gatherCandidatesScratch.push_back(std::move(candidate));
+			gatherCandidatesScratch.push_back(candidate);
 		}
 
-		for (uint32_t meshID : activeMeshBucketKeys)
-		{
-			meshBuckets[meshID].instances.clear();
-		}
-		activeMeshBucketKeys.clear();
-
 		ProcessGatherCandidates(registry, gatherCandidatesScratch, nullptr);
-
-		fullScenePacketScene = &scene;
-		fullScenePacketRenderablesRevision = scene.GetRenderablesRevision();
-		++fullScenePacketVersion;
-		fullScenePacketValid = true;
-	}
-
-
-	bool VulkanIndexDraw::UpdateFullScenePacketDirtyEntities(Scene& scene)
-	{
-		(void)scene;
-		return false;
-	}
-
-
-	bool VulkanIndexDraw::PatchFullScenePacketFrame(uint32_t frameIndex)
-	{
-		(void)frameIndex;
-		return false;
-	}
-
-
-	void VulkanIndexDraw::UploadFullScenePacket(uint32_t frameIndex, Scene& scene)
-	{
-		BuildFullScenePacket(scene);
-		UploadAndBatchInstances(frameIndex);
 	}
 
 
 	void VulkanIndexDraw::UpdateInstanceBuffer(uint32_t frameIndex)
 	{
+		SWIM_PROFILE_FUNCTION();
+
 		meshDecoratorInstanceData.clear();
-		msdfInstancesData.clear();
+		occlusionRanThisFrame = false;
 
 		const std::shared_ptr<Scene>& scene = SwimEngine::GetInstance()->GetSceneSystem()->GetActiveScene();
 		entt::registry& registry = scene->GetRegistry();
@@ -680,38 +802,52 @@ namespace Engine
 		}
 
 		SyncWorldRenderableSlots(*scene);
+		UpdateWorldSlotInstances(*scene);
 
-		for (uint32_t meshID : activeMeshBucketKeys)
-		{
-			meshBuckets[meshID].instances.clear();
-		}
-		activeMeshBucketKeys.clear();
-		cpuInstanceData.clear();
+		// The full scene packet holds everything in the frustum, occluders make the visible set change without anything in it moving
+		const bool hasOccluders = useOcclusionCulling && !registry.view<Occluder>().empty();
+		const bool fullScene = !hasOccluders && CanUseFullScenePacket(*scene, frustum);
 
-		if (CanUseFullScenePacket(*scene, frustum))
+		if (!fullScene || !IsFullScenePacketCurrent(*scene))
 		{
-			UploadFullScenePacket(frameIndex, *scene);
-			return;
-		}
+			worldPacketBuilder.Clear();
+			packetSlotScratch.clear();
 
-		if (cullMode == CullMode::CPU && frustum && useQueriedFrustumSceneBVH)
-		{
-			GatherCandidatesBVH(*scene, *frustum);
-		}
-		else
-		{
-			GatherCandidatesView(registry, TransformSpace::World, frustum);
+			if (fullScene)
+			{
+				GatherCandidatesFullScene(*scene);
+			}
+			else if (cullMode == CullMode::CPU && frustum && useQueriedFrustumSceneBVH)
+			{
+				GatherCandidatesBVH(*scene, *frustum);
+			}
+			else
+			{
+				GatherCandidatesView(registry, TransformSpace::World, frustum);
+			}
+
+			BuildWorldPacket();
+
+			fullScenePacketValid = fullScene;
+			fullScenePacketScene = scene.get();
+			fullScenePacketRenderablesRevision = scene->GetRenderablesRevision();
+			fullScenePacketEngineState = SwimEngine::GetInstance()->GetEngineState();
 		}
 
-		UploadAndBatchInstances(frameIndex);
+		UploadWorldInstances(frameIndex);
 	}
 
 
 	void VulkanIndexDraw::GatherCandidatesBVH(Scene& scene, const Frustum& frustum)
 	{
+		SWIM_PROFILE_FUNCTION();
+
 		entt::registry& registry = scene.GetRegistry();
+		SceneBVH* sceneBVH = scene.GetSceneBVH();
 		visibleEntityScratch.clear();
-		scene.GetSceneBVH()->QueryFrustumParallel(frustum, visibleEntityScratch);
+		sceneBVH->QueryFrustumParallel(frustum, visibleEntityScratch);
+
+		const bool testOcclusion = PrepareOcclusionBuffer(scene);
 
 		gatherCandidatesScratch.clear();
 		gatherCandidatesScratch.reserve(visibleEntityScratch.size() * 2);
@@ -743,8 +879,17 @@ namespace Engine
 				continue;
 			}
 
+			// Occluders are never tested, their box sits inside their own bounds and could hide them through float error
+			if (testOcclusion && !registry.any_of<Occluder>(entity))
+			{
+				AABB bounds;
+				if (sceneBVH->TryGetEntityAABB(entity, bounds) && !occlusionBuffer.IsVisible(bounds.min, bounds.max))
+				{
+					continue;
+				}
+			}
+
 			const Transform& tf = registry.get<Transform>(entity);
-			const glm::mat4& world = tf.GetWorldMatrix(registry);
 
 			for (uint32_t slotIndex : slotIt->second)
 			{
@@ -754,19 +899,20 @@ namespace Engine
 				}
 
 				const WorldRenderableSlot& slot = worldRenderableSlots[slotIndex];
-				if (!slot.active || !slot.material)
+				if (!slot.active || !slot.material.IsValid())
 				{
 					continue;
 				}
 
+				// Already frustum tested by the BVH, so the matrix is left out
 				GatherCandidate candidate{};
 				candidate.entity = entity;
 				candidate.material = slot.material;
-				candidate.worldMatrix = world;
+				candidate.slotIndex = slotIndex;
 				candidate.worldVersion = tf.GetWorldVersion();
 				candidate.transformSpace = tf.GetTransformSpace();
 				candidate.canUseEntityCullCache = false;
-				gatherCandidatesScratch.push_back(std::move(candidate));
+				gatherCandidatesScratch.push_back(candidate);
 			}
 		}
 
@@ -774,14 +920,58 @@ namespace Engine
 	}
 
 
+	bool VulkanIndexDraw::PrepareOcclusionBuffer(Scene& scene)
+	{
+		if (!useOcclusionCulling)
+		{
+			return false;
+		}
+
+		entt::registry& registry = scene.GetRegistry();
+		auto occluders = registry.view<Occluder, Transform>();
+		if (occluders.begin() == occluders.end())
+		{
+			return false;
+		}
+
+		SWIM_PROFILE_FUNCTION();
+
+		std::shared_ptr<CameraSystem> camera = scene.GetCameraSystem();
+		occlusionBuffer.Begin(camera->GetProjectionMatrix() * camera->GetViewMatrix());
+
+		for (entt::entity entity : occluders)
+		{
+			if (!scene.ShouldRenderBasedOnState(entity))
+			{
+				continue;
+			}
+
+			const Transform& tf = occluders.get<Transform>(entity);
+			if (tf.GetTransformSpace() != TransformSpace::World)
+			{
+				continue;
+			}
+
+			const Occluder& occluder = occluders.get<Occluder>(entity);
+			occlusionBuffer.AddOccluder(occluder.localMin, occluder.localMax, tf.GetWorldMatrix(registry));
+		}
+
+		occlusionBuffer.Rasterize();
+		occlusionRanThisFrame = true;
+
+		return occlusionBuffer.HasOccluders();
+	}
+
+
 	void VulkanIndexDraw::GatherCandidatesView(entt::registry& registry, const TransformSpace space, const Frustum* frustum)
 	{
 		auto& scene = SwimEngine::GetInstance()->GetSceneSystem()->GetActiveScene();
 		gatherCandidatesScratch.clear();
 		gatherCandidatesScratch.reserve(worldRenderableSlots.size());
 
-		for (const WorldRenderableSlot& slot : worldRenderableSlots)
+		for (uint32_t slotIndex = 0; slotIndex < static_cast<uint32_t>(worldRenderableSlots.size()); ++slotIndex)
 		{
+			const WorldRenderableSlot& slot = worldRenderableSlots[slotIndex];
 			if (!slot.active)
 			{
 				continue;
@@ -803,6 +993,7 @@ namespace Engine
 				GatherCandidate candidate{};
 				candidate.entity = slot.entity;
 				candidate.material = slot.material;
+				candidate.slotIndex = slotIndex;
 				candidate.worldMatrix = tf.GetWorldMatrix(registry);
 				candidate.worldVersion = tf.GetWorldVersion();
 				candidate.transformSpace = tf.GetTransformSpace();
@@ -815,125 +1006,80 @@ namespace Engine
 	}
 
 
-	void VulkanIndexDraw::AddInstance(entt::registry& registry, entt::entity entity, const Transform& transform, const std::shared_ptr<MaterialData>& mat, const Frustum* frustum)
+	void VulkanIndexDraw::BuildWorldPacket()
 	{
-		GatherCandidate candidate{};
-		candidate.entity = entity;
-		candidate.material = mat;
-		candidate.worldMatrix = transform.GetWorldMatrix(registry);
-		candidate.worldVersion = transform.GetWorldVersion();
-		candidate.transformSpace = transform.GetTransformSpace();
-		candidate.canUseEntityCullCache = registry.any_of<FrustumCullCache>(entity) && !registry.any_of<CompositeMaterial>(entity);
+		SWIM_PROFILE_FUNCTION();
 
-		GatheredInstance gathered{};
-		if (TryBuildGatheredInstance(registry, candidate, frustum, gathered))
-		{
-			AppendGatheredInstance(gathered);
-		}
-	}
+		worldPacketBuilder.Sort();
 
-	void VulkanIndexDraw::UploadAndBatchInstances(uint32_t frameIndex)
-	{
-		worldDrawCommands.clear();
-		cpuInstanceData.clear();
+		const size_t instanceCount = worldPacketBuilder.GetInstanceCount();
+		drawCommandScratch.resize(worldPacketBuilder.GetCommandCount());
+		packetSourceScratch.resize(instanceCount);
+		visibleSlotScratch.resize(instanceCount);
 
-		std::sort(activeMeshBucketKeys.begin(), activeMeshBucketKeys.end());
+		// The builder's command layout is asserted to match VkDrawIndexedIndirectCommand, so it writes straight into the Vulkan array
+		DrawPacketOutput output{};
+		output.commands = reinterpret_cast<DrawIndexedCommand*>(drawCommandScratch.data());
+		output.sourceIndices = packetSourceScratch.data();
+		worldPacketBuilder.Build(output, false);
 
-		size_t totalWorldInstances = 0;
-		for (uint32_t meshID : activeMeshBucketKeys)
+		for (size_t i = 0; i < instanceCount; ++i)
 		{
-			totalWorldInstances += meshBuckets[meshID].instances.size();
+			visibleSlotScratch[i] = packetSlotScratch[packetSourceScratch[i]];
 		}
 
-		cpuInstanceData.resize(totalWorldInstances);
-		worldDrawCommands.reserve(activeMeshBucketKeys.size());
-		bucketFirstInstanceScratch.resize(activeMeshBucketKeys.size(), 0);
+		const bool sameCommands = drawCommandScratch.size() == worldDrawCommands.size()
+			&& std::memcmp(drawCommandScratch.data(), worldDrawCommands.data(), drawCommandScratch.size() * sizeof(VkDrawIndexedIndirectCommand)) == 0;
 
-		uint32_t firstInstance = 0;
-		for (size_t i = 0; i < activeMeshBucketKeys.size(); ++i)
+		if (sameCommands && visibleSlotScratch == worldVisibleSlots)
 		{
-			MeshBucket& bucket = meshBuckets[activeMeshBucketKeys[i]];
-			if (bucket.instances.empty())
-			{
-				continue;
-			}
-
-			bucketFirstInstanceScratch[i] = firstInstance;
-
-			VkDrawIndexedIndirectCommand cmd{};
-			cmd.indexCount = bucket.indexCount;
-			cmd.instanceCount = static_cast<uint32_t>(bucket.instances.size());
-			cmd.firstIndex = static_cast<uint32_t>(bucket.indexOffsetInMegaBuffer / sizeof(uint32_t));
-			cmd.vertexOffset = static_cast<int32_t>(bucket.vertexOffsetInMegaBuffer / sizeof(Vertex));
-			cmd.firstInstance = firstInstance;
-			worldDrawCommands.push_back(cmd);
-
-			firstInstance += cmd.instanceCount;
+			return; // every frame already has this packet or gets it from the version it is missing
 		}
 
-		const bool allowParallelCopy = RenderCpuJobConfig::Enabled
-			&& totalWorldInstances >= RenderCpuJobConfig::MinParallelItemCount
-			&& activeMeshBucketKeys.size() >= 4
-			&& GetRenderParallelWorkerSlots() > 1;
+		worldDrawCommands.swap(drawCommandScratch);
+		worldVisibleSlots.swap(visibleSlotScratch);
+		++worldPacketVersion;
+	}
 
-		if (allowParallelCopy)
-		{
-			ParallelForRender(activeMeshBucketKeys.size(), 1, [&](size_t begin, size_t end, uint32_t workerIndex)
-			{
-				for (size_t i = begin; i < end; ++i)
-				{
-					const MeshBucket& bucket = meshBuckets[activeMeshBucketKeys[i]];
-					if (bucket.instances.empty())
-					{
-						continue;
-					}
+	void VulkanIndexDraw::UploadWorldInstances(uint32_t frameIndex)
+	{
+		SWIM_PROFILE_FUNCTION();
 
-					std::memcpy(
-						cpuInstanceData.data() + bucketFirstInstanceScratch[i],
-						bucket.instances.data(),
-						bucket.instances.size() * sizeof(GpuInstanceData)
-					);
-				}
-			});
-		}
-		else
-		{
-			for (size_t i = 0; i < activeMeshBucketKeys.size(); ++i)
-			{
-				const MeshBucket& bucket = meshBuckets[activeMeshBucketKeys[i]];
-				if (bucket.instances.empty())
-				{
-					continue;
-				}
+		// Every slot has a fixed place in the buffer whether it is visible or not
+		EnsureInstanceCapacity(*instanceBuffer, cpuInstanceData.size());
 
-				std::memcpy(
-					cpuInstanceData.data() + bucketFirstInstanceScratch[i],
-					bucket.instances.data(),
-					bucket.instances.size() * sizeof(GpuInstanceData)
-				);
-			}
+		// A recreated instance buffer (here or by the decorator pass) lost the slots of every frame
+		if (instanceBuffer->GetMaxInstances() != slotBufferCapacity)
+		{
+			slotUploader.MarkAllDirty();
+			slotBufferCapacity = instanceBuffer->GetMaxInstances();
 		}
 
-		// Ensure the per-frame instance buffer can hold the world instances
-		EnsureInstanceCapacity(*instanceBuffer, cpuInstanceData.size());
+		slotUploader.Flush(frameIndex, cpuInstanceData.data(), instanceBuffer->BeginFrame(frameIndex));
 
-		if (!cpuInstanceData.empty())
+		if (uploadedWorldPacketVersions[frameIndex] == worldPacketVersion)
 		{
-			void* dst = instanceBuffer->BeginFrame(frameIndex);
-			memcpy(dst, cpuInstanceData.data(), sizeof(GpuInstanceData) * cpuInstanceData.size());
+			return;
 		}
 
-		// Ensure indirect buffer capacity for world draws
 		EnsureIndirectCapacity(indirectCommandBuffers[frameIndex], worldDrawCommands.size());
+		EnsureVisibleSlotCapacity(visibleSlotBuffers[frameIndex], worldVisibleSlots.size());
 
-		if (!worldDrawCommands.empty())
+		const size_t commandBytes = worldDrawCommands.size() * sizeof(VkDrawIndexedIndirectCommand);
+		const size_t visibleBytes = worldVisibleSlots.size() * sizeof(uint32_t);
+
+		if (commandBytes > 0)
 		{
-			VulkanBuffer& indirectBuf = *indirectCommandBuffers[frameIndex];
-			indirectBuf.CopyData(worldDrawCommands.data(), worldDrawCommands.size() * sizeof(VkDrawIndexedIndirectCommand));
+			indirectCommandBuffers[frameIndex]->CopyData(worldDrawCommands.data(), commandBytes);
+			visibleSlotBuffers[frameIndex]->CopyData(worldVisibleSlots.data(), visibleBytes);
 		}
+
+		slotUploader.AddPacketBytes(commandBytes + visibleBytes);
+		uploadedWorldPacketVersions[frameIndex] = worldPacketVersion;
 	}
 
-	// Draws everything in world space that isn't decorated or requiring custom shaders that was processed into the command buffers via UploadAndBatchInstances()
+
+	// Draws everything in world space that isn't decorated or requiring custom shaders that was processed into the command buffers via UploadWorldInstances()
 	void VulkanIndexDraw::DrawIndexedWorldMeshes(uint32_t frameIndex, VkCommandBuffer cmd)
 	{
 		VkBuffer indirectBuf = indirectCommandBuffers[frameIndex]->GetBuffer();
@@ -948,7 +1094,7 @@ namespace Engine
 		vkCmdBindVertexBuffers(cmd, 0, 2, vertexBuffers, offsets);
 		vkCmdBindIndexBuffer(cmd, megaIndexBuffer->GetBuffer(), 0, VK_INDEX_TYPE_UINT32);
 
-		// UploadAndBatchInstances() already flattened all commands into indirect buffer, 
+		// UploadWorldInstances() already flattened all commands into indirect buffer, 
 		// so we can call vkCmdDrawIndexedIndirect once over entire buffer.
 
 		size_t totalCommands = worldDrawCommands.size();
@@ -1002,6 +1148,7 @@ namespace Engine
 			frustum,
 			instanceCount,
 			drawCommands,
+			sceneDecoratorCache,
 			true // run culling
 		);
 
@@ -1018,6 +1165,7 @@ namespace Engine
 				frustum,
 				instanceCount,
 				drawCommands,
+				debugDecoratorCache,
 				false // no culling
 			);
 		}
@@ -1111,25 +1259,41 @@ namespace Engine
 		const Frustum& frustum,
 		uint32_t& instanceCount,
 		std::vector<VkDrawIndexedIndirectCommand>& drawCommands,
+		ScreenSpaceDecoratorCache& cache,
 		bool cull
 	)
 	{
+		SWIM_PROFILE_FUNCTION();
+
 		// First cache screen scale
 		glm::vec2 screenScale = glm::vec2(
 			static_cast<float>(windowWidth) / Renderer::VirtualCanvasWidth,
 			static_cast<float>(windowHeight) / Renderer::VirtualCanvasHeight
 		);
 
+		const glm::uvec2 windowSize(windowWidth, windowHeight);
+
 		auto& scene = SwimEngine::GetInstance()->GetSceneSystem()->GetActiveScene();
 
+		// Entries are indexed by entity, which only means something inside the registry they were made for
+		if (cache.registry != &registry)
+		{
+			cache.registry = &registry;
+			cache.entries.clear();
+		}
+
+		// Everything that reaches outside the entity happens here on the render thread, world matrices get resolved lazily up the parent chain so the workers can't ask for them
+		decoratorCandidatesScratch.clear();
+		size_t cacheEntryCount = cache.entries.size();
+
 		registry.view<Transform, Material>().each(
 			[&](entt::entity entity, Transform& transform, Material& matComp)
 		{
-			bool hasDecorator = registry.any_of<MeshDecorator>(entity); // hopefully not too expensive
+			const MeshDecorator* decorator = registry.try_get<MeshDecorator>(entity);
 			TransformSpace space = transform.GetTransformSpace();
 
 			// We can render UI in world space if it has a decorator on it.
-			if (!hasDecorator && space != TransformSpace::Screen)
+			if (!decorator && space != TransformSpace::Screen)
 			{
 				return;
 			}
@@ -1140,29 +1304,48 @@ namespace Engine
 				return;
 			}
 
-			const glm::vec3& pos = transform.GetPosition(); // In virtual canvas units
-			const glm::vec3& scale = transform.GetScale();  // Width & height in virtual canvas units
+			DecoratorCandidate& candidate = decoratorCandidatesScratch.emplace_back();
+			candidate.entity = entity;
+			candidate.transform = &transform;
+			candidate.material = matComp.data.get();
+			candidate.decorator = decorator;
+			candidate.worldMatrix = transform.GetWorldMatrix(registry);
+			candidate.transformSpace = space;
+
+			if (space == TransformSpace::Screen)
+			{
+				cacheEntryCount = std::max<size_t>(cacheEntryCount, static_cast<size_t>(entt::to_entity(entity)) + 1);
+			}
+		});
+
+		// Sized up front, every worker then only touches the entries of its own candidates
+		cache.entries.resize(cacheEntryCount);
 
-			const std::shared_ptr<MaterialData>& mat = matComp.data;
+		const auto buildInstance = [&](const DecoratorCandidate& candidate, DecoratorInstance& out) -> bool
+		{
+			const TransformSpace space = candidate.transformSpace;
+			const glm::vec3& pos = candidate.transform->GetPosition(); // In virtual canvas units
+			const glm::vec3& scale = candidate.transform->GetScale();  // Width & height in virtual canvas units
+
+			const MaterialData* mat = candidate.material;
 			const MeshBufferData& mesh = *mat->mesh->meshBufferData;
-			const glm::mat4& model = transform.GetWorldMatrix(registry);
+			const glm::mat4& model = candidate.worldMatrix;
 
 			// First do a simple cull check 
 			if (cull)
 			{
 				if (space == TransformSpace::World)
 				{
-					if (registry.any_of<FrustumCullCache>(entity))
+					if (FrustumCullCache* cullCache = registry.try_get<FrustumCullCache>(candidate.entity))
 					{
-						auto& cache = registry.get<FrustumCullCache>(entity);
-						if (!frustum.IsVisibleCached(cache, glm::vec3(matComp.data->mesh->meshBufferData->aabbMin), glm::vec3(matComp.data->mesh->meshBufferData->aabbMax), model, transform.GetWorldVersion()))
+						if (!frustum.IsVisibleCached(*cullCache, glm::vec3(mesh.aabbMin), glm::vec3(mesh.aabbMax), model, candidate.transform->GetWorldVersion()))
 						{
-							return;
+							return false;
 						}
 					}
-					else if (!frustum.IsVisibleLazy(matComp.data->mesh->meshBufferData->aabbMin, matComp.data->mesh->meshBufferData->aabbMax, model))
+					else if (!frustum.IsVisibleLazy(mesh.aabbMin, mesh.aabbMax, model))
 					{
-						return;
+						return false;
 					}
 				}
 				else
@@ -1170,10 +1353,10 @@ namespace Engine
 					// Sceen space 2D check using window width and height with respect to world matrix scale and position values
 
 					// Extract translation (position) directly from the last column
-					const glm::vec3 worldPos = transform.GetWorldPosition(registry);
+					const glm::vec3 worldPos = glm::vec3(model[3]);
 
 					// Extract per-axis scale as lengths of the basis columns
-					const glm::vec3 worldScale = transform.GetWorldScale(registry);
+					const glm::vec3 worldScale(glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2])));
 
 					glm::vec2 halfSize = glm::vec2(worldScale) * 0.5f;
 					glm::vec2 center = glm::vec2(worldPos) * screenScale;
@@ -1185,23 +1368,21 @@ namespace Engine
 					// Clamp against the actual framebuffer
 					if (maxPx.x < 0.0f || maxPx.y < 0.0f)
 					{
-						return; // off left or bottom
+						return false; // off left or bottom
 					}
 
 					if (minPx.x > windowWidth || minPx.y > windowHeight)
 					{
-						return; // off right or top
+						return false; // off right or top
 					}
 				}
 			}
 
 			// === GpuInstanceData ===
-			GpuInstanceData instance{};
-			instance.model = model;
-			instance.space = static_cast<uint32_t>(space);
-
-			// The vertex shader then sets this on output.instanceID, which the fragment shader then uses for MeshDecoratorGpuInstanceData data = decoratorBuffer[paramIndex]
-			instance.materialIndex = instanceCount;
+			GpuInstanceData& instance = out.instance;
+			instance = GpuInstanceData{};
+			instance.SetModel(model);
+			instance.meshInfoIndex = mesh.GetMeshID();
 
 			// === MeshDecoratorGpuInstanceData ===
 			glm::vec2 pixelSize = glm::vec2(scale);
@@ -1237,15 +1418,16 @@ namespace Engine
 				);
 			}
 
-			MeshDecoratorGpuInstanceData data{};
+			MeshDecoratorGpuInstanceData& data = out.data;
+			data = MeshDecoratorGpuInstanceData{};
 
-			if (hasDecorator)
+			if (candidate.decorator)
 			{
-				MeshDecorator& deco = registry.get<MeshDecorator>(entity);
+				const MeshDecorator& deco = *candidate.decorator;
 
 				bool useTex = deco.useMaterialTexture && mat->albedoMap;
 
-				instance.hasTexture = useTex ? 1.0f : 0.0f;
+				instance.SetFlags(static_cast<uint32_t>(space), useTex);
 				instance.textureIndex = useTex ? mat->albedoMap->GetBindlessIndex() : 0;
 
 				glm::vec2 radiusPx;
@@ -1289,7 +1471,7 @@ namespace Engine
 			else
 			{
 				// If we have no decorator to determine special texture handling, then set it the regular way.
-				instance.hasTexture = mat->albedoMap ? 1.0f : 0.0f;
+				instance.SetFlags(static_cast<uint32_t>(space), mat->albedoMap != nullptr);
 				instance.textureIndex = mat->albedoMap ? mat->albedoMap->GetBindlessIndex() : 0;
 
 				// Meshes in screen space with no decorator need to be drawn with their meshes color, since fill color is a property of Decorator.
@@ -1309,63 +1491,143 @@ namespace Engine
 			data.resolution = glm::vec2(windowWidth, windowHeight);
 			data.quadSize = quadSizeInPixels;
 
+			out.mesh.meshID = mesh.GetMeshID();
+			out.mesh.indexCount = mesh.indexCount;
+			out.mesh.firstIndex = static_cast<uint32_t>(mesh.indexOffsetInMegaBuffer / sizeof(uint32_t));
+			out.mesh.vertexOffset = static_cast<int32_t>(mesh.vertexOffsetInMegaBuffer / sizeof(Vertex));
+
+			return true;
+		};
+
+		// Screen space candidates reuse their last result while nothing it was built from has changed
+		const auto gatherInstance = [&](const DecoratorCandidate& candidate, DecoratorInstance& out) -> bool
+		{
+			if (candidate.transformSpace != TransformSpace::Screen)
+			{
+				return buildInstance(candidate, out);
+			}
+
+			ScreenSpaceDecoratorCacheEntry& entry = cache.entries[entt::to_entity(candidate.entity)];
+			const Texture2D* albedoMap = candidate.material->albedoMap.get();
+			const MeshBufferData* mesh = candidate.material->mesh->meshBufferData.get();
+			const glm::vec3& scale = candidate.transform->GetScale();
+
+			const bool unchanged = entry.entity == candidate.entity
+				&& entry.cull == cull
+				&& entry.windowSize == windowSize
+				&& entry.material == candidate.material
+				&& entry.albedoMap == albedoMap
+				&& entry.mesh == mesh
+				&& entry.scale == scale
+				&& entry.worldMatrix == candidate.worldMatrix
+				&& entry.hasDecorator == (candidate.decorator != nullptr)
+				&& (!candidate.decorator || entry.decorator == *candidate.decorator);
+
+			if (!unchanged)
+			{
+				entry.entity = candidate.entity;
+				entry.cull = cull;
+				entry.windowSize = windowSize;
+				entry.material = candidate.material;
+				entry.albedoMap = albedoMap;
+				entry.mesh = mesh;
+				entry.scale = scale;
+				entry.worldMatrix = candidate.worldMatrix;
+				entry.hasDecorator = candidate.decorator != nullptr;
+				entry.decorator = candidate.decorator ? *candidate.decorator : MeshDecorator{};
+				entry.visible = buildInstance(candidate, entry.built);
+			}
+
+			if (entry.visible)
+			{
+				out = entry.built;
+			}
+
+			return entry.visible;
+		};
+
+		const size_t candidateCount = decoratorCandidatesScratch.size();
+		decoratorBuiltScratch.resize(candidateCount);
+		decoratorVisibleScratch.resize(candidateCount);
+
+		ParallelForRender(candidateCount, RenderCpuJobConfig::DefaultMinItemsPerChunk, [&](size_t begin, size_t end, uint32_t /*workerIndex*/)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				decoratorVisibleScratch[i] = gatherInstance(decoratorCandidatesScratch[i], decoratorBuiltScratch[i]) ? 1 : 0;
+			}
+		});
+
+		// Appended in view order, so the draw order is the same however the chunks were scheduled
+		for (size_t i = 0; i < candidateCount; ++i)
+		{
+			if (!decoratorVisibleScratch[i])
+			{
+				continue;
+			}
+
+			DecoratorInstance& built = decoratorBuiltScratch[i];
+
+			// The vertex shader then sets this on output.instanceID, which the fragment shader then uses for MeshDecoratorGpuInstanceData data = decoratorBuffer[paramIndex]
+			built.instance.materialIndex = instanceCount;
+
 			// Finally add
-			meshDecoratorInstanceData.push_back(data);
-			cpuInstanceData.push_back(instance);
+			meshDecoratorInstanceData.push_back(built.data);
+			cpuInstanceData.push_back(built.instance);
 
 			// === Draw command ===
 			VkDrawIndexedIndirectCommand cmd{};
-			cmd.indexCount = mesh.indexCount;
+			cmd.indexCount = built.mesh.indexCount;
 			cmd.instanceCount = 1;
-			cmd.firstIndex = static_cast<uint32_t>(mesh.indexOffsetInMegaBuffer / sizeof(uint32_t));
-			cmd.vertexOffset = static_cast<int32_t>(mesh.vertexOffsetInMegaBuffer / sizeof(Vertex));
+			cmd.firstIndex = built.mesh.firstIndex;
+			cmd.vertexOffset = built.mesh.vertexOffset;
 			cmd.firstInstance = static_cast<uint32_t>(cpuInstanceData.size() - 1); // latest one
 			drawCommands.push_back(cmd);
 
 			instanceCount++;
-		});
+		}
 	}
 
-	void VulkanIndexDraw::DrawIndexedMsdfText(uint32_t frameIndex, VkCommandBuffer cmd, TransformSpace space)
+	void VulkanIndexDraw::UpdateMsdfTextInstances(uint32_t frameIndex)
 	{
+		SWIM_PROFILE_FUNCTION();
+
+		msdfDrawCommands.clear();
+		msdfScreenCommandScratch.clear();
+		msdfWorldCommandCount = 0;
+
 		std::shared_ptr<SwimEngine> engine = SwimEngine::GetInstance();
-		auto scene = engine->GetSceneSystem()->GetActiveScene();
+		auto& scene = engine->GetSceneSystem()->GetActiveScene();
 		if (!scene) return;
 
-		auto& registry = scene->GetRegistry();
-		const CameraUBO& ubo = engine->GetVulkanRenderer()->GetCameraUBO();
-		const glm::mat4& view = engine->GetCameraSystem()->GetViewMatrix();
-		const glm::mat4& proj = engine->GetCameraSystem()->GetProjectionMatrix();
+		entt::registry& registry = scene->GetRegistry();
 
-		unsigned int ww = engine->GetWindowWidth();
-		unsigned int wh = engine->GetWindowHeight();
+		// Entity ids only mean something within one scene
+		if (msdfTextScene != scene.get())
+		{
+			msdfTextRanges.clear();
+			msdfInstancesData.clear();
+			msdfUploader.Resize(0);
+			msdfHoleCount = 0;
+			msdfTextScene = scene.get();
+		}
 
-		BuildMsdfInstancesForSpace(registry, space, ubo, view, proj, ww, wh, msdfInstancesData);
-		UploadAndDrawMsdfBatch(frameIndex, cmd, msdfInstancesData, msdfIndirectCommandBuffers[frameIndex]);
-	}
+		ReleaseMsdfTextRanges(registry);
 
-	// If we are in world space we should probably cull our quad against the camera frustum
-	void VulkanIndexDraw::BuildMsdfInstancesForSpace
-	(
-		entt::registry& registry,
-		TransformSpace space,
-		const CameraUBO& cameraUBO,
-		const glm::mat4& view,
-		const glm::mat4& proj,
-		unsigned int windowWidth,
-		unsigned int windowHeight,
-		std::vector<MsdfTextGpuInstanceData>& outInstances
-	)
-	{
-		auto& scene = SwimEngine::GetInstance()->GetSceneSystem()->GetActiveScene();
+		// The commands below need the quad's place in the mega buffers
+		EnsureGlyphQuadUploaded();
+
+		const unsigned int ww = engine->GetWindowWidth();
+		const unsigned int wh = engine->GetWindowHeight();
 
 		registry.view<Transform, TextComponent>().each(
 			[&](entt::entity entity, Transform& tf, TextComponent& tc)
 		{
-			if (tf.GetTransformSpace() != space) return;
+			const TransformSpace space = tf.GetTransformSpace();
+			if (space != TransformSpace::World && space != TransformSpace::Screen) return;
 			if (!tc.GetFont() || !tc.GetFont()->msdfAtlas) return;
 
-			// Skip what should not be rendered
+			// Skip what should not be rendered, its range stays resident until the text is gone
 			if (!scene->ShouldRenderBasedOnState(entity))
 			{
 				return;
@@ -1374,66 +1636,142 @@ namespace Engine
 			const FontInfo& fi = *tc.GetFont();
 			const uint32_t atlasIndex = tc.GetFont()->msdfAtlas->GetBindlessIndex();
 
-			MsdfTextGpuInstanceData s = (space == TransformSpace::Screen)
-				? BuildMsdfStateScreen(registry, tf, tc, fi, windowWidth, windowHeight, Renderer::VirtualCanvasWidth, Renderer::VirtualCanvasHeight, atlasIndex)
+			// One state per text, cheap next to the glyphs it would otherwise stamp every frame
+			const MsdfTextGpuInstanceData state = (space == TransformSpace::Screen)
+				? BuildMsdfStateScreen(registry, tf, tc, fi, ww, wh, Renderer::VirtualCanvasWidth, Renderer::VirtualCanvasHeight, atlasIndex)
 				: BuildMsdfStateWorld(registry, tf, tc, fi, atlasIndex);
 
-			EmitMsdf(tc, fi, s, [&](uint32_t /*lineIdx*/, const GlyphQuad& q, const MsdfTextGpuInstanceData& st)
+			// Has to be asked before GetGlyphQuads lays the text out again
+			const bool relayout = tc.IsGlyphLayoutDirty();
+			const std::vector<GlyphQuad>& quads = tc.GetGlyphQuads();
+
+			auto [it, inserted] = msdfTextRanges.try_emplace(entity);
+			MsdfTextRange& range = it->second;
+
+			bool rewrite = inserted || relayout || std::memcmp(&range.state, &state, sizeof(MsdfTextGpuInstanceData)) != 0;
+
+			// Outgrew its range, move to the end and leave the old one as a hole
+			if (quads.size() > range.capacity)
+			{
+				msdfHoleCount += range.capacity;
+				range.first = static_cast<uint32_t>(msdfInstancesData.size());
+				range.capacity = static_cast<uint32_t>(quads.size());
+				msdfInstancesData.resize(msdfInstancesData.size() + quads.size());
+				msdfUploader.Resize(msdfInstancesData.size());
+				rewrite = true;
+			}
+
+			if (rewrite)
+			{
+				range.state = state;
+				range.count = static_cast<uint32_t>(quads.size());
+
+				for (uint32_t i = 0; i < range.count; ++i)
+				{
+					MsdfTextGpuInstanceData& inst = msdfInstancesData[range.first + i];
+					inst = state;
+					inst.plane = quads[i].plane;
+					inst.uvRect = quads[i].uv;
+					msdfUploader.MarkDirty(range.first + i);
+				}
+			}
+
+			if (range.count == 0)
 			{
-				MsdfTextGpuInstanceData inst = st;
-				inst.plane = q.plane;
-				inst.uvRect = q.uv;
-				outInstances.push_back(inst);
-			});
+				return;
+			}
+
+			VkDrawIndexedIndirectCommand cmd{};
+			cmd.indexCount = glyphQuadMesh.indexCount;
+			cmd.instanceCount = range.count;
+			cmd.firstIndex = static_cast<uint32_t>(glyphQuadMesh.indexOffsetInMegaBuffer / sizeof(uint32_t));
+			cmd.vertexOffset = static_cast<int32_t>(glyphQuadMesh.vertexOffsetInMegaBuffer / sizeof(Vertex));
+			cmd.firstInstance = range.first; // the text shader reads gMsdfParams[SV_InstanceID], which counts from firstInstance
+			(space == TransformSpace::World ? msdfDrawCommands : msdfScreenCommandScratch).push_back(cmd);
 		});
+
+		msdfWorldCommandCount = static_cast<uint32_t>(msdfDrawCommands.size());
+		msdfDrawCommands.insert(msdfDrawCommands.end(), msdfScreenCommandScratch.begin(), msdfScreenCommandScratch.end());
+
+		if (msdfDrawCommands.empty())
+		{
+			return;
+		}
+
+		auto& dm = engine->GetVulkanRenderer()->GetDescriptorManager();
+		dm->EnsurePerFrameMsdfCapacity(msdfInstancesData.size() * sizeof(MsdfTextGpuInstanceData));
+
+		// Recreated buffers lost the ranges of every frame
+		VulkanBuffer* msdfBuffer = dm->GetMsdfBufferForFrame(frameIndex);
+		if (msdfBuffer->GetSize() != msdfBufferCapacity)
+		{
+			msdfUploader.MarkAllDirty();
+			msdfBufferCapacity = msdfBuffer->GetSize();
+		}
+
+		msdfUploader.Flush(frameIndex, msdfInstancesData.data(), msdfBuffer->GetMappedPointer());
+
+		EnsureIndirectCapacity(msdfIndirectCommandBuffers[frameIndex], msdfDrawCommands.size());
+		msdfIndirectCommandBuffers[frameIndex]->CopyData(msdfDrawCommands.data(), msdfDrawCommands.size() * sizeof(VkDrawIndexedIndirectCommand));
 	}
 
-	void VulkanIndexDraw::UploadAndDrawMsdfBatch
-	(
-		uint32_t frameIndex,
-		VkCommandBuffer cmd,
-		const std::vector<MsdfTextGpuInstanceData>& instances,
-		std::unique_ptr<VulkanBuffer>& outIndirectBuf
-	)
+	void VulkanIndexDraw::ReleaseMsdfTextRanges(entt::registry& registry)
 	{
-		if (instances.empty()) return;
+		for (auto it = msdfTextRanges.begin(); it != msdfTextRanges.end();)
+		{
+			if (registry.valid(it->first) && registry.all_of<Transform, TextComponent>(it->first))
+			{
+				++it;
+				continue;
+			}
 
-		auto engine = SwimEngine::GetInstance();
-		auto renderer = engine->GetVulkanRenderer();
-		auto& pm = renderer->GetPipelineManager();
-		auto& dm = renderer->GetDescriptorManager();
+			msdfHoleCount += it->second.capacity;
+			it = msdfTextRanges.erase(it);
+		}
 
-		// 0) Ensure the unit glyph quad exists in the mega buffers
-		EnsureGlyphQuadUploaded();
+		if (msdfHoleCount >= kMinMsdfHolesBeforeCompact && msdfHoleCount * 2 >= msdfInstancesData.size())
+		{
+			CompactMsdfTextRanges();
+		}
+	}
+
+	void VulkanIndexDraw::CompactMsdfTextRanges()
+	{
+		SWIM_PROFILE_FUNCTION();
 
-		// 0.5) Ensure per-frame MSDF SSBO capacity
-		const size_t msdfBytes = instances.size() * sizeof(MsdfTextGpuInstanceData);
-		dm->EnsurePerFrameMsdfCapacity(msdfBytes);
+		std::vector<MsdfTextGpuInstanceData> packed;
+		packed.reserve(msdfInstancesData.size() - msdfHoleCount);
 
-		// 1) Upload the MSDF instance data to the per-frame descriptor buffer
-		dm->UpdatePerFrameMsdfBuffer(
-			frameIndex,
-			instances.data(),
-			msdfBytes
-		);
+		for (auto& [entity, range] : msdfTextRanges)
+		{
+			const uint32_t first = static_cast<uint32_t>(packed.size());
+			packed.insert(packed.end(), msdfInstancesData.begin() + range.first, msdfInstancesData.begin() + range.first + range.capacity);
+			range.first = first;
+		}
 
-		// 2) Build the indirect command for the glyph quad (same mesh used for all glyphs)
-		VkDrawIndexedIndirectCommand cmdInfo{};
-		cmdInfo.indexCount = glyphQuadMesh.indexCount;
-		cmdInfo.instanceCount = static_cast<uint32_t>(instances.size());
-		cmdInfo.firstIndex = static_cast<uint32_t>(glyphQuadMesh.indexOffsetInMegaBuffer / sizeof(uint32_t));
-		cmdInfo.vertexOffset = static_cast<int32_t>(glyphQuadMesh.vertexOffsetInMegaBuffer / sizeof(Vertex));
-		cmdInfo.firstInstance = 0;
+		msdfInstancesData.swap(packed);
+		msdfHoleCount = 0;
 
-		// Ensure indirect buffer capacity for a single command
-		EnsureIndirectCapacity(outIndirectBuf, 1);
+		// Every range moved, so every frame writes the whole buffer once
+		msdfUploader.Resize(msdfInstancesData.size());
+		msdfUploader.MarkAllDirty();
+	}
 
-		outIndirectBuf->CopyData(&cmdInfo, sizeof(VkDrawIndexedIndirectCommand));
+	void VulkanIndexDraw::DrawIndexedMsdfText(uint32_t frameIndex, VkCommandBuffer cmd, TransformSpace space)
+	{
+		const uint32_t firstCommand = (space == TransformSpace::World) ? 0 : msdfWorldCommandCount;
+		const uint32_t commandCount = (space == TransformSpace::World) ? msdfWorldCommandCount : static_cast<uint32_t>(msdfDrawCommands.size()) - msdfWorldCommandCount;
+		if (commandCount == 0) return;
 
-		// 3) Bind MSDF text pipeline
+		auto engine = SwimEngine::GetInstance();
+		auto renderer = engine->GetVulkanRenderer();
+		auto& pm = renderer->GetPipelineManager();
+		auto& dm = renderer->GetDescriptorManager();
+
+		// 1) Bind MSDF text pipeline
 		vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pm->GetMsdfTextPipeline());
 
-		// 4) Bind descriptor sets
+		// 2) Bind descriptor sets
 		std::array<VkDescriptorSet, 2> descriptorSets = {
 						dm->GetPerFrameDescriptorSet(frameIndex),
 						dm->GetBindlessSet()
@@ -1450,7 +1788,7 @@ namespace Engine
 			nullptr
 		);
 
-		// 5) Bind vertex and index buffers
+		// 3) Bind vertex and index buffers
 		VkBuffer vertexBuffers[] = {
 						megaVertexBuffer->GetBuffer()
 		};
@@ -1459,12 +1797,12 @@ namespace Engine
 		vkCmdBindVertexBuffers(cmd, 0, 1, vertexBuffers, offsets);
 		vkCmdBindIndexBuffer(cmd, megaIndexBuffer->GetBuffer(), 0, VK_INDEX_TYPE_UINT32);
 
-		// 6) Issue indirect draw
+		// 4) Issue the indirect draws of this space, one per text
 		vkCmdDrawIndexedIndirect(
 			cmd,
-			outIndirectBuf->GetBuffer(),
-			0,
-			1,
+			msdfIndirectCommandBuffers[frameIndex]->GetBuffer(),
+			firstCommand * sizeof(VkDrawIndexedIndirectCommand),
+			commandCount,
 			sizeof(VkDrawIndexedIndirectCommand)
 		);
 	}
@@ -1540,7 +1878,22 @@ namespace Engine
 		cpuInstanceData.clear();
 		meshDecoratorInstanceData.clear();
 		msdfInstancesData.clear();
-		culledVisibleData.clear();
+		msdfTextRanges.clear();
+		msdfDrawCommands.clear();
+		msdfWorldCommandCount = 0;
+		msdfTextScene = nullptr;
+		for (auto& buffer : visibleSlotBuffers)
+		{
+			if (buffer)
+			{
+				buffer->Free();
+				buffer.reset();
+			}
+		}
+		visibleSlotBuffers.clear();
+
+		worldDrawCommands.clear();
+		worldVisibleSlots.clear();
 		worldRenderableSlots.clear();
 		worldRenderableFreeSlots.clear();
 		worldRenderableKeyToSlot.clear();
@@ -3,10 +3,15 @@
 #include "Buffers/VulkanInstanceBuffer.h"
 #include "Buffers/VulkanGpuInstanceData.h"
 #include "Engine/Systems/Renderer/Core/Meshes/Mesh.h"
+#include "Engine/Systems/Renderer/Core/Meshes/DrawPacketBuilder.h"
+#include "Engine/Systems/Renderer/Core/Meshes/InstanceSlotUploader.h"
 #include "Engine/Systems/Renderer/Core/Material/MaterialData.h"
+#include "Engine/Systems/Renderer/Core/Camera/OcclusionBuffer.h"
+#include "Engine/Components/MeshDecorator.h"
+#include "Engine/EngineState.h"
 #include "Library/EnTT/entt.hpp"
 
-#include <deque>
+#include <type_traits>
 #include <unordered_map>
 #include <memory>
 
@@ -44,6 +49,9 @@ namespace Engine
 
 		void DrawIndexedScreenSpaceAndDecoratedMeshes(uint32_t frameIndex, VkCommandBuffer cmd);
 
+		// Brings the resident glyph instances of every text up to date and uploads what this frame has not seen, before either text draw
+		void UpdateMsdfTextInstances(uint32_t frameIndex);
+
 		void DrawIndexedMsdfText(uint32_t frameIndex, VkCommandBuffer cmd, TransformSpace space);
 
 		void CleanUp();
@@ -56,18 +64,33 @@ namespace Engine
 		// Major performance booster
 		void SetUseQueriedFrustumSceneBVH(bool value) { useQueriedFrustumSceneBVH = value; }
 
-		uint32_t GetInstanceCount() const { return static_cast<uint32_t>(cpuInstanceData.size()); }
+		// Tests what survived the BVH frustum query against a software depth buffer of the Occluder entities, only does anything if the scene has some
+		void SetUseOcclusionCulling(bool value) { useOcclusionCulling = value; }
+		bool GetUseOcclusionCulling() const { return useOcclusionCulling; }
+
+		// Counters from the last frame that ran occlusion culling, zeroed on frames that did not
+		OcclusionBuffer::Stats GetOcclusionStats() const { return occlusionRanThisFrame ? occlusionBuffer.GetStats() : OcclusionBuffer::Stats{}; }
+
+		// World instances drawn last frame
+		uint32_t GetInstanceCount() const { return static_cast<uint32_t>(worldVisibleSlots.size()); }
+
+		// Bytes the last frame wrote into its instance, visible slot and indirect buffers
+		const InstanceSlotUploader::Stats& GetInstanceUploadStats() const { return slotUploader.GetStats(); }
+
+		const std::vector<std::unique_ptr<VulkanBuffer>>& GetVisibleSlotBuffers() const { return visibleSlotBuffers; }
 
 	private:
 
 		struct GatherCandidate;
 		struct GatheredInstance;
+		struct ScreenSpaceDecoratorCache;
 
 		struct WorldRenderableSlot
 		{
 			entt::entity entity{ entt::null };
 			uint32_t subMaterialIndex = 0;
-			std::shared_ptr<MaterialData> material;
+			MaterialHandle material;
+			uint32_t textureIndex = UINT32_MAX; // bindless
 			uint32_t meshID = 0;
 			uint32_t indexCount = 0;
 			VkDeviceSize vertexOffsetInMegaBuffer = 0;
@@ -77,6 +100,14 @@ namespace Engine
 			bool active = false;
 		};
 
+		// A slot whose instance gets rewritten, with its world matrix already resolved on the render thread so the workers writing instances only read
+		struct SlotInstanceSource
+		{
+			uint32_t slotIndex = 0;
+			TransformSpace transformSpace = TransformSpace::World;
+			const glm::mat4* worldMatrix = nullptr; // the Transform's cache, nothing writes Transforms while the instances are written
+		};
+
 		// Helpers for stable renderable slots + immutable per-frame prep
 		static uint64_t MakeWorldRenderableKey(entt::entity entity, uint32_t subMaterialIndex);
 		uint32_t AcquireWorldRenderableSlot();
@@ -91,24 +122,26 @@ namespace Engine
 		void RebuildWorldRenderableSlots(Scene& scene);
 		void SyncWorldRenderableSlots(Scene& scene);
 
-		// Helpers for instance buffer update
-		void BuildFullScenePacket(Scene& scene);
+		// Helpers for the persistent per slot instance data
+		void AddSlotInstanceSource(entt::registry& registry, uint32_t slotIndex);
+		bool WriteWorldSlotInstance(const SlotInstanceSource& source);
+		void WriteSlotInstanceSources();
+		void RefreshAllWorldSlotInstances(Scene& scene);
+		void UpdateWorldSlotInstances(Scene& scene);
+
+		// Helpers for the visible slot list and draw commands
 		bool CanUseFullScenePacket(const Scene& scene, const Frustum* frustum) const;
-		bool UpdateFullScenePacketDirtyEntities(Scene& scene);
-		bool PatchFullScenePacketFrame(uint32_t frameIndex);
-		void UploadFullScenePacket(uint32_t frameIndex, Scene& scene);
+		bool IsFullScenePacketCurrent(const Scene& scene) const;
+		void GatherCandidatesFullScene(Scene& scene);
 		void GatherCandidatesBVH(Scene& scene, const Frustum& frustum);
+		bool PrepareOcclusionBuffer(Scene& scene);
 		void GatherCandidatesView(entt::registry& registry, const TransformSpace space, const Frustum* frustum);
-		void AddInstance(entt::registry& registry, entt::entity entity, const Transform& transform, const std::shared_ptr<MaterialData>& mat, const Frustum* frustum);
 		bool TryBuildGatheredInstance(entt::registry& registry, const struct GatherCandidate& candidate, const Frustum* frustum, struct GatheredInstance& outInstance) const;
 		void AppendGatheredInstance(const struct GatheredInstance& gathered);
-		void AppendGatheredInstances(const std::vector<struct GatheredInstance>& gatheredInstances);
 		void ProcessGatherCandidates(entt::registry& registry, const std::vector<struct GatherCandidate>& candidates, const Frustum* frustum);
-		void EnsureGatherThreadScratch(size_t workerSlots, size_t reservePerSlot);
 		void EnsureDirtyThreadScratch(size_t workerSlots, size_t reservePerSlot);
-		void UploadAndBatchInstances(uint32_t frameIndex);
-		bool CanReuseCachedWorldPacket(const Scene& scene, const Frustum* frustum) const;
-		void UploadCachedWorldPacketToFrame(uint32_t frameIndex);
+		void BuildWorldPacket();
+		void UploadWorldInstances(uint32_t frameIndex);
 
 		void GrowMegaBuffers(VkDeviceSize additionalVertexSize, VkDeviceSize additionalIndexSize);
 
@@ -120,6 +153,12 @@ namespace Engine
 			size_t commandCount
 		);
 
+		void EnsureVisibleSlotCapacity
+		(
+			std::unique_ptr<VulkanBuffer>& buf,
+			size_t slotCount
+		);
+
 		void DrawDecoratorsAndScreenSpaceEntitiesInRegistry
 		(
 			entt::registry& registry,
@@ -130,73 +169,72 @@ namespace Engine
 			const Frustum& frustum,
 			uint32_t& instanceCount,
 			std::vector<VkDrawIndexedIndirectCommand>& drawCommands,
+			ScreenSpaceDecoratorCache& cache,
 			bool cull
 		);
 
 		// Ensure the static glyph quad exists in mega buffers
 		void EnsureGlyphQuadUploaded();
 
-		// Build MSDF instances for the given space (World or Screen)
-		void BuildMsdfInstancesForSpace(
-			entt::registry& registry,
-			TransformSpace space,
-			const CameraUBO& cameraUBO,
-			const glm::mat4& view,
-			const glm::mat4& proj,
-			unsigned int windowWidth,
-			unsigned int windowHeight,
-			std::vector<MsdfTextGpuInstanceData>& outInstances
-		);
-
-		// upload + draw for a batch of glyphs
-		void UploadAndDrawMsdfBatch(
-			uint32_t frameIndex,
-			VkCommandBuffer cmd,
-			const std::vector<MsdfTextGpuInstanceData>& instances,
-			std::unique_ptr<VulkanBuffer>& outIndirectBuf
-		);
+		// Frees the ranges of texts that are gone and packs the rest once enough of the buffer is holes
+		void ReleaseMsdfTextRanges(entt::registry& registry);
+		void CompactMsdfTextRanges();
 
 		VkDevice device;
 		VkPhysicalDevice physicalDevice;
 
-		// Draw data instance buffer per frame
+		// Draw data instance buffer per frame, world instances sit at their renderable slot index and decorators are appended behind the slots
 		std::unique_ptr<VulkanInstanceBuffer> instanceBuffer;
 
-		// Draw data instances to feed the buffers per frame
+		// Per frame list of the slots to draw, grouped by mesh like the indirect commands. The world vertex shader reads its instance through it.
+		std::vector<std::unique_ptr<VulkanBuffer>> visibleSlotBuffers;
+
+		// CPU copy of the instance buffer, only slots that changed get written to each frame's buffer
 		std::vector<GpuInstanceData> cpuInstanceData;
 		std::vector<MeshDecoratorGpuInstanceData> meshDecoratorInstanceData;
 		std::vector<MsdfTextGpuInstanceData> msdfInstancesData;
 
-		struct MeshBucket
+		// Every text keeps its glyph instances at a fixed range of msdfInstancesData (one buffer for both spaces).
+		// A range is only rewritten after a relayout or when the per text state (transform, colors, window scale) changed.
+		struct MsdfTextRange
 		{
-			uint32_t indexCount = 0;
-			VkDeviceSize vertexOffsetInMegaBuffer = 0;
-			VkDeviceSize indexOffsetInMegaBuffer = 0;
-			std::vector<GpuInstanceData> instances;
+			uint32_t first = 0;
+			uint32_t count = 0;
+			uint32_t capacity = 0;
+			MsdfTextGpuInstanceData state{}; // plane and uvRect left zero
 		};
 
+		static constexpr uint32_t kMinMsdfHolesBeforeCompact = 1024;
+
+		InstanceSlotUploader msdfUploader;
+		const Scene* msdfTextScene = nullptr;
+		std::unordered_map<entt::entity, MsdfTextRange> msdfTextRanges;
+		uint32_t msdfHoleCount = 0;
+		size_t msdfBufferCapacity = 0;
+
+		// One command per visible text, the world ones first, then screen
+		std::vector<VkDrawIndexedIndirectCommand> msdfDrawCommands;
+		uint32_t msdfWorldCommandCount = 0;
+		std::vector<VkDrawIndexedIndirectCommand> msdfScreenCommandScratch;
+
 		struct GatherCandidate
 		{
 			entt::entity entity{ entt::null };
-			std::shared_ptr<MaterialData> material;
+			MaterialHandle material;
+			uint32_t slotIndex = 0;
 			glm::mat4 worldMatrix{ 1.0f };
 			uint64_t worldVersion = 0;
 			TransformSpace transformSpace = TransformSpace::World;
 			bool canUseEntityCullCache = false;
 		};
 
-		struct GatheredInstance
-		{
-			uint32_t meshID = 0;
-			uint32_t indexCount = 0;
-			VkDeviceSize vertexOffsetInMegaBuffer = 0;
-			VkDeviceSize indexOffsetInMegaBuffer = 0;
-			GpuInstanceData instance{};
-		};
+		// Built for every visible instance every frame, across the render workers, so it has to stay plain data
+		static_assert(std::is_trivially_copyable_v<GatherCandidate>, "GatherCandidate must stay trivially copyable");
 
-		struct GatherThreadScratch
+		struct GatheredInstance
 		{
-			std::vector<GatheredInstance> gathered;
+			DrawPacketMesh mesh{};
+			uint32_t slotIndex = 0;
 		};
 
 		struct DirtyThreadScratch
@@ -204,26 +242,51 @@ namespace Engine
 			std::vector<uint32_t> dirtyIndices;
 		};
 
-		struct FullSceneRenderable
+		// One screen space or decorated entity, resolved on the render thread so the workers building its instance only read
+		struct DecoratorCandidate
 		{
 			entt::entity entity{ entt::null };
-			std::shared_ptr<MaterialData> material;
-			GpuInstanceData baseInstance{};
+			const Transform* transform = nullptr;
+			const MaterialData* material = nullptr;
+			const MeshDecorator* decorator = nullptr;
+			glm::mat4 worldMatrix{ 1.0f };
+			TransformSpace transformSpace = TransformSpace::World;
 		};
 
-		CullMode cullMode{ CullMode::NONE };
+		// What a candidate adds to the decorator pass, materialIndex and the command's firstInstance are only known once it is appended
+		struct DecoratorInstance
+		{
+			GpuInstanceData instance{};
+			MeshDecoratorGpuInstanceData data{};
+			DrawPacketMesh mesh{};
+		};
+
+		// A screen space instance only depends on the entity's own components and the window size, so it is kept until one of them changes.
+		// World space decorators are sized by their distance to the camera and get rebuilt every frame.
+		struct ScreenSpaceDecoratorCacheEntry
+		{
+			entt::entity entity{ entt::null };
+			glm::mat4 worldMatrix{ 1.0f };
+			glm::vec3 scale{ 0.0f };
+			glm::uvec2 windowSize{ 0 };
+			const MaterialData* material = nullptr;
+			const Texture2D* albedoMap = nullptr;
+			const MeshBufferData* mesh = nullptr;
+			MeshDecorator decorator;
+			bool hasDecorator = false;
+			bool cull = false;
+			bool visible = false;
+			DecoratorInstance built;
+		};
 
-		struct CachedWorldPacketState
+		struct ScreenSpaceDecoratorCache
 		{
-			const Scene* scene = nullptr;
-			uint64_t frustumRevision = 0;
-			uint64_t renderablesRevision = 0;
-			uint64_t packetVersion = 0;
-			CullMode cullMode = CullMode::NONE;
-			bool usedSceneBVH = false;
-			bool valid = false;
+			const entt::registry* registry = nullptr;
+			std::vector<ScreenSpaceDecoratorCacheEntry> entries; // by entity index
 		};
 
+		CullMode cullMode{ CullMode::NONE };
+
 		// Stable world renderable slots used to prepare immutable per-frame gather input
 		const Scene* worldRenderableSlotsScene = nullptr;
 		uint64_t worldRenderableSlotsRevision = 0;
@@ -232,40 +295,45 @@ namespace Engine
 		std::unordered_map<uint64_t, uint32_t> worldRenderableKeyToSlot;
 		std::unordered_map<entt::entity, std::vector<uint32_t>> worldEntityToSlotIndices;
 
-		// The world space meshes we put into contiguous buckets to avoid resorting every frame
-		std::unordered_map<uint32_t, MeshBucket> meshBuckets;
-		std::vector<uint32_t> activeMeshBucketKeys;
+		// Which frames in flight still miss which slots of cpuInstanceData, fed from the scene's transform dirty set
+		InstanceSlotUploader slotUploader;
+		const Scene* slotInstancesScene = nullptr;
+		uint64_t slotInstancesRenderablesRevision = 0;
+		uint64_t slotInstancesTrackerEpoch = 0;
+		std::vector<entt::entity> changedEntityScratch;
+		std::vector<SlotInstanceSource> slotSourceScratch;
+		size_t slotBufferCapacity = 0;
+
+		// Groups the gathered slots by mesh into the indirect commands.
+		// The packet only gets a new version when the commands or the visible slots differ from the last one, frames re-upload it on a version change.
+		DrawPacketBuilder worldPacketBuilder;
+		std::vector<uint32_t> packetSlotScratch;   // slot per builder source
+		std::vector<uint32_t> packetSourceScratch;
+		std::vector<uint32_t> visibleSlotScratch;
+		std::vector<VkDrawIndexedIndirectCommand> drawCommandScratch;
 		std::vector<VkDrawIndexedIndirectCommand> worldDrawCommands;
-		CachedWorldPacketState cachedWorldPacketState;
+		std::vector<uint32_t> worldVisibleSlots;
 		std::vector<uint64_t> uploadedWorldPacketVersions;
-		size_t cachedWorldInstanceCount = 0;
-
-		std::vector<glm::uvec4> culledVisibleData; // GPU visible output buffer read into CPU
-		uint32_t instanceCountCulled = 0;          // Count of instances that passed culling
+		uint64_t worldPacketVersion = 0;
 
-		struct FullSceneDirtyHistoryEntry
-		{
-			uint64_t version = 0;
-			std::vector<std::pair<uint32_t, uint32_t>> ranges;
-		};
-
-		std::vector<FullSceneRenderable> fullSceneRenderables;
-		std::vector<VkDrawIndexedIndirectCommand> fullSceneDrawCommands;
-		std::unordered_map<entt::entity, std::vector<uint32_t>> fullSceneEntityToInstanceIndices;
-		std::deque<FullSceneDirtyHistoryEntry> fullSceneDirtyHistory;
-		std::vector<uint64_t> uploadedFullScenePacketVersions;
-		std::vector<uint64_t> uploadedFullSceneCommandVersions;
+		// While the whole scene stays in the frustum the packet only depends on which renderables exist, so it is kept instead of gathered again
 		const Scene* fullScenePacketScene = nullptr;
+		uint64_t fullScenePacketRenderablesRevision = 0;
+		EngineState fullScenePacketEngineState = EngineState::None;
+		bool fullScenePacketValid = false;
 
 		std::vector<entt::entity> visibleEntityScratch;
 		std::vector<GatherCandidate> gatherCandidatesScratch;
-		std::vector<uint32_t> dirtyInstanceIndexScratch;
-		std::vector<GatherThreadScratch> gatherThreadScratch;
+		std::vector<GatheredInstance> gatheredScratch;
+		std::vector<uint8_t> gatheredBuiltScratch;
 		std::vector<DirtyThreadScratch> dirtyThreadScratch;
-		std::vector<uint32_t> bucketFirstInstanceScratch;
-		uint64_t fullScenePacketRenderablesRevision = 0;
-		uint64_t fullScenePacketVersion = 0;
-		bool fullScenePacketValid = false;
+
+		// Decorator pass, the scene and the debug draw registry each keep their own cache
+		ScreenSpaceDecoratorCache sceneDecoratorCache;
+		ScreenSpaceDecoratorCache debugDecoratorCache;
+		std::vector<DecoratorCandidate> decoratorCandidatesScratch;
+		std::vector<DecoratorInstance> decoratorBuiltScratch;
+		std::vector<uint8_t> decoratorVisibleScratch;
 
 		// One static quad to render all glyphs with
 		bool hasUploadedGlyphQuad = false;
@@ -293,6 +361,10 @@ namespace Engine
 
 		bool useQueriedFrustumSceneBVH{ true };
 
+		OcclusionBuffer occlusionBuffer;
+		bool useOcclusionCulling{ true };
+		bool occlusionRanThisFrame{ false };
+
 	};
 
 }
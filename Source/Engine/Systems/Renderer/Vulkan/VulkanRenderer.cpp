@@ -149,6 +149,7 @@ namespace Engine
 
 		// Hook the index buffer SSBO into our per-frame descriptor sets
 		descriptorManager->CreateInstanceBufferDescriptorSets(indexDraw->GetInstanceBuffer()->GetPerFrameBuffers());
+		descriptorManager->CreateVisibleSlotBufferDescriptorSets(indexDraw->GetVisibleSlotBuffers());
 
 		// === Graphics pipeline creation ===
 		VkDescriptorSetLayout layout = descriptorManager->GetLayout(); // set 0
@@ -589,6 +590,9 @@ namespace Engine
 		// This sets up fresh data for the frame and prepares every regular mesh to be draw in world space.
 		indexDraw->UpdateInstanceBuffer(currentFrame);
 
+		// Text glyph instances of both spaces stay resident, only the texts that changed get written again.
+		indexDraw->UpdateMsdfTextInstances(currentFrame);
+
 		// This then draws all of them with the default shader.
 		indexDraw->DrawIndexedWorldMeshes(currentFrame, cmd);
 
@@ -37,13 +37,6 @@ namespace Engine
 	template<typename T>
 	void Scene::OnComponentConstruct(entt::registry& reg, entt::entity entity)
 	{
-		if constexpr (std::is_same_v<T, Transform>)
-		{
-			Transform& tf = reg.get<Transform>(entity);
-			tf.owner = entity;
-			Transform::MarkEntityDirty(entity);
-		}
-
 		if constexpr (
 			std::is_same_v<T, Transform>
 			|| std::is_same_v<T, Material>
@@ -285,6 +278,11 @@ namespace Engine
 		auto& parentTf = registry.get<Transform>(parent);
 		parentTf.children.push_back(child);
 
+		if (transformHierarchy)
+		{
+			transformHierarchy->MarkTopologyDirty();
+		}
+
 		// Invalidate child's world and all its descendants (lazy recompute on demand)
 		std::vector<entt::entity> stack;
 		stack.push_back(child);
@@ -336,6 +334,11 @@ namespace Engine
 		// Clear parent
 		childTf.parent = entt::null;
 
+		if (transformHierarchy)
+		{
+			transformHierarchy->MarkTopologyDirty();
+		}
+
 		// Invalidate subtree world matrices
 		std::vector<entt::entity> stack;
 		stack.push_back(child);
@@ -497,6 +500,10 @@ namespace Engine
 		registry.on_construct<MeshDecorator>().connect<&Scene::OnComponentConstruct<MeshDecorator>>(*this);
 		registry.on_destroy<MeshDecorator>().connect<&Scene::OnComponentDestroy<MeshDecorator>>(*this);
 
+		// Parents before children order for world matrix propagation
+		transformHierarchy = std::make_unique<TransformHierarchy>(registry);
+		transformHierarchy->Init();
+
 		// Initialize SceneBVH grid
 		sceneBVH = std::make_unique<SceneBVH>(registry);
 		sceneBVH->Init();
@@ -601,8 +608,13 @@ namespace Engine
 
 	void Scene::InternalScenePostUpdate(double dt)
 	{
-		Transform::ClearGlobalDirtyFlag();
-		Transform::ClearDirtyEntities();
+		// Resolve every world matrix touched this frame before the dirty list goes away, so rendering reads cached worlds
+		if (transformHierarchy)
+		{
+			transformHierarchy->Update();
+		}
+
+		transformDirtyTracker.Clear();
 
 		// if constexpr (handleDebugDraw)
 		sceneBVH->DebugRender();
@@ -6,6 +6,8 @@
 #include "SubSceneSystems/GizmoSystem.h"
 #include "SubSceneSystems/SceneDebugDraw.h"
 #include "SubSceneSystems/SerializedSceneManager.h"
+#include "SubSceneSystems/TransformHierarchy.h"
+#include "SubSceneSystems/TransformDirtyTracker.h"
 
 #include "Engine/Components/ObjectTag.h"
 
@@ -125,6 +127,8 @@ namespace Engine
 		SceneBVH* GetSceneBVH() const { return sceneBVH.get(); }
 		GizmoSystem* GetGizmoSystem() const { return gizmoSystem.get(); }
 		SceneDebugDraw* GetSceneDebugDraw() const { return sceneDebugDraw.get(); }
+		TransformHierarchy* GetTransformHierarchy() const { return transformHierarchy.get(); }
+		TransformDirtyTracker& GetTransformDirtyTracker() { return transformDirtyTracker; }
 
 		Ray ScreenPointToRay(const glm::vec2& point) const;
 
@@ -302,6 +306,9 @@ namespace Engine
 
 		entt::registry registry;
 
+		// Declared right after the registry so every Transform ever constructed in it gets bound, and so it is torn down first
+		TransformDirtyTracker transformDirtyTracker{ registry };
+
 		template <typename T>
 		std::shared_ptr<T> GetSystem(const std::weak_ptr<T>& weakPtr) const
 		{
@@ -355,6 +362,7 @@ namespace Engine
 		entt::observer frustumCacheObserver;
 
 		std::unique_ptr<SceneBVH> sceneBVH;
+		std::unique_ptr<TransformHierarchy> transformHierarchy;
 		std::unique_ptr<PhysicsWorld> physicsWorld;
 		std::unique_ptr<SceneDebugDraw> sceneDebugDraw;
 		std::unique_ptr<GizmoSystem> gizmoSystem;
@@ -23,6 +23,17 @@ namespace Engine
 
 		int Exit() override;
 
+		// Behaviors can touch pretty much anything in the scene and may call into the window, so this is the one big main thread stage
+		FrameTaskAccess GetFrameTaskAccess() const override
+		{
+			return
+			{
+				FrameResource::Input | FrameResource::Commands | FrameResource::Camera,
+				FrameResource::Entities | FrameResource::Transform | FrameResource::SceneBVH | FrameResource::Physics | FrameResource::Camera | FrameResource::DebugDraw | FrameResource::TextGlyphs,
+				true
+			};
+		}
+
 		template <typename T, typename... Args>
 		void RegisterScene(const std::string& name, Args&&... args)
 		{
@@ -3,10 +3,12 @@
 #include "Engine/Components/Material.h"
 #include "Engine/Components/CompositeMaterial.h"
 #include "Engine/Components/Transform.h"
+#include "TransformDirtyTracker.h"
 #include "Engine/Components/Internal/FrustumCullCache.h"
 #include "Engine/Systems/Renderer/Core/Meshes/Mesh.h"
 #include "Engine/Systems/Renderer/Core/Camera/Frustum.h"
 #include "Engine/Utility/ParallelUtils.h"
+#include "Engine/Utility/Profiler.h"
 
 #ifndef SWIM_BVH_USE_SSE
 #define SWIM_BVH_USE_SSE 0
@@ -16,10 +18,18 @@
 #define SWIM_BVH_ENABLE_INTRIN 1 // 1 to enable
 #endif
 
+#ifndef SWIM_BVH_USE_AVX2
+#define SWIM_BVH_USE_AVX2 0
+#endif
+
 #if SWIM_BVH_ENABLE_INTRIN && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
 #include <immintrin.h>
 #undef SWIM_BVH_USE_SSE
 #define SWIM_BVH_USE_SSE 1
+#if defined(__AVX2__) && SWIM_BVH_WIDE_ARITY == 8
+#undef SWIM_BVH_USE_AVX2
+#define SWIM_BVH_USE_AVX2 1
+#endif
 #endif
 
 namespace Engine
@@ -28,9 +38,12 @@ namespace Engine
 	namespace
 	{
 
-		constexpr int kWideNodeArity = 4;
 		constexpr int kSAHBins = 8;
+		constexpr int kParallelBinMinLeaves = 32768; // below this one thread bins a range faster than a dispatch can
+		constexpr int kParallelSubtreeMinLeaves = 4096; // ranges under this are built whole by a single subtree task
+		constexpr size_t kSubtreeTasksPerWorker = 4;
 		constexpr int kFrustumPlaneCount = 6;
+		constexpr size_t kRayPacketsPerTask = 16; // a few hundred rays per task, AI line of sight batches still split across workers
 
 		void BuildPlaneTraversalOrder(uint8_t firstPlane, uint8_t* outOrder)
 		{
@@ -122,10 +135,24 @@ namespace Engine
 			return foundAny;
 		}
 
-		bool IsFiniteAABB(const AABB& aabb)
+		// SAH bins for all three axes of one split candidate, empty bins keep the default inverted AABB so merging is branch free
+		struct SAHBinSet
 		{
-			return aabb.min.x <= aabb.max.x && aabb.min.y <= aabb.max.y && aabb.min.z <= aabb.max.z;
-		}
+			AABB bounds[3][kSAHBins];
+			int counts[3][kSAHBins]{};
+
+			void Merge(const SAHBinSet& other)
+			{
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					for (int bin = 0; bin < kSAHBins; ++bin)
+					{
+						bounds[axis][bin] = MergeAABBs(bounds[axis][bin], other.bounds[axis][bin]);
+						counts[axis][bin] += other.counts[axis][bin];
+					}
+				}
+			}
+		};
 
 	}
 
@@ -200,109 +227,145 @@ namespace Engine
 		return Frustum::BuildWorldAABB(localMin, localMax, model);
 	}
 
-	void SceneBVH::Update()
+	bool SceneBVH::ComputeEntityWorldAABB(entt::entity entity, const Transform& transform, AABB& outAABB)
 	{
-		static constexpr float kRebuildThreshold = 0.20f;
-
-		if (root == -1 || topologyObserver.size() > 0 || forceUpdate)
+		if (registry.all_of<Material>(entity))
 		{
-			FullRebuild();
-			forceUpdate = false;
-			topologyObserver.clear();
-			return;
+			const std::shared_ptr<MaterialData>& mat = registry.get<Material>(entity).data;
+			if (mat && mat->mesh && mat->mesh->meshBufferData)
+			{
+				outAABB = CalculateWorldAABB(entity, glm::vec3(mat->mesh->meshBufferData->aabbMin), glm::vec3(mat->mesh->meshBufferData->aabbMax), transform);
+				return true;
+			}
 		}
-
-		const std::vector<entt::entity>& dirtyEntities = Transform::GetDirtyEntities();
-		if (dirtyEntities.empty())
+		else if (registry.all_of<CompositeMaterial>(entity))
 		{
-			return;
+			glm::vec3 localMin;
+			glm::vec3 localMax;
+			const CompositeMaterial& comp = registry.get<CompositeMaterial>(entity);
+			if (HasRenderableSubMaterials(comp, localMin, localMax))
+			{
+				outAABB = CalculateWorldAABB(entity, localMin, localMax, transform);
+				return true;
+			}
 		}
 
-		const float preRootArea = (root != -1) ? ComputeSurfaceArea(nodes[root].fatAABB) : 0.0f;
-		bool anyLeafEscapedFatBounds = false;
+		return false;
+	}
 
-		for (entt::entity e : dirtyEntities)
+	bool SceneBVH::SyncEntity(entt::entity entity)
+	{
+		if (entity == entt::null || !registry.valid(entity) || !registry.any_of<Transform>(entity))
 		{
-			if (e == entt::null || !registry.valid(e) || !registry.any_of<Transform>(e))
+			if (entityToLeaf.find(entity) != entityToLeaf.end())
 			{
-				continue;
+				RemoveEntityLeaf(entity);
 			}
+			return false;
+		}
 
-			const Transform& tf = registry.get<Transform>(e);
-			if (tf.GetTransformSpace() != TransformSpace::World)
-			{
-				if (entityToLeaf.find(e) != entityToLeaf.end())
-				{
-					RemoveEntity(e);
-				}
-				continue;
-			}
+		return SyncEntity(entity, registry.get<Transform>(entity));
+	}
 
-			bool hasRenderableBounds = false;
-			AABB worldAABB{};
+	bool SceneBVH::SyncEntity(entt::entity entity, const Transform& tf)
+	{
+		const auto it = entityToLeaf.find(entity);
+		const bool inTree = it != entityToLeaf.end();
 
-			if (registry.all_of<Material>(e))
-			{
-				const std::shared_ptr<MaterialData>& mat = registry.get<Material>(e).data;
-				if (mat && mat->mesh && mat->mesh->meshBufferData)
-				{
-					worldAABB = CalculateWorldAABB(e, glm::vec3(mat->mesh->meshBufferData->aabbMin), glm::vec3(mat->mesh->meshBufferData->aabbMax), tf);
-					hasRenderableBounds = true;
-				}
-			}
-			else if (registry.all_of<CompositeMaterial>(e))
+		AABB worldAABB{};
+		if (tf.GetTransformSpace() != TransformSpace::World || !ComputeEntityWorldAABB(entity, tf, worldAABB))
+		{
+			if (inTree)
 			{
-				glm::vec3 localMin;
-				glm::vec3 localMax;
-				const CompositeMaterial& comp = registry.get<CompositeMaterial>(e);
-				if (HasRenderableSubMaterials(comp, localMin, localMax))
-				{
-					worldAABB = CalculateWorldAABB(e, localMin, localMax, tf);
-					hasRenderableBounds = true;
-				}
+				RemoveEntityLeaf(entity);
 			}
+			return false;
+		}
 
-			if (!hasRenderableBounds)
-			{
-				if (entityToLeaf.find(e) != entityToLeaf.end())
-				{
-					RemoveEntity(e);
-				}
-				continue;
-			}
+		if (!inTree)
+		{
+			InsertLeaf(entity, worldAABB);
+			return true;
+		}
 
-			auto it = entityToLeaf.find(e);
-			if (it == entityToLeaf.end())
-			{
-				forceUpdate = true;
-				continue;
-			}
+		const int leafIndex = it->second;
+		BVHNode& leaf = nodes[leafIndex];
+		const AABB previousAABB = leaf.aabb;
+		leaf.aabb = worldAABB;
+		leaf.hasCullHistory = false;
 
-			const int leafIndex = it->second;
-			BVHNode& leaf = nodes[leafIndex];
-			const AABB previousAABB = leaf.aabb;
-			leaf.aabb = worldAABB;
-			leaf.hasCullHistory = false;
+		bool escapedFatBounds = false;
+		if (!AABBInsideAABB(leaf.aabb, leaf.fatAABB))
+		{
+			leaf.fatAABB = MakeFatAABBMotionAware(previousAABB, leaf.aabb);
+			escapedFatBounds = true;
+		}
 
-			if (!AABBInsideAABB(leaf.aabb, leaf.fatAABB))
-			{
-				leaf.fatAABB = MakeFatAABBMotionAware(previousAABB, leaf.aabb);
-				anyLeafEscapedFatBounds = true;
-			}
+		RefitBinaryAncestors(leafIndex);
+		RefitWideAncestorsFromLeaf(leafIndex);
+		return escapedFatBounds;
+	}
 
-			RefitBinaryAncestors(leafIndex);
-			RefitWideAncestorsFromLeaf(leafIndex);
-		}
+	void SceneBVH::Update()
+	{
+		SWIM_PROFILE_FUNCTION();
 
-		if (forceUpdate)
+		static constexpr float kRebuildThreshold = 0.20f;
+		static constexpr size_t kMinBulkInsertRebuild = 64;
+		static constexpr size_t kBulkInsertRebuildDivisor = 4; // more new leaves than a quarter of the tree builds better from scratch
+
+		const size_t bulkInsertLimit = std::max(kMinBulkInsertRebuild, entityToLeaf.size() / kBulkInsertRebuildDivisor);
+		if (forceUpdate || topologyObserver.size() > bulkInsertLimit)
 		{
 			FullRebuild();
 			forceUpdate = false;
 			topologyObserver.clear();
+			pendingSync.clear();
+			return;
+		}
+
+		const TransformDirtyTracker* dirtyTracker = TransformDirtyTracker::Find(registry);
+		const bool anyDirty = dirtyTracker && !dirtyTracker->GetDirtyEntities().empty();
+		if (!anyDirty && topologyObserver.empty() && pendingSync.empty())
+		{
 			return;
 		}
 
-		if (anyLeafEscapedFatBounds && root != -1 && preRootArea > 0.0f)
+		const float preRootArea = (root != -1) ? ComputeSurfaceArea(nodes[root].fatAABB) : 0.0f;
+		bool treeGrew = false;
+
+		// New renderables (and entities whose material was swapped) go straight in, no rebuild
+		for (entt::entity e : topologyObserver)
+		{
+			treeGrew |= SyncEntity(e);
+		}
+		topologyObserver.clear();
+
+		// Entities that lost one renderable component may still have another one (e.g. Material swapped for a CompositeMaterial)
+		if (!pendingSync.empty())
+		{
+			std::vector<entt::entity> toSync;
+			toSync.swap(pendingSync);
+			for (entt::entity e : toSync)
+			{
+				if (registry.valid(e))
+				{
+					treeGrew |= SyncEntity(e);
+				}
+			}
+		}
+
+		// The tracker drops entities the moment their Transform goes away, so everything left is alive and has one
+		if (anyDirty)
+		{
+			auto& transforms = registry.storage<Transform>();
+			for (entt::entity e : dirtyTracker->GetDirtyEntities())
+			{
+				treeGrew |= SyncEntity(e, transforms.get(e));
+			}
+		}
+
+		if (treeGrew && root != -1 && preRootArea > 0.0f)
 		{
 			const float postArea = ComputeSurfaceArea(nodes[root].fatAABB);
 			const float expansion = postArea / preRootArea;
@@ -316,180 +379,350 @@ namespace Engine
 		}
 	}
 
-	int SceneBVH::BuildRecursive(std::vector<int>& leafIndices, int begin, int end)
+	void SceneBVH::LinkInternalNode(int nodeIndex, int left, int right)
+	{
+		BVHNode& node = nodes[nodeIndex];
+		node.left = left;
+		node.right = right;
+		node.parent = -1;
+		node.entity = entt::null;
+		node.aabb = MergeAABBs(nodes[left].aabb, nodes[right].aabb);
+		node.fatAABB = MergeAABBs(nodes[left].fatAABB, nodes[right].fatAABB);
+		node.hasCullHistory = false;
+
+		nodes[left].parent = nodeIndex;
+		nodes[right].parent = nodeIndex;
+	}
+
+	int SceneBVH::PartitionLeafRange(std::vector<int>& leafIndices, int begin, int end, bool allowParallelBinning)
 	{
 		const int count = end - begin;
-		if (count == 1)
+		if (count <= 2)
 		{
-			return leafIndices[begin];
+			return begin + count / 2;
 		}
 
+		// Only the top few splits of a big rebuild are worth spreading across the pool, everything below runs inside a subtree task
+		const bool parallelBinning = allowParallelBinning && count >= kParallelBinMinLeaves;
+		const size_t partialSlots = parallelBinning ? GetRenderParallelWorkerSlots() : 1;
+
 		AABB centroidBox;
-		centroidBox.min = glm::vec3(FLT_MAX);
-		centroidBox.max = glm::vec3(-FLT_MAX);
+		if (parallelBinning)
+		{
+			std::vector<AABB> partialCentroidBoxes(partialSlots);
+			ParallelForRender(static_cast<size_t>(count), RenderCpuJobConfig::DefaultMinItemsPerChunk, [&](size_t chunkBegin, size_t chunkEnd, uint32_t workerIndex)
+			{
+				AABB& box = partialCentroidBoxes[workerIndex];
+				for (size_t i = chunkBegin; i < chunkEnd; ++i)
+				{
+					const glm::vec3& center = buildCentroids[leafIndices[begin + i]];
+					box.min = glm::min(box.min, center);
+					box.max = glm::max(box.max, center);
+				}
+			});
 
-		for (int i = begin; i < end; ++i)
+			for (const AABB& box : partialCentroidBoxes)
+			{
+				centroidBox = MergeAABBs(centroidBox, box);
+			}
+		}
+		else
 		{
-			const AABB& aabb = nodes[leafIndices[i]].aabb;
-			const glm::vec3 center = 0.5f * (aabb.min + aabb.max);
-			centroidBox.min = glm::min(centroidBox.min, center);
-			centroidBox.max = glm::max(centroidBox.max, center);
+			for (int i = begin; i < end; ++i)
+			{
+				const glm::vec3& center = buildCentroids[leafIndices[i]];
+				centroidBox.min = glm::min(centroidBox.min, center);
+				centroidBox.max = glm::max(centroidBox.max, center);
+			}
 		}
 
-		glm::vec3 extents = centroidBox.max - centroidBox.min;
-		int axis = 0;
-		if (extents.y > extents.x && extents.y > extents.z)
+		const glm::vec3 extents = centroidBox.max - centroidBox.min;
+		glm::vec3 binScale(0.0f);
+		bool anyAxisSplittable = false;
+		for (int axis = 0; axis < 3; ++axis)
 		{
-			axis = 1;
+			if (extents[axis] > 1e-6f)
+			{
+				binScale[axis] = static_cast<float>(kSAHBins) / extents[axis];
+				anyAxisSplittable = true;
+			}
 		}
-		else if (extents.z > extents.x)
+
+		auto binIndexOf = [&](const glm::vec3& center, int axis)
 		{
-			axis = 2;
-		}
+			const int binIndex = static_cast<int>((center[axis] - centroidBox.min[axis]) * binScale[axis]);
+			return glm::clamp(binIndex, 0, kSAHBins - 1);
+		};
 
-		int mid = begin + count / 2;
-		const float axisExtent = extents[axis];
+		int bestAxis = -1;
+		int bestSplit = -1;
 
-		if (axisExtent > 1e-6f && count > 2)
+		if (anyAxisSplittable)
 		{
-			struct Bin
+			// Bin every axis in the same pass over the leaves, a flat axis just piles everything into bin 0 and never wins
+			SAHBinSet bins;
+			auto accumulateBins = [&](SAHBinSet& target, int rangeBegin, int rangeEnd)
 			{
-				AABB bounds;
-				int count = 0;
+				for (int i = rangeBegin; i < rangeEnd; ++i)
+				{
+					const int leafIndex = leafIndices[i];
+					const glm::vec3& center = buildCentroids[leafIndex];
+					const AABB& aabb = nodes[leafIndex].aabb;
+					for (int axis = 0; axis < 3; ++axis)
+					{
+						const int binIndex = binIndexOf(center, axis);
+						target.counts[axis][binIndex]++;
+						target.bounds[axis][binIndex] = MergeAABBs(target.bounds[axis][binIndex], aabb);
+					}
+				}
 			};
 
-			Bin bins[kSAHBins];
-			for (int i = begin; i < end; ++i)
+			if (parallelBinning)
 			{
-				const AABB& aabb = nodes[leafIndices[i]].aabb;
-				const glm::vec3 center = 0.5f * (aabb.min + aabb.max);
-				float t = (center[axis] - centroidBox.min[axis]) / axisExtent;
-				t = glm::clamp(t, 0.0f, 0.999999f);
-				const int binIndex = glm::clamp(static_cast<int>(t * static_cast<float>(kSAHBins)), 0, kSAHBins - 1);
-
-				bins[binIndex].count++;
-				if (!IsFiniteAABB(bins[binIndex].bounds))
-				{
-					bins[binIndex].bounds = aabb;
-				}
-				else
+				std::vector<SAHBinSet> partialBins(partialSlots);
+				ParallelForRender(static_cast<size_t>(count), RenderCpuJobConfig::DefaultMinItemsPerChunk, [&](size_t chunkBegin, size_t chunkEnd, uint32_t workerIndex)
 				{
-					bins[binIndex].bounds = MergeAABBs(bins[binIndex].bounds, aabb);
-				}
-			}
-
-			AABB leftBounds[kSAHBins - 1];
-			AABB rightBounds[kSAHBins - 1];
-			int leftCounts[kSAHBins - 1]{};
-			int rightCounts[kSAHBins - 1]{};
+					accumulateBins(partialBins[workerIndex], begin + static_cast<int>(chunkBegin), begin + static_cast<int>(chunkEnd));
+				});
 
-			AABB runningLeft;
-			runningLeft.min = glm::vec3(FLT_MAX);
-			runningLeft.max = glm::vec3(-FLT_MAX);
-			int runningLeftCount = 0;
-			for (int i = 0; i < kSAHBins - 1; ++i)
-			{
-				if (bins[i].count > 0)
+				for (const SAHBinSet& partial : partialBins)
 				{
-					runningLeft = IsFiniteAABB(runningLeft) ? MergeAABBs(runningLeft, bins[i].bounds) : bins[i].bounds;
-					runningLeftCount += bins[i].count;
+					bins.Merge(partial);
 				}
-				leftBounds[i] = runningLeft;
-				leftCounts[i] = runningLeftCount;
 			}
-
-			AABB runningRight;
-			runningRight.min = glm::vec3(FLT_MAX);
-			runningRight.max = glm::vec3(-FLT_MAX);
-			int runningRightCount = 0;
-			for (int i = kSAHBins - 1; i > 0; --i)
+			else
 			{
-				if (bins[i].count > 0)
-				{
-					runningRight = IsFiniteAABB(runningRight) ? MergeAABBs(runningRight, bins[i].bounds) : bins[i].bounds;
-					runningRightCount += bins[i].count;
-				}
-				rightBounds[i - 1] = runningRight;
-				rightCounts[i - 1] = runningRightCount;
+				accumulateBins(bins, begin, end);
 			}
 
 			float bestCost = std::numeric_limits<float>::infinity();
-			int bestSplit = -1;
-			for (int i = 0; i < kSAHBins - 1; ++i)
+			for (int axis = 0; axis < 3; ++axis)
 			{
-				if (leftCounts[i] == 0 || rightCounts[i] == 0)
+				if (binScale[axis] == 0.0f)
 				{
 					continue;
 				}
 
-				const float cost = static_cast<float>(leftCounts[i]) * ComputeSurfaceArea(leftBounds[i])
-					+ static_cast<float>(rightCounts[i]) * ComputeSurfaceArea(rightBounds[i]);
-				if (cost < bestCost)
+				float leftAreas[kSAHBins - 1];
+				int leftCounts[kSAHBins - 1]{};
+
+				AABB runningLeft;
+				int runningLeftCount = 0;
+				for (int i = 0; i < kSAHBins - 1; ++i)
 				{
-					bestCost = cost;
-					bestSplit = i;
+					runningLeft = MergeAABBs(runningLeft, bins.bounds[axis][i]);
+					runningLeftCount += bins.counts[axis][i];
+					leftAreas[i] = ComputeSurfaceArea(runningLeft);
+					leftCounts[i] = runningLeftCount;
 				}
-			}
 
-			if (bestSplit >= 0)
-			{
-				auto midIt = std::partition(leafIndices.begin() + begin, leafIndices.begin() + end, [&](int leafIndex)
+				AABB runningRight;
+				int runningRightCount = 0;
+				for (int i = kSAHBins - 1; i > 0; --i)
 				{
-					const AABB& aabb = nodes[leafIndex].aabb;
-					const glm::vec3 center = 0.5f * (aabb.min + aabb.max);
-					float t = (center[axis] - centroidBox.min[axis]) / axisExtent;
-					t = glm::clamp(t, 0.0f, 0.999999f);
-					const int binIndex = glm::clamp(static_cast<int>(t * static_cast<float>(kSAHBins)), 0, kSAHBins - 1);
-					return binIndex <= bestSplit;
-				});
+					runningRight = MergeAABBs(runningRight, bins.bounds[axis][i]);
+					runningRightCount += bins.counts[axis][i];
 
-				mid = static_cast<int>(midIt - leafIndices.begin());
-				if (mid == begin || mid == end)
-				{
-					mid = begin + count / 2;
+					const int split = i - 1;
+					if (leftCounts[split] == 0 || runningRightCount == 0)
+					{
+						continue;
+					}
+
+					const float cost = static_cast<float>(leftCounts[split]) * leftAreas[split]
+						+ static_cast<float>(runningRightCount) * ComputeSurfaceArea(runningRight);
+					if (cost < bestCost)
+					{
+						bestCost = cost;
+						bestAxis = axis;
+						bestSplit = split;
+					}
 				}
 			}
 		}
 
-		if (mid == begin || mid == end)
+		int mid = begin + count / 2;
+		if (bestAxis >= 0)
 		{
-			mid = begin + count / 2;
-			std::nth_element(leafIndices.begin() + begin,
-				leafIndices.begin() + mid,
-				leafIndices.begin() + end,
-				[&](int a, int b)
+			auto midIt = std::partition(leafIndices.begin() + begin, leafIndices.begin() + end, [&](int leafIndex)
 			{
-				float ca = 0.5f * (nodes[a].aabb.min[axis] + nodes[a].aabb.max[axis]);
-				float cb = 0.5f * (nodes[b].aabb.min[axis] + nodes[b].aabb.max[axis]);
-				return ca < cb;
+				return binIndexOf(buildCentroids[leafIndex], bestAxis) <= bestSplit;
 			});
+
+			mid = static_cast<int>(midIt - leafIndices.begin());
+			if (mid != begin && mid != end)
+			{
+				return mid;
+			}
 		}
 
-		const int idx = static_cast<int>(nodes.size());
-		nodes.emplace_back();
+		// No usable SAH split (coincident centroids), fall back to a median split on the widest axis
+		int axis = 0;
+		if (extents.y > extents.x && extents.y > extents.z)
+		{
+			axis = 1;
+		}
+		else if (extents.z > extents.x)
+		{
+			axis = 2;
+		}
 
-		const int left = BuildRecursive(leafIndices, begin, mid);
-		const int right = BuildRecursive(leafIndices, mid, end);
+		mid = begin + count / 2;
+		std::nth_element(leafIndices.begin() + begin,
+			leafIndices.begin() + mid,
+			leafIndices.begin() + end,
+			[&](int a, int b)
+		{
+			return buildCentroids[a][axis] < buildCentroids[b][axis];
+		});
 
-		nodes[idx].left = left;
-		nodes[idx].right = right;
-		nodes[idx].parent = -1;
+		return mid;
+	}
 
-		nodes[left].parent = idx;
-		nodes[right].parent = idx;
+	// Internal nodes of a range [begin, end) always live in [nodeIndex, nodeIndex + count - 1), the left child range takes the
+	// slots right after nodeIndex and the right child range follows it. That makes node placement independent of build order,
+	// so subtrees can be built on any thread without sharing an allocator.
+	int SceneBVH::BuildRecursive(std::vector<int>& leafIndices, int begin, int end, int nodeIndex)
+	{
+		if (end - begin == 1)
+		{
+			return leafIndices[begin];
+		}
 
-		nodes[idx].aabb = MergeAABBs(nodes[left].aabb, nodes[right].aabb);
-		nodes[idx].fatAABB = MergeAABBs(nodes[left].fatAABB, nodes[right].fatAABB);
-		nodes[idx].entity = entt::null;
-		nodes[idx].hasCullHistory = false;
+		const int mid = PartitionLeafRange(leafIndices, begin, end, false);
+		const int left = BuildRecursive(leafIndices, begin, mid, nodeIndex + 1);
+		const int right = BuildRecursive(leafIndices, mid, end, nodeIndex + (mid - begin));
 
-		return idx;
+		LinkInternalNode(nodeIndex, left, right);
+		return nodeIndex;
+	}
+
+	void SceneBVH::BuildBinaryHierarchy(std::vector<int>& leafIndices)
+	{
+		const int leafCount = static_cast<int>(leafIndices.size());
+		if (leafCount == 0)
+		{
+			root = -1;
+			return;
+		}
+
+		// Leaves already sit in [0, leafCount), a binary tree over them needs exactly leafCount - 1 internal nodes after that
+		nodes.resize(static_cast<size_t>(leafCount) * 2 - 1);
+
+		buildCentroids.resize(static_cast<size_t>(leafCount));
+		ParallelForRender(static_cast<size_t>(leafCount), RenderCpuJobConfig::DefaultMinItemsPerChunk, [&](size_t begin, size_t end, uint32_t)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				const AABB& aabb = nodes[i].aabb;
+				buildCentroids[i] = 0.5f * (aabb.min + aabb.max);
+			}
+		});
+
+		if (leafCount == 1)
+		{
+			root = leafIndices[0];
+			nodes[root].parent = -1;
+			return;
+		}
+
+		const size_t workerSlots = GetRenderParallelWorkerSlots();
+		if (workerSlots <= 1 || leafCount < kParallelSubtreeMinLeaves * 2)
+		{
+			root = BuildRecursive(leafIndices, 0, leafCount, leafCount);
+			nodes[root].parent = -1;
+			return;
+		}
+
+		struct PendingRange
+		{
+			int begin;
+			int end;
+			int nodeIndex;
+		};
+
+		struct TopLevelSplit
+		{
+			int nodeIndex;
+			PendingRange left;
+			PendingRange right;
+		};
+
+		auto childNodeIndex = [&](const PendingRange& range)
+		{
+			return (range.end - range.begin == 1) ? leafIndices[range.begin] : range.nodeIndex;
+		};
+
+		// Split the top of the tree on this thread (each split bins in parallel) until there are enough independent subtrees
+		// to keep every worker busy, always splitting the largest range next so the tasks come out similar in size.
+		const size_t targetTaskCount = workerSlots * kSubtreeTasksPerWorker;
+		std::vector<PendingRange> pending;
+		std::vector<PendingRange> subtreeTasks;
+		std::vector<TopLevelSplit> topLevelSplits;
+		pending.push_back({ 0, leafCount, leafCount });
+
+		while (!pending.empty())
+		{
+			auto largest = std::max_element(pending.begin(), pending.end(), [](const PendingRange& a, const PendingRange& b)
+			{
+				return (a.end - a.begin) < (b.end - b.begin);
+			});
+
+			const PendingRange range = *largest;
+			*largest = pending.back();
+			pending.pop_back();
+
+			const int count = range.end - range.begin;
+			if (count < kParallelSubtreeMinLeaves || subtreeTasks.size() + pending.size() + 1 >= targetTaskCount)
+			{
+				subtreeTasks.push_back(range);
+				continue;
+			}
+
+			const int mid = PartitionLeafRange(leafIndices, range.begin, range.end, true);
+			const PendingRange leftRange{ range.begin, mid, range.nodeIndex + 1 };
+			const PendingRange rightRange{ mid, range.end, range.nodeIndex + (mid - range.begin) };
+			topLevelSplits.push_back({ range.nodeIndex, leftRange, rightRange });
+
+			if (leftRange.end - leftRange.begin > 1)
+			{
+				pending.push_back(leftRange);
+			}
+
+			if (rightRange.end - rightRange.begin > 1)
+			{
+				pending.push_back(rightRange);
+			}
+		}
+
+		std::sort(subtreeTasks.begin(), subtreeTasks.end(), [](const PendingRange& a, const PendingRange& b)
+		{
+			return (a.end - a.begin) > (b.end - b.begin);
+		});
+
+		// Subtrees touch disjoint leaf ranges and disjoint internal node slots, so they need no synchronization
+		ParallelForRenderTasks(subtreeTasks.size(), [&](size_t taskIndex, uint32_t)
+		{
+			const PendingRange& task = subtreeTasks[taskIndex];
+			BuildRecursive(leafIndices, task.begin, task.end, task.nodeIndex);
+		});
+
+		// Splits were recorded parent first, so walking them backwards links children before their parents
+		for (auto it = topLevelSplits.rbegin(); it != topLevelSplits.rend(); ++it)
+		{
+			LinkInternalNode(it->nodeIndex, childNodeIndex(it->left), childNodeIndex(it->right));
+		}
+
+		root = leafCount;
+		nodes[root].parent = -1;
 	}
 
 	void SceneBVH::FullRebuild()
 	{
 		nodes.clear();
 		wideNodes.clear();
+		freeNodes.clear();
+		freeWideNodes.clear();
 		entityToLeaf.clear();
 		root = -1;
 		wideRoot = -1;
@@ -563,7 +796,7 @@ namespace Engine
 			return;
 		}
 
-		root = BuildRecursive(leafIndices, 0, static_cast<int>(leafIndices.size()));
+		BuildBinaryHierarchy(leafIndices);
 		BuildWideHierarchy();
 	}
 
@@ -630,7 +863,7 @@ namespace Engine
 		wideNodes[wideIndex].parentSlot = parentSlot;
 
 		std::vector<int> frontier;
-		frontier.reserve(kWideNodeArity);
+		frontier.reserve(WideArity);
 
 		const BVHNode& rootNode = nodes[binaryNodeIndex];
 		if (rootNode.IsLeaf())
@@ -643,7 +876,7 @@ namespace Engine
 			frontier.push_back(rootNode.right);
 		}
 
-		while (static_cast<int>(frontier.size()) < kWideNodeArity)
+		while (static_cast<int>(frontier.size()) < WideArity)
 		{
 			int expandCandidateIndex = -1;
 			float expandCandidateArea = -1.0f;
@@ -675,7 +908,7 @@ namespace Engine
 		}
 
 		wideNodes[wideIndex].childCount = static_cast<uint8_t>(frontier.size());
-		for (uint8_t i = 0; i < kWideNodeArity; ++i)
+		for (uint8_t i = 0; i < WideArity; ++i)
 		{
 			wideNodes[wideIndex].childTraversalOrder[i] = i;
 		}
@@ -713,40 +946,685 @@ namespace Engine
 		leafToWideParent.assign(nodes.size(), -1);
 		leafToWideSlot.assign(nodes.size(), 0xFF);
 
-		if (root == -1)
+		if (root == -1)
+		{
+			return;
+		}
+
+		wideNodes.reserve(nodes.size());
+		wideRoot = BuildWideRecursive(root, -1, 0xFF);
+	}
+
+	void SceneBVH::RefitWideAncestorsFromLeaf(int leafIndex)
+	{
+		if (leafIndex < 0 || leafIndex >= static_cast<int>(leafToWideParent.size()))
+		{
+			return;
+		}
+
+		const int wideIndex = leafToWideParent[leafIndex];
+		if (wideIndex == -1)
+		{
+			return;
+		}
+
+		SetWideChildBounds(wideIndex, leafToWideSlot[leafIndex], nodes[leafIndex].aabb);
+		RefitWideAncestors(wideIndex);
+	}
+
+	void SceneBVH::RefitWideAncestors(int wideIndex)
+	{
+		if (wideIndex == -1)
+		{
+			return;
+		}
+
+		UpdateWideNodeBoundsFromChildren(wideIndex);
+
+		while (wideNodes[wideIndex].parent != -1)
+		{
+			const int parentWide = wideNodes[wideIndex].parent;
+			const uint8_t parentSlot = wideNodes[wideIndex].parentSlot;
+			SetWideChildBounds(parentWide, parentSlot, wideNodes[wideIndex].traversalAABB);
+			UpdateWideNodeBoundsFromChildren(parentWide);
+			wideIndex = parentWide;
+		}
+	}
+
+	int SceneBVH::AllocateNode()
+	{
+		int index;
+		if (!freeNodes.empty())
+		{
+			index = freeNodes.back();
+			freeNodes.pop_back();
+			nodes[index] = BVHNode{};
+		}
+		else
+		{
+			index = static_cast<int>(nodes.size());
+			nodes.emplace_back();
+		}
+
+		if (leafToWideParent.size() < nodes.size())
+		{
+			leafToWideParent.resize(nodes.size(), -1);
+			leafToWideSlot.resize(nodes.size(), 0xFF);
+		}
+
+		leafToWideParent[index] = -1;
+		leafToWideSlot[index] = 0xFF;
+		return index;
+	}
+
+	void SceneBVH::FreeNode(int nodeIndex)
+	{
+		// A default node reads as an empty leaf, so debug drawing and stale wide refs never mistake it for live data
+		nodes[nodeIndex] = BVHNode{};
+		leafToWideParent[nodeIndex] = -1;
+		leafToWideSlot[nodeIndex] = 0xFF;
+		freeNodes.push_back(nodeIndex);
+	}
+
+	int SceneBVH::AllocateWideNode(int parentWideIndex, uint8_t parentSlot)
+	{
+		int index;
+		if (!freeWideNodes.empty())
+		{
+			index = freeWideNodes.back();
+			freeWideNodes.pop_back();
+			wideNodes[index] = WideNode{};
+		}
+		else
+		{
+			index = static_cast<int>(wideNodes.size());
+			wideNodes.emplace_back();
+		}
+
+		wideNodes[index].parent = parentWideIndex;
+		wideNodes[index].parentSlot = parentSlot;
+		return index;
+	}
+
+	void SceneBVH::FreeWideNode(int wideIndex)
+	{
+		wideNodes[wideIndex] = WideNode{};
+		freeWideNodes.push_back(wideIndex);
+	}
+
+	// Catto's branch and bound sibling search: the cost of pairing with a node is the area of the new parent plus the area every
+	// ancestor grows by, which also lower bounds the cost of anything below that node, so most of the tree is never visited.
+	int SceneBVH::FindBestSibling(const AABB& leafAABB) const
+	{
+		const float leafArea = ComputeSurfaceArea(leafAABB);
+
+		int bestSibling = root;
+		float bestCost = std::numeric_limits<float>::infinity();
+
+		insertSearchScratch.clear();
+		insertSearchScratch.push_back({ root, 0.0f });
+
+		while (!insertSearchScratch.empty())
+		{
+			const std::pair<int, float> candidate = insertSearchScratch.back();
+			insertSearchScratch.pop_back();
+
+			const BVHNode& node = nodes[candidate.first];
+			const float nodeArea = ComputeSurfaceArea(node.fatAABB);
+			const float combinedArea = ComputeSurfaceArea(MergeAABBs(node.fatAABB, leafAABB));
+			const float directCost = combinedArea + candidate.second;
+
+			if (directCost < bestCost)
+			{
+				bestCost = directCost;
+				bestSibling = candidate.first;
+			}
+
+			if (node.IsLeaf())
+			{
+				continue;
+			}
+
+			const float inheritedCost = candidate.second + (combinedArea - nodeArea);
+			if (leafArea + inheritedCost < bestCost)
+			{
+				insertSearchScratch.push_back({ node.left, inheritedCost });
+				insertSearchScratch.push_back({ node.right, inheritedCost });
+			}
+		}
+
+		return bestSibling;
+	}
+
+	void SceneBVH::RecomputeInternalBounds(int nodeIndex)
+	{
+		BVHNode& node = nodes[nodeIndex];
+		node.aabb = MergeAABBs(nodes[node.left].aabb, nodes[node.right].aabb);
+		node.fatAABB = MergeAABBs(nodes[node.left].fatAABB, nodes[node.right].fatAABB);
+		node.hasCullHistory = false;
+	}
+
+	// Tries swapping one child of nodeIndex with a grandchild on the other side and keeps whichever swap shrinks the surface area
+	// of the rebuilt child the most. Leaves under nodeIndex stay the same, so nodeIndex's own bounds do not change.
+	void SceneBVH::RotateNode(int nodeIndex)
+	{
+		enum class Rotation { None, BF, BG, CD, CE };
+
+		const int b = nodes[nodeIndex].left;
+		const int c = nodes[nodeIndex].right;
+		const bool bInternal = !nodes[b].IsLeaf();
+		const bool cInternal = !nodes[c].IsLeaf();
+		if (!bInternal && !cInternal)
+		{
+			return;
+		}
+
+		Rotation best = Rotation::None;
+		float bestDelta = 0.0f;
+
+		if (cInternal)
+		{
+			const int f = nodes[c].left;
+			const int g = nodes[c].right;
+			const float areaC = ComputeSurfaceArea(nodes[c].fatAABB);
+
+			const float deltaBF = ComputeSurfaceArea(MergeAABBs(nodes[b].fatAABB, nodes[g].fatAABB)) - areaC;
+			if (deltaBF < bestDelta)
+			{
+				bestDelta = deltaBF;
+				best = Rotation::BF;
+			}
+
+			const float deltaBG = ComputeSurfaceArea(MergeAABBs(nodes[b].fatAABB, nodes[f].fatAABB)) - areaC;
+			if (deltaBG < bestDelta)
+			{
+				bestDelta = deltaBG;
+				best = Rotation::BG;
+			}
+		}
+
+		if (bInternal)
+		{
+			const int d = nodes[b].left;
+			const int e = nodes[b].right;
+			const float areaB = ComputeSurfaceArea(nodes[b].fatAABB);
+
+			const float deltaCD = ComputeSurfaceArea(MergeAABBs(nodes[c].fatAABB, nodes[e].fatAABB)) - areaB;
+			if (deltaCD < bestDelta)
+			{
+				bestDelta = deltaCD;
+				best = Rotation::CD;
+			}
+
+			const float deltaCE = ComputeSurfaceArea(MergeAABBs(nodes[c].fatAABB, nodes[d].fatAABB)) - areaB;
+			if (deltaCE < bestDelta)
+			{
+				bestDelta = deltaCE;
+				best = Rotation::CE;
+			}
+		}
+
+		// Swaps child "outer" of nodeIndex with grandchild "inner" of the other child
+		auto swapWithGrandchild = [&](int outer, int otherChild, int inner, bool outerIsLeft, bool innerIsLeft)
+		{
+			if (outerIsLeft)
+			{
+				nodes[nodeIndex].left = inner;
+			}
+			else
+			{
+				nodes[nodeIndex].right = inner;
+			}
+
+			if (innerIsLeft)
+			{
+				nodes[otherChild].left = outer;
+			}
+			else
+			{
+				nodes[otherChild].right = outer;
+			}
+
+			nodes[inner].parent = nodeIndex;
+			nodes[outer].parent = otherChild;
+			RecomputeInternalBounds(otherChild);
+		};
+
+		switch (best)
+		{
+			case Rotation::BF: swapWithGrandchild(b, c, nodes[c].left, true, true); break;
+			case Rotation::BG: swapWithGrandchild(b, c, nodes[c].right, true, false); break;
+			case Rotation::CD: swapWithGrandchild(c, b, nodes[b].left, false, true); break;
+			case Rotation::CE: swapWithGrandchild(c, b, nodes[b].right, false, false); break;
+			case Rotation::None: break;
+		}
+	}
+
+	void SceneBVH::InsertLeaf(entt::entity entity, const AABB& worldAABB)
+	{
+		const int leafIndex = AllocateNode();
+		nodes[leafIndex].entity = entity;
+		nodes[leafIndex].aabb = worldAABB;
+		nodes[leafIndex].fatAABB = MakeFatAABB(worldAABB);
+		entityToLeaf[entity] = leafIndex;
+
+		if (root == -1)
+		{
+			root = leafIndex;
+			InsertWideLeaf(leafIndex);
+			return;
+		}
+
+		const int sibling = FindBestSibling(nodes[leafIndex].fatAABB);
+		const int oldParent = nodes[sibling].parent;
+		const int newParent = AllocateNode();
+
+		nodes[newParent].parent = oldParent;
+		nodes[newParent].left = sibling;
+		nodes[newParent].right = leafIndex;
+		nodes[sibling].parent = newParent;
+		nodes[leafIndex].parent = newParent;
+
+		if (oldParent == -1)
+		{
+			root = newParent;
+		}
+		else if (nodes[oldParent].left == sibling)
+		{
+			nodes[oldParent].left = newParent;
+		}
+		else
+		{
+			nodes[oldParent].right = newParent;
+		}
+
+		int nodeIndex = newParent;
+		while (nodeIndex != -1)
+		{
+			RecomputeInternalBounds(nodeIndex);
+			RotateNode(nodeIndex);
+			nodeIndex = nodes[nodeIndex].parent;
+		}
+
+		InsertWideLeaf(leafIndex);
+	}
+
+	void SceneBVH::RemoveLeaf(int leafIndex)
+	{
+		RemoveWideLeaf(leafIndex);
+
+		if (leafIndex == root)
+		{
+			root = -1;
+			FreeNode(leafIndex);
+			return;
+		}
+
+		const int parent = nodes[leafIndex].parent;
+		const int grandParent = nodes[parent].parent;
+		const int sibling = (nodes[parent].left == leafIndex) ? nodes[parent].right : nodes[parent].left;
+
+		if (grandParent == -1)
+		{
+			root = sibling;
+			nodes[sibling].parent = -1;
+		}
+		else
+		{
+			if (nodes[grandParent].left == parent)
+			{
+				nodes[grandParent].left = sibling;
+			}
+			else
+			{
+				nodes[grandParent].right = sibling;
+			}
+
+			nodes[sibling].parent = grandParent;
+			RefitBinaryAncestors(grandParent);
+		}
+
+		FreeNode(parent);
+		FreeNode(leafIndex);
+	}
+
+	void SceneBVH::SetWideChild(int wideIndex, uint8_t childSlot, int childRef, const AABB& aabb)
+	{
+		WideNode& node = wideNodes[wideIndex];
+		node.childRef[childSlot] = childRef;
+		SetWideChildBounds(wideIndex, childSlot, aabb);
+
+		if (IsEncodedWideLeaf(childRef))
+		{
+			const int leafIndex = DecodeWideLeaf(childRef);
+			leafToWideParent[leafIndex] = wideIndex;
+			leafToWideSlot[leafIndex] = childSlot;
+		}
+		else
+		{
+			wideNodes[childRef].parent = wideIndex;
+			wideNodes[childRef].parentSlot = childSlot;
+		}
+	}
+
+	void SceneBVH::AppendWideChild(int wideIndex, int childRef, const AABB& aabb)
+	{
+		const uint8_t childSlot = wideNodes[wideIndex].childCount++;
+		SetWideChild(wideIndex, childSlot, childRef, aabb);
+		ResetWideTraversalOrder(wideIndex);
+	}
+
+	// Swap-with-last keeps the active slots packed at the front, which the visible masks and traversal orders rely on
+	void SceneBVH::RemoveWideChild(int wideIndex, uint8_t childSlot)
+	{
+		WideNode& node = wideNodes[wideIndex];
+		const uint8_t lastSlot = static_cast<uint8_t>(node.childCount - 1);
+
+		if (childSlot != lastSlot)
+		{
+			AABB lastAABB;
+			lastAABB.min = glm::vec3(node.minX[lastSlot], node.minY[lastSlot], node.minZ[lastSlot]);
+			lastAABB.max = glm::vec3(node.maxX[lastSlot], node.maxY[lastSlot], node.maxZ[lastSlot]);
+			SetWideChild(wideIndex, childSlot, node.childRef[lastSlot], lastAABB);
+		}
+
+		WideNode& updated = wideNodes[wideIndex];
+		updated.childRef[lastSlot] = InvalidWideChild;
+		SetWideChildBounds(wideIndex, lastSlot, AABB{});
+		updated.childCount = lastSlot;
+		ResetWideTraversalOrder(wideIndex);
+	}
+
+	void SceneBVH::ResetWideTraversalOrder(int wideIndex)
+	{
+		WideNode& node = wideNodes[wideIndex];
+		for (uint8_t i = 0; i < WideArity; ++i)
+		{
+			node.childTraversalOrder[i] = i;
+		}
+		node.hasCullHistory = false;
+	}
+
+	AABB SceneBVH::GetWideChildAABB(int wideIndex, uint8_t childSlot) const
+	{
+		const WideNode& node = wideNodes[wideIndex];
+		AABB aabb;
+		aabb.min = glm::vec3(node.minX[childSlot], node.minY[childSlot], node.minZ[childSlot]);
+		aabb.max = glm::vec3(node.maxX[childSlot], node.maxY[childSlot], node.maxZ[childSlot]);
+		return aabb;
+	}
+
+	// FindBestSibling's branch and bound over the wide tree. A wide node costs one SIMD test however many slots it fills, so taking a
+	// free slot only costs what the ancestors grow by, while pairing with a full node's child also pays for the new wide node's area.
+	// Returns the wide node to insert into, outPairSlot is -1 for a free slot or the child slot to pair with.
+	int SceneBVH::FindBestWideInsert(const AABB& leafAABB, int& outPairSlot) const
+	{
+		int bestWide = wideRoot;
+		float bestCost = std::numeric_limits<float>::infinity();
+		outPairSlot = 0;
+
+		const AABB& rootAABB = wideNodes[wideRoot].traversalAABB;
+		insertSearchScratch.clear();
+		insertSearchScratch.push_back({ wideRoot, ComputeSurfaceArea(MergeAABBs(rootAABB, leafAABB)) - ComputeSurfaceArea(rootAABB) });
+
+		while (!insertSearchScratch.empty())
+		{
+			const std::pair<int, float> candidate = insertSearchScratch.back();
+			insertSearchScratch.pop_back();
+
+			const int wideIndex = candidate.first;
+			const float inheritedCost = candidate.second;
+			const WideNode& node = wideNodes[wideIndex];
+			const size_t firstPushed = insertSearchScratch.size();
+
+			if (node.childCount < WideArity && inheritedCost < bestCost)
+			{
+				bestCost = inheritedCost;
+				bestWide = wideIndex;
+				outPairSlot = -1;
+			}
+
+			for (uint8_t slot = 0; slot < node.childCount; ++slot)
+			{
+				const AABB childAABB = GetWideChildAABB(wideIndex, slot);
+				const float childArea = ComputeSurfaceArea(childAABB);
+				const float combinedArea = ComputeSurfaceArea(MergeAABBs(childAABB, leafAABB));
+
+				const float pairCost = inheritedCost + combinedArea;
+				if (pairCost < bestCost)
+				{
+					bestCost = pairCost;
+					bestWide = wideIndex;
+					outPairSlot = slot;
+				}
+
+				// Anything under an internal child at least pays for that child growing
+				const int childRef = node.childRef[slot];
+				const float childInheritedCost = inheritedCost + (combinedArea - childArea);
+				if (!IsEncodedWideLeaf(childRef) && childInheritedCost < bestCost)
+				{
+					insertSearchScratch.push_back({ childRef, childInheritedCost });
+				}
+			}
+
+			// Cheapest child pops first, so a good bound is found early and most of the other children get pruned
+			std::sort(insertSearchScratch.begin() + firstPushed, insertSearchScratch.end(), [](const std::pair<int, float>& a, const std::pair<int, float>& b)
+			{
+				return a.second > b.second;
+			});
+		}
+
+		return bestWide;
+	}
+
+	// RotateNode for wide nodes: swaps a child of wideIndex with a grandchild under one of its internal children when that shrinks the
+	// internal child. Only swaps involving changedSlot, the child the insert went through, are tried, the rest were already settled.
+	// The leaves under wideIndex stay the same, so its own bounds do not change.
+	void SceneBVH::RotateWideNode(int wideIndex, uint8_t changedSlot)
+	{
+		const uint8_t childCount = wideNodes[wideIndex].childCount;
+		if (childCount < 2)
+		{
+			return;
+		}
+
+		float bestDelta = 0.0f;
+		int bestOuterSlot = -1;
+		int bestInnerParentSlot = -1;
+		int bestInnerSlot = -1;
+
+		AABB childAABBs[WideArity];
+		for (uint8_t slot = 0; slot < childCount; ++slot)
+		{
+			childAABBs[slot] = GetWideChildAABB(wideIndex, slot);
+		}
+
+		for (uint8_t innerParentSlot = 0; innerParentSlot < childCount; ++innerParentSlot)
+		{
+			const int innerParent = wideNodes[wideIndex].childRef[innerParentSlot];
+			if (IsEncodedWideLeaf(innerParent) || wideNodes[innerParent].childCount < 2)
+			{
+				continue;
+			}
+
+			const uint8_t innerCount = wideNodes[innerParent].childCount;
+			const float innerParentArea = ComputeSurfaceArea(childAABBs[innerParentSlot]);
+
+			// Bounds of the inner parent without each of its children, from prefix and suffix merges
+			AABB prefix[WideArity + 1];
+			AABB suffix[WideArity + 1];
+			prefix[0].min = suffix[innerCount].min = glm::vec3(FLT_MAX);
+			prefix[0].max = suffix[innerCount].max = glm::vec3(-FLT_MAX);
+			for (uint8_t slot = 0; slot < innerCount; ++slot)
+			{
+				prefix[slot + 1] = MergeAABBs(prefix[slot], GetWideChildAABB(innerParent, slot));
+			}
+			for (int slot = innerCount - 1; slot >= 0; --slot)
+			{
+				suffix[slot] = MergeAABBs(suffix[slot + 1], GetWideChildAABB(innerParent, static_cast<uint8_t>(slot)));
+			}
+
+			for (uint8_t innerSlot = 0; innerSlot < innerCount; ++innerSlot)
+			{
+				const AABB without = MergeAABBs(prefix[innerSlot], suffix[innerSlot + 1]);
+				for (uint8_t outerSlot = 0; outerSlot < childCount; ++outerSlot)
+				{
+					if (outerSlot == innerParentSlot || (outerSlot != changedSlot && innerParentSlot != changedSlot))
+					{
+						continue;
+					}
+
+					const float delta = ComputeSurfaceArea(MergeAABBs(without, childAABBs[outerSlot])) - innerParentArea;
+					if (delta < bestDelta)
+					{
+						bestDelta = delta;
+						bestOuterSlot = outerSlot;
+						bestInnerParentSlot = innerParentSlot;
+						bestInnerSlot = innerSlot;
+					}
+				}
+			}
+		}
+
+		if (bestOuterSlot == -1)
+		{
+			return;
+		}
+
+		const int innerParent = wideNodes[wideIndex].childRef[bestInnerParentSlot];
+		const int outerRef = wideNodes[wideIndex].childRef[bestOuterSlot];
+		const int innerRef = wideNodes[innerParent].childRef[bestInnerSlot];
+		const AABB innerAABB = GetWideChildAABB(innerParent, static_cast<uint8_t>(bestInnerSlot));
+
+		SetWideChild(wideIndex, static_cast<uint8_t>(bestOuterSlot), innerRef, innerAABB);
+		SetWideChild(innerParent, static_cast<uint8_t>(bestInnerSlot), outerRef, childAABBs[bestOuterSlot]);
+		UpdateWideNodeBoundsFromChildren(innerParent);
+		ResetWideTraversalOrder(innerParent);
+		SetWideChildBounds(wideIndex, static_cast<uint8_t>(bestInnerParentSlot), wideNodes[innerParent].traversalAABB);
+		ResetWideTraversalOrder(wideIndex);
+	}
+
+	// The wide tree is maintained on its own rather than re-collapsed from the binary tree, with the same SAH placement and
+	// rotations the binary insert uses: either take a free slot or pair the best child with the leaf in a new wide node.
+	void SceneBVH::InsertWideLeaf(int leafIndex)
+	{
+		const AABB leafAABB = nodes[leafIndex].aabb;
+		const int leafRef = EncodeWideLeaf(leafIndex);
+
+		if (wideRoot == -1)
 		{
+			wideRoot = AllocateWideNode(-1, 0xFF);
+			AppendWideChild(wideRoot, leafRef, leafAABB);
+			UpdateWideNodeBoundsFromChildren(wideRoot);
 			return;
 		}
 
-		wideNodes.reserve(nodes.size());
-		wideRoot = BuildWideRecursive(root, -1, 0xFF);
-	}
+		int pairSlot = -1;
+		const int targetWide = FindBestWideInsert(leafAABB, pairSlot);
+		uint8_t changedSlot = static_cast<uint8_t>(pairSlot);
 
-	void SceneBVH::RefitWideAncestorsFromLeaf(int leafIndex)
-	{
-		if (leafIndex < 0 || leafIndex >= static_cast<int>(leafToWideParent.size()))
+		if (pairSlot == -1)
 		{
-			return;
+			changedSlot = wideNodes[targetWide].childCount;
+			AppendWideChild(targetWide, leafRef, leafAABB);
+		}
+		else
+		{
+			const int siblingRef = wideNodes[targetWide].childRef[pairSlot];
+			const AABB siblingAABB = GetWideChildAABB(targetWide, static_cast<uint8_t>(pairSlot));
+			const int newWide = AllocateWideNode(targetWide, static_cast<uint8_t>(pairSlot));
+			AppendWideChild(newWide, siblingRef, siblingAABB);
+			AppendWideChild(newWide, leafRef, leafAABB);
+			UpdateWideNodeBoundsFromChildren(newWide);
+			SetWideChild(targetWide, static_cast<uint8_t>(pairSlot), newWide, wideNodes[newWide].traversalAABB);
+		}
+
+		// Refit on the way up and rotate each ancestor once its children are final
+		int wideIndex = targetWide;
+		while (wideIndex != -1)
+		{
+			UpdateWideNodeBoundsFromChildren(wideIndex);
+			RotateWideNode(wideIndex, changedSlot);
+
+			const int parentWide = wideNodes[wideIndex].parent;
+			changedSlot = wideNodes[wideIndex].parentSlot;
+			if (parentWide != -1)
+			{
+				SetWideChildBounds(parentWide, changedSlot, wideNodes[wideIndex].traversalAABB);
+			}
+			wideIndex = parentWide;
 		}
+	}
 
+	void SceneBVH::RemoveWideLeaf(int leafIndex)
+	{
 		int wideIndex = leafToWideParent[leafIndex];
 		if (wideIndex == -1)
 		{
 			return;
 		}
 
-		const uint8_t slot = leafToWideSlot[leafIndex];
-		SetWideChildBounds(wideIndex, slot, nodes[leafIndex].aabb);
-		UpdateWideNodeBoundsFromChildren(wideIndex);
+		RemoveWideChild(wideIndex, leafToWideSlot[leafIndex]);
+		leafToWideParent[leafIndex] = -1;
+		leafToWideSlot[leafIndex] = 0xFF;
 
-		while (wideNodes[wideIndex].parent != -1)
+		// Drop nodes that emptied out
+		while (wideNodes[wideIndex].childCount == 0)
 		{
 			const int parentWide = wideNodes[wideIndex].parent;
 			const uint8_t parentSlot = wideNodes[wideIndex].parentSlot;
-			SetWideChildBounds(parentWide, parentSlot, wideNodes[wideIndex].traversalAABB);
-			UpdateWideNodeBoundsFromChildren(parentWide);
+			FreeWideNode(wideIndex);
+
+			if (parentWide == -1)
+			{
+				wideRoot = -1;
+				return;
+			}
+
+			RemoveWideChild(parentWide, parentSlot);
 			wideIndex = parentWide;
 		}
+
+		// Splice out a node left with a single child so the tree does not grow chains of one wide lanes
+		if (wideNodes[wideIndex].childCount == 1)
+		{
+			const WideNode& node = wideNodes[wideIndex];
+			const int onlyChildRef = node.childRef[0];
+			const int parentWide = node.parent;
+
+			if (parentWide != -1)
+			{
+				AABB childAABB;
+				childAABB.min = glm::vec3(node.minX[0], node.minY[0], node.minZ[0]);
+				childAABB.max = glm::vec3(node.maxX[0], node.maxY[0], node.maxZ[0]);
+				SetWideChild(parentWide, node.parentSlot, onlyChildRef, childAABB);
+				FreeWideNode(wideIndex);
+				wideIndex = parentWide;
+			}
+			else if (!IsEncodedWideLeaf(onlyChildRef))
+			{
+				wideRoot = onlyChildRef;
+				wideNodes[wideRoot].parent = -1;
+				wideNodes[wideRoot].parentSlot = 0xFF;
+				FreeWideNode(wideIndex);
+				wideIndex = wideRoot;
+			}
+		}
+
+		RefitWideAncestors(wideIndex);
+	}
+
+	void SceneBVH::RemoveEntityLeaf(entt::entity entity)
+	{
+		auto it = entityToLeaf.find(entity);
+		if (it == entityToLeaf.end())
+		{
+			return;
+		}
+
+		const int leafIndex = it->second;
+		entityToLeaf.erase(it);
+		RemoveLeaf(leafIndex);
 	}
 
 	const AABB& SceneBVH::GetTraversalAABB(const BVHNode& node) const
@@ -811,26 +1689,26 @@ namespace Engine
 		uint8_t planeOrder[kFrustumPlaneCount]{ 0, 1, 2, 3, 4, 5 };
 		BuildPlaneTraversalOrder(node.lastRejectedPlane, planeOrder);
 
-	#if SWIM_BVH_USE_SSE
-		const __m128 zero = _mm_setzero_ps();
+	#if SWIM_BVH_USE_AVX2
+		const __m256 zero = _mm256_setzero_ps();
 		for (int planePass = 0; planePass < kFrustumPlaneCount; ++planePass)
 		{
 			const int planeIndex = planeOrder[planePass];
 			const glm::vec4& plane = frustum.planes[planeIndex];
-			const __m128 px = _mm_set1_ps(plane.x);
-			const __m128 py = _mm_set1_ps(plane.y);
-			const __m128 pz = _mm_set1_ps(plane.z);
-			const __m128 pw = _mm_set1_ps(plane.w);
+			const __m256 px = _mm256_set1_ps(plane.x);
+			const __m256 py = _mm256_set1_ps(plane.y);
+			const __m256 pz = _mm256_set1_ps(plane.z);
+			const __m256 pw = _mm256_set1_ps(plane.w);
 
-			const __m128 outsideX = _mm_load_ps((plane.x >= 0.0f) ? node.maxX : node.minX);
-			const __m128 outsideY = _mm_load_ps((plane.y >= 0.0f) ? node.maxY : node.minY);
-			const __m128 outsideZ = _mm_load_ps((plane.z >= 0.0f) ? node.maxZ : node.minZ);
+			const __m256 outsideX = _mm256_load_ps((plane.x >= 0.0f) ? node.maxX : node.minX);
+			const __m256 outsideY = _mm256_load_ps((plane.y >= 0.0f) ? node.maxY : node.minY);
+			const __m256 outsideZ = _mm256_load_ps((plane.z >= 0.0f) ? node.maxZ : node.minZ);
 
-			__m128 outsideDistance = _mm_add_ps(_mm_mul_ps(px, outsideX), _mm_mul_ps(py, outsideY));
-			outsideDistance = _mm_add_ps(outsideDistance, _mm_mul_ps(pz, outsideZ));
-			outsideDistance = _mm_add_ps(outsideDistance, pw);
+			__m256 outsideDistance = _mm256_add_ps(_mm256_mul_ps(px, outsideX), _mm256_mul_ps(py, outsideY));
+			outsideDistance = _mm256_add_ps(outsideDistance, _mm256_mul_ps(pz, outsideZ));
+			outsideDistance = _mm256_add_ps(outsideDistance, pw);
 
-			const uint8_t outsideMask = static_cast<uint8_t>(_mm_movemask_ps(_mm_cmplt_ps(outsideDistance, zero))) & visibleMask;
+			const uint8_t outsideMask = static_cast<uint8_t>(_mm256_movemask_ps(_mm256_cmp_ps(outsideDistance, zero, _CMP_LT_OQ))) & visibleMask;
 			visibleMask = static_cast<uint8_t>(visibleMask & ~outsideMask);
 			fullyInsideMask = static_cast<uint8_t>(fullyInsideMask & visibleMask);
 			if (visibleMask == 0)
@@ -838,17 +1716,61 @@ namespace Engine
 				break;
 			}
 
-			const __m128 insideX = _mm_load_ps((plane.x >= 0.0f) ? node.minX : node.maxX);
-			const __m128 insideY = _mm_load_ps((plane.y >= 0.0f) ? node.minY : node.maxY);
-			const __m128 insideZ = _mm_load_ps((plane.z >= 0.0f) ? node.minZ : node.maxZ);
+			const __m256 insideX = _mm256_load_ps((plane.x >= 0.0f) ? node.minX : node.maxX);
+			const __m256 insideY = _mm256_load_ps((plane.y >= 0.0f) ? node.minY : node.maxY);
+			const __m256 insideZ = _mm256_load_ps((plane.z >= 0.0f) ? node.minZ : node.maxZ);
 
-			__m128 insideDistance = _mm_add_ps(_mm_mul_ps(px, insideX), _mm_mul_ps(py, insideY));
-			insideDistance = _mm_add_ps(insideDistance, _mm_mul_ps(pz, insideZ));
-			insideDistance = _mm_add_ps(insideDistance, pw);
+			__m256 insideDistance = _mm256_add_ps(_mm256_mul_ps(px, insideX), _mm256_mul_ps(py, insideY));
+			insideDistance = _mm256_add_ps(insideDistance, _mm256_mul_ps(pz, insideZ));
+			insideDistance = _mm256_add_ps(insideDistance, pw);
 
-			const uint8_t insideMask = static_cast<uint8_t>(_mm_movemask_ps(_mm_cmpge_ps(insideDistance, zero)));
+			const uint8_t insideMask = static_cast<uint8_t>(_mm256_movemask_ps(_mm256_cmp_ps(insideDistance, zero, _CMP_GE_OQ)));
 			fullyInsideMask = static_cast<uint8_t>(fullyInsideMask & insideMask);
 		}
+	#elif SWIM_BVH_USE_SSE
+		// One pass per group of 4 lanes, so an 8-wide node without AVX2 still gets tested 4 children at a time
+		const __m128 zero = _mm_setzero_ps();
+		for (int planePass = 0; planePass < kFrustumPlaneCount; ++planePass)
+		{
+			const int planeIndex = planeOrder[planePass];
+			const glm::vec4& plane = frustum.planes[planeIndex];
+			const __m128 px = _mm_set1_ps(plane.x);
+			const __m128 py = _mm_set1_ps(plane.y);
+			const __m128 pz = _mm_set1_ps(plane.z);
+			const __m128 pw = _mm_set1_ps(plane.w);
+
+			for (int lane = 0; lane < WideArity; lane += 4)
+			{
+				const __m128 outsideX = _mm_load_ps(((plane.x >= 0.0f) ? node.maxX : node.minX) + lane);
+				const __m128 outsideY = _mm_load_ps(((plane.y >= 0.0f) ? node.maxY : node.minY) + lane);
+				const __m128 outsideZ = _mm_load_ps(((plane.z >= 0.0f) ? node.maxZ : node.minZ) + lane);
+
+				__m128 outsideDistance = _mm_add_ps(_mm_mul_ps(px, outsideX), _mm_mul_ps(py, outsideY));
+				outsideDistance = _mm_add_ps(outsideDistance, _mm_mul_ps(pz, outsideZ));
+				outsideDistance = _mm_add_ps(outsideDistance, pw);
+
+				const uint8_t outsideMask = static_cast<uint8_t>(_mm_movemask_ps(_mm_cmplt_ps(outsideDistance, zero)) << lane) & visibleMask;
+				visibleMask = static_cast<uint8_t>(visibleMask & ~outsideMask);
+
+				const __m128 insideX = _mm_load_ps(((plane.x >= 0.0f) ? node.minX : node.maxX) + lane);
+				const __m128 insideY = _mm_load_ps(((plane.y >= 0.0f) ? node.minY : node.maxY) + lane);
+				const __m128 insideZ = _mm_load_ps(((plane.z >= 0.0f) ? node.minZ : node.maxZ) + lane);
+
+				__m128 insideDistance = _mm_add_ps(_mm_mul_ps(px, insideX), _mm_mul_ps(py, insideY));
+				insideDistance = _mm_add_ps(insideDistance, _mm_mul_ps(pz, insideZ));
+				insideDistance = _mm_add_ps(insideDistance, pw);
+
+				const uint8_t laneMask = static_cast<uint8_t>(0xFu << lane);
+				const uint8_t insideMask = static_cast<uint8_t>(_mm_movemask_ps(_mm_cmpge_ps(insideDistance, zero)) << lane);
+				fullyInsideMask = static_cast<uint8_t>(fullyInsideMask & (insideMask | ~laneMask));
+			}
+
+			fullyInsideMask = static_cast<uint8_t>(fullyInsideMask & visibleMask);
+			if (visibleMask == 0)
+			{
+				break;
+			}
+		}
 	#else
 		for (uint8_t childIndex = 0; childIndex < node.childCount; ++childIndex)
 		{
@@ -881,6 +1803,87 @@ namespace Engine
 		return visibleMask;
 	}
 
+	// Slab test of the ray against every child box of a wide node, lanes that hit within [tMin, tMax] get their bit set and their entry distance written
+	uint8_t SceneBVH::GetWideNodeRayHitMask(const WideNode& node, const Ray& ray, float tMin, float tMax, float* outTNear) const
+	{
+		const uint8_t activeChildMask = static_cast<uint8_t>((1u << node.childCount) - 1u);
+
+	#if SWIM_BVH_USE_AVX2
+		const __m256 originX = _mm256_set1_ps(ray.origin.x);
+		const __m256 originY = _mm256_set1_ps(ray.origin.y);
+		const __m256 originZ = _mm256_set1_ps(ray.origin.z);
+		const __m256 invDirX = _mm256_set1_ps(ray.invDir.x);
+		const __m256 invDirY = _mm256_set1_ps(ray.invDir.y);
+		const __m256 invDirZ = _mm256_set1_ps(ray.invDir.z);
+
+		const __m256 t1x = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.minX), originX), invDirX);
+		const __m256 t2x = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.maxX), originX), invDirX);
+		const __m256 t1y = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.minY), originY), invDirY);
+		const __m256 t2y = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.maxY), originY), invDirY);
+		const __m256 t1z = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.minZ), originZ), invDirZ);
+		const __m256 t2z = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.maxZ), originZ), invDirZ);
+
+		__m256 tNear = _mm256_max_ps(_mm256_min_ps(t1x, t2x), _mm256_min_ps(t1y, t2y));
+		tNear = _mm256_max_ps(tNear, _mm256_min_ps(t1z, t2z));
+		__m256 tFar = _mm256_min_ps(_mm256_max_ps(t1x, t2x), _mm256_max_ps(t1y, t2y));
+		tFar = _mm256_min_ps(tFar, _mm256_max_ps(t1z, t2z));
+
+		tNear = _mm256_max_ps(tNear, _mm256_set1_ps(tMin));
+		tFar = _mm256_min_ps(tFar, _mm256_set1_ps(tMax));
+		_mm256_storeu_ps(outTNear, tNear);
+
+		return static_cast<uint8_t>(_mm256_movemask_ps(_mm256_cmp_ps(tNear, tFar, _CMP_LE_OQ))) & activeChildMask;
+	#elif SWIM_BVH_USE_SSE
+		const __m128 originX = _mm_set1_ps(ray.origin.x);
+		const __m128 originY = _mm_set1_ps(ray.origin.y);
+		const __m128 originZ = _mm_set1_ps(ray.origin.z);
+		const __m128 invDirX = _mm_set1_ps(ray.invDir.x);
+		const __m128 invDirY = _mm_set1_ps(ray.invDir.y);
+		const __m128 invDirZ = _mm_set1_ps(ray.invDir.z);
+		const __m128 rayTMin = _mm_set1_ps(tMin);
+		const __m128 rayTMax = _mm_set1_ps(tMax);
+
+		uint8_t hitMask = 0;
+		for (int lane = 0; lane < WideArity; lane += 4)
+		{
+			const __m128 t1x = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minX + lane), originX), invDirX);
+			const __m128 t2x = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxX + lane), originX), invDirX);
+			const __m128 t1y = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minY + lane), originY), invDirY);
+			const __m128 t2y = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxY + lane), originY), invDirY);
+			const __m128 t1z = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minZ + lane), originZ), invDirZ);
+			const __m128 t2z = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxZ + lane), originZ), invDirZ);
+
+			__m128 tNear = _mm_max_ps(_mm_min_ps(t1x, t2x), _mm_min_ps(t1y, t2y));
+			tNear = _mm_max_ps(tNear, _mm_min_ps(t1z, t2z));
+			__m128 tFar = _mm_min_ps(_mm_max_ps(t1x, t2x), _mm_max_ps(t1y, t2y));
+			tFar = _mm_min_ps(tFar, _mm_max_ps(t1z, t2z));
+
+			tNear = _mm_max_ps(tNear, rayTMin);
+			tFar = _mm_min_ps(tFar, rayTMax);
+			_mm_storeu_ps(outTNear + lane, tNear);
+
+			hitMask = static_cast<uint8_t>(hitMask | (_mm_movemask_ps(_mm_cmple_ps(tNear, tFar)) << lane));
+		}
+
+		return static_cast<uint8_t>(hitMask & activeChildMask);
+	#else
+		uint8_t hitMask = 0;
+		for (uint8_t childIndex = 0; childIndex < node.childCount; ++childIndex)
+		{
+			AABB childAABB;
+			childAABB.min = glm::vec3(node.minX[childIndex], node.minY[childIndex], node.minZ[childIndex]);
+			childAABB.max = glm::vec3(node.maxX[childIndex], node.maxY[childIndex], node.maxZ[childIndex]);
+
+			if (RayIntersectsAABB(ray, childAABB, tMin, tMax, outTNear[childIndex]))
+			{
+				hitMask = static_cast<uint8_t>(hitMask | (1u << childIndex));
+			}
+		}
+
+		return hitMask;
+	#endif
+	}
+
 	void SceneBVH::CollectWideTraversalOrder(const WideNode& node, uint8_t visibleMask, uint8_t fullyInsideMask, uint8_t* outOrder, uint8_t& outCount) const
 	{
 		outCount = 0;
@@ -891,7 +1894,7 @@ namespace Engine
 		const uint8_t visibleIntersectingMask = static_cast<uint8_t>(clampedVisibleMask & ~clampedFullyInsideMask);
 		const uint8_t invisibleMask = static_cast<uint8_t>(activeMask & ~clampedVisibleMask);
 
-		uint8_t orderedAll[4]{ 0, 1, 2, 3 };
+		uint8_t orderedAll[WideArity];
 		uint8_t orderedAllCount = 0;
 		uint8_t emittedMask = 0;
 
@@ -1006,11 +2009,13 @@ namespace Engine
 		WideTraversalItem stack[WideTraversalStackMax];
 		int stackSize = 0;
 		stack[stackSize++] = { wideIndex, fullyInside };
+		uint64_t visitedWideNodes = 0;
 
 		while (stackSize > 0)
 		{
 			const WideTraversalItem item = stack[--stackSize];
 			const WideNode& node = wideNodes[item.wideIndex];
+			++visitedWideNodes;
 			if (item.fullyInside)
 			{
 				for (int orderIndex = static_cast<int>(node.childCount) - 1; orderIndex >= 0; --orderIndex)
@@ -1047,7 +2052,7 @@ namespace Engine
 			uint8_t fullyInsideMask = 0;
 			const uint8_t visibleMask = GetWideNodeVisibleMask(node, frustum, &fullyInsideMask);
 
-			uint8_t traversalOrder[4]{ 0, 1, 2, 3 };
+			uint8_t traversalOrder[WideArity];
 			uint8_t traversalCount = 0;
 			CollectWideTraversalOrder(node, visibleMask, fullyInsideMask, traversalOrder, traversalCount);
 
@@ -1076,6 +2081,8 @@ namespace Engine
 				}
 			}
 		}
+
+		AddWideNodesVisited(visitedWideNodes);
 	}
 
 	void SceneBVH::QueryFrustum(const Frustum& frustum, std::vector<entt::entity>& outVisible) const
@@ -1142,6 +2149,7 @@ namespace Engine
 		std::vector<WideTraversalItem>& seedItems = parallelSeedItemsScratch;
 		std::vector<entt::entity>& directlyVisible = parallelDirectVisibleScratch;
 
+		uint64_t visitedSeedNodes = 0;
 		while (stackSize > 0 && seedItems.size() < targetSeedCount)
 		{
 			const WideTraversalItem item = stack[--stackSize];
@@ -1153,10 +2161,12 @@ namespace Engine
 				continue;
 			}
 
+			++visitedSeedNodes;
+
 			uint8_t fullyInsideMask = 0;
 			const uint8_t visibleMask = GetWideNodeVisibleMask(node, frustum, &fullyInsideMask);
 
-			uint8_t traversalOrder[4]{ 0, 1, 2, 3 };
+			uint8_t traversalOrder[WideArity];
 			uint8_t traversalCount = 0;
 			CollectWideTraversalOrder(node, visibleMask, fullyInsideMask, traversalOrder, traversalCount);
 
@@ -1197,6 +2207,8 @@ namespace Engine
 			seedItems.push_back(stack[--stackSize]);
 		}
 
+		AddWideNodesVisited(visitedSeedNodes);
+
 		const size_t minParallelSeedCount = std::max<size_t>(workerSlots * 2, 8);
 		if (seedItems.size() < minParallelSeedCount)
 		{
@@ -1366,12 +2378,13 @@ namespace Engine
 	{
 		bool needsUpdate = !frustumObserver.empty();
 
-		if (!needsUpdate && !Transform::GetDirtyEntities().empty())
+		if (!needsUpdate)
 		{
-			needsUpdate = true;
+			const TransformDirtyTracker* dirtyTracker = TransformDirtyTracker::Find(registry);
+			needsUpdate = dirtyTracker && !dirtyTracker->GetDirtyEntities().empty();
 		}
 
-		if (!needsUpdate && topologyObserver.size() > 0)
+		if (!needsUpdate && (topologyObserver.size() > 0 || !pendingSync.empty()))
 		{
 			needsUpdate = true;
 		}
@@ -1385,32 +2398,19 @@ namespace Engine
 
 	void SceneBVH::RemoveEntity(entt::entity entity)
 	{
-		auto it = entityToLeaf.find(entity);
-		if (it == entityToLeaf.end())
+		if (entityToLeaf.find(entity) == entityToLeaf.end())
 		{
 			return;
 		}
 
-		const int idx = it->second;
-
-		// Tombstone this leaf: keep array topology intact for this frame.
-		nodes[idx].entity = entt::null;
-		nodes[idx].aabb.min = glm::vec3(FLT_MAX);
-		nodes[idx].aabb.max = glm::vec3(-FLT_MAX);
-		nodes[idx].fatAABB.min = glm::vec3(FLT_MAX);
-		nodes[idx].fatAABB.max = glm::vec3(-FLT_MAX);
-		nodes[idx].hasCullHistory = false;
+		// Unlink the leaf in place, both hierarchies stay valid for queries this frame without a rebuild
+		RemoveEntityLeaf(entity);
 
-		if (idx >= 0 && idx < static_cast<int>(leafToWideParent.size()))
+		// This runs from on_destroy of a single component, the entity may still be renderable through another one
+		if (registry.valid(entity))
 		{
-			leafToWideParent[idx] = -1;
-			leafToWideSlot[idx] = 0xFF;
+			pendingSync.push_back(entity);
 		}
-
-		entityToLeaf.erase(it);
-
-		// Ensure we rebuild/refit before anyone traverses.
-		forceUpdate = true;
 	}
 
 	entt::entity SceneBVH::RayCastClosestHit
@@ -1426,26 +2426,26 @@ namespace Engine
 			*outTHit = std::numeric_limits<float>::infinity();
 		}
 
-		if (root == -1)
+		if (wideRoot == -1)
 		{
 			return entt::null;
 		}
 
-		static constexpr int STACK_MAX = 512;
-		struct Item { int idx; float tnear; };
-		Item stack[STACK_MAX];
+		struct Item { int wideIndex; float tnear; };
+		Item stack[WideTraversalStackMax];
 		int sp = 0;
 
 		float tRoot;
-		if (!RayIntersectsAABB(ray, GetTraversalAABB(nodes[root]), tMin, tMax, tRoot))
+		if (!RayIntersectsAABB(ray, wideNodes[wideRoot].traversalAABB, tMin, tMax, tRoot))
 		{
 			return entt::null;
 		}
 
-		stack[sp++] = { root, tRoot };
+		stack[sp++] = { wideRoot, tRoot };
 
 		float bestT = std::numeric_limits<float>::infinity();
 		entt::entity bestE = entt::null;
+		uint64_t visitedNodes = 0;
 
 		while (sp)
 		{
@@ -1457,61 +2457,387 @@ namespace Engine
 				continue;
 			}
 
-			const BVHNode& node = nodes[it.idx];
+			const WideNode& node = wideNodes[it.wideIndex];
+			++visitedNodes;
 
-			if (node.IsLeaf())
+			// Intersect children with tMax tightened to current best
+			alignas(WideLaneBytes) float childTNear[WideArity];
+			uint8_t hitOrder[WideArity];
+			const uint8_t hitCount = SortWideRayHits(GetWideNodeRayHitMask(node, ray, tMin, std::min(tMax, bestT), childTNear), childTNear, hitOrder);
+
+			for (int orderIndex = static_cast<int>(hitCount) - 1; orderIndex >= 0; --orderIndex)
+			{
+				const uint8_t childIndex = hitOrder[orderIndex];
+				const int childRef = node.childRef[childIndex];
+				const float tChild = childTNear[childIndex];
+
+				if (IsEncodedWideLeaf(childRef))
+				{
+					// Leaf slots hold the tight entity bounds, so the slab distance is the hit distance (no re-test)
+					const entt::entity entity = nodes[DecodeWideLeaf(childRef)].entity;
+					if (entity != entt::null && tChild <= bestT)
+					{
+						bestT = tChild;
+						bestE = entity;
+					}
+				}
+				else if (childRef >= 0 && sp < WideTraversalStackMax)
+				{
+					// Farther children go on the stack first so nearer pops next
+					stack[sp++] = { childRef, tChild };
+				}
+			}
+		}
+
+		AddWideNodesVisited(visitedNodes);
+
+		if (bestE != entt::null && outTHit)
+		{
+			*outTHit = bestT;
+		}
+
+		return bestE;
+	}
+
+	void SceneBVH::RayCastBatch
+	(
+		std::span<const Ray> rays,
+		std::vector<RayHit>& outHits,
+		float tMin,
+		float tMax
+	) const
+	{
+		outHits.assign(rays.size(), RayHit{});
+
+		if (wideRoot == -1 || rays.empty())
+		{
+			return;
+		}
+
+		// Counting sort by direction octant so each packet holds rays that agree on slab order, stable so neighbouring rays stay neighbours
+		auto directionOctant = [](const Ray& ray)
+		{
+			return static_cast<size_t>(ray.sign[0] | (ray.sign[1] << 1) | (ray.sign[2] << 2));
+		};
+
+		size_t octantStart[9]{};
+		for (const Ray& ray : rays)
+		{
+			++octantStart[directionOctant(ray) + 1];
+		}
+		for (int octant = 0; octant < 8; ++octant)
+		{
+			octantStart[octant + 1] += octantStart[octant];
+		}
+
+		// Local rather than a member so several threads can cast batches against the same tree, the allocation is small next to the trace.
+		// Not thread_local either, a worker waiting on its packets may pick up another batch and reenter here.
+		std::vector<uint32_t> order(rays.size());
+		for (uint32_t rayIndex = 0; rayIndex < static_cast<uint32_t>(rays.size()); ++rayIndex)
+		{
+			order[octantStart[directionOctant(rays[rayIndex])]++] = rayIndex;
+		}
+
+		const size_t packetCount = (rays.size() + RayPacketWidth - 1) / RayPacketWidth;
+
+		auto tracePackets = [&](size_t firstPacket, size_t endPacket)
+		{
+			uint64_t visitedNodes = 0;
+
+			for (size_t packetIndex = firstPacket; packetIndex < endPacket; ++packetIndex)
 			{
-				// Skip tombstones
-				if (node.entity != entt::null)
+				const size_t firstRay = packetIndex * RayPacketWidth;
+				const size_t laneCount = std::min<size_t>(RayPacketWidth, rays.size() - firstRay);
+
+				RayPacket packet;
+				packet.activeMask = static_cast<uint8_t>((1u << laneCount) - 1u);
+				for (size_t lane = 0; lane < RayPacketWidth; ++lane)
+				{
+					// Padding lanes repeat the last ray, they are masked out but keep the slab math finite
+					const Ray& ray = rays[order[firstRay + std::min(lane, laneCount - 1)]];
+					packet.originX[lane] = ray.origin.x;
+					packet.originY[lane] = ray.origin.y;
+					packet.originZ[lane] = ray.origin.z;
+					packet.invDirX[lane] = ray.invDir.x;
+					packet.invDirY[lane] = ray.invDir.y;
+					packet.invDirZ[lane] = ray.invDir.z;
+					packet.tMin[lane] = tMin;
+					packet.bestT[lane] = tMax;
+					packet.bestEntity[lane] = entt::null;
+				}
+
+				visitedNodes += TraceRayPacket(packet);
+
+				for (size_t lane = 0; lane < laneCount; ++lane)
 				{
-					// Use carried tnear as the leaf hit distance (no re-test)
-					const float tLeaf = it.tnear;
-					if (tLeaf >= tMin && tLeaf <= bestT)
+					RayHit& hit = outHits[order[firstRay + lane]];
+					hit.entity = packet.bestEntity[lane];
+					if (hit.entity != entt::null)
 					{
-						bestT = tLeaf;
-						bestE = node.entity;
+						hit.t = packet.bestT[lane];
 					}
 				}
+			}
+
+			AddWideNodesVisited(visitedNodes);
+		};
+
+		const size_t taskCount = (packetCount + kRayPacketsPerTask - 1) / kRayPacketsPerTask;
+		if (taskCount <= 1)
+		{
+			tracePackets(0, packetCount);
+			return;
+		}
+
+		ParallelForRenderTasks(taskCount, [&](size_t taskIndex, uint32_t /*workerIndex*/)
+		{
+			const size_t firstPacket = taskIndex * kRayPacketsPerTask;
+			tracePackets(firstPacket, std::min(packetCount, firstPacket + kRayPacketsPerTask));
+		});
+	}
+
+	// Same front to back walk as RayCastClosestHit, but a node is entered when any lane of the packet still hits it
+	uint64_t SceneBVH::TraceRayPacket(RayPacket& packet) const
+	{
+		struct Item { int wideIndex; float tnear; };
+		Item stack[WideTraversalStackMax];
+		int sp = 0;
+
+		alignas(WideLaneBytes) float laneTNear[RayPacketWidth];
+		const WideNode& rootNode = wideNodes[wideRoot];
+		if (GetRayPacketHitMask(packet, rootNode.traversalAABB.min, rootNode.traversalAABB.max, laneTNear) == 0)
+		{
+			return 0;
+		}
+
+		stack[sp++] = { wideRoot, -std::numeric_limits<float>::infinity() };
+		uint64_t visitedNodes = 0;
+
+		while (sp)
+		{
+			const Item it = stack[--sp];
+
+			// Prune when even the farthest lane already has a closer hit
+			float farthestBest = -std::numeric_limits<float>::infinity();
+			for (int lane = 0; lane < RayPacketWidth; ++lane)
+			{
+				if (packet.activeMask & (1u << lane))
+				{
+					farthestBest = std::max(farthestBest, packet.bestT[lane]);
+				}
+			}
 
+			if (it.tnear > farthestBest)
+			{
 				continue;
 			}
 
-			// Intersect children with tMax tightened to current best
-			float tL, tR;
-			const bool hitL = RayIntersectsAABB(ray, GetTraversalAABB(nodes[node.left]), tMin, bestT, tL);
-			const bool hitR = RayIntersectsAABB(ray, GetTraversalAABB(nodes[node.right]), tMin, bestT, tR);
+			const WideNode& node = wideNodes[it.wideIndex];
+			++visitedNodes;
 
-			if (hitL && hitR)
+			Item internalHits[WideArity];
+			int internalHitCount = 0;
+
+			for (uint8_t childIndex = 0; childIndex < node.childCount; ++childIndex)
 			{
-				// Push farther first so nearer pops next
-				const bool leftIsNear = (tL <= tR);
-				const int  nearIdx = leftIsNear ? node.left : node.right;
-				const int  farIdx = leftIsNear ? node.right : node.left;
-				const float tNear = leftIsNear ? tL : tR;
-				const float tFar = leftIsNear ? tR : tL;
+				const int childRef = node.childRef[childIndex];
+				if (childRef == InvalidWideChild)
+				{
+					continue;
+				}
+
+				const glm::vec3 childMin(node.minX[childIndex], node.minY[childIndex], node.minZ[childIndex]);
+				const glm::vec3 childMax(node.maxX[childIndex], node.maxY[childIndex], node.maxZ[childIndex]);
+				const uint8_t hitMask = GetRayPacketHitMask(packet, childMin, childMax, laneTNear);
+				if (hitMask == 0)
+				{
+					continue;
+				}
+
+				if (IsEncodedWideLeaf(childRef))
+				{
+					// Far is clamped to bestT in the slab test, so every hit lane is a new closest hit
+					const entt::entity entity = nodes[DecodeWideLeaf(childRef)].entity;
+					if (entity == entt::null)
+					{
+						continue;
+					}
+
+					for (int lane = 0; lane < RayPacketWidth; ++lane)
+					{
+						if (hitMask & (1u << lane))
+						{
+							packet.bestT[lane] = laneTNear[lane];
+							packet.bestEntity[lane] = entity;
+						}
+					}
+					continue;
+				}
 
-				if (sp + 2 <= STACK_MAX)
+				float nearest = std::numeric_limits<float>::infinity();
+				for (int lane = 0; lane < RayPacketWidth; ++lane)
 				{
-					stack[sp++] = { farIdx,  tFar };
-					stack[sp++] = { nearIdx, tNear };
+					if (hitMask & (1u << lane))
+					{
+						nearest = std::min(nearest, laneTNear[lane]);
+					}
+				}
+
+				// Keep internalHits sorted far to near so they push in the right order
+				int insertAt = internalHitCount++;
+				while (insertAt > 0 && internalHits[insertAt - 1].tnear < nearest)
+				{
+					internalHits[insertAt] = internalHits[insertAt - 1];
+					--insertAt;
 				}
+				internalHits[insertAt] = { childRef, nearest };
 			}
-			else if (hitL)
+
+			for (int i = 0; i < internalHitCount && sp < WideTraversalStackMax; ++i)
 			{
-				if (sp + 1 <= STACK_MAX) stack[sp++] = { node.left,  tL };
+				stack[sp++] = internalHits[i];
 			}
-			else if (hitR)
+		}
+
+		return visitedNodes;
+	}
+
+	// Slab test of one box against every lane of the packet, far distances are clamped to each lane's current best hit
+	uint8_t SceneBVH::GetRayPacketHitMask(const RayPacket& packet, const glm::vec3& boxMin, const glm::vec3& boxMax, float* outTNear) const
+	{
+	#if SWIM_BVH_USE_AVX2
+		const __m256 originX = _mm256_load_ps(packet.originX);
+		const __m256 originY = _mm256_load_ps(packet.originY);
+		const __m256 originZ = _mm256_load_ps(packet.originZ);
+		const __m256 invDirX = _mm256_load_ps(packet.invDirX);
+		const __m256 invDirY = _mm256_load_ps(packet.invDirY);
+		const __m256 invDirZ = _mm256_load_ps(packet.invDirZ);
+
+		const __m256 t1x = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(boxMin.x), originX), invDirX);
+		const __m256 t2x = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(boxMax.x), originX), invDirX);
+		const __m256 t1y = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(boxMin.y), originY), invDirY);
+		const __m256 t2y = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(boxMax.y), originY), invDirY);
+		const __m256 t1z = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(boxMin.z), originZ), invDirZ);
+		const __m256 t2z = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(boxMax.z), originZ), invDirZ);
+
+		__m256 tNear = _mm256_max_ps(_mm256_min_ps(t1x, t2x), _mm256_min_ps(t1y, t2y));
+		tNear = _mm256_max_ps(tNear, _mm256_min_ps(t1z, t2z));
+		__m256 tFar = _mm256_min_ps(_mm256_max_ps(t1x, t2x), _mm256_max_ps(t1y, t2y));
+		tFar = _mm256_min_ps(tFar, _mm256_max_ps(t1z, t2z));
+
+		tNear = _mm256_max_ps(tNear, _mm256_load_ps(packet.tMin));
+		tFar = _mm256_min_ps(tFar, _mm256_load_ps(packet.bestT));
+		_mm256_store_ps(outTNear, tNear);
+
+		return static_cast<uint8_t>(_mm256_movemask_ps(_mm256_cmp_ps(tNear, tFar, _CMP_LE_OQ))) & packet.activeMask;
+	#elif SWIM_BVH_USE_SSE
+		const __m128 minX = _mm_set1_ps(boxMin.x);
+		const __m128 minY = _mm_set1_ps(boxMin.y);
+		const __m128 minZ = _mm_set1_ps(boxMin.z);
+		const __m128 maxX = _mm_set1_ps(boxMax.x);
+		const __m128 maxY = _mm_set1_ps(boxMax.y);
+		const __m128 maxZ = _mm_set1_ps(boxMax.z);
+
+		uint8_t hitMask = 0;
+		for (int lane = 0; lane < RayPacketWidth; lane += 4)
+		{
+			const __m128 originX = _mm_load_ps(packet.originX + lane);
+			const __m128 originY = _mm_load_ps(packet.originY + lane);
+			const __m128 originZ = _mm_load_ps(packet.originZ + lane);
+			const __m128 invDirX = _mm_load_ps(packet.invDirX + lane);
+			const __m128 invDirY = _mm_load_ps(packet.invDirY + lane);
+			const __m128 invDirZ = _mm_load_ps(packet.invDirZ + lane);
+
+			const __m128 t1x = _mm_mul_ps(_mm_sub_ps(minX, originX), invDirX);
+			const __m128 t2x = _mm_mul_ps(_mm_sub_ps(maxX, originX), invDirX);
+			const __m128 t1y = _mm_mul_ps(_mm_sub_ps(minY, originY), invDirY);
+			const __m128 t2y = _mm_mul_ps(_mm_sub_ps(maxY, originY), invDirY);
+			const __m128 t1z = _mm_mul_ps(_mm_sub_ps(minZ, originZ), invDirZ);
+			const __m128 t2z = _mm_mul_ps(_mm_sub_ps(maxZ, originZ), invDirZ);
+
+			__m128 tNear = _mm_max_ps(_mm_min_ps(t1x, t2x), _mm_min_ps(t1y, t2y));
+			tNear = _mm_max_ps(tNear, _mm_min_ps(t1z, t2z));
+			__m128 tFar = _mm_min_ps(_mm_max_ps(t1x, t2x), _mm_max_ps(t1y, t2y));
+			tFar = _mm_min_ps(tFar, _mm_max_ps(t1z, t2z));
+
+			tNear = _mm_max_ps(tNear, _mm_load_ps(packet.tMin + lane));
+			tFar = _mm_min_ps(tFar, _mm_load_ps(packet.bestT + lane));
+			_mm_store_ps(outTNear + lane, tNear);
+
+			hitMask = static_cast<uint8_t>(hitMask | (_mm_movemask_ps(_mm_cmple_ps(tNear, tFar)) << lane));
+		}
+
+		return static_cast<uint8_t>(hitMask & packet.activeMask);
+	#else
+		uint8_t hitMask = 0;
+		for (int lane = 0; lane < RayPacketWidth; ++lane)
+		{
+			const float t1x = (boxMin.x - packet.originX[lane]) * packet.invDirX[lane];
+			const float t2x = (boxMax.x - packet.originX[lane]) * packet.invDirX[lane];
+			const float t1y = (boxMin.y - packet.originY[lane]) * packet.invDirY[lane];
+			const float t2y = (boxMax.y - packet.originY[lane]) * packet.invDirY[lane];
+			const float t1z = (boxMin.z - packet.originZ[lane]) * packet.invDirZ[lane];
+			const float t2z = (boxMax.z - packet.originZ[lane]) * packet.invDirZ[lane];
+
+			const float tNear = std::max({ std::min(t1x, t2x), std::min(t1y, t2y), std::min(t1z, t2z), packet.tMin[lane] });
+			const float tFar = std::min({ std::max(t1x, t2x), std::max(t1y, t2y), std::max(t1z, t2z), packet.bestT[lane] });
+			outTNear[lane] = tNear;
+
+			if (tNear <= tFar)
 			{
-				if (sp + 1 <= STACK_MAX) stack[sp++] = { node.right, tR };
+				hitMask = static_cast<uint8_t>(hitMask | (1u << lane));
 			}
 		}
 
-		if (bestE != entt::null && outTHit)
+		return static_cast<uint8_t>(hitMask & packet.activeMask);
+	#endif
+	}
+
+	SceneBVH::TraversalStats SceneBVH::GetTraversalStats() const
+	{
+		TraversalStats stats;
+		stats.wideNodesVisited = wideNodesVisited.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	void SceneBVH::ResetTraversalStats() const
+	{
+		wideNodesVisited.store(0, std::memory_order_relaxed);
+	}
+
+	bool SceneBVH::TryGetEntityAABB(entt::entity entity, AABB& outAABB) const
+	{
+		auto it = entityToLeaf.find(entity);
+		if (it == entityToLeaf.end())
 		{
-			*outTHit = bestT;
+			return false;
 		}
 
-		return bestE;
+		outAABB = nodes[it->second].aabb;
+		return true;
+	}
+
+	size_t SceneBVH::GetMemoryFootprintBytes() const
+	{
+		size_t bytes = 0;
+		bytes += nodes.capacity() * sizeof(BVHNode);
+		bytes += wideNodes.capacity() * sizeof(WideNode);
+		bytes += leafToWideParent.capacity() * sizeof(int);
+		bytes += leafToWideSlot.capacity() * sizeof(uint8_t);
+		bytes += (freeNodes.capacity() + freeWideNodes.capacity()) * sizeof(int);
+
+		// Node based map, so count a bucket pointer plus one heap node per element as a rough estimate
+		bytes += entityToLeaf.bucket_count() * sizeof(void*);
+		bytes += entityToLeaf.size() * (sizeof(std::pair<const entt::entity, int>) + 2 * sizeof(void*));
+
+		bytes += parallelSeedItemsScratch.capacity() * sizeof(WideTraversalItem);
+		bytes += parallelDirectVisibleScratch.capacity() * sizeof(entt::entity);
+		for (const ParallelVisibleScratch& scratch : parallelVisibleScratch)
+		{
+			bytes += scratch.visible.capacity() * sizeof(entt::entity);
+		}
+
+		return bytes;
 	}
 
 	// I have more versions of IsAABBVisible, and I have no idea which one is fastest
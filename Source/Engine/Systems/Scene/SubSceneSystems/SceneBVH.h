@@ -1,16 +1,28 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <utility>
 #include <vector>
 #include <unordered_map>
 #include <limits>
+#include <span>
 
 #include "Library/glm/glm.hpp"
 #include "Library/EnTT/entt.hpp"
 #include "SceneDebugDraw.h"
 #include "Engine/Systems/Renderer/Core/MathTypes/MathAlgorithms.h"
 
+// Children per wide node. Builds targeting AVX2 (/arch:AVX2) get 8-wide nodes tested with one 256 bit pass, everything else keeps 4-wide SSE nodes.
+// Define SWIM_BVH_WIDE_ARITY before including this header to force either layout, 8-wide without AVX2 runs the SSE test twice per node.
+#ifndef SWIM_BVH_WIDE_ARITY
+#if defined(__AVX2__)
+#define SWIM_BVH_WIDE_ARITY 8
+#else
+#define SWIM_BVH_WIDE_ARITY 4
+#endif
+#endif
+
 namespace Engine
 {
 
@@ -43,6 +55,22 @@ namespace Engine
 			debugDrawer = drawer;
 		}
 
+		// Node visit counters for benchmarking, each traversal accumulates locally and flushes once when it finishes.
+		struct TraversalStats
+		{
+			uint64_t wideNodesVisited = 0;
+		};
+
+		TraversalStats GetTraversalStats() const;
+		void ResetTraversalStats() const;
+
+		// Approximate bytes held by the BVH containers (capacity based), so memory regressions show up next to timings.
+		size_t GetMemoryFootprintBytes() const;
+		size_t GetLeafCount() const { return entityToLeaf.size(); }
+
+		// Tight world bounds the entity's leaf was last refit with, false if the entity is not in the tree
+		bool TryGetEntityAABB(entt::entity entity, AABB& outAABB) const;
+
 		template<typename Func>
 		void QueryFrustumCallback(const Frustum& frustum, Func&& callback) const
 		{
@@ -59,10 +87,13 @@ namespace Engine
 				return;
 			}
 
+			uint64_t visitedWideNodes = 0;
+
 			while (stackSize > 0)
 			{
 				const WideTraversalItem item = stack[--stackSize];
 				const WideNode& node = wideNodes[item.wideIndex];
+				++visitedWideNodes;
 
 				if (item.fullyInside)
 				{
@@ -100,7 +131,7 @@ namespace Engine
 				uint8_t fullyInsideMask = 0;
 				const uint8_t visibleMask = GetWideNodeVisibleMask(node, frustum, &fullyInsideMask);
 
-				uint8_t traversalOrder[4]{ 0, 1, 2, 3 };
+				uint8_t traversalOrder[WideArity];
 				uint8_t traversalCount = 0;
 				CollectWideTraversalOrder(node, visibleMask, fullyInsideMask, traversalOrder, traversalCount);
 
@@ -129,6 +160,8 @@ namespace Engine
 					}
 				}
 			}
+
+			AddWideNodesVisited(visitedWideNodes);
 		}
 
 		// outTHit is an optional output parameter that lets you know where along the ray the closest hit occurred.
@@ -140,6 +173,25 @@ namespace Engine
 			float* outTHit = nullptr
 		) const;
 
+		// Closest hit of one ray in a batch, entity stays entt::null on a miss
+		struct RayHit
+		{
+			entt::entity entity{ entt::null };
+			float t = std::numeric_limits<float>::infinity();
+		};
+
+		// Closest hit for every ray, outHits[i] answers rays[i].
+		// Rays are traced in packets of WideArity that share one walk of the wide tree, and packets are spread over the render workers.
+		// Rays are grouped by direction octant first, so callers only need to keep rays from the same origin next to each other.
+		// Keeps no state between calls, so several threads may cast batches against the same tree at once.
+		void RayCastBatch
+		(
+			std::span<const Ray> rays,
+			std::vector<RayHit>& outHits,
+			float tMin = 0.0f,
+			float tMax = std::numeric_limits<float>::infinity()
+		) const;
+
 		// Visits all leaf AABBs hit; callback can early-out
 		template<typename Func>
 		void RayCastCallback
@@ -150,77 +202,68 @@ namespace Engine
 			float tMax
 		) const
 		{
-			if (root == -1) return;
+			if (wideRoot == -1) return;
 
 			// Manual stack (index + tnear). No heap, predictable.
-			static constexpr int STACK_MAX = 512;
-			struct Item { int idx; float tnear; };
-			Item stack[STACK_MAX];
+			struct Item { int wideIndex; float tnear; };
+			Item stack[WideTraversalStackMax];
 			int sp = 0;
 
 			float tRoot;
-			if (!RayIntersectsAABB(ray, GetTraversalAABB(nodes[root]), tMin, tMax, tRoot))
+			if (!RayIntersectsAABB(ray, wideNodes[wideRoot].traversalAABB, tMin, tMax, tRoot))
 			{
 				return;
 			}
 
-			stack[sp++] = { root, tRoot };
+			stack[sp++] = { wideRoot, tRoot };
+			uint64_t visitedNodes = 0;
 
 			while (sp)
 			{
-				// LIFO pop (nearer child is pushed last to pop next)
 				const Item it = stack[--sp];
-				const int idx = it.idx;
-				const auto& node = nodes[idx];
+				const WideNode& node = wideNodes[it.wideIndex];
+				++visitedNodes;
+
+				alignas(WideLaneBytes) float childTNear[WideArity];
+				uint8_t hitOrder[WideArity];
+				const uint8_t hitCount = SortWideRayHits(GetWideNodeRayHitMask(node, ray, tMin, tMax, childTNear), childTNear, hitOrder);
 
-				if (node.IsLeaf())
+				// Leaves report near to far, then internal children are pushed farther first so the nearest pops next
+				for (uint8_t orderIndex = 0; orderIndex < hitCount; ++orderIndex)
 				{
-					if (node.entity == entt::null)
+					const uint8_t childIndex = hitOrder[orderIndex];
+					const int childRef = node.childRef[childIndex];
+					if (!IsEncodedWideLeaf(childRef))
 					{
 						continue;
 					}
 
-					float tLeaf;
-					if (RayIntersectsAABB(ray, node.aabb, tMin, tMax, tLeaf))
+					const BVHNode& leaf = nodes[DecodeWideLeaf(childRef)];
+					if (leaf.entity == entt::null)
 					{
-						// callback returns false to stop early
-						if (!callback(node.entity, tLeaf, node.aabb))
-						{
-							return;
-						}
+						continue;
 					}
-					continue;
-				}
-
-				// Internal: test children; push farther first so nearer is popped next
-				float tL, tR;
-				const bool hitL = RayIntersectsAABB(ray, GetTraversalAABB(nodes[node.left]), tMin, tMax, tL);
-				const bool hitR = RayIntersectsAABB(ray, GetTraversalAABB(nodes[node.right]), tMin, tMax, tR);
 
-				if (hitL & hitR) // single branch for both
-				{
-					// Push farther first, then nearer (stack pop gets nearer next)
-					const bool leftIsNear = (tL <= tR);
-					const int nearIdx = leftIsNear ? node.left : node.right;
-					const int farIdx = leftIsNear ? node.right : node.left;
-					const float tNear = leftIsNear ? tL : tR;
-					const float tFar = leftIsNear ? tR : tL;
-
-					if (sp + 2 <= STACK_MAX)
+					// callback returns false to stop early
+					if (!callback(leaf.entity, childTNear[childIndex], leaf.aabb))
 					{
-						stack[sp++] = { farIdx,  tFar };
-						stack[sp++] = { nearIdx, tNear };
+						AddWideNodesVisited(visitedNodes);
+						return;
 					}
 				}
-				else if (hitL)
-				{
-					if (sp + 1 <= STACK_MAX) stack[sp++] = { node.left, tL };
-				}
-				else if (hitR)
+
+				for (int orderIndex = static_cast<int>(hitCount) - 1; orderIndex >= 0; --orderIndex)
 				{
-					if (sp + 1 <= STACK_MAX) stack[sp++] = { node.right, tR };
+					const uint8_t childIndex = hitOrder[orderIndex];
+					const int childRef = node.childRef[childIndex];
+					if (childRef >= 0 && sp < WideTraversalStackMax)
+					{
+						stack[sp++] = { childRef, childTNear[childIndex] };
+					}
 				}
 			}
+
+			AddWideNodesVisited(visitedNodes);
 		}
 
 	private:
@@ -249,16 +292,20 @@ namespace Engine
 		};
 
 		static constexpr int InvalidWideChild = INT32_MIN;
+		static constexpr int WideArity = SWIM_BVH_WIDE_ARITY;
+		static constexpr size_t WideLaneBytes = WideArity * sizeof(float); // one SoA row fills a whole SSE or AVX register
+
+		static_assert(WideArity == 4 || WideArity == 8, "SWIM_BVH_WIDE_ARITY must be 4 or 8, child masks are uint8_t");
 
-		struct alignas(16) WideNode
+		struct alignas(WideLaneBytes) WideNode
 		{
-			alignas(16) float minX[4]{ 0.0f, 0.0f, 0.0f, 0.0f };
-			alignas(16) float minY[4]{ 0.0f, 0.0f, 0.0f, 0.0f };
-			alignas(16) float minZ[4]{ 0.0f, 0.0f, 0.0f, 0.0f };
-			alignas(16) float maxX[4]{ 0.0f, 0.0f, 0.0f, 0.0f };
-			alignas(16) float maxY[4]{ 0.0f, 0.0f, 0.0f, 0.0f };
-			alignas(16) float maxZ[4]{ 0.0f, 0.0f, 0.0f, 0.0f };
-			int childRef[4]{ InvalidWideChild, InvalidWideChild, InvalidWideChild, InvalidWideChild };
+			alignas(WideLaneBytes) float minX[WideArity]{};
+			alignas(WideLaneBytes) float minY[WideArity]{};
+			alignas(WideLaneBytes) float minZ[WideArity]{};
+			alignas(WideLaneBytes) float maxX[WideArity]{};
+			alignas(WideLaneBytes) float maxY[WideArity]{};
+			alignas(WideLaneBytes) float maxZ[WideArity]{};
+			int childRef[WideArity];
 			int parent = -1;
 			uint8_t parentSlot = 0xFF;
 			uint8_t childCount = 0;
@@ -269,10 +316,19 @@ namespace Engine
 			mutable uint8_t lastClassification = 0;
 			mutable uint8_t lastVisibleMask = 0;
 			mutable uint8_t lastFullyInsideMask = 0;
-			mutable uint8_t childTraversalOrder[4]{ 0, 1, 2, 3 };
+			mutable uint8_t childTraversalOrder[WideArity];
 			mutable bool lastVisible = false;
 			mutable bool hasCullHistory = false;
 			AABB traversalAABB;
+
+			WideNode()
+			{
+				for (uint8_t i = 0; i < WideArity; ++i)
+				{
+					childRef[i] = InvalidWideChild;
+					childTraversalOrder[i] = i;
+				}
+			}
 		};
 
 		static bool IsEncodedWideLeaf(int childRef)
@@ -296,6 +352,23 @@ namespace Engine
 			bool fullyInside;
 		};
 
+		static constexpr int RayPacketWidth = WideArity;
+
+		// SoA packet of rays for RayCastBatch, lanes outside activeMask are padding and never report hits
+		struct alignas(WideLaneBytes) RayPacket
+		{
+			alignas(WideLaneBytes) float originX[RayPacketWidth];
+			alignas(WideLaneBytes) float originY[RayPacketWidth];
+			alignas(WideLaneBytes) float originZ[RayPacketWidth];
+			alignas(WideLaneBytes) float invDirX[RayPacketWidth];
+			alignas(WideLaneBytes) float invDirY[RayPacketWidth];
+			alignas(WideLaneBytes) float invDirZ[RayPacketWidth];
+			alignas(WideLaneBytes) float tMin[RayPacketWidth];
+			alignas(WideLaneBytes) float bestT[RayPacketWidth]; // doubles as each lane's tMax, shrinks as hits are found
+			entt::entity bestEntity[RayPacketWidth];
+			uint8_t activeMask = 0;
+		};
+
 		static constexpr int WideTraversalStackMax = 1024;
 
 		struct ParallelVisibleScratch
@@ -305,10 +378,40 @@ namespace Engine
 
 		void EnsureParallelQueryScratch(size_t workerSlots, size_t seedItemHint) const;
 
+		void AddWideNodesVisited(uint64_t count) const
+		{
+			wideNodesVisited.fetch_add(count, std::memory_order_relaxed);
+		}
+
+		// Insertion sorts the hit children by entry distance, returns how many were hit
+		static uint8_t SortWideRayHits(uint8_t hitMask, const float* childTNear, uint8_t* outOrder)
+		{
+			uint8_t count = 0;
+			for (uint8_t childIndex = 0; childIndex < WideArity; ++childIndex)
+			{
+				if ((hitMask & (1u << childIndex)) == 0)
+				{
+					continue;
+				}
+
+				uint8_t insertAt = count++;
+				while (insertAt > 0 && childTNear[outOrder[insertAt - 1]] > childTNear[childIndex])
+				{
+					outOrder[insertAt] = outOrder[insertAt - 1];
+					--insertAt;
+				}
+				outOrder[insertAt] = childIndex;
+			}
+			return count;
+		}
+
 		bool IsAABBVisible(const Frustum& frustum, const AABB& aabb) const;
 		AABBFrustumClassification ClassifyNode(const BVHNode& node, const Frustum& frustum, const AABB& aabb) const;
 		AABBFrustumClassification ClassifyWideNode(const WideNode& node, const Frustum& frustum) const;
 		uint8_t GetWideNodeVisibleMask(const WideNode& node, const Frustum& frustum, uint8_t* outFullyInsideMask) const;
+		uint8_t GetWideNodeRayHitMask(const WideNode& node, const Ray& ray, float tMin, float tMax, float* outTNear) const;
+		uint8_t GetRayPacketHitMask(const RayPacket& packet, const glm::vec3& boxMin, const glm::vec3& boxMax, float* outTNear) const;
+		uint64_t TraceRayPacket(RayPacket& packet) const;
 		void CollectWideTraversalOrder(const WideNode& node, uint8_t visibleMask, uint8_t fullyInsideMask, uint8_t* outOrder, uint8_t& outCount) const;
 		bool PushWideRootIfVisible(const Frustum& frustum, WideTraversalItem* stack, int& stackSize) const;
 		void TraverseWideSubtree(int wideIndex, bool fullyInside, const Frustum& frustum, std::vector<entt::entity>& outVisible) const;
@@ -316,7 +419,10 @@ namespace Engine
 		AABB CalculateWorldAABB(const std::shared_ptr<Mesh>& mesh, const Transform& transform);
 		AABB CalculateWorldAABB(entt::entity entity, const glm::vec3& localMin, const glm::vec3& localMax, const Transform& transform);
 
-		int BuildRecursive(std::vector<int>& leafIndices, int begin, int end);
+		void LinkInternalNode(int nodeIndex, int left, int right);
+		int PartitionLeafRange(std::vector<int>& leafIndices, int begin, int end, bool allowParallelBinning);
+		int BuildRecursive(std::vector<int>& leafIndices, int begin, int end, int nodeIndex);
+		void BuildBinaryHierarchy(std::vector<int>& leafIndices);
 		void RefitBinaryAncestors(int leafIndex);
 		void FullRebuild();
 		int BuildWideRecursive(int binaryNodeIndex, int parentWideIndex, uint8_t parentSlot);
@@ -324,16 +430,46 @@ namespace Engine
 		void SetWideChildBounds(int wideIndex, uint8_t childSlot, const AABB& aabb);
 		void UpdateWideNodeBoundsFromChildren(int wideIndex);
 		void RefitWideAncestorsFromLeaf(int leafIndex);
+		void RefitWideAncestors(int wideIndex);
+
+		// Incremental topology changes, both hierarchies are patched in place and free slots are recycled
+		bool ComputeEntityWorldAABB(entt::entity entity, const Transform& transform, AABB& outAABB);
+		bool SyncEntity(entt::entity entity);
+		bool SyncEntity(entt::entity entity, const Transform& tf);
+		int AllocateNode();
+		void FreeNode(int nodeIndex);
+		int AllocateWideNode(int parentWideIndex, uint8_t parentSlot);
+		void FreeWideNode(int wideIndex);
+		int FindBestSibling(const AABB& leafAABB) const;
+		void RecomputeInternalBounds(int nodeIndex);
+		void RotateNode(int nodeIndex);
+		void InsertLeaf(entt::entity entity, const AABB& worldAABB);
+		void RemoveLeaf(int leafIndex);
+		void RemoveEntityLeaf(entt::entity entity);
+		void SetWideChild(int wideIndex, uint8_t childSlot, int childRef, const AABB& aabb);
+		void AppendWideChild(int wideIndex, int childRef, const AABB& aabb);
+		void RemoveWideChild(int wideIndex, uint8_t childSlot);
+		void ResetWideTraversalOrder(int wideIndex);
+		AABB GetWideChildAABB(int wideIndex, uint8_t childSlot) const;
+		int FindBestWideInsert(const AABB& leafAABB, int& outPairSlot) const;
+		void RotateWideNode(int wideIndex, uint8_t changedSlot);
+		void InsertWideLeaf(int leafIndex);
+		void RemoveWideLeaf(int leafIndex);
 		inline void PushIfVisible(int nodeIndex, const Frustum& frustum, bool parentFullyInside, std::vector<std::pair<int, bool>>& stack) const;
 
 		entt::registry& registry;
 		entt::observer topologyObserver;
 
-		std::vector<BVHNode> nodes; // binary BVH kept for updates and ray casting
-		std::vector<WideNode> wideNodes; // 4-wide SoA frustum traversal layout
+		std::vector<BVHNode> nodes; // binary BVH kept for builds and incremental updates
+		std::vector<WideNode> wideNodes; // WideArity-wide SoA layout that frustum and ray queries traverse
 		std::vector<int> leafToWideParent;
 		std::vector<uint8_t> leafToWideSlot;
 		std::unordered_map<entt::entity, int> entityToLeaf; // entity leaf index
+		std::vector<glm::vec3> buildCentroids; // leaf centroids cached for the duration of a rebuild, indexed by leaf node index
+		std::vector<int> freeNodes; // recycled binary node slots
+		std::vector<int> freeWideNodes; // recycled wide node slots
+		std::vector<entt::entity> pendingSync; // entities that lost a renderable component and need re-checking next update
+		mutable std::vector<std::pair<int, float>> insertSearchScratch;
 		int root = -1;
 		int wideRoot = -1;
 
@@ -343,6 +479,8 @@ namespace Engine
 		mutable std::vector<entt::entity> parallelDirectVisibleScratch;
 		mutable std::vector<ParallelVisibleScratch> parallelVisibleScratch;
 
+		mutable std::atomic<uint64_t> wideNodesVisited{ 0 };
+
 		bool forceUpdate = false;
 	};
 
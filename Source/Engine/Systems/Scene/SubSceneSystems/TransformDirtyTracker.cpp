@@ -0,0 +1,74 @@
+#include "PCH.h"
+#include "TransformDirtyTracker.h"
+#include "Engine/Components/Transform.h"
+
+namespace Engine
+{
+
+	TransformDirtyTracker::TransformDirtyTracker(entt::registry& registry)
+		: registry{ registry }
+	{
+		registry.on_construct<Transform>().connect<&TransformDirtyTracker::OnTransformConstruct>(*this);
+		registry.on_destroy<Transform>().connect<&TransformDirtyTracker::OnTransformDestroy>(*this);
+
+		// The registry context only holds the pointer, the tracker itself is owned by whoever owns the registry (normally the Scene)
+		registry.ctx().insert_or_assign<TransformDirtyTracker*>(this);
+	}
+
+	TransformDirtyTracker::~TransformDirtyTracker()
+	{
+		registry.on_construct<Transform>().disconnect(this);
+		registry.on_destroy<Transform>().disconnect(this);
+		registry.ctx().erase<TransformDirtyTracker*>();
+	}
+
+	TransformDirtyTracker* TransformDirtyTracker::Find(entt::registry& registry)
+	{
+		TransformDirtyTracker** tracker = registry.ctx().find<TransformDirtyTracker*>();
+		return tracker ? *tracker : nullptr;
+	}
+
+	bool TransformDirtyTracker::CollectChangedSince(uint64_t seenEpoch, std::vector<entt::entity>& outEntities) const
+	{
+		outEntities.clear();
+
+		if (epoch != seenEpoch && epoch != seenEpoch + 1)
+		{
+			return false;
+		}
+
+		const bool clearedSince = epoch != seenEpoch;
+		if (clearedSince)
+		{
+			outEntities.insert(outEntities.end(), lastClearedEntities.begin(), lastClearedEntities.end());
+		}
+
+		for (entt::entity entity : dirtyEntities)
+		{
+			if (!clearedSince || !lastClearedEntities.contains(entity))
+			{
+				outEntities.push_back(entity);
+			}
+		}
+
+		return true;
+	}
+
+	void TransformDirtyTracker::OnTransformConstruct(entt::registry& registry, entt::entity entity)
+	{
+		Transform& tf = registry.get<Transform>(entity);
+		tf.owner = entity;
+		tf.dirtyTracker = this;
+		tf.lastQueuedDirtyEpoch = epoch;
+
+		MarkDirty(entity);
+		NoteMutation();
+	}
+
+	void TransformDirtyTracker::OnTransformDestroy(entt::registry& /*registry*/, entt::entity entity)
+	{
+		dirtyEntities.remove(entity);
+		lastClearedEntities.remove(entity);
+	}
+
+}
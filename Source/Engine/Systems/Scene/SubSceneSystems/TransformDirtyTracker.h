@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Library/EnTT/entt.hpp"
+
+namespace Engine
+{
+
+	// Collects the transforms of one registry that changed since the last Clear.
+	// Every Transform constructed in the registry gets bound to it, after which its setters queue the owning entity here.
+	// The set is deduplicated and loses entities as soon as their Transform is destroyed, so consumers never see stale handles.
+	class TransformDirtyTracker
+	{
+
+	public:
+
+		explicit TransformDirtyTracker(entt::registry& registry);
+		~TransformDirtyTracker();
+
+		TransformDirtyTracker(const TransformDirtyTracker&) = delete;
+		TransformDirtyTracker& operator=(const TransformDirtyTracker&) = delete;
+
+		// Null for registries nobody is tracking, such as the debug draw registry
+		static TransformDirtyTracker* Find(entt::registry& registry);
+
+		void MarkDirty(entt::entity entity)
+		{
+			if (!dirtyEntities.contains(entity))
+			{
+				dirtyEntities.push(entity);
+			}
+		}
+
+		// Counts as a change even if nothing got queued, for transforms mutated before they had an owner
+		void NoteMutation()
+		{
+			anyDirty = true;
+			++mutationVersion;
+			if (mutationVersion == 0)
+			{
+				mutationVersion = 1;
+			}
+		}
+
+		// The dropped set stays readable through GetLastClearedEntities until the next Clear
+		void Clear()
+		{
+			std::swap(lastClearedEntities, dirtyEntities);
+			dirtyEntities.clear();
+			anyDirty = false;
+			++epoch;
+			if (epoch == 0)
+			{
+				epoch = 1;
+			}
+		}
+
+		bool AnyDirty() const { return anyDirty || !dirtyEntities.empty(); }
+		const entt::sparse_set& GetDirtyEntities() const { return dirtyEntities; }
+
+		// What the last Clear dropped, for consumers that only run after the scene finished its frame (the renderer).
+		// A consumer that saw every epoch can patch from this alone, one that skipped an epoch has to assume everything changed.
+		const entt::sparse_set& GetLastClearedEntities() const { return lastClearedEntities; }
+
+		// What a consumer that last looked at seenEpoch has to revisit, deduplicated: the last cleared set if a Clear happened since,
+		// plus everything queued after that Clear, which catches transforms written after the scene's post update (physics poses) the same frame.
+		// Returns false when the consumer skipped an epoch and has to assume everything changed.
+		bool CollectChangedSince(uint64_t seenEpoch, std::vector<entt::entity>& outEntities) const;
+
+		// Bumped by Clear, transforms use it to skip requeueing themselves within one frame
+		uint64_t GetEpoch() const { return epoch; }
+
+		// Monotonic transform mutation serial for renderer side cache validation
+		uint64_t GetMutationVersion() const { return mutationVersion; }
+
+		entt::registry& GetRegistry() const { return registry; }
+
+	private:
+
+		entt::registry& registry;
+		entt::sparse_set dirtyEntities;
+		entt::sparse_set lastClearedEntities;
+		bool anyDirty = false;
+		uint64_t epoch = 1;
+		uint64_t mutationVersion = 1;
+
+		void OnTransformConstruct(entt::registry& registry, entt::entity entity);
+		void OnTransformDestroy(entt::registry& registry, entt::entity entity);
+
+	};
+
+}
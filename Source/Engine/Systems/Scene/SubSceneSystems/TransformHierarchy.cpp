@@ -0,0 +1,304 @@
+#include "PCH.h"
+#include "TransformHierarchy.h"
+#include "TransformDirtyTracker.h"
+#include "Engine/Components/Transform.h"
+#include "Engine/Utility/ParallelUtils.h"
+#include "Engine/Utility/Profiler.h"
+
+namespace Engine
+{
+
+	namespace
+	{
+		constexpr size_t kMinNodesPerChunk = 256; // a node is one mat4 multiply plus maybe a TRS rebuild, so chunks have to be fairly big to pay off
+		constexpr size_t kMinHolesBeforeCompact = 64; // small scenes just keep their holes instead of rebuilding for every other despawn
+	}
+
+	TransformHierarchy::TransformHierarchy(entt::registry& registry)
+		: registry{ registry }
+	{}
+
+	TransformHierarchy::~TransformHierarchy()
+	{
+		registry.on_construct<Transform>().disconnect(this);
+		registry.on_destroy<Transform>().disconnect(this);
+	}
+
+	void TransformHierarchy::Init()
+	{
+		registry.on_construct<Transform>().connect<&TransformHierarchy::OnTransformConstruct>(*this);
+		registry.on_destroy<Transform>().connect<&TransformHierarchy::OnTransformDestroy>(*this);
+		topologyDirty = true;
+	}
+
+	void TransformHierarchy::OnTransformConstruct(entt::registry& /*registry*/, entt::entity entity)
+	{
+		if (topologyDirty)
+		{
+			return;
+		}
+
+		// Scene wires parents after the Transform exists, so this is a new root unless it was emplaced as a copy of a linked one
+		const Transform& transform = registry.get<Transform>(entity);
+		if (transform.parent != entt::null || !transform.children.empty())
+		{
+			topologyDirty = true;
+			return;
+		}
+
+		const uint32_t node = AppendNode(entity, InvalidNode, 0);
+		if (dirtyByLevel.empty())
+		{
+			dirtyByLevel.resize(1);
+		}
+		QueueNode(node);
+	}
+
+	void TransformHierarchy::OnTransformDestroy(entt::registry& /*registry*/, entt::entity entity)
+	{
+		if (topologyDirty)
+		{
+			return;
+		}
+
+		const uint32_t node = NodeOf(entity);
+		if (node == InvalidNode)
+		{
+			return;
+		}
+
+		// Children that outlive their parent turn into roots one level up, which moves their whole subtree, so leave that to a rebuild.
+		// Scene::DestroyEntity destroys a subtree children first, so this only triggers when it detaches them instead.
+		const uint32_t firstChild = nodeFirstChild[node];
+		const uint32_t childEnd = firstChild + nodeChildCount[node];
+		for (uint32_t child = firstChild; child < childEnd; ++child)
+		{
+			if (nodeEntities[child] != entt::null)
+			{
+				topologyDirty = true;
+				return;
+			}
+		}
+
+		// Leave a hole, the parent's child range and every other index stay valid
+		entityToNode[static_cast<size_t>(entt::to_entity(entity))] = InvalidNode;
+		nodeEntities[node] = entt::null;
+		++holeCount;
+
+		// Holes still cost a slot in every parent's child walk, compact once they are half the order
+		if (holeCount >= kMinHolesBeforeCompact && holeCount * 2 >= nodeEntities.size())
+		{
+			topologyDirty = true;
+		}
+	}
+
+	uint32_t TransformHierarchy::NodeOf(entt::entity entity) const
+	{
+		const size_t id = static_cast<size_t>(entt::to_entity(entity));
+		if (id >= entityToNode.size())
+		{
+			return InvalidNode;
+		}
+
+		const uint32_t node = entityToNode[id];
+		if (node == InvalidNode || nodeEntities[node] != entity)
+		{
+			return InvalidNode;
+		}
+
+		return node;
+	}
+
+	uint32_t TransformHierarchy::AppendNode(entt::entity entity, uint32_t parentNode, uint32_t level)
+	{
+		const size_t id = static_cast<size_t>(entt::to_entity(entity));
+		if (id >= entityToNode.size())
+		{
+			entityToNode.resize(id + 1, InvalidNode);
+		}
+
+		const uint32_t node = static_cast<uint32_t>(nodeEntities.size());
+		entityToNode[id] = node;
+		nodeEntities.push_back(entity);
+		nodeParents.push_back(parentNode);
+		nodeFirstChild.push_back(node + 1);
+		nodeChildCount.push_back(0);
+		nodeLevels.push_back(level);
+		localMatrices.emplace_back(1.0f);
+		worldMatrices.emplace_back(1.0f);
+		nodeQueued.push_back(0);
+		return node;
+	}
+
+	void TransformHierarchy::RebuildOrder()
+	{
+		nodeEntities.clear();
+		nodeParents.clear();
+		nodeFirstChild.clear();
+		nodeChildCount.clear();
+		nodeLevels.clear();
+		localMatrices.clear();
+		worldMatrices.clear();
+		nodeQueued.clear();
+		std::fill(entityToNode.begin(), entityToNode.end(), InvalidNode);
+		holeCount = 0;
+
+		auto& storage = registry.storage<Transform>();
+
+		auto addNode = [this](entt::entity entity, uint32_t parentNode, uint32_t level)
+		{
+			const size_t id = static_cast<size_t>(entt::to_entity(entity));
+			if (id < entityToNode.size() && entityToNode[id] != InvalidNode)
+			{
+				return; // already placed, only possible with a corrupted children list
+			}
+
+			AppendNode(entity, parentNode, level);
+		};
+
+		// Same rule as Transform::GetWorldMatrix, a parent that is gone or has no Transform makes this a root
+		for (entt::entity entity : registry.view<Transform>())
+		{
+			const entt::entity parent = storage.get(entity).parent;
+			if (parent == entt::null || !registry.valid(parent) || !registry.all_of<Transform>(parent))
+			{
+				addNode(entity, InvalidNode, 0);
+			}
+		}
+
+		size_t levelBegin = 0;
+		size_t levelEnd = nodeEntities.size();
+		uint32_t level = 0;
+
+		while (levelBegin < levelEnd)
+		{
+			for (size_t node = levelBegin; node < levelEnd; ++node)
+			{
+				nodeFirstChild[node] = static_cast<uint32_t>(nodeEntities.size());
+
+				const Transform& transform = storage.get(nodeEntities[node]);
+				for (entt::entity child : transform.children)
+				{
+					if (!registry.valid(child))
+					{
+						continue;
+					}
+
+					const Transform* childTransform = registry.try_get<Transform>(child);
+					if (childTransform && childTransform->parent == nodeEntities[node])
+					{
+						addNode(child, static_cast<uint32_t>(node), level + 1);
+					}
+				}
+
+				nodeChildCount[node] = static_cast<uint32_t>(nodeEntities.size()) - nodeFirstChild[node];
+			}
+
+			levelBegin = levelEnd;
+			levelEnd = nodeEntities.size();
+			++level;
+		}
+
+		dirtyByLevel.resize(level);
+		for (std::vector<uint32_t>& levelNodes : dirtyByLevel)
+		{
+			levelNodes.clear();
+		}
+
+		topologyDirty = false;
+	}
+
+	void TransformHierarchy::QueueNode(uint32_t node)
+	{
+		if (nodeQueued[node] || nodeEntities[node] == entt::null)
+		{
+			return;
+		}
+
+		nodeQueued[node] = 1;
+		dirtyByLevel[nodeLevels[node]].push_back(node);
+	}
+
+	void TransformHierarchy::UpdateNodes(const std::vector<uint32_t>& nodes)
+	{
+		// Fetched here, storage<T>() can create the pool and must not race
+		auto& storage = registry.storage<Transform>();
+
+		// Every node in the list is on the same level, so parents were all finished by the previous call
+		ParallelForRender(nodes.size(), kMinNodesPerChunk, [this, &nodes, &storage](size_t begin, size_t end, size_t /*workerIndex*/)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				const uint32_t node = nodes[i];
+				if (nodeEntities[node] == entt::null)
+				{
+					continue; // spawned and destroyed again before this update
+				}
+
+				Transform& transform = storage.get(nodeEntities[node]);
+
+				localMatrices[node] = transform.GetModelMatrix();
+
+				const uint32_t parent = nodeParents[node];
+				worldMatrices[node] = (parent == InvalidNode) ? localMatrices[node] : worldMatrices[parent] * localMatrices[node];
+
+				transform.worldMatrix = worldMatrices[node];
+				transform.worldDirty = false;
+			}
+		});
+	}
+
+	void TransformHierarchy::Update()
+	{
+		SWIM_PROFILE_FUNCTION();
+
+		if (topologyDirty)
+		{
+			RebuildOrder();
+
+			// Fresh order means nothing in the flat arrays is valid yet, so everything is dirty
+			for (uint32_t node = 0; node < nodeEntities.size(); ++node)
+			{
+				QueueNode(node);
+			}
+		}
+		else if (const TransformDirtyTracker* tracker = TransformDirtyTracker::Find(registry))
+		{
+			for (entt::entity entity : tracker->GetDirtyEntities())
+			{
+				const uint32_t node = NodeOf(entity);
+				if (node != InvalidNode)
+				{
+					QueueNode(node);
+				}
+			}
+		}
+
+		for (size_t level = 0; level < dirtyByLevel.size(); ++level)
+		{
+			std::vector<uint32_t>& levelNodes = dirtyByLevel[level];
+			if (levelNodes.empty())
+			{
+				continue;
+			}
+
+			UpdateNodes(levelNodes);
+
+			// A recomputed world invalidates the whole subtree below it
+			for (uint32_t node : levelNodes)
+			{
+				const uint32_t firstChild = nodeFirstChild[node];
+				const uint32_t childEnd = firstChild + nodeChildCount[node];
+				for (uint32_t child = firstChild; child < childEnd; ++child)
+				{
+					QueueNode(child);
+				}
+
+				nodeQueued[node] = 0;
+			}
+
+			levelNodes.clear();
+		}
+	}
+
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Library/glm/glm.hpp"
+#include "Library/EnTT/entt.hpp"
+
+namespace Engine
+{
+
+	class Transform;
+
+	// Keeps every Transform of a registry in breadth first order (all roots, then all depth 1 children, and so on)
+	// with the local and world matrices in flat arrays next to it. Update recomputes only the dirty subtrees one depth level at a time,
+	// each level split across the job system, and writes the results back into the Transform caches so GetWorldMatrix never has to walk up the parent chain.
+	// Spawning and despawning are patched in place: a new Transform is appended as a root and a destroyed leaf leaves a hole,
+	// only reparenting (or enough holes piling up) rebuilds the order from scratch.
+	class TransformHierarchy
+	{
+
+	public:
+
+		explicit TransformHierarchy(entt::registry& registry);
+		~TransformHierarchy();
+
+		void Init();
+
+		// Parenting changed somewhere, the breadth first order gets rebuilt on the next Update
+		// Constructing or destroying a Transform does not need this, the hierarchy listens for those itself
+		void MarkTopologyDirty() { topologyDirty = true; }
+
+		// Recomputes everything in the registry's TransformDirtyTracker set along with their descendants
+		void Update();
+
+		size_t GetNodeCount() const { return nodeEntities.size() - holeCount; }
+		size_t GetLevelCount() const { return dirtyByLevel.size(); }
+
+		// Indexed by node, valid until the next Update. Holes left by destroyed Transforms hold entt::null
+		const std::vector<glm::mat4>& GetWorldMatrices() const { return worldMatrices; }
+		const std::vector<entt::entity>& GetNodeEntities() const { return nodeEntities; }
+
+	private:
+
+		static constexpr uint32_t InvalidNode = UINT32_MAX;
+
+		entt::registry& registry;
+		bool topologyDirty = true;
+
+		// SoA node storage, parents always sit at lower indices than their children and siblings are contiguous.
+		// Transforms are looked up through the registry instead of cached pointers, destroying any Transform can move another one in the pool.
+		std::vector<entt::entity> nodeEntities;
+		std::vector<uint32_t> nodeParents;
+		std::vector<uint32_t> nodeFirstChild;
+		std::vector<uint32_t> nodeChildCount;
+		std::vector<uint32_t> nodeLevels;
+		std::vector<glm::mat4> localMatrices;
+		std::vector<glm::mat4> worldMatrices;
+
+		std::vector<uint32_t> entityToNode; // indexed by entity id
+		size_t holeCount = 0;
+
+		// Per update scratch, one list per depth level
+		std::vector<std::vector<uint32_t>> dirtyByLevel;
+		std::vector<uint8_t> nodeQueued;
+
+		void OnTransformConstruct(entt::registry& registry, entt::entity entity);
+		void OnTransformDestroy(entt::registry& registry, entt::entity entity);
+
+		void RebuildOrder();
+		uint32_t AppendNode(entt::entity entity, uint32_t parentNode, uint32_t level);
+		uint32_t NodeOf(entt::entity entity) const;
+		void QueueNode(uint32_t node);
+		void UpdateNodes(const std::vector<uint32_t>& nodes);
+
+	};
+
+}
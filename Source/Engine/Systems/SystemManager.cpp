@@ -41,13 +41,34 @@ namespace Engine
     return SmartIterate([](Machine* machine) { return machine->Init(); });
   }
 
+  void SystemManager::RebuildFrameGraph()
+  {
+    frameGraph.Clear();
+
+    for (auto& entry : orderedSystems)
+    {
+      if (!entry.second)
+      {
+        std::cerr << "Warning: Null Machine pointer for system: " << entry.first << std::endl;
+        continue;
+      }
+
+      frameGraph.AddStage(entry.first, entry.second.get());
+    }
+
+    frameGraph.Build();
+    frameGraphDirty = false;
+  }
+
   void SystemManager::Update(double dt)
   {
-    SmartIterate([dt](Machine* machine) -> int
+    if (frameGraphDirty)
     {
-      machine->Update(dt);
-      return 0; // Update doesn't return anything; assume success
-    });
+      RebuildFrameGraph();
+    }
+
+    // Systems that declared disjoint reads and writes can run at the same time, everything else keeps insertion order
+    frameGraph.Run(dt);
   }
 
   void SystemManager::FixedUpdate(unsigned int tickThisSecond)
@@ -43,9 +43,16 @@ namespace Engine
 			}
 
 			systems[name] = system;
+			frameGraphDirty = true;
 			return system;
 		}
 
+		// Timings of the last Update, including which systems bounded the frame
+		const FrameTaskReport& GetFrameTaskReport() const { return frameGraph.GetLastReport(); }
+
+		// Rebuilds the frame graph before the next Update, for when a system changes what it declares in GetFrameTaskAccess
+		void MarkFrameGraphDirty() { frameGraphDirty = true; }
+
 	private:
 
 		// Lookup by name if needed later
@@ -57,6 +64,12 @@ namespace Engine
 		// Name -> index into orderedSystems
 		std::unordered_map<std::string, std::size_t> systemIndex;
 
+		// Per frame Update runs through this so systems that do not conflict can update concurrently
+		FrameTaskGraph frameGraph;
+		bool frameGraphDirty = true;
+
+		void RebuildFrameGraph();
+
 		int SmartIterate(std::function<int(Machine*)> method);
 
 	};
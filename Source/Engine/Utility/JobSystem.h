@@ -0,0 +1,832 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "Profiler.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SWIM_JOB_SPIN_PAUSE() _mm_pause()
+#else
+#define SWIM_JOB_SPIN_PAUSE() std::this_thread::yield()
+#endif
+
+// A header file only work stealing job system, shared by the renderer, BVH builds and anything else that wants CPU side parallelism.
+// Every participating thread (the thread that first calls Get, plus the pool workers) owns a Chase-Lev deque, the owner pushes and pops at the bottom
+// and idle threads steal from the top. Waiting on jobs never blocks a participating thread, it keeps running other jobs until the awaited ones finish,
+// which is what makes nested parallel loops safe instead of serializing them.
+// Threads that are not participants (audio, loader threads and so on) can still submit work, their jobs go through a shared injection queue
+// and they block while waiting since they have no deque or worker slot of their own.
+// Long running work like asset loads goes on the background lane instead, only idle pool workers take from it, so a frame waiting on its
+// own jobs never ends up running one inline.
+
+namespace Engine
+{
+
+	struct JobSystemConfig
+	{
+		static constexpr bool Enabled = true; // if false, every job runs inline on the calling thread
+		static constexpr uint32_t ReserveHardwareThreads = 1; // the thread that owns slot 0 (main) already takes one core
+		static constexpr uint32_t MaxWorkerThreads = 16;
+		static constexpr size_t DequeCapacity = 4096; // power of two, a full deque runs the job inline instead of growing
+		static constexpr uint32_t SpinsBeforeSleep = 256;
+		static constexpr uint32_t WaitParkMinMicroseconds = 50; // a participant with nothing to help with parks on the awaited counter, doubling up to the max
+		static constexpr uint32_t WaitParkMaxMicroseconds = 1000;
+		static constexpr size_t InlineLoopJobs = 64; // parallel loops up to this many chunks keep their jobs on the stack
+	};
+
+	class JobSystem;
+	class JobCounter;
+
+	struct Job
+	{
+		using ExecuteFn = void(*)(Job& job, uint32_t workerIndex);
+
+		ExecuteFn execute = nullptr;
+		void* context = nullptr;
+		size_t begin = 0;
+		size_t end = 0;
+		JobCounter* counter = nullptr; // completed after execute returns, null when execute completes its own counter
+		std::atomic<uint32_t> unresolvedDependencies{ 0 };
+	};
+
+	// Counts unfinished jobs. A counter finishes exactly once, when the count it was created with drops to zero,
+	// and then releases every job that was spawned with it as a dependency.
+	class JobCounter
+	{
+
+	public:
+
+		explicit JobCounter(uint32_t count)
+			: pending{ count }, finished{ count == 0 }
+		{}
+
+		JobCounter(const JobCounter&) = delete;
+		JobCounter& operator=(const JobCounter&) = delete;
+
+		bool IsDone() const
+		{
+			return finished.load(std::memory_order_acquire);
+		}
+
+	private:
+
+		friend class JobSystem;
+
+		std::atomic<uint32_t> pending;
+		std::atomic<bool> finished;
+		std::mutex mutex; // guards continuations and lets blocked waiters sleep
+		std::condition_variable doneCv;
+		std::vector<Job*> continuations;
+
+	};
+
+	using JobHandle = std::shared_ptr<JobCounter>;
+
+	class JobSystem
+	{
+
+	public:
+
+		static constexpr uint32_t InvalidSlot = UINT32_MAX;
+
+		static JobSystem& Get()
+		{
+			static JobSystem instance;
+			return instance;
+		}
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		size_t GetWorkerThreadCount() const
+		{
+			return workers.size();
+		}
+
+		// Every index a job can see as its workerIndex is below this, so it sizes per worker scratch
+		size_t GetWorkerSlotCount() const
+		{
+			return workers.size() + 1;
+		}
+
+		// 0 on the owning thread, 1..N on pool workers. Outside threads also get 0, they only use it for small loops they run inline
+		static uint32_t GetCurrentWorkerIndex()
+		{
+			return tSlot == InvalidSlot ? 0 : tSlot;
+		}
+
+		// Runs task on some worker once every dependency has finished. Null dependencies count as already finished.
+		JobHandle Spawn(std::function<void(uint32_t workerIndex)> task, std::initializer_list<JobHandle> dependencies = {})
+		{
+			return Spawn(std::move(task), dependencies.begin(), dependencies.size());
+		}
+
+		JobHandle Spawn(std::function<void(uint32_t workerIndex)> task, const std::vector<JobHandle>& dependencies)
+		{
+			return Spawn(std::move(task), dependencies.data(), dependencies.size());
+		}
+
+		JobHandle Spawn(std::function<void(uint32_t workerIndex)> task, const JobHandle* dependencies, size_t dependencyCount)
+		{
+			JobHandle handle = std::make_shared<JobCounter>(1);
+
+			if constexpr (!JobSystemConfig::Enabled)
+			{
+				for (size_t i = 0; i < dependencyCount; ++i)
+				{
+					Wait(dependencies[i]);
+				}
+
+				task(0);
+				CompleteOne(*handle);
+				return handle;
+			}
+
+			SpawnedJob* job = new SpawnedJob();
+			job->execute = &ExecuteSpawned;
+			job->task = std::move(task);
+			job->handle = handle;
+			job->unresolvedDependencies.store(static_cast<uint32_t>(dependencyCount) + 1, std::memory_order_relaxed);
+
+			for (size_t i = 0; i < dependencyCount; ++i)
+			{
+				const JobHandle& dependency = dependencies[i];
+				if (!dependency || !AddContinuation(*dependency, job))
+				{
+					job->unresolvedDependencies.fetch_sub(1, std::memory_order_relaxed);
+				}
+			}
+
+			// The extra reference keeps a dependency that finishes mid registration from submitting the job twice
+			if (job->unresolvedDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				Submit(job);
+				WakeWorkers(1);
+			}
+
+			return handle;
+		}
+
+		// Runs task on a pool worker once one has nothing else to do. Waiting threads never pick background jobs up while helping,
+		// so they suit work that takes longer than a frame. Poll the handle, waiting on it from the main thread stalls until a worker got to it.
+		JobHandle SpawnBackground(std::function<void(uint32_t workerIndex)> task)
+		{
+			JobHandle handle = std::make_shared<JobCounter>(1);
+
+			if (!JobSystemConfig::Enabled || workers.empty())
+			{
+				task(GetCurrentWorkerIndex());
+				CompleteOne(*handle);
+				return handle;
+			}
+
+			SpawnedJob* job = new SpawnedJob();
+			job->execute = &ExecuteSpawned;
+			job->task = std::move(task);
+			job->handle = handle;
+
+			{
+				std::lock_guard<std::mutex> lock(backgroundMutex);
+				backgroundQueue.push_back(job);
+				backgroundCount.fetch_add(1, std::memory_order_release);
+			}
+			WakeWorkers(1);
+
+			return handle;
+		}
+
+		void Wait(const JobHandle& handle)
+		{
+			if (handle)
+			{
+				Wait(*handle);
+			}
+		}
+
+		// Participants run other jobs while they wait and park on the counter once there is nothing left to help with,
+		// outside threads sleep until the counter finishes
+		void Wait(JobCounter& counter)
+		{
+			const uint32_t slot = tSlot;
+			if (slot == InvalidSlot)
+			{
+				std::unique_lock<std::mutex> lock(counter.mutex);
+				counter.doneCv.wait(lock, [&]() { return counter.finished.load(std::memory_order_acquire); });
+				return;
+			}
+
+			uint32_t idleSpins = 0;
+			std::chrono::microseconds parkTime{ JobSystemConfig::WaitParkMinMicroseconds };
+			while (!counter.finished.load(std::memory_order_acquire))
+			{
+				if (Job* job = FindJob(slot))
+				{
+					RunJob(job, slot);
+					idleSpins = 0;
+					parkTime = std::chrono::microseconds{ JobSystemConfig::WaitParkMinMicroseconds };
+				}
+				else if (++idleSpins < JobSystemConfig::SpinsBeforeSleep)
+				{
+					SWIM_JOB_SPIN_PAUSE();
+				}
+				else
+				{
+					// Complete notifies doneCv, the timeout only brings the waiter back to help with work queued since it parked
+					std::unique_lock<std::mutex> lock(counter.mutex);
+					counter.doneCv.wait_for(lock, parkTime, [&]() { return counter.finished.load(std::memory_order_acquire); });
+					parkTime = std::min(parkTime * 2, std::chrono::microseconds{ JobSystemConfig::WaitParkMaxMicroseconds });
+				}
+			}
+
+			// The finishing thread sets the flag while holding the lock, taking it once here guarantees it is done touching the counter
+			std::lock_guard<std::mutex> lock(counter.mutex);
+		}
+
+		// Splits [0, itemCount) into chunks of chunkSize and runs func(begin, end, workerIndex) on each, returns when all chunks finished.
+		// Idle workers steal chunks, so uneven chunk costs balance out. Safe to call from inside another job.
+		template<typename Func>
+		void ParallelFor(size_t itemCount, size_t chunkSize, Func&& func)
+		{
+			if (itemCount == 0)
+			{
+				return;
+			}
+
+			chunkSize = std::max<size_t>(chunkSize, 1);
+			const size_t chunkCount = (itemCount + chunkSize - 1) / chunkSize;
+
+			if (!JobSystemConfig::Enabled || chunkCount <= 1 || workers.empty())
+			{
+				func(0, itemCount, GetCurrentWorkerIndex());
+				return;
+			}
+
+			const Job::ExecuteFn execute = [](Job& job, uint32_t workerIndex)
+			{
+				(*static_cast<std::remove_reference_t<Func>*>(job.context))(job.begin, job.end, workerIndex);
+			};
+
+			RunJobs(chunkCount, [&](Job& job, size_t chunkIndex)
+			{
+				job.execute = execute;
+				job.context = std::addressof(func);
+				job.begin = chunkIndex * chunkSize;
+				job.end = std::min(job.begin + chunkSize, itemCount);
+			});
+		}
+
+		// Runs taskCount coarse tasks (such as whole BVH subtrees) as func(taskIndex, workerIndex).
+		// One puller job per participant claims task indices from a shared counter, so tasks of uneven size balance without a job per task.
+		template<typename Func>
+		void ParallelForTasks(size_t taskCount, Func&& func)
+		{
+			if (taskCount == 0)
+			{
+				return;
+			}
+
+			if (!JobSystemConfig::Enabled || taskCount == 1 || workers.empty())
+			{
+				const uint32_t workerIndex = GetCurrentWorkerIndex();
+				for (size_t taskIndex = 0; taskIndex < taskCount; ++taskIndex)
+				{
+					func(taskIndex, workerIndex);
+				}
+				return;
+			}
+
+			std::atomic<size_t> nextTask{ 0 };
+			auto pullTasks = [&](size_t, size_t, uint32_t workerIndex)
+			{
+				while (true)
+				{
+					const size_t taskIndex = nextTask.fetch_add(1, std::memory_order_relaxed);
+					if (taskIndex >= taskCount)
+					{
+						break;
+					}
+
+					func(taskIndex, workerIndex);
+				}
+			};
+
+			const Job::ExecuteFn execute = [](Job& job, uint32_t workerIndex)
+			{
+				(*static_cast<decltype(pullTasks)*>(job.context))(0, 0, workerIndex);
+			};
+
+			RunJobs(std::min(taskCount, GetWorkerSlotCount()), [&](Job& job, size_t)
+			{
+				job.execute = execute;
+				job.context = std::addressof(pullTasks);
+			});
+		}
+
+		// ParallelForTasks for code already running on the background lane. The helper pullers go on the background lane too,
+		// so a thread waiting on its frame jobs can't steal one and end up running the rest of a long loop. The caller pulls as well
+		// and only waits for the tasks, not the helpers, so the loop finishes even when no other worker is idle. func must not throw.
+		template<typename Func>
+		void ParallelForBackgroundTasks(size_t taskCount, Func&& func)
+		{
+			if (taskCount == 0)
+			{
+				return;
+			}
+
+			if (!JobSystemConfig::Enabled || taskCount == 1 || workers.empty())
+			{
+				const uint32_t workerIndex = GetCurrentWorkerIndex();
+				for (size_t taskIndex = 0; taskIndex < taskCount; ++taskIndex)
+				{
+					func(taskIndex, workerIndex);
+				}
+				return;
+			}
+
+			// Shared with the helpers, one that only starts after the loop returned finds no task left and never touches func
+			struct TaskLoop
+			{
+				explicit TaskLoop(size_t count)
+					: taskCount{ count }, tasksDone{ static_cast<uint32_t>(count) }
+				{}
+
+				const size_t taskCount;
+				std::atomic<size_t> nextTask{ 0 };
+				JobCounter tasksDone;
+				std::function<void(size_t, uint32_t)> run;
+			};
+
+			std::shared_ptr<TaskLoop> loop = std::make_shared<TaskLoop>(taskCount);
+			loop->run = [&func](size_t taskIndex, uint32_t workerIndex) { func(taskIndex, workerIndex); };
+
+			auto pullTasks = [](TaskLoop& taskLoop, uint32_t workerIndex)
+			{
+				while (true)
+				{
+					const size_t taskIndex = taskLoop.nextTask.fetch_add(1, std::memory_order_relaxed);
+					if (taskIndex >= taskLoop.taskCount)
+					{
+						break;
+					}
+
+					taskLoop.run(taskIndex, workerIndex);
+					Get().CompleteOne(taskLoop.tasksDone);
+				}
+			};
+
+			const size_t helperCount = std::min(taskCount - 1, workers.size());
+			for (size_t helper = 0; helper < helperCount; ++helper)
+			{
+				SpawnBackground([loop, pullTasks](uint32_t workerIndex) { pullTasks(*loop, workerIndex); });
+			}
+
+			pullTasks(*loop, GetCurrentWorkerIndex());
+			Wait(loop->tasksDone);
+		}
+
+	private:
+
+		// Bounded Chase-Lev deque (Le, Pop, Cohen, Zappa Nardelli 2013). Only the owning thread calls Push and Pop, anyone may Steal.
+		class WorkStealingDeque
+		{
+
+		public:
+
+			bool Push(Job* job)
+			{
+				const int64_t b = bottom.load(std::memory_order_relaxed);
+				const int64_t t = top.load(std::memory_order_acquire);
+				if (b - t >= static_cast<int64_t>(JobSystemConfig::DequeCapacity))
+				{
+					return false;
+				}
+
+				buffer[static_cast<size_t>(b) & Mask].store(job, std::memory_order_relaxed);
+				bottom.store(b + 1, std::memory_order_release);
+				return true;
+			}
+
+			Job* Pop()
+			{
+				const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+				bottom.store(b, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				int64_t t = top.load(std::memory_order_relaxed);
+
+				if (t > b)
+				{
+					bottom.store(b + 1, std::memory_order_relaxed);
+					return nullptr;
+				}
+
+				Job* job = buffer[static_cast<size_t>(b) & Mask].load(std::memory_order_relaxed);
+				if (t == b)
+				{
+					// Last job, race any thief for it
+					if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					{
+						job = nullptr;
+					}
+					bottom.store(b + 1, std::memory_order_relaxed);
+				}
+
+				return job;
+			}
+
+			Job* Steal()
+			{
+				int64_t t = top.load(std::memory_order_acquire);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				const int64_t b = bottom.load(std::memory_order_acquire);
+				if (t >= b)
+				{
+					return nullptr;
+				}
+
+				Job* job = buffer[static_cast<size_t>(t) & Mask].load(std::memory_order_relaxed);
+				if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				{
+					return nullptr;
+				}
+
+				return job;
+			}
+
+		private:
+
+			static constexpr size_t Mask = JobSystemConfig::DequeCapacity - 1;
+			static_assert((JobSystemConfig::DequeCapacity & Mask) == 0, "DequeCapacity must be a power of two");
+
+			alignas(64) std::atomic<int64_t> top{ 0 };
+			alignas(64) std::atomic<int64_t> bottom{ 0 };
+			std::atomic<Job*> buffer[JobSystemConfig::DequeCapacity]{};
+
+		};
+
+		struct SpawnedJob : Job
+		{
+			std::function<void(uint32_t)> task;
+			JobHandle handle;
+		};
+
+		JobSystem()
+		{
+			// Whoever constructs the system owns slot 0, in practice the main thread through the first SceneBVH or benchmark call
+			tSlot = 0;
+
+			if constexpr (!JobSystemConfig::Enabled)
+			{
+				dequeCount = 1;
+				deques = std::make_unique<WorkStealingDeque[]>(dequeCount);
+				return;
+			}
+
+			uint32_t hardwareThreads = std::thread::hardware_concurrency();
+			if (hardwareThreads == 0)
+			{
+				hardwareThreads = 1;
+			}
+
+			uint32_t desiredWorkers = 0;
+			if (hardwareThreads > JobSystemConfig::ReserveHardwareThreads)
+			{
+				desiredWorkers = hardwareThreads - JobSystemConfig::ReserveHardwareThreads;
+			}
+
+			desiredWorkers = std::min<uint32_t>(desiredWorkers, JobSystemConfig::MaxWorkerThreads);
+
+			// Deques never move once workers start, so they are all created up front
+			dequeCount = desiredWorkers + 1;
+			deques = std::make_unique<WorkStealingDeque[]>(dequeCount);
+			workers.reserve(desiredWorkers);
+
+			for (uint32_t workerIndex = 0; workerIndex < desiredWorkers; ++workerIndex)
+			{
+				workers.emplace_back(&JobSystem::WorkerMain, this, workerIndex + 1);
+			}
+		}
+
+		~JobSystem()
+		{
+			{
+				std::lock_guard<std::mutex> lock(sleepMutex);
+				stop.store(true, std::memory_order_seq_cst);
+			}
+			sleepCv.notify_all();
+
+			for (std::thread& worker : workers)
+			{
+				if (worker.joinable())
+				{
+					worker.join();
+				}
+			}
+		}
+
+		// Fills jobCount jobs through setup, runs the first on this thread when it is a participant and waits on the rest
+		template<typename Setup>
+		void RunJobs(size_t jobCount, Setup&& setup)
+		{
+			JobCounter counter(static_cast<uint32_t>(jobCount));
+
+			Job inlineJobs[JobSystemConfig::InlineLoopJobs];
+			std::unique_ptr<Job[]> heapJobs;
+			Job* jobs = inlineJobs;
+			if (jobCount > JobSystemConfig::InlineLoopJobs)
+			{
+				heapJobs = std::make_unique<Job[]>(jobCount);
+				jobs = heapJobs.get();
+			}
+
+			for (size_t jobIndex = 0; jobIndex < jobCount; ++jobIndex)
+			{
+				setup(jobs[jobIndex], jobIndex);
+				jobs[jobIndex].counter = &counter;
+			}
+
+			const uint32_t slot = tSlot;
+			const size_t firstQueued = (slot == InvalidSlot) ? 0 : 1;
+
+			// Pushed back to front, so the owner pops the next chunk in order while thieves take the far end
+			for (size_t jobIndex = jobCount; jobIndex > firstQueued; --jobIndex)
+			{
+				Submit(&jobs[jobIndex - 1]);
+			}
+			WakeWorkers(static_cast<uint32_t>(jobCount - firstQueued));
+
+			if (firstQueued == 1)
+			{
+				RunJob(&jobs[0], slot);
+			}
+
+			Wait(counter);
+		}
+
+		void Submit(Job* job)
+		{
+			if (workers.empty())
+			{
+				// Nobody else would ever pick it up
+				RunJob(job, GetCurrentWorkerIndex());
+				return;
+			}
+
+			const uint32_t slot = tSlot;
+			if (slot != InvalidSlot && deques[slot].Push(job))
+			{
+				return;
+			}
+
+			if (slot != InvalidSlot)
+			{
+				// Own deque is full, running it now is always correct and keeps memory bounded
+				RunJob(job, slot);
+				return;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(injectionMutex);
+				injectionQueue.push_back(job);
+				injectionCount.fetch_add(1, std::memory_order_release);
+			}
+		}
+
+		void WakeWorkers(uint32_t jobCount)
+		{
+			workEpoch.fetch_add(1, std::memory_order_seq_cst);
+			if (jobCount == 0 || sleepingWorkers.load(std::memory_order_seq_cst) == 0)
+			{
+				return;
+			}
+
+			{
+				// Taking the lock orders this notify after a worker that is between its last check and its wait
+				std::lock_guard<std::mutex> lock(sleepMutex);
+			}
+
+			if (jobCount == 1)
+			{
+				sleepCv.notify_one();
+			}
+			else
+			{
+				sleepCv.notify_all();
+			}
+		}
+
+		Job* FindJob(uint32_t slot)
+		{
+			if (Job* job = deques[slot].Pop())
+			{
+				return job;
+			}
+
+			if (injectionCount.load(std::memory_order_acquire) > 0)
+			{
+				std::lock_guard<std::mutex> lock(injectionMutex);
+				if (!injectionQueue.empty())
+				{
+					Job* job = injectionQueue.front();
+					injectionQueue.pop_front();
+					injectionCount.fetch_sub(1, std::memory_order_relaxed);
+					return job;
+				}
+			}
+
+			// Start at a different victim per thread so thieves do not all hammer the same deque
+			for (uint32_t offset = 1; offset < dequeCount; ++offset)
+			{
+				const uint32_t victim = (slot + offset) % dequeCount;
+				if (Job* job = deques[victim].Steal())
+				{
+					return job;
+				}
+			}
+
+			return nullptr;
+		}
+
+		// Only WorkerMain calls this, after FindJob came back empty
+		Job* FindBackgroundJob()
+		{
+			if (backgroundCount.load(std::memory_order_acquire) == 0)
+			{
+				return nullptr;
+			}
+
+			std::lock_guard<std::mutex> lock(backgroundMutex);
+			if (backgroundQueue.empty())
+			{
+				return nullptr;
+			}
+
+			Job* job = backgroundQueue.front();
+			backgroundQueue.pop_front();
+			backgroundCount.fetch_sub(1, std::memory_order_relaxed);
+			return job;
+		}
+
+		void RunJob(Job* job, uint32_t slot)
+		{
+			JobCounter* counter = job->counter;
+			{
+				SWIM_PROFILE_ZONE("Job");
+				job->execute(*job, slot);
+			}
+
+			if (counter != nullptr)
+			{
+				CompleteOne(*counter);
+			}
+		}
+
+		void CompleteOne(JobCounter& counter)
+		{
+			if (counter.pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				Complete(counter);
+			}
+		}
+
+		void Complete(JobCounter& counter)
+		{
+			std::vector<Job*> ready;
+			{
+				std::lock_guard<std::mutex> lock(counter.mutex);
+				counter.finished.store(true, std::memory_order_release);
+				ready.swap(counter.continuations);
+				counter.doneCv.notify_all();
+			}
+
+			for (Job* job : ready)
+			{
+				if (job->unresolvedDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				{
+					Submit(job);
+				}
+			}
+
+			if (!ready.empty())
+			{
+				WakeWorkers(static_cast<uint32_t>(ready.size()));
+			}
+		}
+
+		// False when the counter already finished, the caller then treats that dependency as resolved
+		bool AddContinuation(JobCounter& counter, Job* job)
+		{
+			std::lock_guard<std::mutex> lock(counter.mutex);
+			if (counter.finished.load(std::memory_order_relaxed))
+			{
+				return false;
+			}
+
+			counter.continuations.push_back(job);
+			return true;
+		}
+
+		static void ExecuteSpawned(Job& job, uint32_t workerIndex)
+		{
+			SpawnedJob* spawned = static_cast<SpawnedJob*>(&job);
+			spawned->task(workerIndex);
+
+			// Hold the handle past the delete, the counter lives inside it and dependants may be waiting on it
+			JobHandle handle = std::move(spawned->handle);
+			delete spawned;
+			Get().CompleteOne(*handle);
+		}
+
+		void WorkerMain(uint32_t slot)
+		{
+			tSlot = slot;
+			Profiler::Get().SetCurrentThreadName("Job Worker " + std::to_string(slot));
+
+			uint32_t idleSpins = 0;
+			while (!stop.load(std::memory_order_acquire))
+			{
+				if (Job* job = FindJob(slot))
+				{
+					RunJob(job, slot);
+					idleSpins = 0;
+					continue;
+				}
+
+				if (Job* job = FindBackgroundJob())
+				{
+					RunJob(job, slot);
+					idleSpins = 0;
+					continue;
+				}
+
+				if (++idleSpins < JobSystemConfig::SpinsBeforeSleep)
+				{
+					SWIM_JOB_SPIN_PAUSE();
+					continue;
+				}
+
+				// Read the epoch before the last look, so a push that lands after the look still changes it and wakes us
+				sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+				const uint64_t seenEpoch = workEpoch.load(std::memory_order_seq_cst);
+
+				Job* job = FindJob(slot);
+				if (job == nullptr)
+				{
+					job = FindBackgroundJob();
+				}
+
+				if (job != nullptr)
+				{
+					sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+					RunJob(job, slot);
+					idleSpins = 0;
+					continue;
+				}
+
+				{
+					std::unique_lock<std::mutex> lock(sleepMutex);
+					sleepCv.wait(lock, [&]()
+					{
+						return stop.load(std::memory_order_relaxed) || workEpoch.load(std::memory_order_seq_cst) != seenEpoch;
+					});
+				}
+
+				sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+				idleSpins = 0;
+			}
+		}
+
+		std::unique_ptr<WorkStealingDeque[]> deques; // index 0 belongs to the owning thread, index i to worker i
+		uint32_t dequeCount = 0;
+		std::vector<std::thread> workers;
+
+		std::mutex injectionMutex;
+		std::deque<Job*> injectionQueue; // jobs submitted by threads without a deque
+		std::atomic<size_t> injectionCount{ 0 };
+
+		std::mutex backgroundMutex;
+		std::deque<Job*> backgroundQueue; // SpawnBackground jobs, drained by idle workers only
+		std::atomic<size_t> backgroundCount{ 0 };
+
+		std::mutex sleepMutex;
+		std::condition_variable sleepCv;
+		std::atomic<uint64_t> workEpoch{ 0 };
+		std::atomic<uint32_t> sleepingWorkers{ 0 };
+		std::atomic<bool> stop{ false };
+
+		inline static thread_local uint32_t tSlot = InvalidSlot;
+	};
+
+}
@@ -0,0 +1,264 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// CPU profiler for finding out where a frame goes.
+// Every thread records zones into its own ring buffer, so recording never takes a lock and old zones are simply overwritten.
+// Recording is off by default, a zone then costs one relaxed atomic load. Toggle it at runtime with the "profiler" command.
+// The capture is written out as Chrome trace JSON, which chrome://tracing and ui.perfetto.dev both open.
+
+#ifndef SWIM_PROFILER_ENABLED
+#define SWIM_PROFILER_ENABLED 1
+#endif
+
+namespace Engine
+{
+
+	struct ProfilerConfig
+	{
+		static constexpr bool CompiledIn = SWIM_PROFILER_ENABLED != 0; // false strips every zone out at compile time
+		static constexpr size_t EventsPerThread = 1u << 16; // power of two, roughly a few seconds of zones per thread at 60fps
+	};
+
+	class Profiler
+	{
+
+	public:
+
+		static Profiler& Get()
+		{
+			static Profiler instance;
+			return instance;
+		}
+
+		Profiler(const Profiler&) = delete;
+		Profiler& operator=(const Profiler&) = delete;
+
+		static bool IsRecording()
+		{
+			if constexpr (!ProfilerConfig::CompiledIn)
+			{
+				return false;
+			}
+
+			return recording.load(std::memory_order_relaxed);
+		}
+
+		// Starting a new capture drops whatever the previous one recorded
+		void SetRecording(bool enable)
+		{
+			if constexpr (!ProfilerConfig::CompiledIn)
+			{
+				return;
+			}
+
+			if (enable && !recording.load(std::memory_order_relaxed))
+			{
+				std::lock_guard<std::mutex> lock(buffersMutex);
+				for (const std::unique_ptr<ThreadBuffer>& buffer : buffers)
+				{
+					buffer->clearedAt.store(buffer->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+				}
+			}
+
+			recording.store(enable, std::memory_order_relaxed);
+		}
+
+		// Names the calling thread in exported traces, call it once near the top of the thread.
+		// The ring buffer itself is only allocated once the thread records its first zone.
+		void SetCurrentThreadName(const std::string& name)
+		{
+			tThreadName = name;
+
+			if (tBuffer != nullptr)
+			{
+				std::lock_guard<std::mutex> lock(buffersMutex);
+				tBuffer->name = name;
+			}
+		}
+
+		uint64_t NowNs() const
+		{
+			return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+		}
+
+		// name must outlive the profiler, string literals and __FUNCTION__ are what the zone macros pass
+		void Record(const char* name, uint64_t startNs, uint64_t endNs)
+		{
+			ThreadBuffer& buffer = GetThreadBuffer();
+			const uint64_t head = buffer.head.load(std::memory_order_relaxed);
+
+			Event& event = buffer.events[head & (ProfilerConfig::EventsPerThread - 1)];
+			event.name = name;
+			event.startNs = startNs;
+			event.endNs = endNs;
+
+			buffer.head.store(head + 1, std::memory_order_release);
+		}
+
+		// Best called while recording is off or between frames, zones that get overwritten mid export can come out garbled
+		bool ExportChromeTrace(const std::string& path)
+		{
+			std::ofstream file(path, std::ios::out | std::ios::trunc);
+			if (!file.is_open())
+			{
+				std::cerr << "[Profiler] Could not open " << path << " for writing" << std::endl;
+				return false;
+			}
+
+			file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+			bool first = true;
+
+			std::lock_guard<std::mutex> lock(buffersMutex);
+			for (const std::unique_ptr<ThreadBuffer>& buffer : buffers)
+			{
+				file << (first ? "" : ",\n");
+				file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId
+					<< ",\"args\":{\"name\":\"" << EscapeJson(buffer->name) << "\"}}";
+				first = false;
+
+				const uint64_t head = buffer->head.load(std::memory_order_acquire);
+				uint64_t begin = buffer->clearedAt.load(std::memory_order_relaxed);
+				if (head - begin > ProfilerConfig::EventsPerThread)
+				{
+					begin = head - ProfilerConfig::EventsPerThread;
+				}
+
+				for (uint64_t i = begin; i < head; ++i)
+				{
+					const Event& event = buffer->events[i & (ProfilerConfig::EventsPerThread - 1)];
+
+					// Chrome wants microseconds, keep the fraction so sub microsecond zones still show up
+					file << ",\n{\"name\":\"" << EscapeJson(event.name ? event.name : "?") << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+						<< ",\"ts\":" << (static_cast<double>(event.startNs) / 1000.0)
+						<< ",\"dur\":" << (static_cast<double>(event.endNs - event.startNs) / 1000.0) << "}";
+				}
+			}
+
+			file << "\n]}\n";
+			return true;
+		}
+
+	private:
+
+		struct Event
+		{
+			const char* name = nullptr;
+			uint64_t startNs = 0;
+			uint64_t endNs = 0;
+		};
+
+		// Only the owning thread writes, the exporter reads up to head
+		struct ThreadBuffer
+		{
+			std::unique_ptr<Event[]> events = std::make_unique<Event[]>(ProfilerConfig::EventsPerThread);
+			std::atomic<uint64_t> head{ 0 };
+			std::atomic<uint64_t> clearedAt{ 0 };
+			uint32_t threadId = 0;
+			std::string name;
+		};
+
+		Profiler() : epoch(std::chrono::steady_clock::now()) {}
+
+		// Buffers are kept until shutdown even if their thread exits, so the exporter never has to worry about them vanishing
+		ThreadBuffer& GetThreadBuffer()
+		{
+			if (tBuffer == nullptr)
+			{
+				std::lock_guard<std::mutex> lock(buffersMutex);
+				buffers.push_back(std::make_unique<ThreadBuffer>());
+				tBuffer = buffers.back().get();
+				tBuffer->threadId = static_cast<uint32_t>(buffers.size());
+				tBuffer->name = tThreadName.empty() ? "Thread " + std::to_string(tBuffer->threadId) : tThreadName;
+			}
+
+			return *tBuffer;
+		}
+
+		static std::string EscapeJson(const std::string& text)
+		{
+			std::string escaped;
+			escaped.reserve(text.size());
+
+			for (char c : text)
+			{
+				if (c == '"' || c == '\\')
+				{
+					escaped += '\\';
+					escaped += c;
+				}
+				else if (static_cast<unsigned char>(c) >= 0x20)
+				{
+					escaped += c;
+				}
+			}
+
+			return escaped;
+		}
+
+		const std::chrono::steady_clock::time_point epoch;
+
+		std::mutex buffersMutex;
+		std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+		inline static std::atomic<bool> recording{ false };
+		inline static thread_local ThreadBuffer* tBuffer = nullptr;
+		inline static thread_local std::string tThreadName;
+
+	};
+
+	// Records the time between construction and destruction, if recording was on when the zone opened
+	class ProfileZone
+	{
+
+	public:
+
+		explicit ProfileZone(const char* zoneName)
+		{
+			if (Profiler::IsRecording())
+			{
+				name = zoneName;
+				startNs = Profiler::Get().NowNs();
+			}
+		}
+
+		~ProfileZone()
+		{
+			if (name != nullptr)
+			{
+				Profiler& profiler = Profiler::Get();
+				profiler.Record(name, startNs, profiler.NowNs());
+			}
+		}
+
+		ProfileZone(const ProfileZone&) = delete;
+		ProfileZone& operator=(const ProfileZone&) = delete;
+
+	private:
+
+		const char* name = nullptr;
+		uint64_t startNs = 0;
+
+	};
+
+}
+
+#define SWIM_PROFILE_CONCAT_INNER(a, b) a##b
+#define SWIM_PROFILE_CONCAT(a, b) SWIM_PROFILE_CONCAT_INNER(a, b)
+
+#if SWIM_PROFILER_ENABLED
+// name has to be a string literal or otherwise live forever
+#define SWIM_PROFILE_ZONE(name) ::Engine::ProfileZone SWIM_PROFILE_CONCAT(swimProfileZone, __LINE__)(name)
+#define SWIM_PROFILE_FUNCTION() SWIM_PROFILE_ZONE(__FUNCTION__)
+#else
+#define SWIM_PROFILE_ZONE(name) ((void)0)
+#define SWIM_PROFILE_FUNCTION() ((void)0)
+#endif
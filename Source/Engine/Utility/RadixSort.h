@@ -0,0 +1,146 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "ParallelUtils.h"
+
+// LSD radix sort of 64 bit keys carrying a 32 bit payload, for the per frame sorts of the renderer.
+// Big inputs are cut into one block per worker: every block builds its own digit histogram, and then scatters into the range the prefix sums give it, so the sort stays stable.
+
+namespace Engine
+{
+
+	struct RadixSortConfig
+	{
+		static constexpr uint32_t DigitBits = 8;
+		static constexpr uint32_t DigitCount = 1u << DigitBits;
+		static constexpr size_t MinParallelItemCount = 16384; // below this a single thread wins, the passes are memory bound
+	};
+
+	// Kept by the caller so a sort every frame does not allocate
+	struct RadixSortScratch
+	{
+		std::vector<uint64_t> keys;
+		std::vector<uint32_t> payloads;
+		std::vector<uint32_t> histograms; // DigitCount per block
+	};
+
+	// Sorts keys ascending and moves payloads along with them. Equal keys keep their order.
+	// Digits that are the same in every key are skipped, so keys that only use a few bytes only pay for those.
+	inline void RadixSortPairs(std::vector<uint64_t>& keys, std::vector<uint32_t>& payloads, RadixSortScratch& scratch)
+	{
+		const size_t count = keys.size();
+		if (count < 2)
+		{
+			return;
+		}
+
+		uint64_t anyBits = 0;
+		uint64_t allBits = ~0ull;
+		for (uint64_t key : keys)
+		{
+			anyBits |= key;
+			allBits &= key;
+		}
+		const uint64_t varyingBits = anyBits ^ allBits;
+		if (varyingBits == 0)
+		{
+			return; // all equal, already sorted
+		}
+
+		const bool parallel = RenderCpuJobConfig::Enabled
+			&& count >= RadixSortConfig::MinParallelItemCount
+			&& GetRenderParallelWorkerSlots() > 1;
+
+		// Fixed block boundaries, each block's histogram has to match what the same block scatters later
+		const size_t blockCount = parallel ? GetRenderParallelWorkerSlots() : 1;
+		const size_t blockSize = (count + blockCount - 1) / blockCount;
+
+		scratch.keys.resize(count);
+		scratch.payloads.resize(count);
+		scratch.histograms.resize(blockCount * RadixSortConfig::DigitCount);
+
+		uint64_t* srcKeys = keys.data();
+		uint32_t* srcPayloads = payloads.data();
+		uint64_t* dstKeys = scratch.keys.data();
+		uint32_t* dstPayloads = scratch.payloads.data();
+		bool inScratch = false;
+
+		const auto forEachBlock = [&](auto&& func)
+		{
+			if (parallel)
+			{
+				ParallelForRenderTasks(blockCount, [&](size_t block, uint32_t /*workerIndex*/)
+				{
+					func(block);
+				});
+			}
+			else
+			{
+				func(0);
+			}
+		};
+
+		for (uint32_t shift = 0; shift < 64; shift += RadixSortConfig::DigitBits)
+		{
+			if (((varyingBits >> shift) & (RadixSortConfig::DigitCount - 1)) == 0)
+			{
+				continue;
+			}
+
+			forEachBlock([&](size_t block)
+			{
+				uint32_t* histogram = scratch.histograms.data() + block * RadixSortConfig::DigitCount;
+				std::fill(histogram, histogram + RadixSortConfig::DigitCount, 0u);
+
+				const size_t begin = block * blockSize;
+				const size_t end = std::min(count, begin + blockSize);
+				for (size_t i = begin; i < end; ++i)
+				{
+					++histogram[(srcKeys[i] >> shift) & (RadixSortConfig::DigitCount - 1)];
+				}
+			});
+
+			// Exclusive prefix over (digit, block), so block 0's share of a digit comes before block 1's
+			uint32_t offset = 0;
+			for (uint32_t digit = 0; digit < RadixSortConfig::DigitCount; ++digit)
+			{
+				for (size_t block = 0; block < blockCount; ++block)
+				{
+					uint32_t& slot = scratch.histograms[block * RadixSortConfig::DigitCount + digit];
+					const uint32_t digitCount = slot;
+					slot = offset;
+					offset += digitCount;
+				}
+			}
+
+			forEachBlock([&](size_t block)
+			{
+				uint32_t* cursors = scratch.histograms.data() + block * RadixSortConfig::DigitCount;
+
+				const size_t begin = block * blockSize;
+				const size_t end = std::min(count, begin + blockSize);
+				for (size_t i = begin; i < end; ++i)
+				{
+					const uint32_t to = cursors[(srcKeys[i] >> shift) & (RadixSortConfig::DigitCount - 1)]++;
+					dstKeys[to] = srcKeys[i];
+					dstPayloads[to] = srcPayloads[i];
+				}
+			});
+
+			std::swap(srcKeys, dstKeys);
+			std::swap(srcPayloads, dstPayloads);
+			inScratch = !inScratch;
+		}
+
+		if (inScratch)
+		{
+			keys.swap(scratch.keys);
+			payloads.swap(scratch.payloads);
+		}
+	}
+
+}
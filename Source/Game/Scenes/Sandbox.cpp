@@ -33,6 +33,11 @@ namespace Game
 	constexpr static bool doWorldSpaceParentTesting = true; // via orbit system
 	constexpr static bool physicsPrimitivesTest = true; // spawn a ton of dynamic primitives with rigidbodies over a big plane
 
+	// The Sponza load in flight and the entity it goes onto once Update sees it finished
+	static const std::string sponzaPath = "Assets/Models/Sponza/sponza-ktx-draco.glb";
+	static Engine::GlbLoadHandle sponzaLoad;
+	static entt::entity sponzaEntity = entt::null;
+
 	int SandBox::Awake()
 	{
 		std::cout << name << " Awoke" << std::endl;
@@ -187,39 +192,23 @@ namespace Game
 		auto sofaModel = materialPool.LazyLoadAndGetCompositeMaterial("Assets/Models/webp_sofa.glb");
 		AddComponent<Engine::CompositeMaterial>(couch, Engine::CompositeMaterial(sofaModel, "Assets/Models/webp_sofa.glb"));
 
-		// Sponza 3D model test
+		// Sponza 3D model test, streamed in on a background worker while the scene already runs. Update polls the load.
 		if constexpr (doSponza)
 		{
-			std::vector<std::shared_ptr<Engine::MaterialData>> sponzaData;
-			std::cout << "Sponza load time\n";
+			std::cout << "Sponza load started\n";
 
 			// unpacked raw version that is much easier to parse, but not efficent + fat on disk (deleted from repo it was so fat)
-			// sponzaData = materialPool.LoadAndRegisterCompositeMaterialFromGLB("Assets/Models/Sponza/Raw/sponza.glb"); // 156 MB
+			// sponzaLoad = materialPool.LoadCompositeMaterialFromGLBAsync("Assets/Models/Sponza/Raw/sponza.glb"); // 156 MB
 
 			// compressed version + using ktx for textures, efficent
-			// sponzaData = materialPool.LoadAndRegisterCompositeMaterialFromGLB("Assets/Models/Sponza/sponza-ktx.glb"); // 15 MB
+			// sponzaLoad = materialPool.LoadCompositeMaterialFromGLBAsync("Assets/Models/Sponza/sponza-ktx.glb"); // 15 MB
 
 			// super compressed draco version, very efficent and fast, perfect for release
-			sponzaData = materialPool.LoadAndRegisterCompositeMaterialFromGLB("Assets/Models/Sponza/sponza-ktx-draco.glb"); // 9 MB
-
-			glm::vec3 sponzaScale = glm::vec3(1.0f);
-
-			if (materialPool.CompositeMaterialExists("Assets/Models/barrel.glb") && sponzaData.empty()) // if barrel exists and sponza wasn't loaded, set the data to the barrel
-			{
-				sponzaData = materialPool.GetCompositeMaterialData("Assets/Models/barrel.glb");
-			}
-			else if (sponzaData.empty()) // if barrel doesn't exist and sponza wasnt loaded, load and set the data to the barrel
-			{
-				sponzaData = materialPool.LoadAndRegisterCompositeMaterialFromGLB("Assets/Models/barrel.glb");
-			}
-
-			// Just hand waving it for file path arg
-			Engine::CompositeMaterial sponzaCompositeMaterial = Engine::CompositeMaterial(sponzaData, "Assets/Models/Sponza/sponza-ktx-draco.glb");
+			sponzaLoad = materialPool.LoadCompositeMaterialFromGLBAsync(sponzaPath); // 9 MB
 
-			auto sponza = CreateEntity();
-			SetTag(sponza, Engine::TagConstants::WORLD, "sponza");
-			AddComponent<Engine::Transform>(sponza, Engine::Transform(glm::vec3(3.0f, 0.0f, -12.0f), sponzaScale));
-			AddComponent<Engine::CompositeMaterial>(sponza, sponzaCompositeMaterial);
+			sponzaEntity = CreateEntity();
+			SetTag(sponzaEntity, Engine::TagConstants::WORLD, "sponza");
+			AddComponent<Engine::Transform>(sponzaEntity, Engine::Transform(glm::vec3(3.0f, 0.0f, -12.0f), glm::vec3(1.0f)));
 		}
 
 		int textureCountAfter = Engine::Texture2D::GetTextureCountOnGPU();
@@ -273,9 +262,48 @@ namespace Game
 		drawer->SubmitWireframeBox(glm::vec3(0.f, 0.f, 0.f), glm::vec3(1.0f));
 	}
 
+	// Registers the finished Sponza load and puts it on its entity, falls back to the barrel if it failed
+	static void AttachSponza(Engine::Scene* scene)
+	{
+		auto& materialPool = Engine::MaterialPool::GetInstance();
+
+		std::vector<std::shared_ptr<Engine::MaterialData>> sponzaData;
+		try
+		{
+			sponzaData = materialPool.FinishCompositeMaterialLoad(sponzaLoad);
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << "Sponza failed to load: " << e.what() << std::endl;
+		}
+		sponzaLoad.reset();
+
+		if (materialPool.CompositeMaterialExists("Assets/Models/barrel.glb") && sponzaData.empty()) // if barrel exists and sponza wasn't loaded, set the data to the barrel
+		{
+			sponzaData = materialPool.GetCompositeMaterialData("Assets/Models/barrel.glb");
+		}
+		else if (sponzaData.empty()) // if barrel doesn't exist and sponza wasnt loaded, load and set the data to the barrel
+		{
+			sponzaData = materialPool.LoadAndRegisterCompositeMaterialFromGLB("Assets/Models/barrel.glb");
+		}
+
+		if (!scene->GetRegistry().valid(sponzaEntity))
+		{
+			return;
+		}
+
+		// Just hand waving it for file path arg
+		scene->AddComponent<Engine::CompositeMaterial>(sponzaEntity, Engine::CompositeMaterial(sponzaData, sponzaPath));
+	}
+
 	void SandBox::Update(double dt)
 	{
 		// WireframeTest(this);
+
+		if (sponzaLoad && Engine::MaterialPool::IsCompositeMaterialLoadReady(sponzaLoad))
+		{
+			AttachSponza(this);
+		}
 	}
 
 	void SandBox::FixedUpdate(unsigned int tickThisSecond)
@@ -286,6 +314,11 @@ namespace Game
 	int SandBox::Exit()
 	{
 		std::cout << name << " Exiting" << std::endl;
+
+		// An unfinished load just gets dropped, its job keeps what it needs alive until it is done
+		sponzaLoad.reset();
+		sponzaEntity = entt::null;
+
 		return Scene::Exit();
 	}
 
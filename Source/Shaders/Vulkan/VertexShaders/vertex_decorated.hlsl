@@ -12,19 +12,22 @@ cbuffer CameraUBO : register(b0, space0)
 
 struct GpuInstanceData
 {
-  float4x4 model;
-  float4 aabbMin;
-  float4 aabbMax;
+  float4 modelRow0;     // affine model matrix rows, translation in w
+  float4 modelRow1;
+  float4 modelRow2;
+
   uint textureIndex;
-  float hasTexture;
-  uint meshInfoIndex;
+  uint meshInfoIndex;   // mesh ID, per mesh data is not repeated per instance
   uint materialIndex;
-  uint indexCount;
-  uint space;  // 0 = world, 1 = screen
-  uint2 vertexOffsetInMegaBuffer;
-  uint2 indexOffsetInMegaBuffer;
+  uint flags;           // bit 0 = screen space, bit 1 = has texture
 };
 
+float3 TransformByInstance(GpuInstanceData instance, float3 position)
+{
+  float4 p = float4(position, 1.0f);
+  return float3(dot(instance.modelRow0, p), dot(instance.modelRow1, p), dot(instance.modelRow2, p));
+}
+
 [[vk::binding(1, 0)]]
 StructuredBuffer<GpuInstanceData> instanceBuffer : register(t1, space0);
 
@@ -76,24 +79,14 @@ VSOutput main(VSInput vin)
   MeshDecoratorGpuInstanceData deco = decoratorBuffer[inst.materialIndex];
   
   // Determine transform space
-  const bool isScreen = (inst.space == 1);
+  const bool isScreen = (inst.flags & 1u) != 0;
   
   // Select appropriate view/projection matrix
   float4x4 view = isScreen ? screenView : worldView;
   float4x4 proj = isScreen ? screenProj : worldProj;
   
-  float3 worldPos;
-  if (isScreen)
-  {
-    // In screen-space, model matrix directly gives pixel position
-    float4 local = float4(vin.position, 1.0f);
-    worldPos = mul(inst.model, local).xyz;
-  }
-  else
-  {
-    // In world-space, apply full model transform
-    worldPos = mul(inst.model, float4(vin.position, 1.0f)).xyz;
-  }
+  // In screen-space the model matrix directly gives the pixel position, in world-space it is the full model transform
+  float3 worldPos = TransformByInstance(inst, vin.position);
   
   // Final clip space position
   float4 clipPos = mul(proj, mul(view, float4(worldPos, 1.0f)));
@@ -131,7 +124,7 @@ VSOutput main(VSInput vin)
   // Pass-through values
   vout.uv = vin.uv;
   vout.textureIndex = inst.textureIndex;
-  vout.hasTexture = inst.hasTexture;
+  vout.hasTexture = (inst.flags & 2u) != 0 ? 1.0f : 0.0f;
   vout.instanceID = inst.materialIndex;
   vout.color = vin.color;
   
@@ -139,7 +132,8 @@ VSOutput main(VSInput vin)
   vout.quadSizePx = deco.quadSize * 0.5f;
   
   // Compute center of quad in screen-space for SDF math
-  float4 clipCentre = mul(proj, mul(view, float4(inst.model[3].xyz, 1.0f)));
+  float3 centre = float3(inst.modelRow0.w, inst.modelRow1.w, inst.modelRow2.w);
+  float4 clipCentre = mul(proj, mul(view, float4(centre, 1.0f)));
   float2 ndcCentre = clipCentre.xy / clipCentre.w;
   vout.centerPx = (ndcCentre * 0.5f + 0.5f) * viewportSize;
   
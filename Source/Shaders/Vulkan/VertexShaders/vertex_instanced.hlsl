@@ -13,26 +13,30 @@ cbuffer CameraUBO : register(b0, space0)
 
 struct GpuInstanceData
 {
-  float4x4 model;
-
-  float4 aabbMin;
-  float4 aabbMax;
+  float4 modelRow0;     // affine model matrix rows, translation in w
+  float4 modelRow1;
+  float4 modelRow2;
 
   uint textureIndex;
-  float hasTexture;
-  uint meshInfoIndex;
+  uint meshInfoIndex;   // mesh ID, per mesh data is not repeated per instance
   uint materialIndex;
-
-  uint indexCount;
-  uint space;                          // 0 = world, 1 = screen
-
-  uint2 vertexOffsetInMegaBuffer;      // emulate uint64_t
-  uint2 indexOffsetInMegaBuffer;       // emulate uint64_t
+  uint flags;           // bit 0 = screen space, bit 1 = has texture
 };
 
+float3 TransformByInstance(GpuInstanceData instance, float3 position)
+{
+  float4 p = float4(position, 1.0f);
+  return float3(dot(instance.modelRow0, p), dot(instance.modelRow1, p), dot(instance.modelRow2, p));
+}
+
+// Indexed by renderable slot, only written when a slot changes
 [[vk::binding(1, 0)]]
 StructuredBuffer<GpuInstanceData> instanceBuffer : register(t1, space0);
 
+// Slot of every drawn instance, grouped by mesh like the indirect commands
+[[vk::binding(4, 0)]]
+StructuredBuffer<uint> visibleSlots : register(t4, space0);
+
 struct VSInput
 {
   float3 position : POSITION;
@@ -54,13 +58,14 @@ VSOutput main(VSInput input)
 {
   VSOutput output;
 
-  GpuInstanceData instance = instanceBuffer[input.instanceID];
+  GpuInstanceData instance = instanceBuffer[visibleSlots[input.instanceID]];
 
   // Pick view/proj depending on transform space
-  float4x4 viewMatrix = (instance.space == 1) ? screenView : worldView;
-  float4x4 projMatrix = (instance.space == 1) ? screenProj : worldProj;
+  const bool isScreen = (instance.flags & 1u) != 0;
+  float4x4 viewMatrix = isScreen ? screenView : worldView;
+  float4x4 projMatrix = isScreen ? screenProj : worldProj;
 
-  float4 worldPos = mul(instance.model, float4(input.position, 1.0f));
+  float4 worldPos = float4(TransformByInstance(instance, input.position), 1.0f);
   float4 viewPos = mul(viewMatrix, worldPos);
   float4 projPos = mul(projMatrix, viewPos);
 
@@ -68,7 +73,7 @@ VSOutput main(VSInput input)
   output.color = input.color;
   output.uv = input.uv;
   output.textureIndex = instance.textureIndex;
-  output.hasTexture = instance.hasTexture;
+  output.hasTexture = (instance.flags & 2u) != 0 ? 1.0f : 0.0f;
 
   return output;
 }
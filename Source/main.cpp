@@ -1,5 +1,7 @@
 #include "PCH.h"
 #include "Engine/SwimEngine.h"
+#include "Engine/Systems/Benchmark/BenchmarkRunner.h"
+#include "Engine/Utility/JobSystem.h"
 
 // this makes it so no console appears in a release build
 #ifndef _SWIM_DEBUG
@@ -8,6 +10,13 @@
 
 int main(int argc, char** argv)
 {
+  // first use makes the calling thread slot 0 of the job system, so do it here before anything can touch it from another thread
+  Engine::JobSystem::Get();
+  Engine::Profiler::Get().SetCurrentThreadName("Main Thread");
+
+  // headless benchmark mode never creates the engine, window or GPU device (release builds have no console, so pass --bench-csv there)
+  if (Engine::BenchmarkRunner::WantsBenchmarkRun(argc, argv)) return Engine::BenchmarkRunner::RunFromArgs(argc, argv);
+
   auto engine = std::make_shared<Engine::SwimEngine>(Engine::SwimEngine::ParseStartingEngineArgs(argc, argv));
   if (engine->Start() == 0) return engine->Run(); // runs if started with zero errors
 